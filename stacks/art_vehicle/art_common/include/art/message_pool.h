@@ -0,0 +1,121 @@
+/* -*- mode: C++ -*-
+ *
+ *  ART pool of reusable outgoing ROS messages
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#ifndef _MESSAGE_POOL_H_
+#define _MESSAGE_POOL_H_
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+/**  @file
+
+     @brief ART pool of reusable outgoing ROS messages.
+
+     A node publishing large messages at a high rate fills one from
+     the pool each cycle and publishes it by shared pointer:
+
+     @code
+       art_msgs::ArtLanes::Ptr msg = pool_.get();
+       fill(*msg);                      // vectors keep their capacity
+       pub_.publish(msg);
+     @endcode
+
+     Once published, roscpp and any intra-process subscribers may
+     hold the message for a while, so it must not be modified again.
+     get() only hands out messages nobody else references, so the
+     vectors inside each message grow to their working size once and
+     are then reused.  When all of them are still referenced, it
+     allocates a new one and counts a miss.
+ */
+
+namespace ArtMsgPool
+{
+  template <class M>
+  class MessagePool
+  {
+  public:
+    typedef boost::shared_ptr<M> Ptr;
+
+    /** @brief constructor
+     *  @param size number of messages to preallocate
+     */
+    MessagePool(unsigned size = 4):
+      next_(0),
+      misses_(0)
+    {
+      resize(size);
+    }
+
+    /** @brief change the number of pooled messages
+     *
+     *  Messages still held elsewhere stay valid when removed from
+     *  the pool.
+     */
+    void resize(unsigned size)
+    {
+      if (size < 1)
+        size = 1;
+      pool_.resize(size);
+      for (unsigned i = 0; i < size; ++i)
+        {
+          if (!pool_[i])
+            pool_[i].reset(new M);
+        }
+      next_ = 0;
+    }
+
+    /** @brief get a message nobody else references
+     *
+     *  The message still contains whatever it held when last used.
+     */
+    Ptr get(void)
+    {
+      for (unsigned i = 0; i < pool_.size(); ++i)
+        {
+          Ptr &msg = pool_[next_];
+          next_ = (next_ + 1) % pool_.size();
+          if (msg.unique())
+            return msg;
+        }
+
+      // all still in use: replace the oldest, its holders keep it
+      ++misses_;
+      Ptr &msg = pool_[next_];
+      next_ = (next_ + 1) % pool_.size();
+      msg.reset(new M);
+      return msg;
+    }
+
+    /** @brief pooled message, for setting up its capacity */
+    M &operator[](unsigned i)
+    {
+      return *pool_[i];
+    }
+
+    /** @return number of pooled messages */
+    unsigned size(void) const
+    {
+      return pool_.size();
+    }
+
+    /** @return messages allocated because the pool ran out */
+    unsigned long misses(void) const
+    {
+      return misses_;
+    }
+
+  private:
+    std::vector<Ptr> pool_;
+    unsigned next_;                     ///< next message to try
+    unsigned long misses_;
+  };
+}
+
+#endif // _MESSAGE_POOL_H_
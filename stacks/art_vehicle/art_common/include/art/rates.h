@@ -0,0 +1,82 @@
+/* -*- mode: C++ -*-
+ *
+ *  ART node cycle rate parameters
+ *
+ *  Copyright (C) 2010 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#ifndef _RATES_H_
+#define _RATES_H_
+
+#include <ros/ros.h>
+
+/**  @file
+
+     @brief ART node cycle rate parameters.
+
+     The art_msgs/ArtHertz constants are only the defaults.  Each node
+     reads its actual cycle rate from its private "~hertz" parameter,
+     so rates can be changed at launch without recompiling.  Any
+     computation depending on the cycle rate must use the configured
+     value (or the measured cycle duration), never the constant.
+ */
+
+namespace ArtRates
+{
+  /** @brief get node cycle rate parameter
+   *
+   *  @param nh private node handle for this node
+   *  @param default_hz default rate (from art_msgs/ArtHertz)
+   *  @returns configured cycle rate (Hz)
+   */
+  inline double getHertz(const ros::NodeHandle &nh, double default_hz)
+  {
+    double hz;
+    nh.param("hertz", hz, default_hz);
+    if (!(hz > 0.0))
+      {
+        ROS_WARN("invalid cycle rate %.3f Hz, using %.3f Hz instead",
+                 hz, default_hz);
+        hz = default_hz;
+      }
+    ROS_INFO("cycle rate is %.3f Hz", hz);
+    return hz;
+  }
+
+  /** @brief elapsed time since previous cycle, bounded
+   *
+   *  Returns the measured duration since @a last, then updates it.
+   *  If the interval is negative (time source reset) or much longer
+   *  than the nominal cycle (node was not running that code), only
+   *  one nominal cycle is counted.
+   *
+   *  @param last time of previous call (updated), zero if none
+   *  @param cycle nominal cycle duration
+   *  @param now time of this call
+   *  @returns seconds elapsed since previous call
+   */
+  inline double elapsed(ros::Time &last, const ros::Duration &cycle,
+                        const ros::Time &now)
+  {
+    double dt = cycle.toSec();
+    if (!last.isZero())
+      {
+        double measured = (now - last).toSec();
+        if (measured >= 0.0 && measured <= 2.0 * cycle.toSec())
+          dt = measured;
+      }
+    last = now;
+    return dt;
+  }
+
+  /** @brief elapsed time since previous cycle, bounded, until now */
+  inline double elapsed(ros::Time &last, const ros::Duration &cycle)
+  {
+    return elapsed(last, cycle, ros::Time::now());
+  }
+};
+
+#endif // _RATES_H_
@@ -11,6 +11,7 @@
 #include <tf/transform_broadcaster.h>
 
 #include <art/frames.h>
+#include <art/rates.h>
 #include <art_msgs/ArtHertz.h>
 #include <art_msgs/ArtVehicle.h>
 
@@ -43,7 +44,8 @@ namespace
   /// These are *static* transforms, so it's safe to post-date them
   //  into the future.  Otherwise, some transform listeners will see
   //  old data at times.
-  ros::Duration transform_post_date_(1.0/art_msgs::ArtHertz::VEHICLE_TF);
+  //  (Set to one cycle at the configured rate.)
+  ros::Duration transform_post_date_;
 
   // class for generating vehicle-relative frame IDs
   ArtFrames::VehicleRelative vr_;
@@ -114,7 +116,10 @@ int main(int argc, char** argv)
   tf::TransformBroadcaster tf_broadcaster;
   vr_.getPrefixParam();                 // get vehicle-relative tf prefix
 
-  ros::Rate cycle(art_msgs::ArtHertz::VEHICLE_TF); // set driver cycle rate
+  ros::NodeHandle mynh("~");
+  double hz = ArtRates::getHertz(mynh, art_msgs::ArtHertz::VEHICLE_TF);
+  transform_post_date_ = ros::Duration(1.0 / hz);
+  ros::Rate cycle(hz);                  // set driver cycle rate
   
   // Start the dynamic reconfigure server to set the transform values
   dynamic_reconfigure::Server<art_common::CameraTransformConfig> srv;
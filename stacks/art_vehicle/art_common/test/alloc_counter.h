@@ -0,0 +1,111 @@
+/* -*- mode: C++ -*-
+ *
+ *  ART heap allocation counter for unit tests
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#ifndef _ALLOC_COUNTER_H_
+#define _ALLOC_COUNTER_H_
+
+#include <stdlib.h>
+#include <new>
+
+/**  @file
+
+     @brief ART heap allocation counter for unit tests.
+
+     Replaces the global operator new and delete with versions that
+     count every allocation, so a test can verify that the steady
+     state cycle of a control node does not touch the heap:
+
+     @code
+       for (int i = 0; i < WARM_UP; ++i)
+         run_cycle();                   // vectors reach full size
+       ArtAlloc::Counter allocs;
+       for (int i = 0; i < N_CYCLES; ++i)
+         run_cycle();
+       EXPECT_EQ(0u, allocs.count());
+     @endcode
+
+     Since it defines the replacement operators, this header must be
+     included in exactly one source file of a test program, and never
+     in a node or library.  That is why it lives in the test
+     directory, outside the package include path: each test target
+     adds art_common/test to its own compile flags.  Allocations made
+     directly with malloc() are not counted.
+
+     Counts are per thread, and a Counter only sees the thread that
+     created it.  Under rostest, roscpp's background threads (rosout,
+     XML-RPC, the network poller) allocate at any time; they neither
+     race with the test thread's count nor show up in it.  So the
+     cycle being checked must run in the thread that owns the Counter.
+ */
+
+namespace ArtAlloc
+{
+  /** @brief total operator new calls in the calling thread */
+  inline unsigned long &total(void)
+  {
+    static __thread unsigned long allocations = 0;
+    return allocations;
+  }
+
+  /** @brief counts this thread's allocations since it was constructed */
+  class Counter
+  {
+  public:
+    Counter():
+      start_(total())
+    {}
+
+    /** @return allocations since constructed or reset */
+    unsigned long count(void) const
+    {
+      return total() - start_;
+    }
+
+    /** @brief restart counting from zero */
+    void reset(void)
+    {
+      start_ = total();
+    }
+
+  private:
+    unsigned long start_;
+  };
+
+  inline void *allocate(size_t size)
+  {
+    ++total();
+    void *ptr = malloc(size? size: 1);
+    if (ptr == NULL)
+      throw std::bad_alloc();
+    return ptr;
+  }
+}
+
+void *operator new(size_t size) throw(std::bad_alloc)
+{
+  return ArtAlloc::allocate(size);
+}
+
+void *operator new[](size_t size) throw(std::bad_alloc)
+{
+  return ArtAlloc::allocate(size);
+}
+
+void operator delete(void *ptr) throw()
+{
+  free(ptr);
+}
+
+void operator delete[](void *ptr) throw()
+{
+  free(ptr);
+}
+
+#endif // _ALLOC_COUNTER_H_
@@ -0,0 +1,61 @@
+/* -*- mode: C++ -*-
+ *
+ *  Convex polygon clipping and overlap
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#ifndef _CONVEX_POLYGON_H_
+#define _CONVEX_POLYGON_H_
+
+#include <vector>
+#include <art_msgs/ArtLanes.h>
+#include <art_map/PolyOps.h>
+
+/**  @file
+
+     @brief Exact clipping and intersection area for convex polygons.
+
+     Lane quadrilaterals and zone perimeters are convex, so any two of
+     them intersect in a convex polygon, computed here by clipping one
+     against each edge of the other (Sutherland-Hodgman).  Vertices
+     may be in either clockwise or counter-clockwise order.
+
+     The batch functions compare one region against a list of
+     polygons, rejecting most of them with a bounding box test before
+     clipping, and reuse their working storage.
+ */
+
+namespace ConvexPolygon
+{
+  void fromPoly(const poly &p, mapxy_list_t &vertices);
+  void fromQuad(const art_msgs::ArtQuadrilateral &q, mapxy_list_t &vertices);
+
+  float signedArea(const mapxy_list_t &vertices);
+  float area(const mapxy_list_t &vertices);
+
+  bool clip(const mapxy_list_t &subject, const mapxy_list_t &clipper,
+            mapxy_list_t &result);
+
+  float intersectionArea(const mapxy_list_t &a, const mapxy_list_t &b);
+  float intersectionArea(const poly &a, const poly &b);
+  float intersectionArea(const art_msgs::ArtQuadrilateral &a,
+                         const art_msgs::ArtQuadrilateral &b);
+
+  void intersectionAreas(const mapxy_list_t &region,
+                         const poly_list_t &polys,
+                         std::vector<float> &areas);
+  unsigned overlapping(const mapxy_list_t &region,
+                       const poly_list_t &polys,
+                       float min_area,
+                       std::vector<int> &indices);
+  unsigned overlapping(const mapxy_list_t &region,
+                       const art_msgs::ArtLanes &quads,
+                       float min_area,
+                       std::vector<int> &indices);
+}
+
+#endif // _CONVEX_POLYGON_H_
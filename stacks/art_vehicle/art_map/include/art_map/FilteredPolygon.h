@@ -18,6 +18,9 @@ class FilteredPolygon
   FilteredPolygon();
   ~FilteredPolygon() {};
 
+  void Restart();
+  /** @return true if vision updated since constructed or restarted */
+  bool Updated() const { return updated_; }
   void SetPoint(int pointID, float x, float y);
   void UpdatePoint(int pointID, float visionDistance, float visionAngle,
                    float confidence,float rx, float ry, float rori);
@@ -30,9 +33,12 @@ class FilteredPolygon
 
   void SetPolygon(poly p);
   poly GetPolygon();
+  MapXY GetMidpoint();
   art_msgs::ArtQuadrilateral GetQuad();
+  void GetQuad(art_msgs::ArtQuadrilateral &q);
 
  private:
+  bool updated_;
   poly polygon_;
   PolyOps ops_;
 };
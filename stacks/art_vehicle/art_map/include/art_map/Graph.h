@@ -22,9 +22,11 @@
 #include <algorithm>
 #include <fstream>
 #include <cstdlib>
+#include <boost/thread/mutex.hpp>
 
 #include <art_map/coordinates.h>
 #include <art_map/types.h>
+#include <art_map/GraphIndex.h>
 
 typedef std::vector<WayPointEdge> WayPointEdgeList;
 typedef std::vector<WayPointNode> WayPointNodeList;
@@ -40,6 +42,7 @@ class Graph{
     edges_size = 0;
     nodes=NULL;
     edges.clear();
+    generation_ = 0;
   };
 
   Graph(uint num_nodes, uint num_edges, 
@@ -54,6 +57,7 @@ class Graph{
     edges.clear();
    for (uint i=0; i< num_edges; i++)
      edges.push_back(nedges[i]);
+    generation_ = 0;
   };
   
   Graph(Graph& that){
@@ -64,6 +68,7 @@ class Graph{
     
     this->edges_size=that.edges_size;
     this->edges=that.edges;
+    this->generation_ = 0;
   };
 
 
@@ -123,6 +128,21 @@ class Graph{
   WayPointNode* get_closest_node(const MapXY &p) const;
   WayPointNode* get_closest_node_within_radius(const MapXY &p) const;
 
+  /** @brief note that the nodes have changed
+   *
+   *  Every method that modifies the nodes array or node positions
+   *  calls this, and so must other code that does so directly, like
+   *  RNDF::populate_graph().  Bumps the generation number, so the
+   *  next get_closest_node*() call rebuilds the spatial index.
+   *
+   *  The get_closest_node*() methods may be called from several
+   *  threads at once, but not while the nodes are being modified.
+   */
+  void nodes_changed(void)
+  {
+    ++generation_;
+  }
+
   WayPointNode* nodes;
   std::vector<WayPointEdge> edges;
   uint32_t nodes_size;
@@ -130,6 +150,13 @@ class Graph{
   bool passing_allowed(int index, int index2, bool left);
 
   bool lanes_in_same_direction(int index1,int index2, bool& left_lane);
+
+ private:
+  const GraphIndex &index(void) const;
+
+  uint32_t generation_;			//< bumped by nodes_changed()
+  mutable boost::mutex index_lock_;	//< serializes index_ queries
+  mutable GraphIndex index_;		//< spatial index of nodes
 };
 	
 int parse_integer(std::string line, std::string token, 
@@ -0,0 +1,83 @@
+/* -*- mode: C++ -*-
+ *
+ *  Spatial index of way-point graph nodes
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#ifndef _GRAPH_INDEX_H_
+#define _GRAPH_INDEX_H_
+
+#include <vector>
+#include <art_map/types.h>
+
+/**  @file
+
+     @brief Spatial index for nearest way-point queries.
+
+     A two dimensional k-d tree over the MapXY positions of an array
+     of way-point nodes, stored implicitly in one vector: each range
+     is split at its median, alternating between the x and y axes.
+
+     Queries return exactly what a linear scan of the node array
+     would: the closest node by Euclidean::DistanceTo(), the lowest
+     array index when several are equally close.
+
+     The index remembers the generation number of the nodes it was
+     built from, so its owner can tell when it is out of date.  It
+     does no locking of its own.
+ */
+
+class GraphIndex
+{
+public:
+
+  GraphIndex():
+    built_(false),
+    generation_(0),
+    max_width_(0.0)
+  {}
+
+  void build(const WayPointNode *nodes, uint32_t size, uint32_t generation);
+  void clear();
+
+  /** @return true if built for this generation of the nodes */
+  bool valid(uint32_t generation) const
+  {
+    return (built_ && generation_ == generation);
+  }
+
+  int nearest(const MapXY &p) const;
+  int nearest_within_width(const MapXY &p) const;
+
+private:
+
+  /** one node, with its coordinates copied for locality */
+  struct Entry
+  {
+    float x, y;
+    float width;                        ///< lane width of node
+    uint32_t index;                     ///< index in node array
+  };
+
+  /** best node found so far by a query */
+  struct Best
+  {
+    float distance;
+    int index;
+  };
+
+  void build_range(unsigned lo, unsigned hi, bool x_axis);
+  void search(unsigned lo, unsigned hi, bool x_axis, const MapXY &p,
+              bool within_width, float bound, Best &best) const;
+
+  bool built_;                          ///< true once built
+  uint32_t generation_;                 ///< generation of nodes indexed
+  float max_width_;                     ///< largest node lane width
+  std::vector<Entry> tree_;             ///< implicit k-d tree
+};
+
+#endif // _GRAPH_INDEX_H_
@@ -0,0 +1,82 @@
+/* -*- mode: C++ -*-
+ *
+ *  In-memory road map editing
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#ifndef _MAP_EDITOR_H_
+#define _MAP_EDITOR_H_
+
+#include <string>
+#include <vector>
+#include <art_map/Graph.h>
+#include <art_map/MapLanes.h>
+#include <art_map/RNDF.h>
+
+/**  @file
+
+     @brief Apply way-point, lane and zone edits to a loaded road map.
+
+     The editor owns an RNDF, the way-point graph made from it, and
+     its MapLanes polygons, built the same way as maplanes does:
+     RNDF::populate_graph(), Graph::find_mapxy(), then polygons.
+
+     Edits change the RNDF; rebuild() makes them ready to use.  The
+     graph is always rebuilt, that takes well under a millisecond even
+     for large maps.  Polygons are rebuilt by MapLanes::RemapRNDF(),
+     which only recomputes the lanes and transitions affected by the
+     edits.  The result is identical to loading the edited RNDF.
+ */
+
+class MapEditor
+{
+public:
+
+  /** @param poly_size maximum polygon size (m)
+   *  @param range MapLanes range for getLanes() (m)
+   */
+  MapEditor(float poly_size = MIN_POLY_SIZE, float range = -1);
+  ~MapEditor();
+
+  bool load(const std::string &rndf_name);
+
+  bool move_waypoint(const ElementID &id, const LatLong &ll);
+  bool set_lane_width(segment_id_t seg, lane_id_t lane, int width);
+  bool add_lane(segment_id_t seg, const Lane &lane);
+  bool remove_lane(segment_id_t seg, lane_id_t lane);
+  bool set_spot_width(segment_id_t zone, lane_id_t spot, int width);
+
+  bool rebuild(void);
+
+  /** @return true if edits are waiting for rebuild() */
+  bool changed(void) const { return changed_; }
+
+  const RNDF *rndf(void) const { return rndf_; }
+  Graph *graph(void) { return graph_; }
+  MapLanes *lanes(void) { return lanes_; }
+
+private:
+
+  Segment *find_segment(segment_id_t seg);
+  Lane *find_lane(segment_id_t seg, lane_id_t lane);
+  Zone *find_zone(segment_id_t zone);
+  Spot *find_spot(segment_id_t zone, lane_id_t spot);
+
+  float poly_size_;
+  float range_;
+  bool changed_;                        ///< edits since last rebuild
+
+  RNDF *rndf_;
+  Graph *graph_;
+  MapLanes *lanes_;
+
+  // RNDF contents of the last successful rebuild
+  std::vector<Segment> good_segments_;
+  std::vector<Zone> good_zones_;
+};
+
+#endif // _MAP_EDITOR_H_
@@ -19,9 +19,13 @@
 #define __MapLanes_h__
 
 #include <math.h>
+#include <map>
 #include <vector>
 #include <stdio.h>
 
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
 #include <art/UTM.h>
 #include <art/error.h>
 #include <art/conversions.h>
@@ -48,9 +52,19 @@ public:
     range = r;
     transition=false;
     trans_index=-1;
+    remember_units_=false;
+    units_reused_=0;
+    max_poly_size=MIN_POLY_SIZE;
+    update_threads_=0;
+    work_batch_=0;
+    work_busy_=0;
+    work_nworkers_=0;
+    work_shutdown_=false;
+    SetUpdateThreads(0);
   };
   ~MapLanes()
   {
+     StopUpdateThreads();
      #ifdef DEBUGMAP
       fclose(debugFile);
      #endif
@@ -58,6 +72,25 @@ public:
 
   int MapRNDF(Graph* _graph, float _max_poly_size=MIN_POLY_SIZE);
 
+  /** @brief rebuild polygons after the graph was edited
+   *
+   *  Like MapRNDF(), but remembers how each lane and transition was
+   *  made.  On the next call, those whose way-points and neighboring
+   *  polygons did not change are copied instead of recomputed.  The
+   *  result is identical to MapRNDF() on the same graph.
+   *
+   *  @param _graph edited graph, replaces the previous one
+   *  @param _max_poly_size polygon size, a full rebuild if changed
+   *  @return 0 if successful
+   */
+  int RemapRNDF(Graph* _graph, float _max_poly_size=MIN_POLY_SIZE);
+
+  /** @return number of lanes and transitions made by the last build */
+  unsigned unitsMade(void) const { return units_.size(); }
+
+  /** @return number of those copied from the previous build */
+  unsigned unitsReused(void) const { return units_reused_; }
+
   int getAllLanes(art_msgs::ArtLanes *lanes);
   int getLanes(art_msgs::ArtLanes *lanes, MapXY here);
   int getVisionLanes(art_msgs::ArtLanes *lanes, float x, float y, float heading);
@@ -82,6 +115,10 @@ public:
 
   void UpdatePoly(polyUpdate upPoly, float rX, float rY, float rOri);
 
+  // batch self-observation updates, run in parallel across lanes
+  void UpdateWithCurrent(const std::vector<int> &poly_ids);
+  void SetUpdateThreads(unsigned nthreads);
+
 private:
   int32_t poly_id_counter;
   std::vector<poly> allPolys;
@@ -91,6 +128,11 @@ private:
 
   float range;
 
+  // polygon being checked by getLanes() and getVisionLanes(), a
+  // class variable to avoid memory allocation for every polygon on
+  // every cycle
+  art_msgs::ArtQuadrilateral scratch_quad;
+
   bool transition;
   int trans_index;
 
@@ -98,8 +140,60 @@ private:
 
   float rX,rY,rOri;
 
+  int BuildPolygons(Graph* _graph, float _max_poly_size, bool remember);
   void MakePolygons();
 
+  /** A unit of polygon generation: a run of lane way-points, or the
+   *  transition from nodes[base] to nodes[base+1].  Besides its own
+   *  polygons, a unit reads the latest polygon made before it and,
+   *  for transitions, the way-point polygons it attaches to.  It may
+   *  also modify those (context) polygons.
+   */
+  struct PolyUnit
+  {
+    bool is_transition;
+    int base;
+    std::vector<WayPointNode> nodes;	// way-points along the curve
+    std::vector<WayPointEdge> edges;	// edge for each lane polygon
+    std::vector<int> context;		// context indices, -1 if none
+    std::vector<poly> before;		// context polygons on entry
+    std::vector<poly> after;		// context polygons on exit
+    std::vector<poly> polys;		// polygons added
+  };
+
+  /** Previous build units, by transition flag and first two IDs. */
+  struct UnitKey
+  {
+    bool is_transition;
+    ElementID from;
+    ElementID to;
+    UnitKey(const PolyUnit &unit):
+      is_transition(unit.is_transition),
+      from(unit.nodes[unit.base].id),
+      to(unit.nodes[unit.base+1].id)
+    {}
+    bool operator<(const UnitKey &that) const
+    {
+      if (is_transition != that.is_transition)
+        return that.is_transition;
+      if (from != that.from)
+        return from < that.from;
+      return to < that.to;
+    }
+  };
+
+  void MakeUnit(PolyUnit &unit);
+  void BuildUnit(const PolyUnit &unit, int index_w1, int index_w2);
+  const PolyUnit *FindUnit(const PolyUnit &unit) const;
+  void FindWaypointPolys(const ElementID &id1, const ElementID &id2,
+                         int &index_w1, int &index_w2) const;
+
+  bool remember_units_;			// RemapRNDF() build in progress
+  std::vector<PolyUnit> units_;		// units of the last build
+  std::vector<PolyUnit> prev_units_;	// units of the build before
+  std::map<UnitKey, unsigned> prev_index_; // prev_units_ by key
+  unsigned units_reused_;
+
   poly build_waypoint_poly(const WayPointNode& w1, const WayPointEdge &e,
 			   const Point2f& _pt,
 			   float time,
@@ -116,10 +210,41 @@ private:
 
   void MakeTransitionPolygon(WayPointNode w1, WayPointNode w2, WayPointEdge e, 
 			     float time1, float time2,
-			     SmoothCurve& c);
+			     SmoothCurve& c,
+			     int index_w1, int index_w2);
 
   void SetFilteredPolygons();
 
+  // Batch filter updates are partitioned by lane.  Polygons in
+  // different lanes are independent, so lanes can run in parallel.
+  struct LaneWork
+  {
+    std::vector<int> current;		// self-observation poly IDs
+    std::vector<float> noise;		// NUM_POINTS samples per current
+  };
+  std::vector<int> poly_lane_;		// lane index of each polygon
+  std::vector<LaneWork> lane_work_;	// pending work for each lane
+  unsigned update_threads_;
+
+  // Helper threads for batch updates, started by the first batch
+  // that needs them and kept until the thread count changes.  The
+  // calling thread is always worker 0.
+  std::vector<boost::shared_ptr<boost::thread> > workers_;
+  boost::mutex work_lock_;		// protects the work_ fields
+  boost::condition_variable work_ready_; // new batch, or shutdown
+  boost::condition_variable work_done_;	// helpers all finished
+  unsigned work_batch_;			// number of the latest batch
+  unsigned work_busy_;			// helpers still running it
+  unsigned work_nworkers_;		// workers sharing it
+  bool work_shutdown_;
+
+  void SetLanePartition();
+  void RunLaneUpdates();
+  void StopUpdateThreads();
+  void UpdateLanes(unsigned worker, unsigned nworkers);
+  void UpdateWorker(unsigned worker, unsigned batch);
+  void UpdateWithCurrent(int i, const float noise[NUM_POINTS]);
+
   PolyOps ops;
   
   // File Writing / Reading
@@ -38,6 +38,8 @@ class LL_Waypoint {
   //double longitude; //6 decimal digits
   
   //METHODS
+  LL_Waypoint(){clear();};
+  LL_Waypoint(int id, const LatLong &_ll): waypoint_id(id), ll(_ll) {};
   LL_Waypoint(std::string line, int x, int y, int line_number, bool& valid,
 	      bool verbose);
   bool isvalid(){return(waypoint_id > 0);};
@@ -254,6 +256,14 @@ class RNDF {
   void populate_graph(Graph& graph);
   void print();
 
+  /** @brief rebuild graph data after editing segments or zones
+   *
+   *  The element counts must agree with the edited vectors.
+   *
+   *  @return true if the edited RNDF is valid
+   */
+  bool rebuild_graph(void);
+
   bool is_valid;
 
  private:
@@ -0,0 +1,275 @@
+/* -*- mode: C++ -*-
+ *
+ *  Vehicle pose history
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#ifndef _POSE_HISTORY_H_
+#define _POSE_HISTORY_H_
+
+#include <math.h>
+#include <stdint.h>
+#include <nav_msgs/Odometry.h>
+#include <art/epsilon.h>
+#include <art_map/coordinates.h>
+
+/**  @file
+
+     @brief Vehicle pose history, indexed by time stamp.
+
+     Keeps the most recent odometry poses in a fixed ring buffer, so
+     any sensor data can be placed at the pose the vehicle had when
+     it was acquired.  Poses between samples are interpolated.  Poses
+     slightly newer than the last sample are extrapolated, assuming
+     constant velocity and yaw rate.  Estimate::control_pose uses the
+     same model.
+
+     Each node keeps its own history, fed from the odometry topic it
+     already subscribes to: the navigator estimates its control pose
+     from it, and the lane observers place each point cloud with it.
+     Point clouds themselves are transformed with the node's
+     TransformCache, because the sensor mounting transforms are
+     three-dimensional.
+
+     One thread (normally the odometry callback) may add samples while
+     any number of other threads look them up.  There are no locks:
+     each slot carries a sequence number, readers retry if a slot
+     changed while they were copying it.
+ */
+
+class PoseHistory
+{
+public:
+
+  /** ring buffer capacity, more than two seconds of 50 Hz odometry */
+  static const unsigned N_SLOTS = 128;
+
+  /** vehicle pose and velocities at one instant */
+  struct Sample
+  {
+    ros::Time stamp;
+    MapPose pose;
+    float speed;                        ///< forward velocity (m/s)
+    float yaw_rate;                     ///< (radians/s)
+
+    Sample(): speed(0.0), yaw_rate(0.0) {}
+  };
+
+  /** Constructor.
+   *
+   *  @param max_extrapolation how far past the latest sample a
+   *         pose may be estimated
+   */
+  PoseHistory(const ros::Duration &max_extrapolation = ros::Duration(0.2)):
+    count_(0),
+    max_extrapolation_(max_extrapolation)
+  {
+    for (unsigned i = 0; i < N_SLOTS; ++i)
+      slots_[i].seq = 0;
+  }
+
+  /** @brief add an odometry message (writer thread only)
+   *
+   *  @return false if out of time stamp order, and ignored
+   */
+  bool add(const nav_msgs::Odometry &odom)
+  {
+    Sample s;
+    s.stamp = odom.header.stamp;
+    s.pose = MapPose(odom.pose.pose);
+    s.speed = odom.twist.twist.linear.x;
+    s.yaw_rate = odom.twist.twist.angular.z;
+    return add(s);
+  }
+
+  /** @brief add a pose sample (writer thread only)
+   *
+   *  @return false if out of time stamp order, and ignored
+   */
+  bool add(const Sample &sample)
+  {
+    uint32_t n = count_;
+    if (n > 0 && !(slots_[(n-1) % N_SLOTS].sample.stamp < sample.stamp))
+      return false;
+
+    Slot &slot = slots_[n % N_SLOTS];
+    slot.seq = slot.seq + 1;            // odd: update in progress
+    __sync_synchronize();
+    slot.sample = sample;
+    __sync_synchronize();
+    slot.seq = slot.seq + 1;            // even: stable
+    __sync_synchronize();
+    count_ = n + 1;                     // publish the new sample
+    return true;
+  }
+
+  /** @return true if no samples have been added */
+  bool empty() const
+  {
+    return count_ == 0;
+  }
+
+  /** @brief get the most recent sample
+   *
+   *  @param sample [out] latest sample, unchanged if none
+   *  @return true if successful
+   */
+  bool latest(Sample &sample) const
+  {
+    uint32_t n = count_;
+    return (n > 0 && read(n-1, sample));
+  }
+
+  /** @brief get vehicle pose at some time
+   *
+   *  @param stamp time of desired pose
+   *  @param pose [out] vehicle pose at @a stamp, unchanged if unknown
+   *  @return true if @a stamp is within the history, or no farther
+   *          past the latest sample than the extrapolation limit
+   */
+  bool lookup(const ros::Time &stamp, MapPose &pose) const
+  {
+    Sample sample;
+    if (!lookup(stamp, sample))
+      return false;
+    pose = sample.pose;
+    return true;
+  }
+
+  /** @brief get interpolated or extrapolated sample at some time
+   *
+   *  Cost is bounded by a binary search of the ring buffer.
+   *
+   *  @param stamp time of desired sample
+   *  @param sample [out] vehicle state at @a stamp, unchanged if unknown
+   *  @return true if successful
+   */
+  bool lookup(const ros::Time &stamp, Sample &sample) const
+  {
+    uint32_t n = count_;
+    if (n == 0)
+      return false;
+
+    Sample newest;
+    if (!read(n-1, newest))
+      return false;
+    if (!(stamp < newest.stamp))
+      {
+        double dt = (stamp - newest.stamp).toSec();
+        if (dt > max_extrapolation_.toSec())
+          return false;
+        extrapolate(newest, dt, sample);
+        sample.stamp = stamp;
+        return true;
+      }
+
+    // Search for the first sample after stamp.  The writer may be
+    // replacing the oldest slot, so leave it out.
+    uint32_t lo = (n > N_SLOTS? n - N_SLOTS + 1: 0);
+    uint32_t hi = n - 1;
+    Sample after = newest;
+    while (lo < hi)
+      {
+        uint32_t mid = lo + (hi - lo) / 2;
+        Sample s;
+        if (!read(mid, s) || !(stamp < s.stamp))
+          lo = mid + 1;                 // overwritten or not after
+        else
+          {
+            hi = mid;
+            after = s;
+          }
+      }
+
+    Sample before;
+    if (lo == 0 || !read(lo-1, before) || stamp < before.stamp)
+      return false;                     // older than the history
+
+    // interpolate between the two samples
+    double span = (after.stamp - before.stamp).toSec();
+    double frac = (span > 0.0? (stamp - before.stamp).toSec() / span: 0.0);
+    sample.stamp = stamp;
+    sample.pose.map.x = before.pose.map.x
+      + frac * (after.pose.map.x - before.pose.map.x);
+    sample.pose.map.y = before.pose.map.y
+      + frac * (after.pose.map.y - before.pose.map.y);
+    sample.pose.yaw = Coordinates::normalize
+      (before.pose.yaw
+       + frac * Coordinates::normalize(after.pose.yaw - before.pose.yaw));
+    sample.speed = before.speed + frac * (after.speed - before.speed);
+    sample.yaw_rate = before.yaw_rate
+      + frac * (after.yaw_rate - before.yaw_rate);
+    return true;
+  }
+
+  /** @brief estimate state some time after a sample
+   *
+   *  Uses the exact motion model for constant velocity and yaw rate
+   *  [_Probabilistic Robotics_, Thrun, Burgard and Fox, section 5.3.3].
+   *
+   *  @param from starting sample
+   *  @param dt seconds after @a from
+   *  @param est [out] estimated sample (stamp not set)
+   */
+  static void extrapolate(const Sample &from, double dt, Sample &est)
+  {
+    est = from;
+    double dist = from.speed * dt;
+    double yaw = from.pose.yaw;
+    double new_yaw = Coordinates::normalize(yaw + from.yaw_rate * dt);
+    if (fabs(from.yaw_rate) < Epsilon::yaw)
+      {
+        est.pose.map.x = from.pose.map.x + dist * cos(yaw);
+        est.pose.map.y = from.pose.map.y + dist * sin(yaw);
+      }
+    else
+      {
+        double radius = dist / from.yaw_rate;
+        est.pose.map.x = from.pose.map.x
+          - radius * sin(yaw) + radius * sin(new_yaw);
+        est.pose.map.y = from.pose.map.y
+          + radius * cos(yaw) - radius * cos(new_yaw);
+      }
+    est.pose.yaw = new_yaw;
+  }
+
+private:
+
+  /** ring buffer entry */
+  struct Slot
+  {
+    volatile uint32_t seq;              ///< odd while being written
+    Sample sample;
+  };
+
+  /** @brief copy a consistent sample from the ring buffer
+   *
+   *  @param index sample number (count of samples before it)
+   *  @param sample [out] copy of that sample
+   *  @return false if it has already been overwritten
+   */
+  bool read(uint32_t index, Sample &sample) const
+  {
+    const Slot &slot = slots_[index % N_SLOTS];
+    for (;;)
+      {
+        uint32_t seq = slot.seq;
+        __sync_synchronize();
+        sample = slot.sample;
+        __sync_synchronize();
+        if ((seq & 1) == 0 && seq == slot.seq)
+          break;
+      }
+    return (count_ - index <= N_SLOTS - 1);
+  }
+
+  Slot slots_[N_SLOTS];
+  volatile uint32_t count_;             ///< number of samples ever added
+  ros::Duration max_extrapolation_;
+};
+
+#endif // _POSE_HISTORY_H_
@@ -0,0 +1,358 @@
+/* -*- mode: C++ -*-
+ *
+ *  Per-node transform cache
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#ifndef _TRANSFORM_CACHE_H_
+#define _TRANSFORM_CACHE_H_
+
+#include <string>
+#include <vector>
+#include <tr1/unordered_map>
+
+#include <ros/ros.h>
+#include <tf/tfMessage.h>
+#include <tf/transform_datatypes.h>
+
+/**  @file
+
+     @brief Per-node cache of recent tf transforms.
+
+     A lightweight replacement for tf::TransformListener in nodes
+     that only need a few frames at recent times.  Each frame keeps
+     its latest transforms in a fixed ring buffer, so memory does not
+     grow with the broadcast rate.  A frame whose transform stops
+     changing is static: its value then answers lookups at later
+     times without history, but only up to a maximum age after its
+     newest sample.  That covers the static transform publishers,
+     which re-broadcast the same value with new time stamps, and a
+     stopped vehicle.  If a source stops publishing altogether, its
+     frame stops answering soon after, instead of reporting a stale
+     position forever.
+
+     Transforms arrive through the node's own callback queue, and
+     lookups never wait.  The cost of a lookup is one hash per frame
+     name, plus a bounded binary search of the ring buffer for each
+     link of the chain between the two frames.  Like tf, dynamic
+     transforms are interpolated between samples, but never
+     extrapolated.  A zero time stamp requests the latest transforms.
+     tf::TransformListener fails any lookup after the newest sample
+     of a frame; here a static frame gets the extra age allowed.
+
+     Frame IDs with and without a leading '/' are the same frame.
+     Not thread safe: the node must update and use the cache from
+     the same thread, which ros::spin() does.
+ */
+
+class TransformCache
+{
+public:
+
+  /** ring buffer capacity per frame, more than half a second of
+   *  100 Hz odometry */
+  static const unsigned N_SLOTS = 64;
+
+  /** longest chain of frames searched */
+  static const unsigned MAX_DEPTH = 16;
+
+  /** @brief constructor
+   *
+   *  @param max_static_age how long after its newest sample an
+   *         unchanging frame still answers lookups (seconds).  The
+   *         default allows for a missed broadcast at the 1 Hz and 5 Hz
+   *         rates of the vehicle's static transform publishers.
+   */
+  TransformCache(double max_static_age = 1.0):
+    max_static_age_(max_static_age)
+  {}
+
+  /** @brief subscribe to the tf topic
+   *
+   *  The cache must not be copied after subscribing.
+   */
+  void subscribe(ros::NodeHandle node, uint32_t queue_size = 100)
+  {
+    sub_ = node.subscribe("/tf", queue_size,
+                          &TransformCache::process, this,
+                          ros::TransportHints().tcpNoDelay(true));
+  }
+
+  /** @brief add a transform
+   *
+   *  @return false if invalid, or older than that frame's latest
+   */
+  bool add(const geometry_msgs::TransformStamped &msg)
+  {
+    std::string child = strip(msg.child_frame_id);
+    std::string parent = strip(msg.header.frame_id);
+    if (child.empty() || parent.empty() || child == parent)
+      return false;
+
+    int c = frame(child);
+    int p = frame(parent);
+    Frame &f = frames_[c];
+    if (f.parent != p)
+      {
+        // new or re-parented frame: start over
+        f.parent = p;
+        f.count = 0;
+        f.is_static = false;
+      }
+
+    Sample s;
+    s.stamp = msg.header.stamp;
+    tf::vector3MsgToTF(msg.transform.translation, s.origin);
+    tf::quaternionMsgToTF(msg.transform.rotation, s.rotation);
+
+    if (f.count > 0)
+      {
+        const Sample &last = newest(f);
+        if (s.origin == last.origin && s.rotation == last.rotation)
+          {
+            if (!f.is_static)
+              {
+                f.is_static = true;
+                f.static_since = last.stamp;
+              }
+            if (!(last.stamp < s.stamp))
+              return true;              // nothing new
+          }
+        else
+          {
+            if (!(last.stamp < s.stamp))
+              return false;
+            f.is_static = false;
+          }
+      }
+
+    f.slots[f.count % N_SLOTS] = s;
+    ++f.count;
+    return true;
+  }
+
+  /** @return true if lookup() would succeed */
+  bool canTransform(const std::string &target, const std::string &source,
+                    const ros::Time &stamp) const
+  {
+    tf::StampedTransform transform;
+    return lookup(target, source, stamp, transform);
+  }
+
+  /** @brief get the transform between two frames
+   *
+   *  @param target frame to transform data into
+   *  @param source frame of the data
+   *  @param stamp time of the data, zero for the latest
+   *  @param transform [out] maps @a source coordinates into
+   *         @a target coordinates, unchanged if unknown
+   *  @return true if successful
+   */
+  bool lookup(const std::string &target, const std::string &source,
+              const ros::Time &stamp, tf::StampedTransform &transform) const
+  {
+    int t = find(target);
+    int s = find(source);
+    if (t < 0 || s < 0)
+      return false;
+
+    // chain from the source frame up to its root
+    int chain[MAX_DEPTH];
+    unsigned nchain = 0;
+    for (int f = s; f >= 0; f = frames_[f].parent)
+      {
+        if (nchain == MAX_DEPTH)
+          return false;
+        chain[nchain++] = f;
+      }
+
+    // from the target frame up to the nearest common ancestor
+    tf::Transform target_up = tf::Transform::getIdentity();
+    unsigned depth = 0;
+    int f = t;
+    for (;;)
+      {
+        unsigned i = 0;
+        while (i < nchain && chain[i] != f)
+          ++i;
+        if (i < nchain)
+          {
+            nchain = i;                 // the ancestor ends the chain
+            break;
+          }
+        tf::Transform link;
+        if (++depth > MAX_DEPTH || !at(frames_[f], stamp, link))
+          return false;                 // no common ancestor
+        target_up = link * target_up;
+        f = frames_[f].parent;
+      }
+
+    tf::Transform source_up = tf::Transform::getIdentity();
+    for (unsigned i = 0; i < nchain; ++i)
+      {
+        tf::Transform link;
+        if (!at(frames_[chain[i]], stamp, link))
+          return false;
+        source_up = link * source_up;
+      }
+
+    transform = tf::StampedTransform(target_up.inverse() * source_up,
+                                     stamp, target, source);
+    return true;
+  }
+
+  /** @return number of frames known */
+  unsigned frames(void) const
+  {
+    return frames_.size();
+  }
+
+  /** @return approximate bytes used */
+  size_t memory(void) const
+  {
+    size_t bytes = sizeof(*this) + frames_.capacity() * sizeof(Frame);
+    for (unsigned i = 0; i < frames_.size(); ++i)
+      bytes += (frames_[i].slots.capacity() * sizeof(Sample)
+                + 2 * frames_[i].name.capacity());
+    return bytes;
+  }
+
+private:
+
+  /** one transform from a frame to its parent */
+  struct Sample
+  {
+    ros::Time stamp;
+    tf::Vector3 origin;
+    tf::Quaternion rotation;
+  };
+
+  struct Frame
+  {
+    std::string name;
+    int parent;                         ///< index, -1 if root
+    unsigned count;                     ///< samples ever added
+    bool is_static;                     ///< unchanged since static_since
+    ros::Time static_since;
+    std::vector<Sample> slots;          ///< ring buffer
+
+    Frame(const std::string &frame_name):
+      name(frame_name),
+      parent(-1),
+      count(0),
+      is_static(false),
+      slots(N_SLOTS)
+    {}
+  };
+
+  void process(const tf::tfMessage::ConstPtr &msg)
+  {
+    for (unsigned i = 0; i < msg->transforms.size(); ++i)
+      {
+        if (!add(msg->transforms[i]))
+          ROS_DEBUG("transform %s to %s ignored",
+                    msg->transforms[i].header.frame_id.c_str(),
+                    msg->transforms[i].child_frame_id.c_str());
+      }
+  }
+
+  static std::string strip(const std::string &frame_id)
+  {
+    if (!frame_id.empty() && frame_id[0] == '/')
+      return frame_id.substr(1);
+    return frame_id;
+  }
+
+  /** @return frame index, -1 if unknown */
+  int find(const std::string &frame_id) const
+  {
+    const char *name = frame_id.c_str();
+    if (*name == '/')
+      ++name;
+    Index::const_iterator it = index_.find(name);
+    return (it == index_.end()? -1: it->second);
+  }
+
+  /** @return index of the frame, added if new */
+  int frame(const std::string &name)
+  {
+    Index::const_iterator it = index_.find(name);
+    if (it != index_.end())
+      return it->second;
+    int i = frames_.size();
+    frames_.push_back(Frame(name));
+    index_[name] = i;
+    return i;
+  }
+
+  static const Sample &newest(const Frame &f)
+  {
+    return f.slots[(f.count - 1) % N_SLOTS];
+  }
+
+  /** @brief transform from a frame to its parent at some time
+   *
+   *  @param link [out] transform, unchanged if unknown
+   *  @return true if successful
+   */
+  bool at(const Frame &f, const ros::Time &stamp,
+          tf::Transform &link) const
+  {
+    if (f.count == 0)
+      return false;
+
+    const Sample &last = newest(f);
+    if (stamp.isZero()
+        || (f.is_static && !(stamp < f.static_since)
+            && !(last.stamp + max_static_age_ < stamp)))
+      {
+        link = tf::Transform(last.rotation, last.origin);
+        return true;
+      }
+    if (last.stamp < stamp)
+      return false;                     // never extrapolate
+
+    // search for the first sample not before stamp
+    unsigned lo = (f.count > N_SLOTS? f.count - N_SLOTS: 0);
+    unsigned hi = f.count - 1;
+    unsigned oldest = lo;
+    while (lo < hi)
+      {
+        unsigned mid = lo + (hi - lo) / 2;
+        if (f.slots[mid % N_SLOTS].stamp < stamp)
+          lo = mid + 1;
+        else
+          hi = mid;
+      }
+
+    const Sample &after = f.slots[lo % N_SLOTS];
+    if (after.stamp == stamp)
+      {
+        link = tf::Transform(after.rotation, after.origin);
+        return true;
+      }
+    if (lo == oldest)
+      return false;                     // older than the history
+
+    // interpolate between the two samples
+    const Sample &before = f.slots[(lo - 1) % N_SLOTS];
+    double frac = ((stamp - before.stamp).toSec()
+                   / (after.stamp - before.stamp).toSec());
+    link = tf::Transform(before.rotation.slerp(after.rotation, frac),
+                         before.origin.lerp(after.origin, frac));
+    return true;
+  }
+
+  typedef std::tr1::unordered_map<std::string, int> Index;
+
+  std::vector<Frame> frames_;
+  Index index_;                         ///< frame indices by name
+  ros::Duration max_static_age_;        ///< static answers after newest
+  ros::Subscriber sub_;
+};
+
+#endif // _TRANSFORM_CACHE_H_
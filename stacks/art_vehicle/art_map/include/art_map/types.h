@@ -65,7 +65,7 @@ public:
   };
 
   /** Convert ElementID to MapID message. */
-  art_msgs::MapID toMapID()
+  art_msgs::MapID toMapID() const
   {
     art_msgs::MapID mid;
     mid.seg = this->seg;
@@ -0,0 +1,271 @@
+/*
+ *  Convex polygon clipping and overlap
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <algorithm>
+#include <math.h>
+
+#include <art/epsilon.h>
+#include <art_map/ConvexPolygon.h>
+
+namespace
+{
+  /** axis-aligned bounding box */
+  struct Box
+  {
+    float min_x, min_y, max_x, max_y;
+
+    Box(const mapxy_list_t &vertices):
+      min_x(INFINITY), min_y(INFINITY), max_x(-INFINITY), max_y(-INFINITY)
+    {
+      for (unsigned i = 0; i < vertices.size(); ++i)
+        {
+          min_x = std::min(min_x, vertices[i].x);
+          min_y = std::min(min_y, vertices[i].y);
+          max_x = std::max(max_x, vertices[i].x);
+          max_y = std::max(max_y, vertices[i].y);
+        }
+    }
+
+    bool overlaps(const Box &that) const
+    {
+      return (min_x <= that.max_x && that.min_x <= max_x
+              && min_y <= that.max_y && that.min_y <= max_y);
+    }
+  };
+
+  /** cross product of (b - a) and (p - a), positive if p is left of a->b */
+  inline double cross(const MapXY &a, const MapXY &b, const MapXY &p)
+  {
+    return ((double) (b.x - a.x) * (p.y - a.y)
+            - (double) (b.y - a.y) * (p.x - a.x));
+  }
+
+  /** intersection of segment p->q with the line through a->b */
+  inline MapXY crossing(const MapXY &p, const MapXY &q,
+                        const MapXY &a, const MapXY &b)
+  {
+    double cp = cross(a, b, p);
+    double cq = cross(a, b, q);
+    double t = cp / (cp - cq);
+    return MapXY(p.x + t * (q.x - p.x), p.y + t * (q.y - p.y));
+  }
+
+  /** clip subject in place, with result as scratch storage */
+  bool clip_into(mapxy_list_t &subject, const mapxy_list_t &clipper,
+                 mapxy_list_t &scratch)
+  {
+    unsigned nclip = clipper.size();
+    if (nclip < 3 || subject.size() < 3)
+      {
+        subject.clear();
+        return false;
+      }
+
+    // orient the clipper counter-clockwise, so inside is left
+    float clip_area = ConvexPolygon::signedArea(clipper);
+    if (fabsf(clip_area) < Epsilon::distance * Epsilon::distance)
+      {
+        subject.clear();                // degenerate clipper
+        return false;
+      }
+    bool ccw = (clip_area > 0.0);
+
+    for (unsigned e = 0; e < nclip && !subject.empty(); ++e)
+      {
+        MapXY a = clipper[e];
+        MapXY b = clipper[(e + 1) % nclip];
+        if (!ccw)
+          std::swap(a, b);
+
+        scratch.clear();
+        unsigned n = subject.size();
+        for (unsigned i = 0; i < n; ++i)
+          {
+            const MapXY &p = subject[i];
+            const MapXY &q = subject[(i + 1) % n];
+            bool p_in = (cross(a, b, p) >= 0.0);
+            bool q_in = (cross(a, b, q) >= 0.0);
+            if (p_in)
+              scratch.push_back(p);
+            if (p_in != q_in)
+              scratch.push_back(crossing(p, q, a, b));
+          }
+        subject.swap(scratch);
+      }
+
+    if (subject.size() < 3)
+      subject.clear();
+    return !subject.empty();
+  }
+}
+
+namespace ConvexPolygon
+{
+  /** @brief get vertices of a MapLanes polygon */
+  void fromPoly(const poly &p, mapxy_list_t &vertices)
+  {
+    vertices.resize(4);
+    vertices[0] = p.p1;
+    vertices[1] = p.p2;
+    vertices[2] = p.p3;
+    vertices[3] = p.p4;
+  }
+
+  /** @brief get vertices of an ArtQuadrilateral message */
+  void fromQuad(const art_msgs::ArtQuadrilateral &q, mapxy_list_t &vertices)
+  {
+    vertices.resize(q.poly.points.size());
+    for (unsigned i = 0; i < q.poly.points.size(); ++i)
+      vertices[i] = MapXY(q.poly.points[i]);
+  }
+
+  /** @brief area of a simple polygon
+   *
+   *  @return area, positive if vertices are counter-clockwise
+   */
+  float signedArea(const mapxy_list_t &vertices)
+  {
+    double sum = 0.0;
+    unsigned n = vertices.size();
+    for (unsigned i = 0; i < n; ++i)
+      {
+        const MapXY &p = vertices[i];
+        const MapXY &q = vertices[(i + 1) % n];
+        sum += (double) p.x * q.y - (double) q.x * p.y;
+      }
+    return sum / 2.0;
+  }
+
+  /** @brief area of a simple polygon, regardless of vertex order */
+  float area(const mapxy_list_t &vertices)
+  {
+    return fabsf(signedArea(vertices));
+  }
+
+  /** @brief clip one convex polygon against another
+   *
+   *  @param subject polygon to clip
+   *  @param clipper convex clipping polygon
+   *  @param result [out] intersection of the two, empty if none
+   *  @return true if they intersect with nonzero area
+   */
+  bool clip(const mapxy_list_t &subject, const mapxy_list_t &clipper,
+            mapxy_list_t &result)
+  {
+    mapxy_list_t scratch;
+    result = subject;
+    return clip_into(result, clipper, scratch);
+  }
+
+  /** @brief area of intersection of two convex polygons */
+  float intersectionArea(const mapxy_list_t &a, const mapxy_list_t &b)
+  {
+    if (!Box(a).overlaps(Box(b)))
+      return 0.0;
+    mapxy_list_t result;
+    if (!clip(a, b, result))
+      return 0.0;
+    return area(result);
+  }
+
+  /** @brief area of intersection of two MapLanes polygons */
+  float intersectionArea(const poly &a, const poly &b)
+  {
+    mapxy_list_t va, vb;
+    fromPoly(a, va);
+    fromPoly(b, vb);
+    return intersectionArea(va, vb);
+  }
+
+  /** @brief area of intersection of two quadrilateral messages */
+  float intersectionArea(const art_msgs::ArtQuadrilateral &a,
+                         const art_msgs::ArtQuadrilateral &b)
+  {
+    mapxy_list_t va, vb;
+    fromQuad(a, va);
+    fromQuad(b, vb);
+    return intersectionArea(va, vb);
+  }
+
+  /** @brief intersection areas of a region with many polygons
+   *
+   *  @param region convex polygon
+   *  @param polys polygons to compare
+   *  @param areas [out] area overlapping @a region for each of @a polys
+   */
+  void intersectionAreas(const mapxy_list_t &region,
+                         const poly_list_t &polys,
+                         std::vector<float> &areas)
+  {
+    Box box(region);
+    mapxy_list_t vertices, scratch;
+    areas.assign(polys.size(), 0.0);
+    for (unsigned i = 0; i < polys.size(); ++i)
+      {
+        fromPoly(polys[i], vertices);
+        if (box.overlaps(Box(vertices))
+            && clip_into(vertices, region, scratch))
+          areas[i] = area(vertices);
+      }
+  }
+
+  /** @brief find the polygons overlapping a region
+   *
+   *  @param region convex polygon
+   *  @param polys polygons to compare
+   *  @param min_area minimum overlap to count
+   *  @param indices [out] indices in @a polys of overlapping polygons
+   *  @return number of overlapping polygons
+   */
+  unsigned overlapping(const mapxy_list_t &region,
+                       const poly_list_t &polys,
+                       float min_area,
+                       std::vector<int> &indices)
+  {
+    Box box(region);
+    mapxy_list_t vertices, scratch;
+    indices.clear();
+    for (unsigned i = 0; i < polys.size(); ++i)
+      {
+        fromPoly(polys[i], vertices);
+        if (box.overlaps(Box(vertices))
+            && clip_into(vertices, region, scratch)
+            && area(vertices) >= min_area)
+          indices.push_back(i);
+      }
+    return indices.size();
+  }
+
+  /** @brief find the quadrilaterals overlapping a region
+   *
+   *  @param region convex polygon
+   *  @param quads quadrilaterals to compare
+   *  @param min_area minimum overlap to count
+   *  @param indices [out] indices in @a quads.polygons that overlap
+   *  @return number of overlapping quadrilaterals
+   */
+  unsigned overlapping(const mapxy_list_t &region,
+                       const art_msgs::ArtLanes &quads,
+                       float min_area,
+                       std::vector<int> &indices)
+  {
+    Box box(region);
+    mapxy_list_t vertices, scratch;
+    indices.clear();
+    for (unsigned i = 0; i < quads.polygons.size(); ++i)
+      {
+        fromQuad(quads.polygons[i], vertices);
+        if (box.overlaps(Box(vertices))
+            && clip_into(vertices, region, scratch)
+            && area(vertices) >= min_area)
+          indices.push_back(i);
+      }
+    return indices.size();
+  }
+}
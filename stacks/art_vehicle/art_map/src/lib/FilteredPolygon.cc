@@ -39,21 +39,36 @@ FilteredPolygon::FilteredPolygon()
   angleStruct.changeAlpha = true;
   //------------
 
+  updated_ = false;
+
   #ifdef DEBUGFILTER
   printf("Constructed FilteredPolygon\n");
   #endif
 }
 
+// Returns all the filters to their initial state, as if newly
+// constructed, so a map rebuild can reuse the allocated matrices.
+void FilteredPolygon::Restart()
+{
+  for (int i=0; i<NUM_POINTS; i++) {
+    point[i].Restart();
+    point[i].alpha=1.0;
+    point[i].active=true;
+    point[i].activate=false;
+  }
+  updated_=false;
+}
+
 // Sets the location of the filtered point ... 
 //
 // I would suggest only using this to set the original location
 // because it changes the X matrix directly and therefore changing it
 // other times could corrupt the relationship between X and P
 void FilteredPolygon::SetPoint(int pointID, float x, float y) {
-  Matrix X=point[pointID].GetStates();
-  X[0][0]=x;
-  X[1][0]=y;
-  point[pointID].SetStates(X);
+  // set the states in place, copying the matrix is slow for
+  // thousands of polygons
+  point[pointID].SetState(0,x);
+  point[pointID].SetState(1,y);
 
   #ifdef DEBUGFILTER
   printf("Point %i set to (%f,%f)\n",pointID,x,y);
@@ -74,6 +89,7 @@ void FilteredPolygon::UpdatePoint(int pointID, float visionDistance,
 
 // The current state of the Kalman Filter	
   Matrix X = point[pointID].GetStates();
+  updated_ = true;
 
   float visionElevation=0;
   float dist = visionDistance*cos(visionElevation);
@@ -157,14 +173,12 @@ void FilteredPolygon::SetPolygon(poly p)
 
 poly FilteredPolygon::GetPolygon()
 {
-  Matrix X=point[0].GetStates();
-  polygon_.p1 = MapXY(X[0][0],X[1][0]);  
-  X=point[1].GetStates();
-  polygon_.p2 = MapXY(X[0][0],X[1][0]);  
-  X=point[2].GetStates();
-  polygon_.p3 = MapXY(X[0][0],X[1][0]);
-  X=point[3].GetStates();
-  polygon_.p4 = MapXY(X[0][0],X[1][0]);
+  // GetState() reads the filter states without copying the matrix,
+  // this runs for every polygon on every maplanes cycle
+  polygon_.p1 = MapXY(point[0].GetState(0),point[0].GetState(1));
+  polygon_.p2 = MapXY(point[1].GetState(0),point[1].GetState(1));
+  polygon_.p3 = MapXY(point[2].GetState(0),point[2].GetState(1));
+  polygon_.p4 = MapXY(point[3].GetState(0),point[3].GetState(1));
   
   polygon_.heading = ops_.PolyHeading(polygon_);
   polygon_.midpoint = ops_.centerpoint(polygon_);
@@ -173,11 +187,31 @@ poly FilteredPolygon::GetPolygon()
   return polygon_;
 }
 
+/** returns polygon midpoint, without computing the rest of it */
+MapXY FilteredPolygon::GetMidpoint()
+{
+  MapXY p1(point[0].GetState(0),point[0].GetState(1));
+  MapXY p2(point[1].GetState(0),point[1].GetState(1));
+  MapXY p3(point[2].GetState(0),point[2].GetState(1));
+  MapXY p4(point[3].GetState(0),point[3].GetState(1));
+  return ops_.midpoint(ops_.midpoint(p1, p3), ops_.midpoint(p2, p4));
+}
+
 /** returns quadrilateral message */
 art_msgs::ArtQuadrilateral FilteredPolygon::GetQuad()
 {
-  poly p = GetPolygon(); 
   art_msgs::ArtQuadrilateral q;
+  GetQuad(q);
+  return q;
+}
+
+/** fill in an existing quadrilateral message
+ *
+ *  Reuses the storage of its points vector, when already allocated.
+ */
+void FilteredPolygon::GetQuad(art_msgs::ArtQuadrilateral &q)
+{
+  poly p = GetPolygon(); 
   q.poly.points.resize(art_msgs::ArtQuadrilateral::quad_size);
 
   q.poly.points[art_msgs::ArtQuadrilateral::bottom_left].x = p.p1.x;
@@ -212,6 +246,4 @@ art_msgs::ArtQuadrilateral FilteredPolygon::GetQuad()
   q.left_boundary.lane_marking = p.left_boundary.lane_marking;
   q.right_boundary.lane_marking = p.right_boundary.lane_marking;
 #endif
-
-  return q;
 }
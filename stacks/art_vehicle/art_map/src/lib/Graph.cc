@@ -43,33 +43,26 @@ WayPointNode* Graph::get_node_by_id(const ElementID id) const {
   return NULL;
 };
 
+/** Spatial index of the current nodes, rebuilt if they changed.
+ *
+ *  Caller must hold index_lock_.
+ */
+const GraphIndex &Graph::index(void) const {
+  if (!index_.valid(generation_))
+    index_.build(nodes, nodes_size, generation_);
+  return index_;
+};
+
 WayPointNode* Graph::get_closest_node(const MapXY &p) const {
-  WayPointNode* closest = NULL;
-  float distance = 0;
-  float new_distance = 0;
-  for(uint i=0; i<nodes_size; i++) {
-    new_distance = Euclidean::DistanceTo(p, nodes[i].map);
-    if(closest == NULL || new_distance < distance) {
-      closest = &nodes[i];
-      distance = new_distance;
-    }
-  }
-  return closest;
+  boost::mutex::scoped_lock lock(index_lock_);
+  int i = index().nearest(p);
+  return (i < 0? NULL: &nodes[i]);
 };
 
 WayPointNode* Graph::get_closest_node_within_radius(const MapXY &p) const {
-  WayPointNode* closest = NULL;
-  float distance = 0;
-  float new_distance = 0;
-  for(uint i=0; i<nodes_size; i++) {
-    new_distance = Euclidean::DistanceTo(p, nodes[i].map);
-    if((closest == NULL || new_distance < distance)
-       && (new_distance < nodes[i].lane_width)) {
-      closest = &nodes[i];
-      distance = new_distance;
-    }
-  }
-  return closest;
+  boost::mutex::scoped_lock lock(index_lock_);
+  int i = index().nearest_within_width(p);
+  return (i < 0? NULL: &nodes[i]);
 };
 
 
@@ -201,6 +194,7 @@ bool Graph::load(const char* fName){
 	else {
 	  nodes_size = number_of_nodes;
 	  nodes = new WayPointNode[nodes_size];
+	  nodes_changed();
 	}
       }
       else if (line_number == 3){
@@ -236,6 +230,7 @@ bool Graph::load(const char* fName){
 }
 
 void Graph::clear(){
+  nodes_changed();
   for(uint i = 0; i < nodes_size; i++)
     nodes[i].clear();
   nodes_size = 0;
@@ -334,6 +329,7 @@ bool Graph::rndf_is_gps() {
 }
 
 void Graph::xy_rndf() {
+  nodes_changed();
   for(uint i = 0; i < nodes_size; i++){
     nodes[i].map.x = nodes[i].ll.latitude;
     nodes[i].map.y = nodes[i].ll.longitude;
@@ -356,6 +352,7 @@ void Graph::xy_rndf() {
  */
 void Graph::find_mapxy(void)
 {
+  nodes_changed();
   if (nodes_size < 1)
     {
       ROS_INFO("No graph nodes available for conversion to MapXY");
@@ -0,0 +1,172 @@
+/*
+ *  Spatial index of way-point graph nodes
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <algorithm>
+#include <math.h>
+
+#include <art_map/euclidean_distance.h>
+#include <art_map/GraphIndex.h>
+
+namespace
+{
+  /** ranges this small are scanned instead of split */
+  const unsigned LEAF_SIZE = 8;
+
+  /** Allowance for rounding when pruning a subtree.
+   *
+   *  A node beyond the splitting line is at least that far away, but
+   *  DistanceTo() rounds, so only prune subtrees clearly farther than
+   *  the current bound, keeping results identical to a linear scan.
+   */
+  inline float slack(float bound)
+  {
+    return 1e-4 * (1.0 + bound);
+  }
+
+  struct CompareX
+  {
+    template <class T> bool operator()(const T &a, const T &b) const
+    {
+      return a.x < b.x;
+    }
+  };
+
+  struct CompareY
+  {
+    template <class T> bool operator()(const T &a, const T &b) const
+    {
+      return a.y < b.y;
+    }
+  };
+}
+
+/** @brief index an array of way-point nodes
+ *
+ *  The index must be rebuilt whenever the array or any node position
+ *  changes.
+ *
+ *  @param nodes array to index
+ *  @param size number of nodes in the array
+ *  @param generation of those nodes, for valid()
+ */
+void GraphIndex::build(const WayPointNode *nodes, uint32_t size,
+                       uint32_t generation)
+{
+  tree_.resize(size);
+  max_width_ = 0.0;
+  for (uint32_t i = 0; i < size; ++i)
+    {
+      tree_[i].x = nodes[i].map.x;
+      tree_[i].y = nodes[i].map.y;
+      tree_[i].width = nodes[i].lane_width;
+      tree_[i].index = i;
+      max_width_ = std::max(max_width_, nodes[i].lane_width);
+    }
+  build_range(0, size, true);
+  built_ = true;
+  generation_ = generation;
+}
+
+/** @brief discard the index */
+void GraphIndex::clear()
+{
+  tree_.clear();
+  built_ = false;
+  max_width_ = 0.0;
+}
+
+/** @brief find the closest node
+ *
+ *  @return its array index, or -1 if there are no nodes
+ */
+int GraphIndex::nearest(const MapXY &p) const
+{
+  Best best;
+  best.distance = INFINITY;
+  best.index = -1;
+  search(0, tree_.size(), true, p, false, INFINITY, best);
+  return best.index;
+}
+
+/** @brief find the closest node nearer than its own lane width
+ *
+ *  @return its array index, or -1 if none
+ */
+int GraphIndex::nearest_within_width(const MapXY &p) const
+{
+  Best best;
+  best.distance = INFINITY;
+  best.index = -1;
+  search(0, tree_.size(), true, p, true, max_width_, best);
+  return best.index;
+}
+
+/** split range [lo, hi) at its median, then each half on the other axis */
+void GraphIndex::build_range(unsigned lo, unsigned hi, bool x_axis)
+{
+  if (hi - lo <= LEAF_SIZE)
+    return;
+
+  unsigned mid = lo + (hi - lo) / 2;
+  if (x_axis)
+    std::nth_element(tree_.begin() + lo, tree_.begin() + mid,
+                     tree_.begin() + hi, CompareX());
+  else
+    std::nth_element(tree_.begin() + lo, tree_.begin() + mid,
+                     tree_.begin() + hi, CompareY());
+  build_range(lo, mid, !x_axis);
+  build_range(mid + 1, hi, !x_axis);
+}
+
+/** @brief search range [lo, hi) for a better node
+ *
+ *  @param bound no closer node can be farther than this
+ */
+void GraphIndex::search(unsigned lo, unsigned hi, bool x_axis,
+                        const MapXY &p, bool within_width, float bound,
+                        Best &best) const
+{
+  if (hi - lo <= LEAF_SIZE)
+    {
+      for (unsigned i = lo; i < hi; ++i)
+        {
+          const Entry &e = tree_[i];
+          float d = Euclidean::DistanceTo(p, MapXY(e.x, e.y));
+          if (within_width && !(d < e.width))
+            continue;
+          if (d < best.distance
+              || (d == best.distance && (int) e.index < best.index))
+            {
+              best.distance = d;
+              best.index = e.index;
+            }
+        }
+      return;
+    }
+
+  unsigned mid = lo + (hi - lo) / 2;
+  const Entry &e = tree_[mid];
+  float diff = (x_axis? p.x - e.x: p.y - e.y);
+
+  // visit the node at the split, then the nearer half first
+  search(mid, mid + 1, x_axis, p, within_width, bound, best);
+  if (diff < 0.0)
+    search(lo, mid, !x_axis, p, within_width, bound, best);
+  else
+    search(mid + 1, hi, !x_axis, p, within_width, bound, best);
+
+  float limit = std::min(bound, best.distance);
+  if (fabsf(diff) <= limit + slack(limit))
+    {
+      if (diff < 0.0)
+        search(mid + 1, hi, !x_axis, p, within_width, bound, best);
+      else
+        search(lo, mid, !x_axis, p, within_width, bound, best);
+    }
+}
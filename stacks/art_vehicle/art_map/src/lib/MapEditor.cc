@@ -0,0 +1,283 @@
+/*
+ *  In-memory road map editing
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <ros/ros.h>
+#include <art_map/MapEditor.h>
+
+MapEditor::MapEditor(float poly_size, float range):
+  poly_size_(poly_size),
+  range_(range),
+  changed_(false),
+  rndf_(NULL),
+  graph_(NULL),
+  lanes_(NULL)
+{}
+
+MapEditor::~MapEditor()
+{
+  delete lanes_;
+  delete graph_;
+  delete rndf_;
+}
+
+/** @brief load an RNDF and build its graph and polygons
+ *
+ *  @param rndf_name RNDF file name
+ *  @return true if successful
+ */
+bool MapEditor::load(const std::string &rndf_name)
+{
+  RNDF *rndf = new RNDF(rndf_name);
+  if (!rndf->is_valid)
+    {
+      ROS_ERROR("RNDF not valid: %s", rndf_name.c_str());
+      delete rndf;
+      return false;
+    }
+
+  delete lanes_;
+  delete graph_;
+  delete rndf_;
+  rndf_ = rndf;
+  graph_ = NULL;
+  good_segments_ = rndf_->segments;
+  good_zones_ = rndf_->zones;
+  lanes_ = new MapLanes(range_);
+  changed_ = true;
+  return rebuild();
+}
+
+/** @brief move a lane, parking spot or perimeter way-point
+ *
+ *  @param id way-point ID: segment, lane and point for lanes; zone,
+ *            spot and point for spots; zone, 0 and point for
+ *            perimeters
+ *  @param ll new latitude and longitude
+ *  @return true if the way-point exists
+ */
+bool MapEditor::move_waypoint(const ElementID &id, const LatLong &ll)
+{
+  std::vector<LL_Waypoint> *points = NULL;
+  Lane *lane = find_lane(id.seg, id.lane);
+  if (lane != NULL)
+    points = &lane->waypoints;
+  else if (id.lane == 0)
+    {
+      Zone *zone = find_zone(id.seg);
+      if (zone != NULL)
+        points = &zone->perimeter.perimeterpoints;
+    }
+  else
+    {
+      Spot *spot = find_spot(id.seg, id.lane);
+      if (spot != NULL)
+        points = &spot->waypoints;
+    }
+
+  if (points != NULL)
+    for (unsigned i = 0; i < points->size(); ++i)
+      if ((*points)[i].waypoint_id == id.pt)
+        {
+          (*points)[i].ll = ll;
+          changed_ = true;
+          return true;
+        }
+
+  ROS_WARN("way-point %s not found", id.name().str);
+  return false;
+}
+
+/** @brief change a lane width
+ *  @param width lane width (feet), 0 for the default
+ *  @return true if the lane exists
+ */
+bool MapEditor::set_lane_width(segment_id_t seg, lane_id_t lane, int width)
+{
+  Lane *l = find_lane(seg, lane);
+  if (l == NULL || width < 0)
+    {
+      ROS_WARN("cannot set lane %d.%d width to %d", seg, lane, width);
+      return false;
+    }
+  l->lane_width = width;
+  changed_ = true;
+  return true;
+}
+
+/** @brief add a lane to a segment
+ *
+ *  @param seg segment ID
+ *  @param lane new lane, with an ID not yet used in the segment
+ *  @return true if added
+ */
+bool MapEditor::add_lane(segment_id_t seg, const Lane &lane)
+{
+  Segment *s = find_segment(seg);
+  if (s == NULL || find_lane(seg, lane.lane_id) != NULL)
+    {
+      ROS_WARN("cannot add lane %d.%d", seg, lane.lane_id);
+      return false;
+    }
+  s->lanes.push_back(lane);
+  s->number_of_lanes = s->lanes.size();
+  changed_ = true;
+  return true;
+}
+
+/** @brief remove a lane from a segment
+ *
+ *  Exits from other lanes and zone perimeters into the removed lane
+ *  are removed too.  The last lane of a segment cannot be removed.
+ *
+ *  @return true if removed
+ */
+bool MapEditor::remove_lane(segment_id_t seg, lane_id_t lane)
+{
+  Segment *s = find_segment(seg);
+  if (s == NULL || find_lane(seg, lane) == NULL || s->lanes.size() < 2)
+    {
+      ROS_WARN("cannot remove lane %d.%d", seg, lane);
+      return false;
+    }
+
+  for (unsigned i = 0; i < s->lanes.size(); ++i)
+    if (s->lanes[i].lane_id == lane)
+      {
+        s->lanes.erase(s->lanes.begin() + i);
+        break;
+      }
+  s->number_of_lanes = s->lanes.size();
+
+  // exits into the removed lane
+  for (unsigned i = 0; i < rndf_->segments.size(); ++i)
+    for (unsigned j = 0; j < rndf_->segments[i].lanes.size(); ++j)
+      {
+        std::vector<Exit> &exits = rndf_->segments[i].lanes[j].exits;
+        for (unsigned k = 0; k < exits.size(); )
+          {
+            if (exits[k].end_point.segment_id == seg
+                && exits[k].end_point.lane_id == lane)
+              exits.erase(exits.begin() + k);
+            else
+              ++k;
+          }
+      }
+  for (unsigned i = 0; i < rndf_->zones.size(); ++i)
+    {
+      std::vector<Exit> &exits =
+        rndf_->zones[i].perimeter.exits_from_perimeter;
+      for (unsigned k = 0; k < exits.size(); )
+        {
+          if (exits[k].end_point.segment_id == seg
+              && exits[k].end_point.lane_id == lane)
+            exits.erase(exits.begin() + k);
+          else
+            ++k;
+        }
+    }
+
+  changed_ = true;
+  return true;
+}
+
+/** @brief change a parking spot width
+ *  @param width spot width (feet), 0 for the default
+ *  @return true if the spot exists
+ */
+bool MapEditor::set_spot_width(segment_id_t zone, lane_id_t spot, int width)
+{
+  Spot *s = find_spot(zone, spot);
+  if (s == NULL || width < 0)
+    {
+      ROS_WARN("cannot set spot %d.%d width to %d", zone, spot, width);
+      return false;
+    }
+  s->spot_width = width;
+  changed_ = true;
+  return true;
+}
+
+/** @brief make the edits ready to use
+ *
+ *  If the edited RNDF is not valid, the edits since the last
+ *  successful rebuild are discarded.
+ *
+ *  @return true if successful
+ */
+bool MapEditor::rebuild(void)
+{
+  if (rndf_ == NULL)
+    return false;
+  if (!changed_)
+    return true;
+
+  if (!rndf_->rebuild_graph())
+    {
+      ROS_ERROR("edited map not valid, discarding changes");
+      rndf_->segments = good_segments_;
+      rndf_->zones = good_zones_;
+      rndf_->number_of_segments = good_segments_.size();
+      rndf_->number_of_zones = good_zones_.size();
+      rndf_->rebuild_graph();
+      changed_ = false;
+      return false;
+    }
+
+  Graph *graph = new Graph();
+  rndf_->populate_graph(*graph);
+  graph->find_mapxy();
+  lanes_->RemapRNDF(graph, poly_size_);
+
+  // the polygons no longer refer to the previous graph
+  delete graph_;
+  graph_ = graph;
+
+  good_segments_ = rndf_->segments;
+  good_zones_ = rndf_->zones;
+  changed_ = false;
+  return true;
+}
+
+Segment *MapEditor::find_segment(segment_id_t seg)
+{
+  if (rndf_ != NULL)
+    for (unsigned i = 0; i < rndf_->segments.size(); ++i)
+      if (rndf_->segments[i].segment_id == seg)
+        return &rndf_->segments[i];
+  return NULL;
+}
+
+Lane *MapEditor::find_lane(segment_id_t seg, lane_id_t lane)
+{
+  Segment *s = find_segment(seg);
+  if (s != NULL)
+    for (unsigned i = 0; i < s->lanes.size(); ++i)
+      if (s->lanes[i].lane_id == lane)
+        return &s->lanes[i];
+  return NULL;
+}
+
+Zone *MapEditor::find_zone(segment_id_t zone)
+{
+  if (rndf_ != NULL)
+    for (unsigned i = 0; i < rndf_->zones.size(); ++i)
+      if (rndf_->zones[i].zone_id == zone)
+        return &rndf_->zones[i];
+  return NULL;
+}
+
+Spot *MapEditor::find_spot(segment_id_t zone, lane_id_t spot)
+{
+  Zone *z = find_zone(zone);
+  if (z != NULL)
+    for (unsigned i = 0; i < z->spots.size(); ++i)
+      if (z->spots[i].spot_id == spot)
+        return &z->spots[i];
+  return NULL;
+}
@@ -14,10 +14,13 @@
 
  */
 
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <art/epsilon.h>
 #include <vector>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
 
 #include <art_map/gaussian.h>
 #include <art_map/MapLanes.h>
@@ -38,10 +41,37 @@ int bCount=0;
 int cCount=0;
     
 int MapLanes::MapRNDF(Graph* _graph, float _max_poly_size)
+{
+  return BuildPolygons(_graph, _max_poly_size, false);
+}
+
+int MapLanes::RemapRNDF(Graph* _graph, float _max_poly_size)
+{
+  return BuildPolygons(_graph, _max_poly_size, true);
+}
+
+int MapLanes::BuildPolygons(Graph* _graph, float _max_poly_size,
+                            bool remember)
 {
   graph=_graph;
 
-  max_poly_size=fmaxf(_max_poly_size, MIN_POLY_SIZE);
+  float new_size=fmaxf(_max_poly_size, MIN_POLY_SIZE);
+
+  // units of the previous build can only be reused when they were
+  // made with the same polygon size
+  prev_units_.clear();
+  prev_index_.clear();
+  if (remember && new_size == max_poly_size)
+    {
+      prev_units_.swap(units_);
+      for (unsigned i = 0; i < prev_units_.size(); ++i)
+        prev_index_.insert(std::make_pair(UnitKey(prev_units_[i]), i));
+    }
+  units_.clear();
+  units_reused_ = 0;
+  remember_units_ = remember;
+
+  max_poly_size=new_size;
 
   allPolys.clear();
   //filtPolys.clear();
@@ -63,6 +93,14 @@ int MapLanes::MapRNDF(Graph* _graph, float _max_poly_size)
 
   MakePolygons();
   SetFilteredPolygons();
+
+  if (remember)
+    ROS_INFO("reused %u of %u lanes and transitions",
+             units_reused_, (unsigned) units_.size());
+
+  prev_units_.clear();
+  prev_index_.clear();
+  remember_units_ = false;
   
   ROS_DEBUG("MapLanes constructed successfully");
   return 0;				// success
@@ -72,18 +110,14 @@ void MapLanes::MakePolygons()
 {
   // Add Waypoints to WayPointImage
   std::vector<WayPointNode> lane;
-  std::vector<Point2f> lane_pt;
-  std::vector<int> lane_map;
-
-  SmoothCurve lc,rc;
 
   ElementID prev_lane;             // used to determine when the edges
                                    // switch lanes
 
-  // Walk along graph edges, pushing nodes (and the associated points
-  // that the curve code uses) from same lane onto a list, then
-  // process the list whenever a new lane is encountered (or an transition)
-  // or before leaving the function if the list isn't empty.
+  // Walk along graph edges, pushing nodes from same lane onto a
+  // list, then process the list whenever a new lane is encountered
+  // (or an transition) or before leaving the function if the list
+  // isn't empty.
 
   for(uint j = 0; j < graph->edges_size; j++)
     { 
@@ -107,41 +141,21 @@ void MapLanes::MakePolygons()
 	      // If last lane info is still around, process it
 	      if (lane.size()>1)
 		{
-		  Point2f diff_pt=lane_pt[1]-lane_pt[0];
-		  Point2f diff_pt2=lane_pt[lane_pt.size()-1]-
-		    lane_pt[lane_pt.size()-2];
-		  SmoothCurve c=
-		    SmoothCurve(lane_pt,
-				atan2f(diff_pt[1],diff_pt[0]), 1,
-				atan2f(diff_pt2[1],diff_pt2[0]), 1);
-		  
-		  for (uint i=0;i<lane.size()-1;i++)
-		    {
-		      MakeLanePolygon(lane[i],lane[i+1],e,
-				      c.knots[lane_map[i]],
-				      c.knots[lane_map[i+1]],
-				      c, true,
-				      0,0,lc,
-				      0,0,rc);
-		    }
+		  PolyUnit unit;
+		  unit.is_transition=false;
+		  unit.base=0;
+		  unit.nodes=lane;
+		  unit.edges.assign(lane.size()-1, e);
+		  MakeUnit(unit);
 		}
 	      
 	      // Set up new lane
 	      lane.clear();
-	      lane_pt.clear();
-	      lane_map.clear();
-	      
 	      lane.push_back(w1);
-	      Point2f pt1(w1.map.x,w1.map.y);
-	      lane_pt.push_back(pt1);
-	      lane_map.push_back(lane_pt.size()-1);
 	    }
 	  
 	  // Fill in rest of lane
 	  lane.push_back(w2);
-	  Point2f pt2(w2.map.x,w2.map.y);
-	  lane_pt.push_back(pt2);
-	  lane_map.push_back(lane_pt.size()-1);
 	  
 	  prev_lane=w2.id;
 	}
@@ -155,29 +169,20 @@ void MapLanes::MakePolygons()
 	  if (lane.size()>1)
 	    // Process out previous lane if one exists
 	    {
-	      Point2f diff_pt=lane_pt[1]-lane_pt[0];
-	      Point2f diff_pt2=lane_pt[lane_pt.size()-1]-
-		lane_pt[lane_pt.size()-2];
-	      
-	      SmoothCurve c=
-		SmoothCurve(lane_pt,
-			    atan2f(diff_pt[1],diff_pt[0]), 1,
-			    atan2f(diff_pt2[1],diff_pt2[0]), 1);
-	      
-	      for (uint i=0;i<lane.size()-1;i++)
-		MakeLanePolygon(lane[i],lane[i+1],e,
-				c.knots[lane_map[i]],
-				c.knots[lane_map[i+1]],
-				c, true,
-				0,0,lc,0,0,rc);
+	      PolyUnit unit;
+	      unit.is_transition=false;
+	      unit.base=0;
+	      unit.nodes=lane;
+	      unit.edges.assign(lane.size()-1, e);
+	      MakeUnit(unit);
 	    }
 	  
 	  // Make transition polygons
 	  lane.clear();
-	  lane_pt.clear();
-	  lane_map.clear();	  
 
-	  int base_ind=0;
+	  PolyUnit unit;
+	  unit.is_transition=true;
+	  unit.base=0;
 	  
 	  // Exits have 2 waypoints, but curves need 3 or more.  Go
 	  // get neighboring waypoints to entrance and transition if
@@ -189,24 +194,14 @@ void MapLanes::MakePolygons()
 	  WayPointNode* w0=graph->get_node_by_id(pre);
 	  
 	  if (w0 != NULL && w0->id.lane != 0) {
-	    lane.push_back(*w0);
-	    Point2f pt(w0->map.x,w0->map.y);
-	    lane_pt.push_back(pt);
-	    lane_map.push_back(lane_pt.size()-1);
-	    base_ind=1;
+	    unit.nodes.push_back(*w0);
+	    unit.base=1;
 	  }
 	  
 	  // Push 2 (or 3 or 4 if found) waypoints onto list to find
 	  // curve.
-	  lane.push_back(w1);
-	  Point2f pt1(w1.map.x,w1.map.y);
-	  lane_pt.push_back(pt1);
-	  lane_map.push_back(lane_pt.size()-1);	  
-
-	  lane.push_back(w2);
-	  Point2f pt2(w2.map.x,w2.map.y);
-	  lane_pt.push_back(pt2);
-	  lane_map.push_back(lane_pt.size()-1);	  
+	  unit.nodes.push_back(w1);
+	  unit.nodes.push_back(w2);
 
 	  ElementID post=w2.id;
 	  post.pt++;
@@ -214,41 +209,12 @@ void MapLanes::MakePolygons()
 	  WayPointNode* w3=graph->get_node_by_id(post);
 	  
 	  if (w3!=NULL && w3->id.lane != 0)
-            {
-              lane.push_back(*w3);
-              Point2f pt(w3->map.x,w3->map.y);
-              lane_pt.push_back(pt);
-              lane_map.push_back(lane_pt.size()-1);
-            }
+	    unit.nodes.push_back(*w3);
 	  
-	  
-	  if (lane_pt.size()<2)
-	    {
-	      WayPointNode w4=w2;
-	      w4.map=w2.map+w2.map-w1.map;
-	      lane.push_back(w4);
-	      Point2f pt(w4.map.x,w4.map.y);
-	      lane_pt.push_back(pt);
-	      lane_map.push_back(lane_pt.size()-1);
-	    }
-	    
-	  
-	  Point2f diff_pt=lane_pt[1]-lane_pt[0];
-	  Point2f diff_pt2=lane_pt[lane_pt.size()-1]-
-	    lane_pt[lane_pt.size()-2];
-	  
-	  SmoothCurve c=
-	    SmoothCurve(lane_pt,
-			atan2f(diff_pt[1],diff_pt[0]), 1,
-			atan2f(diff_pt2[1],diff_pt2[0]), 1);
-	  
-	  MakeTransitionPolygon(lane[base_ind],lane[base_ind+1],e,
-				c.knots[lane_map[base_ind]],c.knots[lane_map[base_ind+1]],c);
+	  unit.edges.push_back(e);
+	  MakeUnit(unit);
 	  
 	  // Clear out transition
-	  lane.clear();
-	  lane_pt.clear();
-	  lane_map.clear();
 	  prev_lane=ElementID();
 	}
     }
@@ -256,15 +222,11 @@ void MapLanes::MakePolygons()
   // If last lane info is still around, process it
   if (lane.size()>1)
     {
-      // Clear out previous lane
-      Point2f diff_pt=lane_pt[1]-lane_pt[0];
-      Point2f diff_pt2=lane_pt[lane_pt.size()-1]-
-	lane_pt[lane_pt.size()-2];
-      SmoothCurve c=
-	SmoothCurve(lane_pt,
-		    atan2f(diff_pt[1],diff_pt[0]), 1,
-		    atan2f(diff_pt2[1],diff_pt2[0]), 1);
-      
+      PolyUnit unit;
+      unit.is_transition=false;
+      unit.base=0;
+      unit.nodes=lane;
+
       for (uint i=0;i<lane.size()-1;i++) {
 	// Find the edge that links lane[i] and lane[i+1]
 	WayPointEdge e;
@@ -281,29 +243,233 @@ void MapLanes::MakePolygons()
 	      
 	      break;
 	  }
-	
-	MakeLanePolygon(lane[i],lane[i+1],e,
-			c.knots[lane_map[i]],
-			c.knots[lane_map[i+1]],
-			c, true,0,0,lc,0,0,rc);
+	unit.edges.push_back(e);
       }
+      MakeUnit(unit);
     }
   
   // Set up new lane
   lane.clear();
-  lane_pt.clear();
-  lane_map.clear();
+}
+
+// polygon fields set by MakePolygons(), except its index
+static bool same_poly(const poly &a, const poly &b)
+{
+  return (a.p1.x == b.p1.x && a.p1.y == b.p1.y
+          && a.p2.x == b.p2.x && a.p2.y == b.p2.y
+          && a.p3.x == b.p3.x && a.p3.y == b.p3.y
+          && a.p4.x == b.p4.x && a.p4.y == b.p4.y
+          && a.heading == b.heading
+          && a.midpoint.x == b.midpoint.x && a.midpoint.y == b.midpoint.y
+          && a.length == b.length
+          && a.is_stop == b.is_stop
+          && a.is_transition == b.is_transition
+          && a.contains_way == b.contains_way
+          && a.start_way == b.start_way
+          && a.end_way == b.end_way);
+}
+
+// way-point fields used for making polygons
+static bool same_node(const WayPointNode &a, const WayPointNode &b)
+{
+  return (a.id == b.id
+          && a.map.x == b.map.x && a.map.y == b.map.y
+          && a.lane_width == b.lane_width
+          && a.is_stop == b.is_stop);
+}
+
+/** Make the polygons for one lane or transition.
+ *
+ *  When rebuilding, a unit of the previous build with the same
+ *  way-points and context polygons made exactly the same changes
+ *  then, so they are copied instead.
+ */
+void MapLanes::MakeUnit(PolyUnit &unit)
+{
+  unsigned start = allPolys.size();
+  int index_w1 = -1;
+  int index_w2 = -1;
+  if (unit.is_transition)
+    FindWaypointPolys(unit.nodes[unit.base].id, unit.nodes[unit.base+1].id,
+                      index_w1, index_w2);
+
+  if (!remember_units_)
+    {
+      BuildUnit(unit, index_w1, index_w2);
+      return;
+    }
+
+  unit.context.push_back((int) start - 1);
+  if (unit.is_transition)
+    {
+      unit.context.push_back(index_w1);
+      unit.context.push_back(index_w2);
+    }
+  for (unsigned i = 0; i < unit.context.size(); ++i)
+    if (unit.context[i] >= 0)
+      unit.before.push_back(allPolys[unit.context[i]]);
+
+  const PolyUnit *prev = FindUnit(unit);
+  if (prev != NULL)
+    {
+      // append the same polygons, renumbered
+      for (unsigned i = 0; i < prev->polys.size(); ++i)
+        {
+          allPolys.push_back(prev->polys[i]);
+          allPolys.back().poly_id = poly_id_counter++;
+        }
+      unsigned k = 0;
+      for (unsigned i = 0; i < unit.context.size(); ++i)
+        if (unit.context[i] >= 0)
+          {
+            int index = unit.context[i];
+            allPolys[index] = prev->after[k++];
+            allPolys[index].poly_id = index;
+          }
+      if (unit.is_transition && !prev->polys.empty())
+        {
+          transition=true;
+          trans_index=index_w1;
+        }
+      ++units_reused_;
+    }
+  else
+    BuildUnit(unit, index_w1, index_w2);
+
+  unit.polys.assign(allPolys.begin() + start, allPolys.end());
+  for (unsigned i = 0; i < unit.context.size(); ++i)
+    if (unit.context[i] >= 0)
+      unit.after.push_back(allPolys[unit.context[i]]);
+  units_.push_back(unit);
+}
+
+/** Compute the polygons of a lane or transition. */
+void MapLanes::BuildUnit(const PolyUnit &unit, int index_w1, int index_w2)
+{
+  std::vector<Point2f> lane_pt;
+  for (unsigned i = 0; i < unit.nodes.size(); ++i)
+    lane_pt.push_back(Point2f(unit.nodes[i].map.x, unit.nodes[i].map.y));
+
+  Point2f diff_pt=lane_pt[1]-lane_pt[0];
+  Point2f diff_pt2=lane_pt[lane_pt.size()-1]-
+    lane_pt[lane_pt.size()-2];
+  SmoothCurve c=
+    SmoothCurve(lane_pt,
+		atan2f(diff_pt[1],diff_pt[0]), 1,
+		atan2f(diff_pt2[1],diff_pt2[0]), 1);
+
+  if (unit.is_transition)
+    {
+      int base_ind=unit.base;
+      MakeTransitionPolygon(unit.nodes[base_ind],unit.nodes[base_ind+1],
+			    unit.edges[0],
+			    c.knots[base_ind],c.knots[base_ind+1],c,
+			    index_w1, index_w2);
+      return;
+    }
+
+  SmoothCurve lc,rc;
+  for (uint i=0;i<unit.nodes.size()-1;i++)
+    MakeLanePolygon(unit.nodes[i],unit.nodes[i+1],unit.edges[i],
+		    c.knots[i],
+		    c.knots[i+1],
+		    c, true,
+		    0,0,lc,0,0,rc);
+}
+
+/** Find a unit of the previous build with the same inputs.
+ *
+ *  The edge markings are compared too, though polygons do not use
+ *  them yet.
+ *
+ *  @return pointer to the unit, NULL if none
+ */
+const MapLanes::PolyUnit *MapLanes::FindUnit(const PolyUnit &unit) const
+{
+  std::map<UnitKey, unsigned>::const_iterator it =
+    prev_index_.find(UnitKey(unit));
+  if (it == prev_index_.end())
+    return NULL;
+  const PolyUnit &prev = prev_units_[it->second];
+
+  if (prev.base != unit.base
+      || prev.nodes.size() != unit.nodes.size()
+      || prev.edges.size() != unit.edges.size()
+      || prev.context.size() != unit.context.size()
+      || prev.before.size() != unit.before.size())
+    return NULL;
+  for (unsigned i = 0; i < unit.nodes.size(); ++i)
+    if (!same_node(prev.nodes[i], unit.nodes[i]))
+      return NULL;
+  for (unsigned i = 0; i < unit.edges.size(); ++i)
+    if (prev.edges[i].left_boundary != unit.edges[i].left_boundary
+        || prev.edges[i].right_boundary != unit.edges[i].right_boundary)
+      return NULL;
+  for (unsigned i = 0; i < unit.context.size(); ++i)
+    {
+      // same missing polygons, and the same ones shared between slots
+      if ((prev.context[i] < 0) != (unit.context[i] < 0))
+        return NULL;
+      for (unsigned j = 0; j < i; ++j)
+        if ((prev.context[i] == prev.context[j])
+            != (unit.context[i] == unit.context[j]))
+          return NULL;
+    }
+  for (unsigned i = 0; i < unit.before.size(); ++i)
+    if (!same_poly(prev.before[i], unit.before[i]))
+      return NULL;
+
+  return &prev;
+}
+
+/** Find the way-point polygons a transition attaches to.
+ *
+ *  Transitions assume that 1 meter polygons around waypoints exist.
+ *  Looks them up so the new polygons can be attached at the ends.
+ *
+ *  @param id1 starting way-point
+ *  @param id2 ending way-point
+ *  @param index_w1 [out] polygon containing id1, -1 if none
+ *  @param index_w2 [out] polygon containing id2, -1 if none
+ */
+void MapLanes::FindWaypointPolys(const ElementID &id1, const ElementID &id2,
+                                 int &index_w1, int &index_w2) const
+{
+  index_w1=-1;
+  index_w2=-1;
+  for (uint i=0; i<allPolys.size() && (index_w1<0 || index_w2<0); i++) 
+    if (allPolys[i].contains_way) {
+      if (ElementID(allPolys[i].start_way) == id1) 
+	index_w1=i;
+      else if (ElementID(allPolys[i].start_way) == id2)
+	index_w2=i;
+    }
 }
 
 void MapLanes::SetFilteredPolygons()
 {
-  for (int i=0; i<(int)allPolys.size(); i++)
+  // Filters left from a previous build are reused instead of
+  // constructed again, their matrices are expensive to allocate.
+  // Only those with vision updates need restarting.
+  if (filtPolys.size() > allPolys.size())
+    filtPolys.resize(allPolys.size());
+  for (int i=0; i<(int)filtPolys.size(); i++)
+    {
+      if (filtPolys[i].Updated())
+        filtPolys[i].Restart();
+      filtPolys[i].SetPolygon(allPolys.at(i));
+    }
+
+  filtPolys.reserve(allPolys.size());
+  for (int i=filtPolys.size(); i<(int)allPolys.size(); i++)
     {
       FilteredPolygon p;
       p.SetPolygon(allPolys.at(i));
       filtPolys.push_back(p);
     }
 
+  SetLanePartition();
+
   #ifdef DEBUGMAP
   for (int i=0; i<(int)filtPolys.size(); i++) {
     WritePolygonToDebugFile(i);	
@@ -652,30 +818,17 @@ void MapLanes::MakeLanePolygon(WayPointNode w1, WayPointNode w2,
 void MapLanes::MakeTransitionPolygon(WayPointNode w1, WayPointNode w2,
 				     WayPointEdge e,
 				     float time1, float time2,
-				     SmoothCurve& c)
+				     SmoothCurve& c,
+				     int index_w1, int index_w2)
 {
-  // Assumes Transition edges come after lane edges in the edge list
+  // Assumes Transition edges come after lane edges in the edge list.
+  // The way-point polygons were found by FindWaypointPolys().
   poly poly_w1, poly_w2;
-  
-  int index_w1=-1;
-  int index_w2=-1;
-
-  //Transitions assume that 1 meter polygons around waypoints exist.  Look
-  //them up so the new polygons can be attached at the ends.
 
-  for (uint i=0; i<allPolys.size() && (index_w1<0 || index_w2<0); i++) 
-    if (allPolys[i].contains_way) {
-      if (ElementID(allPolys[i].start_way) == w1.id) 
-	{
-	  poly_w1=allPolys[i];
-	  index_w1=i;
-	}
-      else if (ElementID(allPolys[i].start_way) == w2.id)
-	{
-	  poly_w2=allPolys[i];
-	  index_w2=i;
-	}
-    }
+  if (index_w1>=0)
+    poly_w1=allPolys[index_w1];
+  if (index_w2>=0)
+    poly_w2=allPolys[index_w2];
 
   if (index_w1<0)
     {
@@ -790,18 +943,36 @@ void MapLanes::MakeTransitionPolygon(WayPointNode w1, WayPointNode w2,
       }
 }
 
+/** store a polygon in an ArtLanes message
+ *
+ *  Assigning over a polygon already in the message reuses the storage
+ *  of its points vector, so refilling a message every cycle only
+ *  allocates when it has more polygons than before.
+ *
+ *  @param lanes message being filled
+ *  @param n index of this polygon in the message
+ *  @param quad polygon to store
+ */
+static inline void setQuad(art_msgs::ArtLanes *lanes, unsigned n,
+                           const art_msgs::ArtQuadrilateral &quad)
+{
+  if (n < lanes->polygons.size())
+    lanes->polygons[n] = quad;
+  else
+    lanes->polygons.push_back(quad);
+}
+
 /** copy all polygons to an ArtLanes message.
  *
  * @return number of polygons added
  */
 int MapLanes::getAllLanes(art_msgs::ArtLanes *lanes)
 {
-  lanes->polygons.clear();
+  lanes->polygons.resize(filtPolys.size());
 
   for(unsigned int i = 0; i < filtPolys.size(); i++)
     {
-      art_msgs::ArtQuadrilateral temp = filtPolys.at(i).GetQuad();
-      lanes->polygons.push_back(temp);
+      filtPolys.at(i).GetQuad(lanes->polygons[i]);
     }
 
   return lanes->polygons.size();
@@ -813,19 +984,20 @@ int MapLanes::getLanes(art_msgs::ArtLanes *lanes, MapXY here)
   if (range < 0)
     return getAllLanes(lanes);
 
-  lanes->polygons.clear();
-
+  // only polygons in range need the whole quadrilateral
+  unsigned n = 0;
   for(unsigned int i = 0; i < filtPolys.size(); i++)
     {
-      art_msgs::ArtQuadrilateral temp = filtPolys.at(i).GetQuad();
-      float dist = Euclidean::DistanceTo(MapXY(temp.midpoint), here);
+      float dist = Euclidean::DistanceTo(filtPolys.at(i).GetMidpoint(), here);
       
       if(dist <= range)
         {
-          lanes->polygons.push_back(temp);
-          allPolys[i] = poly(temp);
+          filtPolys.at(i).GetQuad(scratch_quad);
+          setQuad(lanes, n++, scratch_quad);
+          allPolys[i] = poly(scratch_quad);
         }
     }
+  lanes->polygons.resize(n);
 
   ROS_DEBUG_STREAM("found " << lanes->polygons.size()
                    << " polygons within " << range
@@ -840,18 +1012,19 @@ int MapLanes::getVisionLanes(art_msgs::ArtLanes *lanes, float x, float y,
   if (range < 0)
     return getAllLanes(lanes);
 
-  lanes->polygons.clear();
-
   int index = ops.getContainingPoly(allPolys,x,y);
   if (index < 0)
     {
+      lanes->polygons.clear();
       return 0;
     }
 
   poly current = allPolys.at(index);
+  unsigned n = 0;
   for(unsigned int i = 0; i < filtPolys.size(); i++)
     {
-      art_msgs::ArtQuadrilateral temp = filtPolys.at(i).GetQuad();
+      art_msgs::ArtQuadrilateral &temp = scratch_quad;
+      filtPolys.at(i).GetQuad(temp);
 
       if (temp.start_way.lane != current.start_way.lane
           || temp.start_way.seg != current.start_way.seg
@@ -864,9 +1037,10 @@ int MapLanes::getVisionLanes(art_msgs::ArtLanes *lanes, float x, float y,
   
     if((dist <= range) && (dist>10.0) && (fabs(angle)<DEG_T_RAD*25))
       {
-        lanes->polygons.push_back(temp);
+        setQuad(lanes, n++, temp);
       }  
     }
+  lanes->polygons.resize(n);
 
   //testDraw();
   return 0;
@@ -874,22 +1048,23 @@ int MapLanes::getVisionLanes(art_msgs::ArtLanes *lanes, float x, float y,
 
 void MapLanes::UpdatePoly(polyUpdate upPoly, float rrX, float rrY, float rrOri)
 {
-  if (upPoly.poly_id <=0 || upPoly.poly_id>=(int)filtPolys.size()) {
+  // Don't break waypoints !
+  if (upPoly.poly_id <=0 || upPoly.poly_id+1>=(int)filtPolys.size()) {
     return;
   }
   if (upPoly.distance<3.0) return;
   FilteredPolygon* filt=&(filtPolys.at(upPoly.poly_id));
-  poly curr=filt->GetPolygon();
-  
-  // Don't break waypoints !
-  if (upPoly.poly_id <=0 || upPoly.poly_id>=(int)filtPolys.size()) {
-    return;
-  }
-  //printf("Good %i \n",upPoly.poly_id);
+
+  // Only the IDs and flags of this polygon and its neighbors are
+  // needed here, never their corners.  Those attributes are the same
+  // in allPolys and the filters, and they never change, so read them
+  // from allPolys instead of rebuilding each filter's polygon with
+  // GetPolygon().  Updates still propagate to the neighbors' filters.
+  const poly &curr=allPolys.at(upPoly.poly_id);
+  const poly &prev=allPolys.at(upPoly.poly_id-1);
+  const poly &next=allPolys.at(upPoly.poly_id+1);
 
   //printf("1 %i %lf %lf\n",upPoly.poly_id,upPoly.distance,upPoly.bearing);
-  poly prev=(filtPolys.at(upPoly.poly_id-1)).GetPolygon();
-  poly next=(filtPolys.at(upPoly.poly_id+1)).GetPolygon();
   // Don't update the bottom points if they touch a waypoint
   if (prev.contains_way && (upPoly.point_id==0 || upPoly.point_id==3)) return;
   // Don't update the top points if they touch a waypoint
@@ -928,25 +1103,168 @@ void MapLanes::UpdatePoly(polyUpdate upPoly, float rrX, float rrY, float rrOri)
 
 void MapLanes::UpdateWithCurrent(int i){
   static gaussian g1(0.0,1.0);
+  float noise[NUM_POINTS];
+  for (int j=0; j<NUM_POINTS; j++)
+    noise[j]=g1.get_sample_1D();
+  UpdateWithCurrent(i, noise);
+}
+
+// Self-observation update of polygon i, with the given measurement
+// noise for each point.
+void MapLanes::UpdateWithCurrent(int i, const float noise[NUM_POINTS]){
   FilteredPolygon* filt=&(filtPolys.at(i));
-  poly temp2 = filtPolys.at(i).GetPolygon();
+  const poly &temp2 = allPolys.at(i);
   if (temp2.is_transition || temp2.contains_way) return;
 
-  float angle=AngleFromXY(rX,rY,rOri,temp2.p1.x,temp2.p1.y);
-  float distU=DistFromXY(rX,rY,temp2.p1.x,temp2.p1.y);
-  if (distU>5 && distU<80 && fabs(angle) < 0.2) filt->UpdatePoint(0,distU+g1.get_sample_1D(),angle,1.0,rX,rY,rOri);
-      
-  angle=AngleFromXY(rX,rY,rOri,temp2.p2.x,temp2.p2.y);
-  distU=DistFromXY(rX,rY,temp2.p2.x,temp2.p2.y);
-  if (distU>5 && distU<80 && fabs(angle) < 0.2) filt->UpdatePoint(1,distU+g1.get_sample_1D(),angle,1.0,rX,rY,rOri);
+  // use the current filtered location of each point
+  poly curr = filt->GetPolygon();
+  MapXY pts[NUM_POINTS] = {curr.p1, curr.p2, curr.p3, curr.p4};
+  for (int j=0; j<NUM_POINTS; j++) {
+    float angle=AngleFromXY(rX,rY,rOri,pts[j].x,pts[j].y);
+    float distU=DistFromXY(rX,rY,pts[j].x,pts[j].y);
+    if (distU>5 && distU<80 && fabs(angle) < 0.2)
+      filt->UpdatePoint(j,distU+noise[j],angle,1.0,rX,rY,rOri);
+  }
+}
+
+/** Apply self-observation updates to a batch of polygons.
+ *
+ *  Updates are partitioned by lane.  Each lane's polygons are updated
+ *  in their original order by a single thread, and no update touches
+ *  another polygon's filter, so the results do not depend on the
+ *  number of threads or their scheduling.  The noise samples are
+ *  drawn here, in the order given, so results are deterministic for
+ *  the same random number sequence.
+ */
+void MapLanes::UpdateWithCurrent(const std::vector<int> &poly_ids)
+{
+  static gaussian g1(0.0,1.0);
+  for (unsigned i = 0; i < poly_ids.size(); ++i)
+    {
+      int id = poly_ids[i];
+      if (id < 0 || id >= (int) poly_lane_.size())
+        continue;
+      LaneWork &work = lane_work_[poly_lane_[id]];
+      work.current.push_back(id);
+      for (int j=0; j<NUM_POINTS; j++)
+        work.noise.push_back(g1.get_sample_1D());
+    }
+  RunLaneUpdates();
+}
+
+/** Set the number of threads for batch polygon updates.
+ *
+ *  @param nthreads number of threads; 0 means one per processor
+ */
+void MapLanes::SetUpdateThreads(unsigned nthreads)
+{
+  if (nthreads == 0)
+    nthreads = std::max(1u, boost::thread::hardware_concurrency());
+  if (nthreads != update_threads_)
+    {
+      StopUpdateThreads();
+      update_threads_ = nthreads;
+    }
+}
+
+// Partition the filtered polygons by lane.  Transition polygons
+// belong to the lane they leave.
+void MapLanes::SetLanePartition()
+{
+  std::map<ElementID, int> lanes;
+  poly_lane_.resize(allPolys.size());
+  for (unsigned i = 0; i < allPolys.size(); ++i)
+    {
+      ElementID lane(allPolys[i].start_way.seg,
+                     allPolys[i].start_way.lane, 0);
+      std::map<ElementID, int>::iterator it = lanes.find(lane);
+      if (it == lanes.end())
+        it = lanes.insert(std::make_pair(lane, lanes.size())).first;
+      poly_lane_[i] = it->second;
+    }
+  lane_work_.clear();
+  lane_work_.resize(lanes.size());
+}
 
-  angle=AngleFromXY(rX,rY,rOri,temp2.p3.x,temp2.p3.y);
-  distU=DistFromXY(rX,rY,temp2.p3.x,temp2.p3.y);
-  if (distU>5 && distU<80 && fabs(angle) < 0.2) filt->UpdatePoint(2,distU+g1.get_sample_1D(),angle,1.0,rX,rY,rOri);     
+// Run all pending lane work, spreading the lanes over the threads.
+// The helper threads persist from one batch to the next.
+void MapLanes::RunLaneUpdates()
+{
+  unsigned nworkers = std::min(update_threads_, (unsigned) lane_work_.size());
+  if (nworkers <= 1)
+    {
+      UpdateLanes(0, 1);
+      return;
+    }
 
-  angle=AngleFromXY(rX,rY,rOri,temp2.p4.x,temp2.p4.y);
-  distU=DistFromXY(rX,rY,temp2.p4.x,temp2.p4.y);
-  if (distU>5 && distU<80 && fabs(angle) < 0.2) filt->UpdatePoint(3,distU+g1.get_sample_1D(),angle,1.0,rX,rY,rOri);
+  {
+    boost::mutex::scoped_lock lock(work_lock_);
+    for (unsigned w = workers_.size() + 1; w < update_threads_; ++w)
+      workers_.push_back(boost::shared_ptr<boost::thread>
+                         (new boost::thread(&MapLanes::UpdateWorker,
+                                            this, w, work_batch_)));
+    work_nworkers_ = nworkers;
+    work_busy_ = nworkers - 1;
+    ++work_batch_;
+  }
+  work_ready_.notify_all();
+
+  UpdateLanes(0, nworkers);             // this thread does its share
+
+  boost::mutex::scoped_lock lock(work_lock_);
+  while (work_busy_ > 0)
+    work_done_.wait(lock);
+}
+
+// Helper thread body: run its share of each new batch.
+void MapLanes::UpdateWorker(unsigned worker, unsigned batch)
+{
+  boost::mutex::scoped_lock lock(work_lock_);
+  for (;;)
+    {
+      while (!work_shutdown_ && work_batch_ == batch)
+        work_ready_.wait(lock);
+      if (work_shutdown_)
+        return;
+
+      batch = work_batch_;
+      unsigned nworkers = work_nworkers_;
+      if (worker >= nworkers)
+        continue;                       // fewer lanes than threads
+
+      lock.unlock();
+      UpdateLanes(worker, nworkers);
+      lock.lock();
+      if (--work_busy_ == 0)
+        work_done_.notify_one();
+    }
+}
+
+// Stop and join the helper threads.
+void MapLanes::StopUpdateThreads()
+{
+  {
+    boost::mutex::scoped_lock lock(work_lock_);
+    work_shutdown_ = true;
+  }
+  work_ready_.notify_all();
+  for (unsigned i = 0; i < workers_.size(); ++i)
+    workers_[i]->join();
+  workers_.clear();
+  work_shutdown_ = false;
+}
+
+// Apply the pending work for every nworkers'th lane, starting at worker.
+void MapLanes::UpdateLanes(unsigned worker, unsigned nworkers)
+{
+  for (unsigned lane = worker; lane < lane_work_.size(); lane += nworkers)
+    {
+      LaneWork &work = lane_work_[lane];
+      for (unsigned i = 0; i < work.current.size(); ++i)
+        UpdateWithCurrent(work.current[i], &work.noise[NUM_POINTS*i]);
+      work.current.clear();
+      work.noise.clear();
+    }
 }
 
 
@@ -1205,6 +1205,32 @@ void RNDF::prep_graph(){
   }
 }
 
+bool RNDF::rebuild_graph(void)
+{
+  id_map.clear();
+  edges.clear();
+
+  is_valid = isvalid();
+  for (uint i = 0; is_valid && i < segments.size(); i++)
+    {
+      is_valid = segments[i].isvalid();
+      for (uint j = 0; is_valid && j < segments[i].lanes.size(); j++)
+	is_valid = segments[i].lanes[j].isvalid();
+    }
+  for (uint i = 0; is_valid && i < zones.size(); i++)
+    is_valid = (zones[i].isvalid() && zones[i].perimeter.isvalid());
+
+  if (!is_valid)
+    {
+      ROS_ERROR("edited RNDF \"%s\" is not valid", filename.c_str());
+      return false;
+    }
+
+  // prep_graph() resets is_valid if any reference is missing
+  prep_graph();
+  return is_valid;
+}
+
 /** Populate graph from RNDF parser data.
  *
  * Copies all nodes from the way-point map to an array in the
@@ -1218,6 +1244,7 @@ void RNDF::populate_graph(Graph& graph)
   for(node_itr = id_map.begin(); node_itr != id_map.end(); node_itr++){
     graph.nodes[(node_itr->second).index] = (node_itr->second);
   }
+  graph.nodes_changed();
 
   graph.edges_size = edges.size();
   graph.edges = edges;
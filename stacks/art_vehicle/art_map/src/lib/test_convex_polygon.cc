@@ -0,0 +1,102 @@
+/*
+ *  ART convex polygon clipping unit test
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <art_map/ConvexPolygon.h>
+
+// axis-aligned square, counter-clockwise unless reversed
+mapxy_list_t square(float x, float y, float side, bool reversed = false)
+{
+  mapxy_list_t v;
+  v.push_back(MapXY(x, y));
+  v.push_back(MapXY(x + side, y));
+  v.push_back(MapXY(x + side, y + side));
+  v.push_back(MapXY(x, y + side));
+  if (reversed)
+    std::reverse(v.begin(), v.end());
+  return v;
+}
+
+TEST(ConvexPolygon, area)
+{
+  EXPECT_FLOAT_EQ(4.0, ConvexPolygon::signedArea(square(0, 0, 2)));
+  EXPECT_FLOAT_EQ(-4.0, ConvexPolygon::signedArea(square(0, 0, 2, true)));
+  EXPECT_FLOAT_EQ(4.0, ConvexPolygon::area(square(0, 0, 2, true)));
+}
+
+TEST(ConvexPolygon, intersectionArea)
+{
+  // partial, either vertex order
+  EXPECT_NEAR(1.0, ConvexPolygon::intersectionArea(square(0, 0, 2),
+                                                   square(1, 1, 2)), 1e-5);
+  EXPECT_NEAR(1.0, ConvexPolygon::intersectionArea(square(0, 0, 2, true),
+                                                   square(1, 1, 2)), 1e-5);
+  EXPECT_NEAR(1.0, ConvexPolygon::intersectionArea(square(0, 0, 2),
+                                                   square(1, 1, 2, true)),
+              1e-5);
+
+  // contained
+  EXPECT_NEAR(1.0, ConvexPolygon::intersectionArea(square(0, 0, 4),
+                                                   square(1, 1, 1)), 1e-5);
+
+  // sharing only an edge, or disjoint
+  EXPECT_NEAR(0.0, ConvexPolygon::intersectionArea(square(0, 0, 2),
+                                                   square(2, 0, 2)), 1e-5);
+  EXPECT_EQ(0.0, ConvexPolygon::intersectionArea(square(0, 0, 2),
+                                                 square(5, 5, 2)));
+}
+
+TEST(ConvexPolygon, rotated)
+{
+  // diamond inscribed in a 2x2 square has half its area
+  mapxy_list_t diamond;
+  diamond.push_back(MapXY(1.0f, 0.0f));
+  diamond.push_back(MapXY(2.0f, 1.0f));
+  diamond.push_back(MapXY(1.0f, 2.0f));
+  diamond.push_back(MapXY(0.0f, 1.0f));
+  EXPECT_NEAR(2.0, ConvexPolygon::intersectionArea(square(0, 0, 2), diamond),
+              1e-5);
+}
+
+TEST(ConvexPolygon, overlapping)
+{
+  poly_list_t polys(3);
+  mapxy_list_t sq[3] = {square(0, 0, 2), square(2, 0, 2), square(10, 0, 2)};
+  for (unsigned i = 0; i < 3; ++i)
+    {
+      polys[i].p1 = sq[i][0];
+      polys[i].p2 = sq[i][1];
+      polys[i].p3 = sq[i][2];
+      polys[i].p4 = sq[i][3];
+    }
+
+  std::vector<int> indices;
+  EXPECT_EQ(2u, ConvexPolygon::overlapping(square(1, 0, 2), polys,
+                                           0.5, indices));
+  EXPECT_EQ(0, indices[0]);
+  EXPECT_EQ(1, indices[1]);
+  EXPECT_EQ(1u, ConvexPolygon::overlapping(square(1.5, 0, 2), polys,
+                                           1.5, indices));
+  EXPECT_EQ(1, indices[0]);
+
+  std::vector<float> areas;
+  ConvexPolygon::intersectionAreas(square(1, 0, 2), polys, areas);
+  ASSERT_EQ(3u, areas.size());
+  EXPECT_NEAR(2.0, areas[0], 1e-5);
+  EXPECT_NEAR(2.0, areas[1], 1e-5);
+  EXPECT_EQ(0.0, areas[2]);
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
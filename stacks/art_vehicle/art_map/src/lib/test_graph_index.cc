@@ -0,0 +1,259 @@
+/*
+ *  ART way-point graph spatial index unit test
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <float.h>
+#include <stdlib.h>
+#include <gtest/gtest.h>
+#include <boost/thread.hpp>
+#include <ros/package.h>
+
+#include <art_map/euclidean_distance.h>
+#include <art_map/Graph.h>
+#include <art_map/RNDF.h>
+
+// the linear scans Graph used before it had an index
+WayPointNode *scan_closest(const Graph &g, const MapXY &p)
+{
+  WayPointNode *closest = NULL;
+  float distance = 0;
+  for (uint i = 0; i < g.nodes_size; i++)
+    {
+      float new_distance = Euclidean::DistanceTo(p, g.nodes[i].map);
+      if (closest == NULL || new_distance < distance)
+        {
+          closest = &g.nodes[i];
+          distance = new_distance;
+        }
+    }
+  return closest;
+}
+
+WayPointNode *scan_closest_within_radius(const Graph &g, const MapXY &p)
+{
+  WayPointNode *closest = NULL;
+  float distance = 0;
+  for (uint i = 0; i < g.nodes_size; i++)
+    {
+      float new_distance = Euclidean::DistanceTo(p, g.nodes[i].map);
+      if ((closest == NULL || new_distance < distance)
+          && (new_distance < g.nodes[i].lane_width))
+        {
+          closest = &g.nodes[i];
+          distance = new_distance;
+        }
+    }
+  return closest;
+}
+
+// load a bundled RNDF, return false if not available
+bool load_graph(const std::string &name, Graph &graph)
+{
+  std::string path = ros::package::getPath("art_map") + "/rndf/" + name;
+  RNDF rndf(path);
+  if (!rndf.is_valid)
+    return false;
+  rndf.populate_graph(graph);
+  if (graph.rndf_is_gps())
+    graph.find_mapxy();
+  else
+    graph.xy_rndf();
+  return (graph.nodes_size > 0);
+}
+
+// compare index and linear scan at random points around a map
+void compare_map(const std::string &name)
+{
+  Graph graph;
+  ASSERT_TRUE(load_graph(name, graph)) << name;
+
+  float min_x = FLT_MAX, min_y = FLT_MAX;
+  float max_x = -FLT_MAX, max_y = -FLT_MAX;
+  for (uint i = 0; i < graph.nodes_size; i++)
+    {
+      min_x = std::min(min_x, graph.nodes[i].map.x);
+      min_y = std::min(min_y, graph.nodes[i].map.y);
+      max_x = std::max(max_x, graph.nodes[i].map.x);
+      max_y = std::max(max_y, graph.nodes[i].map.y);
+    }
+
+  // query points: random ones covering the map plus a margin, and
+  // every way-point itself
+  const unsigned N_RANDOM = 2000;
+  const float margin = 50.0;
+  unsigned seed = 42;
+  std::vector<MapXY> points;
+  for (unsigned i = 0; i < N_RANDOM; i++)
+    {
+      float fx = rand_r(&seed) / (float) RAND_MAX;
+      float fy = rand_r(&seed) / (float) RAND_MAX;
+      float x = min_x - margin + fx * (max_x - min_x + 2*margin);
+      float y = min_y - margin + fy * (max_y - min_y + 2*margin);
+      points.push_back(MapXY(x, y));
+    }
+  for (uint i = 0; i < graph.nodes_size; i++)
+    points.push_back(graph.nodes[i].map);
+
+  std::vector<WayPointNode *> expected(2 * points.size());
+  for (unsigned i = 0; i < points.size(); i++)
+    {
+      expected[2*i] = scan_closest(graph, points[i]);
+      expected[2*i+1] = scan_closest_within_radius(graph, points[i]);
+    }
+
+  std::vector<WayPointNode *> actual(2 * points.size());
+  for (unsigned i = 0; i < points.size(); i++)
+    {
+      actual[2*i] = graph.get_closest_node(points[i]);
+      actual[2*i+1] = graph.get_closest_node_within_radius(points[i]);
+    }
+
+  for (unsigned i = 0; i < expected.size(); i++)
+    {
+      EXPECT_EQ(expected[i], actual[i])
+        << name << " point " << i/2 << ": ("
+        << points[i/2].x << ", " << points[i/2].y << ")";
+    }
+}
+
+// nearest node to each point, as seen by one query thread
+void query_all(const Graph *graph, const std::vector<MapXY> *points,
+               std::vector<WayPointNode *> *result)
+{
+  result->resize(points->size());
+  for (unsigned i = 0; i < points->size(); i++)
+    (*result)[i] = graph->get_closest_node((*points)[i]);
+}
+
+TEST(GraphIndex, empty)
+{
+  Graph graph;
+  EXPECT_TRUE(graph.get_closest_node(MapXY(0.0, 0.0)) == NULL);
+  EXPECT_TRUE(graph.get_closest_node_within_radius(MapXY(0.0, 0.0))
+              == NULL);
+}
+
+TEST(GraphIndex, ties)
+{
+  // several nodes at the same place, the first one always wins
+  const uint N = 40;
+  WayPointNode nodes[N];
+  for (uint i = 0; i < N; i++)
+    {
+      nodes[i].index = i;
+      nodes[i].map = MapXY((i % 4) * 10.0, 0.0);
+      nodes[i].lane_width = (i < 4? 0.0: 3.0);
+    }
+  Graph graph(N, 0, nodes, NULL);
+  EXPECT_EQ(&graph.nodes[1], graph.get_closest_node(MapXY(10.0, 0.0)));
+  EXPECT_EQ(&graph.nodes[5],
+            graph.get_closest_node_within_radius(MapXY(10.0, 1.0)));
+  EXPECT_TRUE(graph.get_closest_node_within_radius(MapXY(5.0, 0.0)) == NULL);
+
+  // moving nodes directly requires reporting the change
+  graph.nodes[7].map = MapXY(100.0, 100.0);
+  graph.nodes_changed();
+  EXPECT_EQ(&graph.nodes[7], graph.get_closest_node(MapXY(90.0, 90.0)));
+}
+
+TEST(GraphIndex, generation)
+{
+  // same array and size, different nodes
+  const uint N = 20;
+  WayPointNode nodes[N];
+  for (uint i = 0; i < N; i++)
+    {
+      nodes[i].index = i;
+      nodes[i].map = MapXY(i * 10.0, 0.0);
+    }
+  Graph graph(N, 0, nodes, NULL);
+  WayPointNode *array = graph.nodes;
+  EXPECT_EQ(&graph.nodes[0], graph.get_closest_node(MapXY(-5.0, 0.0)));
+
+  // clear() then refill in place, as a reload would
+  graph.clear();
+  EXPECT_TRUE(graph.get_closest_node(MapXY(-5.0, 0.0)) == NULL);
+  graph.nodes_size = N;
+  for (uint i = 0; i < N; i++)
+    graph.nodes[i].map = MapXY((N - i) * 10.0, 0.0);
+  graph.nodes_changed();
+  EXPECT_EQ(array, graph.nodes);
+  EXPECT_EQ(&graph.nodes[N-1], graph.get_closest_node(MapXY(-5.0, 0.0)));
+
+  // xy_rndf() moves every node
+  for (uint i = 0; i < N; i++)
+    {
+      graph.nodes[i].ll.latitude = 0.0;
+      graph.nodes[i].ll.longitude = i * 10.0;
+    }
+  graph.xy_rndf();
+  EXPECT_EQ(&graph.nodes[0], graph.get_closest_node(MapXY(0.0, -5.0)));
+}
+
+TEST(GraphIndex, threads)
+{
+  Graph graph;
+  ASSERT_TRUE(load_graph("prc_osm.rndf", graph));
+
+  unsigned seed = 7;
+  std::vector<MapXY> points;
+  for (unsigned i = 0; i < 500; i++)
+    {
+      float x = graph.nodes[i % graph.nodes_size].map.x;
+      float y = graph.nodes[i % graph.nodes_size].map.y;
+      x += 20.0 * rand_r(&seed) / (float) RAND_MAX - 10.0;
+      y += 20.0 * rand_r(&seed) / (float) RAND_MAX - 10.0;
+      points.push_back(MapXY(x, y));
+    }
+
+  // all threads start with a stale index, so they race to build it
+  const unsigned N_THREADS = 4;
+  std::vector<WayPointNode *> results[N_THREADS];
+  boost::thread_group threads;
+  graph.nodes_changed();
+  for (unsigned t = 0; t < N_THREADS; t++)
+    threads.create_thread(boost::bind(query_all, &graph, &points,
+                                      &results[t]));
+  threads.join_all();
+
+  for (unsigned i = 0; i < points.size(); i++)
+    {
+      WayPointNode *expected = scan_closest(graph, points[i]);
+      for (unsigned t = 0; t < N_THREADS; t++)
+        EXPECT_EQ(expected, results[t][i]) << "thread " << t
+                                           << " point " << i;
+    }
+}
+
+TEST(GraphIndex, bundled_maps)
+{
+  const char *maps[] =
+    {
+      "digcs.rndf",
+      "longhorn.rndf",
+      "new_digcs.rndf",
+      "outside_prc_gen.rndf",
+      "prc_large.rndf",
+      "prc_large_obstacle.rndf",
+      "prc_osm.rndf",
+      "RoadA.rndf",
+      "speedway.rndf",
+      "swri_site_visit.rndf",
+      "swri_site_visit_with_zones.rndf",
+      "utexas_explore.rndf",
+    };
+  for (unsigned i = 0; i < sizeof(maps) / sizeof(maps[0]); ++i)
+    compare_map(maps[i]);
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
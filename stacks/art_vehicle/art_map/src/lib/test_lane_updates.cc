@@ -0,0 +1,161 @@
+/*
+ *  ART road map batch filter update unit test
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <stdlib.h>
+#include <gtest/gtest.h>
+#include <ros/package.h>
+
+#include <art_map/MapLanes.h>
+
+// The same self-observation updates are applied one polygon at a
+// time, and as batches with one and with several threads.  All three
+// must give bit-identical polygons.
+//
+// Self-observation noise comes from random(), which is reseeded for
+// each map.  Every batch draws an even number of samples, so no
+// gaussian pair is left over from one map to the next.
+
+const unsigned N_CYCLES = 20;
+
+class LaneUpdates: public testing::Test
+{
+protected:
+
+  virtual void SetUp()
+  {
+    std::string path =
+      ros::package::getPath("art_map") + "/rndf/prc_large.rndf";
+    RNDF rndf(path);
+    ASSERT_TRUE(rndf.is_valid);
+    rndf.populate_graph(graph_);
+    graph_.find_mapxy();
+
+    art_msgs::ArtLanes lanes;
+    MapLanes map;
+    Graph graph(graph_);
+    ASSERT_EQ(0, map.MapRNDF(&graph, MIN_POLY_SIZE));
+    map.getAllLanes(&lanes);
+    original_ = lanes.polygons;
+    ASSERT_LT(1000u, original_.size());
+
+    // self-observations of the polygons near random robot positions
+    unsigned seed = 17;
+    for (unsigned c = 0; c < N_CYCLES; ++c)
+      {
+        Cycle cycle;
+        unsigned here = rand_r(&seed) % original_.size();
+        cycle.x = original_[here].midpoint.x;
+        cycle.y = original_[here].midpoint.y;
+        cycle.yaw = original_[here].heading;
+        for (unsigned i = 0; i < original_.size(); ++i)
+          {
+            float dx = original_[i].midpoint.x - cycle.x;
+            float dy = original_[i].midpoint.y - cycle.y;
+            if (dx*dx + dy*dy < 80.0*80.0)
+              cycle.current.push_back(original_[i].poly_id);
+          }
+        cycles_.push_back(cycle);
+      }
+  }
+
+  // apply all the cycles, return the resulting polygons
+  void run(unsigned nthreads, art_msgs::ArtLanes &result)
+  {
+    Graph graph(graph_);
+    MapLanes map;
+    ASSERT_EQ(0, map.MapRNDF(&graph, MIN_POLY_SIZE));
+    map.SetUpdateThreads(nthreads);
+    srandom(42);
+    for (unsigned c = 0; c < cycles_.size(); ++c)
+      {
+        const Cycle &cycle = cycles_[c];
+        map.SetRobotPos(MapPose(cycle.x, cycle.y, cycle.yaw));
+        if (nthreads == 0)
+          {
+            // one polygon at a time
+            for (unsigned i = 0; i < cycle.current.size(); ++i)
+              map.UpdateWithCurrent(cycle.current[i]);
+          }
+        else
+          {
+            map.UpdateWithCurrent(cycle.current);
+          }
+      }
+    map.getAllLanes(&result);
+  }
+
+  void expect_identical(const art_msgs::ArtLanes &expected,
+                        const art_msgs::ArtLanes &actual)
+  {
+    ASSERT_EQ(expected.polygons.size(), actual.polygons.size());
+    for (unsigned i = 0; i < expected.polygons.size(); ++i)
+      {
+        const art_msgs::ArtQuadrilateral &e = expected.polygons[i];
+        const art_msgs::ArtQuadrilateral &a = actual.polygons[i];
+        ASSERT_EQ(e.poly.points.size(), a.poly.points.size());
+        for (unsigned j = 0; j < e.poly.points.size(); ++j)
+          {
+            EXPECT_EQ(e.poly.points[j].x, a.poly.points[j].x) << i;
+            EXPECT_EQ(e.poly.points[j].y, a.poly.points[j].y) << i;
+          }
+      }
+  }
+
+  struct Cycle
+  {
+    float x, y, yaw;
+    std::vector<int> current;
+  };
+
+  Graph graph_;
+  std::vector<art_msgs::ArtQuadrilateral> original_;
+  std::vector<Cycle> cycles_;
+};
+
+TEST_F(LaneUpdates, deterministic)
+{
+  art_msgs::ArtLanes serial;
+  run(0, serial);
+
+  // the updates did move some polygons
+  unsigned moved = 0;
+  for (unsigned i = 0; i < original_.size(); ++i)
+    if (original_[i].midpoint.x != serial.polygons[i].midpoint.x
+        || original_[i].midpoint.y != serial.polygons[i].midpoint.y)
+      ++moved;
+  EXPECT_LT(100u, moved);
+
+  art_msgs::ArtLanes one;
+  run(1, one);
+  expect_identical(serial, one);
+
+  for (unsigned nthreads = 2; nthreads <= 8; nthreads *= 2)
+    {
+      art_msgs::ArtLanes several;
+      run(nthreads, several);
+      expect_identical(serial, several);
+    }
+}
+
+TEST_F(LaneUpdates, repeated_batches)
+{
+  // the same worker threads run every batch, and the results do not
+  // depend on what ran before
+  art_msgs::ArtLanes first, second;
+  run(4, first);
+  run(4, second);
+  expect_identical(first, second);
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
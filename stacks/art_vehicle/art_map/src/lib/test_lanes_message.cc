@@ -0,0 +1,153 @@
+/*
+ *  ART local road map message reuse unit test
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <gtest/gtest.h>
+#include <ros/package.h>
+
+#include "alloc_counter.h"
+#include <art/message_pool.h>
+#include <art_map/euclidean_distance.h>
+#include <art_map/MapLanes.h>
+
+// Refills local road map messages the way maplanes does every cycle,
+// driving along the lanes of a bundled RNDF.
+
+typedef ArtMsgPool::MessagePool<art_msgs::ArtLanes> LanesPool;
+
+const float RANGE = 80.0;               // maplanes default (m)
+const int N_POOL = 4;                   // maplanes default
+const int MAX_POLYGONS = 1000;          // maplanes default
+
+class LanesMessage: public testing::Test
+{
+protected:
+
+  virtual void SetUp()
+  {
+    std::string path =
+      ros::package::getPath("art_map") + "/rndf/prc_large.rndf";
+    RNDF rndf(path);
+    ASSERT_TRUE(rndf.is_valid);
+    rndf.populate_graph(graph_);
+    graph_.find_mapxy();
+    map_ = new MapLanes(RANGE);
+    ASSERT_EQ(0, map_->MapRNDF(&graph_, MIN_POLY_SIZE));
+
+    // the vehicle route: every way-point in turn, with one position
+    // per meter in between, like odometry at 20Hz and 20 m/s
+    for (unsigned i = 1; i < graph_.nodes_size; ++i)
+      {
+        MapXY from = graph_.nodes[i-1].map;
+        MapXY to = graph_.nodes[i].map;
+        int steps = (int) Euclidean::DistanceTo(from, to);
+        for (int s = 0; s < steps; ++s)
+          {
+            float f = s / (float) steps;
+            route_.push_back(MapXY(from.x + f * (to.x - from.x),
+                                   from.y + f * (to.y - from.y)));
+          }
+      }
+  }
+
+  virtual void TearDown()
+  {
+    delete map_;
+  }
+
+  Graph graph_;
+  MapLanes *map_;
+  std::vector<MapXY> route_;
+};
+
+TEST(MessagePool, reuse)
+{
+  LanesPool pool(2);
+  art_msgs::ArtLanes::Ptr a = pool.get();
+  art_msgs::ArtLanes::Ptr b = pool.get();
+  EXPECT_NE(a.get(), b.get());
+  EXPECT_EQ(0u, pool.misses());
+
+  // a subscriber still holds b, so a is reused
+  art_msgs::ArtLanes *a_ptr = a.get();
+  a.reset();
+  EXPECT_EQ(a_ptr, pool.get().get());
+  EXPECT_EQ(a_ptr, pool.get().get());
+  EXPECT_EQ(0u, pool.misses());
+
+  // all held: a new message, which takes the place of one of them
+  a = pool.get();
+  art_msgs::ArtLanes::Ptr c = pool.get();
+  EXPECT_NE(a.get(), c.get());
+  EXPECT_NE(b.get(), c.get());
+  EXPECT_EQ(1u, pool.misses());
+}
+
+TEST_F(LanesMessage, same_polygons)
+{
+  // a reused message holds exactly what a fresh one would
+  LanesPool pool(1);
+  for (unsigned i = 0; i < route_.size(); i += 25)
+    {
+      art_msgs::ArtLanes fresh;
+      map_->getLanes(&fresh, route_[i]);
+      art_msgs::ArtLanes::Ptr reused = pool.get();
+      map_->getLanes(reused.get(), route_[i]);
+      ASSERT_EQ(fresh.polygons.size(), reused->polygons.size());
+      for (unsigned j = 0; j < fresh.polygons.size(); ++j)
+        {
+          EXPECT_EQ(fresh.polygons[j].poly_id, reused->polygons[j].poly_id);
+          ASSERT_EQ(4u, reused->polygons[j].poly.points.size());
+          EXPECT_EQ(fresh.polygons[j].poly.points[2].x,
+                    reused->polygons[j].poly.points[2].x);
+        }
+    }
+}
+
+TEST_F(LanesMessage, allocations)
+{
+  unsigned ncycles = route_.size();
+  ASSERT_LT(1000u, ncycles);
+
+  // a new message every cycle, as maplanes used to publish
+  ArtAlloc::Counter allocs;
+  for (unsigned i = 0; i < ncycles; ++i)
+    {
+      art_msgs::ArtLanes lane_data;
+      map_->getLanes(&lane_data, route_[i]);
+    }
+  double fresh_allocs = allocs.count() / (double) ncycles;
+
+  // pooled messages, with the last one still held by a subscriber
+  LanesPool pool(N_POOL);
+  for (unsigned i = 0; i < pool.size(); ++i)
+    pool[i].polygons.reserve(MAX_POLYGONS);
+  art_msgs::ArtLanes::Ptr held;
+  for (unsigned i = 0; i < ncycles; ++i)  // warm up
+    {
+      held = pool.get();
+      map_->getLanes(held.get(), route_[i]);
+    }
+  allocs.reset();
+  for (unsigned i = 0; i < ncycles; ++i)
+    {
+      held = pool.get();
+      map_->getLanes(held.get(), route_[i]);
+    }
+  double pooled_allocs = allocs.count() / (double) ncycles;
+
+  EXPECT_EQ(0u, pool.misses());
+  EXPECT_LT(pooled_allocs * 10.0, fresh_allocs);
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,199 @@
+/*
+ *  ART road map editing unit test
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <gtest/gtest.h>
+#include <ros/package.h>
+
+#include <art_map/MapEditor.h>
+
+// Each edit is rebuilt incrementally, then compared with the polygons
+// of a full MapRNDF() build from the same graph.
+
+class MapEditorTest: public testing::Test
+{
+protected:
+
+  virtual void SetUp()
+  {
+    path_ = ros::package::getPath("art_map") + "/rndf/prc_large.rndf";
+    ASSERT_TRUE(editor_.load(path_));
+  }
+
+  // expect the editor polygons to match a full build exactly
+  void expect_full_build(void)
+  {
+    art_msgs::ArtLanes edited;
+    editor_.lanes()->getAllLanes(&edited);
+
+    Graph graph(*editor_.graph());
+    MapLanes full;
+    ASSERT_EQ(0, full.MapRNDF(&graph, MIN_POLY_SIZE));
+    art_msgs::ArtLanes expected;
+    full.getAllLanes(&expected);
+
+    ASSERT_EQ(expected.polygons.size(), edited.polygons.size());
+    for (unsigned i = 0; i < expected.polygons.size(); ++i)
+      {
+        const art_msgs::ArtQuadrilateral &e = expected.polygons[i];
+        const art_msgs::ArtQuadrilateral &p = edited.polygons[i];
+        for (unsigned j = 0; j < e.poly.points.size(); ++j)
+          {
+            EXPECT_EQ(e.poly.points[j].x, p.poly.points[j].x);
+            EXPECT_EQ(e.poly.points[j].y, p.poly.points[j].y);
+          }
+        EXPECT_EQ(e.midpoint.x, p.midpoint.x);
+        EXPECT_EQ(e.midpoint.y, p.midpoint.y);
+        EXPECT_EQ(e.heading, p.heading);
+        EXPECT_EQ(e.length, p.length);
+        EXPECT_EQ(e.poly_id, p.poly_id);
+        EXPECT_EQ(e.is_stop, p.is_stop);
+        EXPECT_EQ(e.is_transition, p.is_transition);
+        EXPECT_EQ(e.contains_way, p.contains_way);
+        EXPECT_TRUE(ElementID(e.start_way) == ElementID(p.start_way));
+        EXPECT_TRUE(ElementID(e.end_way) == ElementID(p.end_way));
+      }
+  }
+
+  // rebuild, expecting only the units an edit changed to be remade
+  void rebuild(const char *edit, bool lanes_changed = true)
+  {
+    SCOPED_TRACE(edit);
+    ASSERT_TRUE(editor_.rebuild());
+    MapLanes *lanes = editor_.lanes();
+    if (lanes_changed)
+      EXPECT_LT(lanes->unitsReused(), lanes->unitsMade());
+    else
+      EXPECT_EQ(lanes->unitsReused(), lanes->unitsMade());
+  }
+
+  // a copy of lane 2.2, moved over by about five meters
+  Lane shifted_lane(lane_id_t lane_id)
+  {
+    Lane lane = editor_.rndf()->segments[1].lanes[1];
+    lane.lane_id = lane_id;
+    lane.checkpoints.clear();
+    lane.stops.clear();
+    lane.exits.clear();
+    for (unsigned i = 0; i < lane.waypoints.size(); ++i)
+      lane.waypoints[i].ll.latitude += 0.00005;
+    return lane;
+  }
+
+  std::string path_;
+  MapEditor editor_;
+};
+
+TEST_F(MapEditorTest, move_waypoint)
+{
+  const RNDF *rndf = editor_.rndf();
+  LatLong ll = rndf->segments[0].lanes[0].waypoints[2].ll;
+  ll.latitude += 0.00001;
+  EXPECT_TRUE(editor_.move_waypoint(ElementID(1, 1, 3), ll));
+  rebuild("move lane way-point");
+  expect_full_build();
+
+  // perimeter and parking spot way-points
+  ll = rndf->zones[0].perimeter.perimeterpoints[1].ll;
+  ll.longitude += 0.00001;
+  EXPECT_TRUE(editor_.move_waypoint(ElementID(7, 0, 2), ll));
+  ll = rndf->zones[0].spots[0].waypoints[0].ll;
+  ll.latitude += 0.00001;
+  EXPECT_TRUE(editor_.move_waypoint(ElementID(7, 1, 1), ll));
+  rebuild("move zone way-points");
+  expect_full_build();
+
+  EXPECT_FALSE(editor_.move_waypoint(ElementID(1, 1, 99), ll));
+}
+
+TEST_F(MapEditorTest, lane_width)
+{
+  EXPECT_TRUE(editor_.set_lane_width(3, 2, 16));
+  rebuild("set lane width");
+  expect_full_build();
+
+  // parking spots have no polygons
+  EXPECT_TRUE(editor_.set_spot_width(7, 2, 10));
+  rebuild("set spot width", false);
+  expect_full_build();
+  EXPECT_FALSE(editor_.set_lane_width(3, 5, 16));
+}
+
+TEST_F(MapEditorTest, add_remove_lane)
+{
+  EXPECT_TRUE(editor_.add_lane(2, shifted_lane(3)));
+  rebuild("add lane");
+  expect_full_build();
+  EXPECT_FALSE(editor_.add_lane(2, shifted_lane(3)));
+
+  EXPECT_TRUE(editor_.remove_lane(2, 3));
+  rebuild("remove lane");
+  expect_full_build();
+
+  // also removes exits into the lane
+  EXPECT_TRUE(editor_.remove_lane(1, 2));
+  rebuild("remove lane with entries");
+  expect_full_build();
+  EXPECT_FALSE(editor_.remove_lane(1, 1));
+}
+
+TEST_F(MapEditorTest, after_vision_updates)
+{
+  // move some polygon corners, as maplanes does with vision data
+  art_msgs::ArtLanes lanes;
+  editor_.lanes()->getAllLanes(&lanes);
+  for (unsigned i = 0; i < lanes.polygons.size(); i += 7)
+    {
+      polyUpdate update;
+      update.poly_id = i;
+      update.point_id = i % NUM_POINTS;
+      update.distance = 10.0;
+      update.bearing = 0.1;
+      update.confidence = 1.0;
+      const geometry_msgs::Point &pt = lanes.polygons[i].midpoint;
+      editor_.lanes()->UpdatePoly(update, pt.x - 10.0, pt.y, 0.0);
+    }
+  art_msgs::ArtLanes updated;
+  editor_.lanes()->getAllLanes(&updated);
+  unsigned moved = 0;
+  for (unsigned i = 0; i < lanes.polygons.size(); ++i)
+    if (lanes.polygons[i].midpoint.x != updated.polygons[i].midpoint.x)
+      ++moved;
+  EXPECT_LT(0u, moved);
+
+  // a rebuild starts over from the RNDF
+  EXPECT_TRUE(editor_.set_lane_width(4, 1, 14));
+  rebuild("set lane width after updates");
+  expect_full_build();
+}
+
+TEST_F(MapEditorTest, invalid_edit)
+{
+  unsigned nunits = editor_.lanes()->unitsMade();
+
+  // a lane exit to a way-point that does not exist
+  Lane lane = shifted_lane(3);
+  Exit exit = editor_.rndf()->segments[0].lanes[0].exits[0];
+  exit.end_point.waypoint_id = 99;
+  lane.exits.push_back(exit);
+  EXPECT_TRUE(editor_.add_lane(2, lane));
+  EXPECT_FALSE(editor_.rebuild());
+
+  // discarded, the map is still usable
+  EXPECT_FALSE(editor_.changed());
+  EXPECT_EQ(2, editor_.rndf()->segments[1].number_of_lanes);
+  EXPECT_EQ(nunits, editor_.lanes()->unitsMade());
+  expect_full_build();
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
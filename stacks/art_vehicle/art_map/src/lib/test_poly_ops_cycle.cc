@@ -0,0 +1,133 @@
+/*
+ *  ART lane polygon cycle heap allocation unit test
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <gtest/gtest.h>
+#include "alloc_counter.h"
+#include <art_map/PolyOps.h>
+
+// Runs the lane queries navigator Course makes every cycle, and
+// checks they do not allocate once the scratch vector has grown.
+
+const int N_WAYPTS = 12;                // way-points in the lane
+const int N_BETWEEN = 3;                // polygons between way-points
+const float POLY_LENGTH = 2.0;          // length of each polygon
+const float LANE_WIDTH = 4.0;
+
+// a straight east-bound lane: one polygon containing each way-point,
+// followed by N_BETWEEN polygons leading to the next one
+poly_list_t make_lane(void)
+{
+  poly_list_t lane;
+  for (int w = 1; w <= N_WAYPTS; ++w)
+    {
+      for (int i = 0; i <= N_BETWEEN; ++i)
+        {
+          if (i > 0 && w == N_WAYPTS)
+            break;
+          poly p;
+          float x = lane.size() * POLY_LENGTH;
+          p.p1 = MapXY(x, LANE_WIDTH/2);
+          p.p2 = MapXY(x + POLY_LENGTH, LANE_WIDTH/2);
+          p.p3 = MapXY(x + POLY_LENGTH, -LANE_WIDTH/2);
+          p.p4 = MapXY(x, -LANE_WIDTH/2);
+          p.midpoint = MapXY(x + POLY_LENGTH/2, 0.0);
+          p.heading = 0.0;
+          p.length = POLY_LENGTH;
+          p.poly_id = lane.size();
+          p.is_stop = false;
+          p.is_transition = false;
+          p.contains_way = (i == 0);
+          p.start_way = ElementID(1, 1, w);
+          p.end_way = ElementID(1, 1, (i == 0? w: w + 1));
+          p.left_boundary = DOUBLE_YELLOW;
+          p.right_boundary = SOLID_WHITE;
+          lane.push_back(p);
+        }
+    }
+  return lane;
+}
+
+// one cycle of the queries in Course::find_aim_polygon() and
+// Course::distance_in_plan(), returning the aim polygon index
+int lane_cycle(PolyOps &pops, const poly_list_t &lane,
+               poly_list_t &edge, const MapXY &pos, float &distance)
+{
+  int pt = 1 + (int) (pos.x / (POLY_LENGTH * (N_BETWEEN + 1)));
+  ElementID waypt0(1, 1, pt);
+  ElementID waypt1(1, 1, pt + 1);
+
+  edge.clear();
+  pops.add_polys_for_waypts(lane, edge, waypt0, waypt1);
+  int nearby_poly = pops.getClosestPoly(edge, pos);
+  if (nearby_poly < 0)
+    nearby_poly = pops.getClosestPoly(lane, pos);
+  else
+    nearby_poly = pops.getPolyIndex(lane, edge.at(nearby_poly));
+
+  distance = pops.distanceAlongLane(lane, pos, lane.back().midpoint);
+  return pops.index_of_downstream_poly(lane, nearby_poly, 5.0);
+}
+
+TEST(PolyOpsCycle, results)
+{
+  PolyOps pops;
+  poly_list_t lane = make_lane();
+  poly_list_t edge;
+  float distance;
+
+  // at the second way-point: the nearest polygon leading to the
+  // third is 5, the aim point 5m beyond its start lies in 7
+  MapXY pos(4 * POLY_LENGTH + 0.5, 0.0);
+  EXPECT_EQ(7, lane_cycle(pops, lane, edge, pos, distance));
+  EXPECT_EQ((unsigned) N_BETWEEN + 1, edge.size());
+  EXPECT_NEAR(lane.back().midpoint.x - pos.x, distance, POLY_LENGTH);
+}
+
+TEST(PolyOpsCycle, no_allocation)
+{
+  PolyOps pops;
+  poly_list_t lane = make_lane();
+  poly_list_t edge;
+  float distance;
+  float end_x = (lane.size() - 1) * POLY_LENGTH;
+
+  // warm up: the scratch vector grows to its largest size
+  for (float x = 0.0; x < end_x; x += 0.25)
+    lane_cycle(pops, lane, edge, MapXY(x, 0.1), distance);
+
+  ArtAlloc::Counter allocs;
+  int cycles = 0;
+  for (int pass = 0; pass < 20; ++pass)
+    for (float x = 0.0; x < end_x; x += 0.25, ++cycles)
+      lane_cycle(pops, lane, edge, MapXY(x, 0.1), distance);
+  EXPECT_EQ(0u, allocs.count()) << "in " << cycles << " cycles";
+}
+
+TEST(PolyOpsCycle, counter_works)
+{
+  // a local vector, as Course used to have, allocates every cycle
+  PolyOps pops;
+  poly_list_t lane = make_lane();
+  float distance;
+
+  ArtAlloc::Counter allocs;
+  for (int i = 0; i < 10; ++i)
+    {
+      poly_list_t edge;
+      lane_cycle(pops, lane, edge, MapXY(i * 0.5, 0.1), distance);
+    }
+  EXPECT_LE(10u, allocs.count());
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,86 @@
+/*
+ *  ART vehicle pose history unit test
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <gtest/gtest.h>
+#include <art_map/pose_history.h>
+
+// add samples moving straight east at 10 m/s, every 20 msec
+void fill_history(PoseHistory &hist, unsigned nsamples)
+{
+  for (unsigned i = 0; i < nsamples; ++i)
+    {
+      PoseHistory::Sample s;
+      s.stamp = ros::Time(100.0 + 0.02 * i);
+      s.pose = MapPose(0.2 * i, 0.0, 0.0);
+      s.speed = 10.0;
+      EXPECT_TRUE(hist.add(s));
+    }
+}
+
+TEST(PoseHistory, empty)
+{
+  PoseHistory hist;
+  MapPose pose;
+  EXPECT_TRUE(hist.empty());
+  EXPECT_FALSE(hist.lookup(ros::Time(100.0), pose));
+}
+
+TEST(PoseHistory, interpolate)
+{
+  PoseHistory hist;
+  fill_history(hist, 10);
+  MapPose pose;
+  EXPECT_TRUE(hist.lookup(ros::Time(100.05), pose));
+  EXPECT_NEAR(0.5, pose.map.x, 0.001);
+  EXPECT_NEAR(0.0, pose.map.y, 0.001);
+  EXPECT_TRUE(hist.lookup(ros::Time(100.0), pose));
+  EXPECT_NEAR(0.0, pose.map.x, 0.001);
+  EXPECT_FALSE(hist.lookup(ros::Time(99.99), pose));
+}
+
+TEST(PoseHistory, extrapolate)
+{
+  PoseHistory hist(ros::Duration(0.2));
+  fill_history(hist, 10);               // last sample at 100.18
+  MapPose pose;
+  EXPECT_TRUE(hist.lookup(ros::Time(100.28), pose));
+  EXPECT_NEAR(2.8, pose.map.x, 0.001);
+  EXPECT_FALSE(hist.lookup(ros::Time(100.5), pose));
+}
+
+TEST(PoseHistory, wrapAround)
+{
+  PoseHistory hist;
+  fill_history(hist, 3 * PoseHistory::N_SLOTS);
+  MapPose pose;
+
+  // oldest samples were overwritten
+  EXPECT_FALSE(hist.lookup(ros::Time(100.0), pose));
+
+  // recent ones are still there
+  unsigned last = 3 * PoseHistory::N_SLOTS - 1;
+  EXPECT_TRUE(hist.lookup(ros::Time(100.0 + 0.02 * last - 0.01), pose));
+  EXPECT_NEAR(0.2 * last - 0.1, pose.map.x, 0.01);
+}
+
+TEST(PoseHistory, outOfOrder)
+{
+  PoseHistory hist;
+  fill_history(hist, 2);
+  PoseHistory::Sample s;
+  s.stamp = ros::Time(100.0);
+  EXPECT_FALSE(hist.add(s));
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,171 @@
+/*
+ *  ART per-node transform cache unit test
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <gtest/gtest.h>
+#include <art_map/transform_cache.h>
+
+// The frames published on the vehicle: static /map to /odom and
+// /vehicle to /velodyne transforms, with /odom to /earth and /earth
+// to /vehicle from odometry.
+
+geometry_msgs::TransformStamped make_tf(const std::string &parent,
+                                        const std::string &child,
+                                        double stamp, double x, double y,
+                                        double yaw = 0.0)
+{
+  geometry_msgs::TransformStamped msg;
+  msg.header.stamp = ros::Time(stamp);
+  msg.header.frame_id = parent;
+  msg.child_frame_id = child;
+  msg.transform.translation.x = x;
+  msg.transform.translation.y = y;
+  msg.transform.translation.z = 0.0;
+  msg.transform.rotation = tf::createQuaternionMsgFromYaw(yaw);
+  return msg;
+}
+
+// static transforms, re-broadcast with post-dated time stamps
+void add_static(TransformCache &cache, double stamp)
+{
+  EXPECT_TRUE(cache.add(make_tf("/map", "/odom", stamp, 0.0, 0.0)));
+  EXPECT_TRUE(cache.add(make_tf("vehicle", "velodyne", stamp, 1.0, 0.0)));
+}
+
+// odometry moving straight east at 10 m/s, every 10 msec
+void add_odometry(TransformCache &cache, double start, unsigned nsamples)
+{
+  for (unsigned i = 0; i < nsamples; ++i)
+    {
+      double stamp = start + 0.01 * i;
+      double x = 10.0 * (stamp - 100.0);
+      EXPECT_TRUE(cache.add(make_tf("/earth", "/vehicle", stamp, x, 0.0)));
+      EXPECT_TRUE(cache.add(make_tf("/odom", "/earth", stamp, 0.0, 0.0)));
+    }
+}
+
+TEST(TransformCache, chain)
+{
+  TransformCache cache;
+  add_static(cache, 99.0);
+  add_static(cache, 99.2);
+  add_odometry(cache, 100.0, 50);
+
+  // a velodyne point in the map frame, between odometry samples
+  tf::StampedTransform transform;
+  ASSERT_TRUE(cache.lookup("/map", "velodyne", ros::Time(100.105),
+                           transform));
+  tf::Point pt = transform * tf::Point(2.0, 0.5, 0.0);
+  EXPECT_NEAR(4.05, pt.x(), 0.0001);
+  EXPECT_NEAR(0.5, pt.y(), 0.0001);
+
+  // and back again
+  ASSERT_TRUE(cache.lookup("velodyne", "map", ros::Time(100.105),
+                           transform));
+  pt = transform * pt;
+  EXPECT_NEAR(2.0, pt.x(), 0.0001);
+  EXPECT_NEAR(0.5, pt.y(), 0.0001);
+
+  // zero time stamp gets the latest
+  ASSERT_TRUE(cache.lookup("map", "vehicle", ros::Time(), transform));
+  EXPECT_NEAR(4.9, transform.getOrigin().x(), 0.0001);
+
+  EXPECT_TRUE(cache.canTransform("vehicle", "vehicle", ros::Time(100.0)));
+  EXPECT_FALSE(cache.canTransform("map", "camera", ros::Time(100.0)));
+  EXPECT_EQ(5u, cache.frames());
+}
+
+TEST(TransformCache, rotation)
+{
+  TransformCache cache;
+  EXPECT_TRUE(cache.add(make_tf("map", "vehicle", 10.0, 1.0, 0.0, 0.0)));
+  EXPECT_TRUE(cache.add(make_tf("map", "vehicle", 11.0, 1.0, 0.0, M_PI/2)));
+  tf::StampedTransform transform;
+  ASSERT_TRUE(cache.lookup("map", "vehicle", ros::Time(10.5), transform));
+  tf::Point pt = transform * tf::Point(1.0, 0.0, 0.0);
+  EXPECT_NEAR(1.0 + cos(M_PI/4), pt.x(), 0.0001);
+  EXPECT_NEAR(sin(M_PI/4), pt.y(), 0.0001);
+}
+
+TEST(TransformCache, window)
+{
+  TransformCache cache;
+  add_static(cache, 99.0);
+  add_static(cache, 99.2);
+  add_odometry(cache, 100.0, 3 * TransformCache::N_SLOTS);
+  double last = 100.0 + 0.01 * (3 * TransformCache::N_SLOTS - 1);
+  double first = 100.0 + 0.01 * (2 * TransformCache::N_SLOTS);
+  add_static(cache, last);
+
+  // dynamic transforms are neither extrapolated nor kept too long
+  EXPECT_TRUE(cache.canTransform("map", "velodyne", ros::Time(last)));
+  EXPECT_FALSE(cache.canTransform("map", "velodyne",
+                                  ros::Time(last + 0.001)));
+  EXPECT_TRUE(cache.canTransform("map", "velodyne", ros::Time(first)));
+  EXPECT_FALSE(cache.canTransform("map", "velodyne",
+                                  ros::Time(first - 0.001)));
+
+  // static transforms are good for a while after the newest
+  EXPECT_TRUE(cache.canTransform("odom", "map", ros::Time(last + 0.9)));
+  EXPECT_TRUE(cache.canTransform("velodyne", "vehicle",
+                                 ros::Time(last + 0.9)));
+  EXPECT_FALSE(cache.canTransform("odom", "map", ros::Time(last + 1.1)));
+  EXPECT_FALSE(cache.canTransform("velodyne", "vehicle",
+                                  ros::Time(last + 1.1)));
+
+  // out of order
+  EXPECT_FALSE(cache.add(make_tf("earth", "vehicle", first, 0.0, 0.0)));
+}
+
+TEST(TransformCache, stopped)
+{
+  TransformCache cache;
+  EXPECT_TRUE(cache.add(make_tf("odom", "vehicle", 10.0, 0.0, 0.0)));
+  EXPECT_TRUE(cache.add(make_tf("odom", "vehicle", 11.0, 5.0, 0.0)));
+  EXPECT_TRUE(cache.add(make_tf("odom", "vehicle", 12.0, 5.0, 0.0)));
+
+  // unchanged while stopped, but its history is still there
+  tf::StampedTransform transform;
+  ASSERT_TRUE(cache.lookup("odom", "vehicle", ros::Time(10.5), transform));
+  EXPECT_NEAR(2.5, transform.getOrigin().x(), 0.0001);
+  ASSERT_TRUE(cache.lookup("odom", "vehicle", ros::Time(12.5), transform));
+  EXPECT_NEAR(5.0, transform.getOrigin().x(), 0.0001);
+
+  // odometry gone quiet is not trusted forever
+  EXPECT_FALSE(cache.canTransform("odom", "vehicle", ros::Time(20.0)));
+
+  // moving again
+  EXPECT_TRUE(cache.add(make_tf("odom", "vehicle", 13.0, 6.0, 0.0)));
+  EXPECT_FALSE(cache.canTransform("odom", "vehicle", ros::Time(13.5)));
+  ASSERT_TRUE(cache.lookup("odom", "vehicle", ros::Time(12.5), transform));
+  EXPECT_NEAR(5.5, transform.getOrigin().x(), 0.0001);
+
+  // new parent starts over
+  EXPECT_TRUE(cache.add(make_tf("map", "vehicle", 5.0, 1.0, 0.0)));
+  EXPECT_FALSE(cache.canTransform("odom", "vehicle", ros::Time(12.5)));
+  EXPECT_TRUE(cache.canTransform("map", "vehicle", ros::Time(5.0)));
+}
+
+TEST(TransformCache, max_static_age)
+{
+  TransformCache cache(5.0);
+  EXPECT_TRUE(cache.add(make_tf("odom", "vehicle", 10.0, 5.0, 0.0)));
+  EXPECT_TRUE(cache.add(make_tf("odom", "vehicle", 11.0, 5.0, 0.0)));
+  EXPECT_TRUE(cache.canTransform("odom", "vehicle", ros::Time(15.9)));
+  EXPECT_FALSE(cache.canTransform("odom", "vehicle", ros::Time(16.1)));
+
+  // the latest is always available
+  EXPECT_TRUE(cache.canTransform("odom", "vehicle", ros::Time()));
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
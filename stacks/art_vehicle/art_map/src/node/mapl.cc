@@ -13,15 +13,20 @@
 #include <string.h>
 #include <iostream>
 
+#include <boost/thread.hpp>
+
 #include <ros/ros.h>
 #include <tf/tf.h>
 
+#include <art/message_pool.h>
+#include <art/rates.h>
 #include <art_msgs/ArtHertz.h>
 #include <sensor_msgs/PointCloud.h>
 #include <nav_msgs/Odometry.h>
 #include <visualization_msgs/MarkerArray.h>
 
 #include <art_msgs/ArtLanes.h>
+#include <art_msgs/MapReload.h>
 #include <art_map/Graph.h>
 #include <art_map/MapLanes.h>
 #include <art_map/RNDF.h>
@@ -35,6 +40,9 @@
 Subscribes:
 
 - @b odom [nav_msgs::Odometry] estimate of robot position and velocity.
+- @b map_reload [art_msgs::MapReload] replace the road map: the new
+     RNDF is processed in a background thread, then the driver
+     switches to it between cycles and republishes the global map.
 
 Publishes:
 
@@ -43,9 +51,18 @@ Publishes:
 - @b visualization_marker_array [visualization_msgs::MarkerArray]
      markers for map visualization
 
-@todo Provide centralized interface to allow map updates during
-      operation.  Could be done in maplanes or in a separate node that
-      reads the RNDF and publishes the graph.
+Parameters:
+
+- @b ~range [double] radius of local lanes to report (m, default 80)
+- @b ~poly_size [double] maximum polygon size (m, default 2.5)
+- @b ~pool_size [int] local road map messages to reuse (default 4)
+- @b ~max_polygons [int] local road map polygons to preallocate
+     space for in each message (default 1000)
+- @b ~self_updates [bool] every cycle, update the filters of the
+     polygons ahead in the current lane with their own positions as
+     seen from the odometry pose (default false)
+- @b ~update_threads [int] threads for the ~self_updates, which run
+     in parallel across lanes (default 0: one per processor)
 
 @author Jack O'Quin, Patrick Beeson
 
@@ -60,6 +77,9 @@ public:
   MapLanesDriver();
   ~MapLanesDriver()
     {
+      reload_thread_.join();            // wait for any map build
+      delete pending_map_;
+      delete pending_graph_;
       delete map_;
       if (graph_)
         delete graph_;
@@ -72,8 +92,24 @@ public:
 
 private:
 
+  /** states of a road map reload */
+  typedef enum
+    {
+      Idle,                             ///< no reload requested
+      Building,                         ///< background thread running
+      Ready,                            ///< new map waiting to switch
+      Failed                            ///< new map could not be built
+    } reload_state_t;
+
+  bool loadRoadMap(const std::string &rndf_name,
+                   Graph *&graph, MapLanes *&map);
   void markCar();
+  visualization_msgs::Marker &nextMark(unsigned n);
   void processOdom(const nav_msgs::Odometry::ConstPtr &odomIn);
+  void processReload(const art_msgs::MapReload::ConstPtr &reloadIn);
+  void reloadRoadMap(std::string rndf_name);
+  void selfUpdate(void);
+  void switchRoadMap(void);
   void publishGlobalMap(void);
   void publishLocalMap(void);
   void publishMapCloud(ros::Publisher &pub,
@@ -88,10 +124,20 @@ private:
   double poly_size_;            ///< maximum polygon size (m)
   std::string rndf_name_;       ///< Road Network Definition File name
   std::string frame_id_;        ///< frame ID of map (default "/map")
+  double hertz_;                ///< driver cycle rate (Hz)
+  int pool_size_;               ///< local map messages to reuse
+  int max_polygons_;            ///< local map polygons to preallocate
+  bool self_updates_;           ///< update filters from odometry
+  int update_threads_;          ///< filter update threads (0: all CPUs)
 
   // topics and messages
   ros::Subscriber odom_topic_;       // odometry topic
   nav_msgs::Odometry odom_msg_;      // last Odometry message received
+  ros::Subscriber reload_topic_;     // map reload requests
+
+  // self-observation update batch, reused every cycle
+  std::vector<int> update_ids_;
+  art_msgs::ArtLanes vision_lanes_;
 
   ros::Publisher roadmap_global_;       // global road map publisher
   ros::Publisher roadmap_local_;        // local road map publisher
@@ -100,6 +146,10 @@ private:
 
   ros::Publisher roadmap_cloud_;        // local road map point cloud
 
+  // local road map messages, reused once subscribers are done with
+  // them, so their polygon vectors are not reallocated every cycle
+  ArtMsgPool::MessagePool<art_msgs::ArtLanes> local_pool_;
+
   // this vector is only used while publishMapMarks() is running
   // we define it here to avoid memory allocation on every cycle
   sensor_msgs::PointCloud cloud_msg_;
@@ -111,6 +161,15 @@ private:
   Graph *graph_;                  ///< graph object (used by MapLanes)
   MapLanes* map_;                 ///< MapLanes object instance
   bool initial_position_;         ///< true if initial odometry received
+
+  // road map reload, built by reload_thread_ (protected by reload_lock_)
+  boost::thread reload_thread_;
+  boost::mutex reload_lock_;
+  reload_state_t reload_state_;
+  std::string pending_rndf_;      ///< RNDF being loaded
+  Graph *pending_graph_;          ///< new graph, when Ready
+  MapLanes *pending_map_;         ///< new MapLanes, when Ready
+  ros::WallTime reload_start_;    ///< when reload was requested
 };
 
 /** constructor */
@@ -133,6 +192,19 @@ MapLanesDriver::MapLanesDriver(void)
   nh.param("poly_size", poly_size_, MIN_POLY_SIZE);
   ROS_INFO("polygon size = %.0f meters", poly_size_);
 
+  hertz_ = ArtRates::getHertz(nh, art_msgs::ArtHertz::MAPLANES);
+
+  nh.param("pool_size", pool_size_, 4);
+  nh.param("max_polygons", max_polygons_, 1000);
+  local_pool_.resize(pool_size_);
+  for (unsigned i = 0; i < local_pool_.size(); ++i)
+    local_pool_[i].polygons.reserve(max_polygons_);
+
+  nh.param("self_updates", self_updates_, false);
+  nh.param("update_threads", update_threads_, 0);
+  if (update_threads_ < 0)
+    update_threads_ = 0;
+
   rndf_name_ = "";
   std::string rndf_param;
   if (nh.searchParam("rndf", rndf_param))
@@ -147,7 +219,12 @@ MapLanesDriver::MapLanesDriver(void)
 
   // create the MapLanes class
   map_ = new MapLanes(range_);
+  map_->SetUpdateThreads(update_threads_);
   graph_ = NULL;
+
+  reload_state_ = Idle;
+  pending_graph_ = NULL;
+  pending_map_ = NULL;
 }
 
 /** @brief create marker for car pose.
@@ -203,6 +280,8 @@ int MapLanesDriver::Setup(ros::NodeHandle node)
 
   odom_topic_ = node.subscribe("odom", qDepth, &MapLanesDriver::processOdom,
                                this, noDelay);
+  reload_topic_ = node.subscribe("map_reload", qDepth,
+                                 &MapLanesDriver::processReload, this);
 
   // Local road map publisher
   roadmap_local_ =
@@ -248,6 +327,115 @@ void MapLanesDriver::processOdom(const nav_msgs::Odometry::ConstPtr &odomIn)
     }
 }
 
+/** Update the filters of polygons ahead with their own positions
+ *
+ *  All polygons ahead in the current lane are one batch.
+ */
+void MapLanesDriver::selfUpdate(void)
+{
+  MapPose pose(odom_msg_.pose.pose);
+  map_->SetRobotPos(pose);
+  map_->getVisionLanes(&vision_lanes_, pose.map.x, pose.map.y, pose.yaw);
+  update_ids_.resize(vision_lanes_.polygons.size());
+  for (unsigned i = 0; i < update_ids_.size(); ++i)
+    update_ids_[i] = vision_lanes_.polygons[i].poly_id;
+  map_->UpdateWithCurrent(update_ids_);
+}
+
+/** Handle road map reload request */
+void
+MapLanesDriver::processReload(const art_msgs::MapReload::ConstPtr &reloadIn)
+{
+  boost::mutex::scoped_lock lock(reload_lock_);
+  if (reload_state_ != Idle)
+    {
+      ROS_WARN("road map reload already in progress, request ignored");
+      return;
+    }
+
+  std::string rndf_name = reloadIn->rndf;
+  if (rndf_name == "")
+    rndf_name = rndf_name_;
+  ROS_INFO_STREAM("reloading road map from RNDF: " << rndf_name);
+
+  // the previous thread (if any) has finished, start a new one
+  reload_thread_.join();
+  reload_state_ = Building;
+  reload_start_ = ros::WallTime::now();
+  reload_thread_ = boost::thread(&MapLanesDriver::reloadRoadMap,
+                                 this, rndf_name);
+}
+
+/** Build a new road map (runs in reload_thread_)
+ *
+ *  Only touches its own Graph and MapLanes objects, handing them to
+ *  the driver thread when complete.
+ */
+void MapLanesDriver::reloadRoadMap(std::string rndf_name)
+{
+  Graph *graph = NULL;
+  MapLanes *map = NULL;
+  bool ok = loadRoadMap(rndf_name, graph, map);
+
+  boost::mutex::scoped_lock lock(reload_lock_);
+  if (ok)
+    {
+      pending_rndf_ = rndf_name;
+      pending_graph_ = graph;
+      pending_map_ = map;
+      reload_state_ = Ready;
+    }
+  else
+    {
+      reload_state_ = Failed;
+    }
+}
+
+/** Switch to a newly built road map, if one is ready.
+ *
+ *  Called by the driver thread between cycles, so the local map is
+ *  never published from a mix of the old and new maps.
+ */
+void MapLanesDriver::switchRoadMap(void)
+{
+  Graph *old_graph;
+  MapLanes *old_map;
+  ros::WallTime requested;
+  {
+    boost::mutex::scoped_lock lock(reload_lock_);
+    if (reload_state_ == Failed)
+      {
+        ROS_ERROR("road map reload failed, still using RNDF: %s",
+                  rndf_name_.c_str());
+        reload_state_ = Idle;
+        return;
+      }
+    if (reload_state_ != Ready)
+      return;
+
+    old_graph = graph_;
+    old_map = map_;
+    graph_ = pending_graph_;
+    map_ = pending_map_;
+    rndf_name_ = pending_rndf_;
+    pending_graph_ = NULL;
+    pending_map_ = NULL;
+    requested = reload_start_;
+    reload_state_ = Idle;
+  }
+
+  ros::WallTime start = ros::WallTime::now();
+  publishGlobalMap();
+  ros::WallTime done = ros::WallTime::now();
+  ROS_INFO("switched to new road map %.3fs after request, "
+           "switch took %.3fms", (done - requested).toSec(),
+           (done - start).toSec() * 1000.0);
+
+  // the old map is no longer referenced
+  delete old_map;
+  delete old_graph;
+}
+
 /** @brief Publish map point cloud
  *
  *  Converts polygon data into point cloud for clearing the occupancy
@@ -288,6 +476,21 @@ void MapLanesDriver::publishMapCloud(ros::Publisher &pub,
   pub.publish(cloud_msg_);
 }
 
+/** @brief Get a marker to fill in, reusing one from a previous cycle.
+ *
+ *  Reused markers keep the storage of their strings and point
+ *  vectors, but every field must be set again.
+ *
+ *  @param n index of the marker in marks_msg_
+ *  @return reference to that marker
+ */
+visualization_msgs::Marker &MapLanesDriver::nextMark(unsigned n)
+{
+  if (n == marks_msg_.markers.size())
+    marks_msg_.markers.resize(n + 1);
+  return marks_msg_.markers[n];
+}
+
 /** @brief Publish map visualization markers
  *
  *  Converts polygon data into an array of rviz visualization
@@ -315,10 +518,12 @@ void MapLanesDriver::publishMapMarks(ros::Publisher &pub,
   green.b = 0.0;
   green.a = 1.0;
   ros::Time now = ros::Time::now();
+  const std::string lanes_ns("lanes_" + map_name);
+  const std::string waypoints_ns("waypoints_" + map_name);
 
-  // clear message array, this is a class variable to avoid memory
+  // refill message array, this is a class variable to avoid memory
   // allocation and deallocation on every cycle
-  marks_msg_.markers.clear();
+  unsigned nmarks = 0;
 
   for (uint32_t i = 0; i < lane_data.polygons.size(); ++i)
     {
@@ -348,7 +553,7 @@ void MapLanesDriver::publishMapMarks(ros::Publisher &pub,
 #endif
       if (!lane_data.polygons[i].is_transition)
         {
-          visualization_msgs::Marker lane;
+          visualization_msgs::Marker &lane = nextMark(nmarks++);
           lane.header.stamp = now;
           lane.header.frame_id = frame_id_;
 
@@ -359,43 +564,44 @@ void MapLanesDriver::publishMapMarks(ros::Publisher &pub,
           // lane as two strips, then publish them as separate
           // LINE_STRIP markers. This LINE_LIST version is an
           // experiment to see how it looks (pretty good).
-          lane.ns = "lanes_" + map_name ;
+          lane.ns = lanes_ns;
           lane.id = (int32_t) i;
           lane.type = visualization_msgs::Marker::LINE_LIST;
           lane.action = visualization_msgs::Marker::ADD;
+          lane.pose = geometry_msgs::Pose();
 
           // define lane boundary points: first left (0, 1), then right (2, 3)
-          for (uint32_t j = 0;
-               j < lane_data.polygons[i].poly.points.size(); ++j)
+          uint32_t npoints = lane_data.polygons[i].poly.points.size();
+          lane.points.resize(npoints);
+          for (uint32_t j = 0; j < npoints; ++j)
             {
               // convert Point32 message to Point (there should be a
               // better way)
-              geometry_msgs::Point p;
+              geometry_msgs::Point &p = lane.points[j];
               p.x = lane_data.polygons[i].poly.points[j].x;
               p.y = lane_data.polygons[i].poly.points[j].y;
               p.z = lane_data.polygons[i].poly.points[j].z;
-              lane.points.push_back(p);
             }
 
           lane.scale.x = 0.1;               // 10cm lane boundaries
+          lane.scale.y = 0.0;
+          lane.scale.z = 0.0;
           lane.color = green;
           lane.lifetime = life;
-
-          // Add these boundaries to the vector of markers to publish
-          marks_msg_.markers.push_back(lane);
         }
 
       if (lane_data.polygons[i].contains_way)
         {
-          visualization_msgs::Marker wp;
+          visualization_msgs::Marker &wp = nextMark(nmarks++);
           wp.header.stamp = now;
           wp.header.frame_id = frame_id_;
 
           // publish way-points
-          wp.ns = "waypoints_" + map_name;
+          wp.ns = waypoints_ns;
           wp.id = (int32_t) i;
           wp.type = visualization_msgs::Marker::CYLINDER;
           wp.action = visualization_msgs::Marker::ADD;
+          wp.points.clear();
 
           wp.pose.position = lane_data.polygons[i].midpoint;
           wp.pose.orientation = 
@@ -421,11 +627,9 @@ void MapLanesDriver::publishMapMarks(ros::Publisher &pub,
               wp.color.g = 1.0;
               wp.color.b = 0.0;
             }
-
-          // Add this way-point to the vector of markers to publish
-          marks_msg_.markers.push_back(wp);
         }
     }
+  marks_msg_.markers.resize(nmarks);
 
   pub.publish(marks_msg_);
 }
@@ -456,7 +660,14 @@ void MapLanesDriver::publishGlobalMap(void)
 /** Publish current local road map */
 void MapLanesDriver::publishLocalMap(void)
 {
-  art_msgs::ArtLanes lane_data;
+  // refill a message subscribers are no longer using
+  unsigned long misses = local_pool_.misses();
+  art_msgs::ArtLanes::Ptr msg = local_pool_.get();
+  if (local_pool_.misses() != misses)
+    ROS_WARN_THROTTLE(60, "local road map messages all in use, "
+                      "~pool_size %d may be too small", pool_size_);
+
+  art_msgs::ArtLanes &lane_data = *msg;
   if (0 != map_->getLanes(&lane_data, MapXY(odom_msg_.pose.pose.position)))
     {
       ROS_DEBUG("no map data available to publish");
@@ -470,11 +681,12 @@ void MapLanesDriver::publishLocalMap(void)
 
   ROS_DEBUG_STREAM("publishing " <<  lane_data.polygons.size()
                    <<" local roadmap polygons");
-  roadmap_local_.publish(lane_data);
+  roadmap_local_.publish(msg);
 
-  // publish local map with temporary duration
+  // publish local map with temporary duration (two cycles, so the
+  // markers do not flicker when a cycle runs late)
   publishMapMarks(mapmarks_, "local_roadmap",
-                  ros::Duration(art_msgs::ArtHertz::MAPLANES), lane_data);
+                  ros::Duration(2.0 / hertz_), lane_data);
 
   // publish local map with temporary duration
   publishMapCloud(roadmap_cloud_, lane_data);
@@ -485,15 +697,19 @@ void MapLanesDriver::Spin()
 {
   publishGlobalMap();                   // publish global map once at start
 
-  ros::Rate cycle(art_msgs::ArtHertz::MAPLANES); // set driver cycle rate
+  ros::Rate cycle(hertz_);              // set driver cycle rate
 
   // Loop publishing MapLanes state until driver Shutdown().
   while(ros::ok())
     {
       ros::spinOnce();                  // handle incoming messages
+      switchRoadMap();                  // use new road map, if ready
 
       if (initial_position_)
         {
+          if (self_updates_)
+            selfUpdate();
+
           // Publish local roadmap
           publishLocalMap();
         }
@@ -514,11 +730,35 @@ bool MapLanesDriver::buildRoadMap(void)
       return false;
     }
 
-  RNDF *rndf = new RNDF(rndf_name_);
+  delete map_;
+  map_ = NULL;
+  if (!loadRoadMap(rndf_name_, graph_, map_))
+    {
+      ROS_FATAL_STREAM("cannot build road map from RNDF: " << rndf_name_);
+      return false;
+    }
+
+  return true;
+}
+
+/** Load an RNDF and build its road map.
+ *
+ *  Safe to run in a background thread, it uses no class variables
+ *  except parameters.
+ *
+ *  @param rndf_name Road Network Definition File name
+ *  @param graph [out] new way-point graph, if successful
+ *  @param map [out] new MapLanes object, if successful
+ *  @return true if successful
+ */  
+bool MapLanesDriver::loadRoadMap(const std::string &rndf_name,
+                                 Graph *&graph, MapLanes *&map)
+{
+  RNDF *rndf = new RNDF(rndf_name);
   
   if (!rndf->is_valid)
     {
-      ROS_FATAL("RNDF not valid");
+      ROS_ERROR("RNDF not valid");
       delete rndf;
       return false;;
     }
@@ -526,22 +766,28 @@ bool MapLanesDriver::buildRoadMap(void)
   // Allocate a way-point graph.  Populate with nodes from the RNDF,
   // then fill in the MapXY coordinates relative to a UTM grid based
   // on the first way-point in the graph.
-  graph_ = new Graph();
-  rndf->populate_graph(*graph_);
-  graph_->find_mapxy();
+  Graph *new_graph = new Graph();
+  rndf->populate_graph(*new_graph);
+  new_graph->find_mapxy();
 
   // MapRNDF() saves a pointer to the Graph object, so we can't delete it here.
-  // That is why graph_ is a class variable, deleted in the deconstructor.
+  // That is why the graph is returned, deleted with its MapLanes object.
   // TODO: fix this absurd interface
-  int rc = map_->MapRNDF(graph_, poly_size_);
+  MapLanes *new_map = new MapLanes(range_);
+  new_map->SetUpdateThreads(update_threads_);
+  int rc = new_map->MapRNDF(new_graph, poly_size_);
   delete rndf;
 
   if (rc != 0)
     {
-      ROS_FATAL("cannot process RNDF! (%s)", strerror(rc));
+      ROS_ERROR("cannot process RNDF! (%s)", strerror(rc));
+      delete new_map;
+      delete new_graph;
       return false;
     }
 
+  graph = new_graph;
+  map = new_map;
   return true;
 }
 
@@ -20,11 +20,69 @@
 #include <iostream>
 
 namespace GraphSearch {
+
+  /** @brief Expected traversal times of road map graph edges.
+   *
+   *  Built once for each road map and mission, after the MDF speed
+   *  limits have been applied to the graph.  Edge times account for
+   *  the speed limit, stop lines, the slow-down for turns, lane
+   *  changes, U-turns and zones.  Edges added to the graph later (by
+   *  blockages) are timed with the same model when first searched.
+   */
+  class RouteCost
+  {
+  public:
+
+    RouteCost(const Graph& graph, float speedlimit);
+
+    /** @brief recompute all edge times for the current graph */
+    void update(const Graph& graph);
+
+    /** @brief expected time to traverse an edge (seconds) */
+    double edge_time(const Graph& graph, const WayPointEdge& edge) const;
+
+    /** @brief lower bound on the time between two nodes (seconds) */
+    double min_time(const WayPointNode& start,
+		    const WayPointNode& end) const;
+
+    // model parameters, defaults match the navigator configuration
+    float accel;			//< normal acceleration (m/s^2)
+    float decel;			//< stopping deceleration (m/s^2)
+    float lateral_accel;		//< comfortable turn (m/s^2)
+    float min_turn_speed;		//< slowest speed for turns (m/s)
+    float stop_wait;			//< time stopped at a stop line (s)
+    float lane_change_time;		//< extra time to change lanes (s)
+    float uturn_time;			//< time for a U-turn maneuver (s)
+    float zone_time;			//< extra time entering a zone (s)
+
+  private:
+
+    typedef std::pair<waypt_index_t,waypt_index_t> EdgeKey;
+
+    double compute_time(const Graph& graph,
+			const WayPointEdge& edge) const;
+
+    float speedlimit_;			//< commander speed limit
+    float max_speed_;			//< fastest speed on any edge
+    std::vector<float> heading_in_;	//< lane heading arriving at node
+    std::vector<float> heading_out_;	//< lane heading leaving node
+    std::map<EdgeKey,float> times_;	//< edge times, by end nodes
+  };
+
   WayPointEdgeList astar_search(const Graph& graph,
 				waypt_index_t start_id,
 				waypt_index_t goal_id, 
 				float speedlimit=1.0);
 
+  WayPointEdgeList astar_search(const Graph& graph,
+				waypt_index_t start_id,
+				waypt_index_t goal_id,
+				const RouteCost& route_cost);
+
+  /** @brief expected time to follow a list of edges (seconds) */
+  double route_time(const Graph& graph, const RouteCost& route_cost,
+		    const WayPointEdgeList& edges);
+
   WayPointNodeList edge_list_to_node_list(const Graph& graph,
 					  WayPointEdgeList& edges);
 };
@@ -45,6 +45,9 @@ class Mission{
   //Returns whether the MDF was valid match to the graph
   bool populate_elementid(const Graph& graph);
 
+  // Continue the progress of another mission on a new graph
+  bool resume(const Mission& that, const Graph& graph);
+
   // Hooks to save, reload Mission state
   void save(const char* fName);
   bool load(const char* fName, const Graph& graph);
@@ -0,0 +1,115 @@
+/* -*- mode: C++ -*-
+ *
+ *  Checkpoint file for warm restarts
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#ifndef _CHECKPOINT_FILE_H_
+#define _CHECKPOINT_FILE_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <ros/serialization.h>
+
+/**  @file
+
+     @brief Checkpoint file for warm restarts.
+
+     Saves a serialized ROS message every cycle, so a restarted node
+     can resume where it left off.  The file has two fixed slots,
+     written alternately.  Each slot carries a sequence number and a
+     CRC, so a write interrupted part way never destroys the previous
+     checkpoint.
+
+     Writes go to the operating system's file cache without syncing:
+     they survive the process dying, which is the point, and cost one
+     system call per cycle.
+ */
+
+class CheckpointFile
+{
+public:
+
+  /** largest message that fits in a slot */
+  static const uint32_t MAX_DATA = 8192;
+
+  /** space reserved before the data in the slot buffer */
+  static const uint32_t HEADER_SIZE = 16;
+
+  CheckpointFile():
+    fd_(-1),
+    seq_(0)
+  {}
+
+  ~CheckpointFile()
+  {
+    close();
+  }
+
+  static std::string home_path(const std::string &name);
+
+  bool open(const std::string &path);
+  void close(void);
+
+  /** @return true if file is open */
+  bool is_open(void) const
+  {
+    return fd_ >= 0;
+  }
+
+  bool read(std::vector<uint8_t> &data) const;
+
+  /** @brief save a message as the latest checkpoint
+   *
+   *  Reuses the same buffer every time, so this does not allocate
+   *  memory once messages stop growing.
+   *
+   *  @return true if successful
+   */
+  template <class M> bool save(const M &msg)
+  {
+    uint32_t size = ros::serialization::serializationLength(msg);
+    if (size > MAX_DATA)
+      return false;
+    buffer_.resize(HEADER_SIZE + size);
+    ros::serialization::OStream stream(&buffer_[HEADER_SIZE], size);
+    ros::serialization::serialize(stream, msg);
+    return write(size);
+  }
+
+  /** @brief load the latest checkpoint message
+   *
+   *  @return true if successful
+   */
+  template <class M> bool load(M &msg) const
+  {
+    std::vector<uint8_t> data;
+    if (!read(data) || data.empty())
+      return false;
+    try
+      {
+        ros::serialization::IStream stream(&data[0], data.size());
+        ros::serialization::deserialize(stream, msg);
+      }
+    catch (ros::serialization::StreamOverrunException &e)
+      {
+        return false;                   // saved by some other version
+      }
+    return true;
+  }
+
+private:
+
+  bool write(uint32_t size);
+
+  int fd_;                              ///< file descriptor, or -1
+  uint32_t seq_;                        ///< sequence of latest slot
+  std::vector<uint8_t> buffer_;         ///< slot header, then data
+};
+
+#endif // _CHECKPOINT_FILE_H_
@@ -12,6 +12,7 @@
 #define _ESTIMATE_H_
 
 #include <nav_msgs/Odometry.h>
+#include <art_map/pose_history.h>
 
 /** @file
  *
@@ -23,6 +24,11 @@ namespace Estimate
                     ros::Time est_time,
                     nav_msgs::Odometry &est);
 
+  bool control_pose(const PoseHistory &history,
+                    const nav_msgs::Odometry &odom,
+                    ros::Time est_time,
+                    nav_msgs::Odometry &est);
+
   void front_bumper_pose(const nav_msgs::Odometry &odom,
                          nav_msgs::Odometry &est);
 
@@ -0,0 +1,161 @@
+/* -*- mode: C++ -*-
+ *
+ *  In-lane lateral offset planner interface
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#ifndef _LATERAL_OFFSET_H_
+#define _LATERAL_OFFSET_H_
+
+#include <vector>
+#include <art_map/PolyOps.h>
+
+/** @file
+ *
+ *  @brief In-lane lateral offset planner for obstacle avoidance.
+ */
+
+/** @brief In-lane lateral offset planner for obstacle avoidance.
+ *
+ *  Plans steer a constant offset from the center of the lane polygons
+ *  ahead, positive to the left.  Each plan ramps linearly from the
+ *  vehicle's current offset to a target offset, changing by at most
+ *  slope meters per meter travelled, then holds it.
+ *
+ *  Obstacle points are projected into path coordinates once per
+ *  cycle: distance ahead of the vehicle, and signed distance from
+ *  the lane center.  Each candidate target is checked against every
+ *  obstacle the vehicle body would pass, so a plan costs a few
+ *  microseconds per obstacle point, well within one navigator cycle.
+ *
+ *  Usage, once per cycle:
+ *
+ *  @code
+ *    if (planner.start(course->plan, position))
+ *      {
+ *        for (each obstacle point)
+ *          planner.add_obstacle(point);
+ *        if (planner.plan())
+ *          steer for planner.offset(lookahead);
+ *      }
+ *  @endcode
+ */
+class LateralOffset
+{
+public:
+
+  LateralOffset();
+
+  /** @brief set planning limits
+   *
+   *  @param clearance lateral distance to keep from obstacles (m)
+   *  @param outside_lane distance the vehicle may extend outside its
+   *         lane (m)
+   *  @param horizon planning distance ahead of the vehicle (m)
+   *  @param slope largest offset change per distance travelled
+   *  @param step spacing of the candidate target offsets (m)
+   */
+  void configure(float clearance, float outside_lane, float horizon,
+                 float slope, float step = 0.25);
+
+  /** @brief forget the previous target */
+  void reset(void);
+
+  /** @brief start planning along lane polygons
+   *
+   *  @param plan polygons of the lane ahead, in travel order
+   *  @param position vehicle position (rear axle)
+   *  @return false if the plan is too short to use
+   */
+  bool start(const poly_list_t &plan, const MapXY &position);
+
+  /** @brief add an obstacle point for the current plan */
+  void add_obstacle(const MapXY &point);
+
+  /** @brief choose the target offset
+   *
+   *  Prefers the target nearest the lane center, and near the
+   *  previous target, among those clear for the whole horizon.
+   *
+   *  @return true if the chosen plan is clear of all obstacles;
+   *          otherwise it is the one going farthest before contact
+   */
+  bool plan(void);
+
+  /** @return current vehicle offset from the lane center (m) */
+  float current(void) const { return current_; }
+
+  /** @return planned target offset (m) */
+  float target(void) const { return target_; }
+
+  /** @brief planned offset
+   *  @param distance ahead of the vehicle (m)
+   *  @return offset from the lane center (m)
+   */
+  float offset(float distance) const
+  {
+    return ramp(target_, distance);
+  }
+
+  /** @return distance the plan travels before obstacle contact (m),
+   *          Infinite::distance if clear
+   */
+  float free_distance(void) const { return free_distance_; }
+
+  /** @return number of obstacle points within the lane ahead */
+  unsigned in_lane(void) const { return in_lane_; }
+
+  /** @return lane space beside the vehicle at the lane center (m) */
+  float lane_space(void) const { return lane_space_; }
+
+private:
+
+  /** @brief path point at a lane polygon center */
+  struct PathPoint
+  {
+    MapXY center;
+    float station;                      ///< distance along path (m)
+    float half_width;                   ///< half lane width (m)
+  };
+
+  /** @brief obstacle point in path coordinates */
+  struct PathObstacle
+  {
+    float distance;                     ///< ahead of the vehicle (m)
+    float offset;                       ///< from lane center (m)
+  };
+
+  float contact_distance(float target) const;
+  float ramp(float target, float distance) const;
+
+  // limits
+  float clearance_;
+  float outside_lane_;
+  float horizon_;
+  float slope_;
+  float step_;
+
+  // current plan (vectors keep their storage between cycles)
+  std::vector<PathPoint> path_;
+  std::vector<PathObstacle> obstacles_;
+  unsigned first_;                      ///< first segment in range
+  unsigned last_;                       ///< last segment in range
+  float station_;                       ///< vehicle station (m)
+  MapXY position_;                      ///< vehicle position
+  float reach_;                         ///< largest useful offset (m)
+  float max_target_;                    ///< largest target offset (m)
+  float lane_space_;
+  unsigned in_lane_;
+
+  // result
+  float current_;
+  float target_;
+  float prev_target_;
+  float free_distance_;
+};
+
+#endif // _LATERAL_OFFSET_H_
@@ -0,0 +1,107 @@
+/* -*- mode: C++ -*-
+ *
+ *  Jerk-limited stop profile interface
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#ifndef _STOP_PROFILE_H_
+#define _STOP_PROFILE_H_
+
+/** @file
+ *
+ *  @brief Jerk-limited deceleration profile to a stop point.
+ */
+
+/** @brief Jerk-limited deceleration profile to a stop point.
+ *
+ *  A plan has up to three constant-jerk phases: change from the
+ *  current acceleration to a peak deceleration, hold it, then ease
+ *  off so speed and deceleration reach zero together at the stop
+ *  point.  The peak is the lowest deceleration stopping exactly at
+ *  the requested distance, so the vehicle keeps its speed as long as
+ *  possible without exceeding the limits.
+ *
+ *  The plan is a function of time since it was made.  Controllers
+ *  advance() it once per cycle, and only replan when the measured
+ *  distance drifts away from remaining().
+ */
+class StopProfile
+{
+public:
+
+  StopProfile() { clear(); }
+
+  /** @brief plan a stop
+   *
+   *  @param distance to the stop point (m)
+   *  @param speed current speed (m/s)
+   *  @param accel current acceleration (m/s^2, negative when slowing)
+   *  @param max_decel deceleration limit (m/s^2, positive)
+   *  @param max_jerk jerk limit (m/s^3, positive)
+   *  @return true if the stop is possible within the limits,
+   *          otherwise the plan brakes as hard as allowed and
+   *          overshoots
+   */
+  bool plan(float distance, float speed, float accel,
+            float max_decel, float max_jerk);
+
+  /** @brief move along the plan
+   *  @param dt time since the last call (s)
+   */
+  void advance(float dt) { elapsed_ += dt; }
+
+  /** @brief forget the plan */
+  void clear(void);
+
+  /** @return true when a plan has been made */
+  bool active(void) const { return active_; }
+
+  /** @return planned distance remaining to the stop point (m) */
+  float remaining(void) const;
+
+  /** @brief planned speed
+   *  @param lookahead time after the current plan time (s)
+   *  @return speed (m/s)
+   */
+  float speed(float lookahead = 0.0) const;
+
+  /** @return planned acceleration (m/s^2) */
+  float accel(void) const;
+
+  /** @brief distance needed to stop from a steady speed (m) */
+  static float stopping_distance(float speed, float max_decel,
+                                 float max_jerk);
+
+  /** @brief highest steady speed able to stop within a distance (m/s) */
+  static float max_speed(float distance, float max_decel,
+                         float max_jerk);
+
+private:
+
+  /** @brief one constant-jerk phase */
+  struct Phase
+  {
+    double duration;                    ///< seconds
+    double jerk;                        ///< m/s^3
+  };
+
+  void state_at(double t, double &s, double &v, double &a) const;
+  bool set_phases(double peak, double &distance);
+
+  static const int max_phases = 3;
+  Phase phases_[max_phases];
+  int n_phases_;
+
+  bool active_;
+  double distance_;                     ///< planned distance to stop
+  double speed_;                        ///< speed when planned
+  double accel_;                        ///< acceleration when planned
+  double jerk_;                         ///< jerk limit
+  double elapsed_;                      ///< time since planned
+};
+
+#endif // _STOP_PROFILE_H_
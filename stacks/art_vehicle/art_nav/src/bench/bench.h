@@ -0,0 +1,53 @@
+/* -*- mode: C++ -*-
+ *
+ *  ART benchmark tool interface
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include <string>
+
+/**  @file
+
+     @brief Timing helpers shared by the benchmark tool.
+
+     Each benchmark is a function registered in benchmark.cc.  Unit
+     tests only check behaviour; timings belong here.
+ */
+
+namespace bench
+{
+  /** @return wall clock time in microseconds */
+  double now_usec(void);
+
+  /** @brief print one result line, printf style */
+  void report(const char *format, ...)
+    __attribute__ ((format (printf, 1, 2)));
+
+  /** @return path of a file in a ROS package */
+  std::string package_file(const std::string &package,
+                           const std::string &file);
+
+  /** one benchmark in the registry */
+  struct Benchmark
+  {
+    const char *name;
+    void (*run)(void);
+  };
+
+  // the benchmarks
+  void checkpoint_file(void);
+  void graph_index(void);
+  void lanes_message(void);
+  void lateral_offset(void);
+  void map_editor(void);
+  void transform_cache(void);
+}
+
+#endif // _BENCH_H_
@@ -0,0 +1,91 @@
+/*
+ *  ART benchmark tool
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+/**  @file
+
+     @brief Time the hot paths of the ART navigation libraries.
+
+     Usage: rosrun art_nav benchmark [name ...]
+
+     With no arguments, runs every benchmark.  Results are printed
+     one per line, and depend on the machine, so nothing is checked.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include <ros/package.h>
+
+#include "bench.h"
+
+namespace
+{
+  const bench::Benchmark benchmarks[] =
+    {
+      {"checkpoint_file", bench::checkpoint_file},
+      {"graph_index", bench::graph_index},
+      {"lanes_message", bench::lanes_message},
+      {"lateral_offset", bench::lateral_offset},
+      {"map_editor", bench::map_editor},
+      {"transform_cache", bench::transform_cache},
+    };
+
+  const unsigned n_benchmarks = sizeof(benchmarks) / sizeof(benchmarks[0]);
+}
+
+double bench::now_usec(void)
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+void bench::report(const char *format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  printf("[ BENCH    ] ");
+  vprintf(format, args);
+  printf("\n");
+  va_end(args);
+  fflush(stdout);
+}
+
+std::string bench::package_file(const std::string &package,
+                                const std::string &file)
+{
+  return ros::package::getPath(package) + "/" + file;
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 2)
+    {
+      for (unsigned i = 0; i < n_benchmarks; ++i)
+        benchmarks[i].run();
+      return 0;
+    }
+
+  int rc = 0;
+  for (int arg = 1; arg < argc; ++arg)
+    {
+      unsigned i = 0;
+      while (i < n_benchmarks && strcmp(argv[arg], benchmarks[i].name) != 0)
+        ++i;
+      if (i < n_benchmarks)
+        benchmarks[i].run();
+      else
+        {
+          fprintf(stderr, "unknown benchmark: %s\n", argv[arg]);
+          rc = 1;
+        }
+    }
+  return rc;
+}
@@ -0,0 +1,75 @@
+/*
+ *  Navigator checkpoint file benchmark
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <art_msgs/NavigatorCheckpoint.h>
+#include <art_nav/checkpoint_file.h>
+
+#include "bench.h"
+
+using art_msgs::NavigatorCheckpoint;
+
+void bench::checkpoint_file(void)
+{
+  char name[] = "/tmp/bench_checkpoint_XXXXXX";
+  int fd = mkstemp(name);
+  if (fd < 0)
+    {
+      report("checkpoint_file: cannot create %s", name);
+      return;
+    }
+  ::close(fd);
+
+  // a checkpoint with some typical state
+  NavigatorCheckpoint chk;
+  chk.header.frame_id = "vehicle";
+  chk.navdata.estop.state = art_msgs::EstopState::Run;
+  chk.order.behavior.value = art_msgs::Behavior::Go;
+  for (unsigned i = 0; i < art_msgs::Order::N_WAYPTS; ++i)
+    {
+      chk.order.waypt[i].id.seg = 1;
+      chk.order.waypt[i].id.lane = 2;
+      chk.order.waypt[i].id.pt = i + 1;
+      chk.saved_waypt[i] = chk.order.waypt[i].id;
+    }
+  for (unsigned i = 0; i < NavigatorCheckpoint::N_TIMERS; ++i)
+    chk.timers[i] = -1.0;
+
+  const int N = 2000;
+  CheckpointFile file;
+  file.open(name);
+  double start = now_usec();
+  for (int n = 0; n < N; ++n)
+    {
+      chk.header.stamp = ros::Time(1000.0 + n);
+      file.save(chk);
+    }
+  double save_time = now_usec() - start;
+
+  // restore includes opening the file, as a restarted node would
+  NavigatorCheckpoint restored;
+  unsigned loaded = 0;
+  start = now_usec();
+  for (int n = 0; n < N; ++n)
+    {
+      CheckpointFile reopened;
+      reopened.open(name);
+      if (reopened.load(restored))
+        ++loaded;
+    }
+  double restore_time = now_usec() - start;
+  unlink(name);
+
+  report("checkpoint_file: %u bytes, %.2f us/save, %.2f us/restore%s",
+         ros::serialization::serializationLength(chk),
+         save_time / N, restore_time / N,
+         (loaded == (unsigned) N? "": " (load FAILED)"));
+}
@@ -0,0 +1,104 @@
+/*
+ *  Graph spatial index benchmark
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <float.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+
+#include <art_map/euclidean_distance.h>
+#include <art_map/Graph.h>
+#include <art_map/RNDF.h>
+
+#include "bench.h"
+
+namespace
+{
+  // the linear scan Graph used before it had an index
+  WayPointNode *scan_closest(const Graph &g, const MapXY &p)
+  {
+    WayPointNode *closest = NULL;
+    float distance = 0;
+    for (uint i = 0; i < g.nodes_size; i++)
+      {
+        float new_distance = Euclidean::DistanceTo(p, g.nodes[i].map);
+        if (closest == NULL || new_distance < distance)
+          {
+            closest = &g.nodes[i];
+            distance = new_distance;
+          }
+      }
+    return closest;
+  }
+
+  void time_map(const char *name)
+  {
+    RNDF rndf(bench::package_file("art_map", std::string("rndf/") + name));
+    if (!rndf.is_valid)
+      {
+        bench::report("%s: not available", name);
+        return;
+      }
+    Graph graph;
+    rndf.populate_graph(graph);
+    if (graph.rndf_is_gps())
+      graph.find_mapxy();
+    else
+      graph.xy_rndf();
+
+    float min_x = FLT_MAX, min_y = FLT_MAX;
+    float max_x = -FLT_MAX, max_y = -FLT_MAX;
+    for (uint i = 0; i < graph.nodes_size; i++)
+      {
+        min_x = std::min(min_x, graph.nodes[i].map.x);
+        min_y = std::min(min_y, graph.nodes[i].map.y);
+        max_x = std::max(max_x, graph.nodes[i].map.x);
+        max_y = std::max(max_y, graph.nodes[i].map.y);
+      }
+
+    // random points covering the map plus a margin
+    const unsigned N_POINTS = 20000;
+    const float margin = 50.0;
+    unsigned seed = 42;
+    std::vector<MapXY> points;
+    for (unsigned i = 0; i < N_POINTS; i++)
+      {
+        float fx = rand_r(&seed) / (float) RAND_MAX;
+        float fy = rand_r(&seed) / (float) RAND_MAX;
+        points.push_back(MapXY(min_x - margin + fx * (max_x-min_x + 2*margin),
+                               min_y - margin + fy * (max_y-min_y + 2*margin)));
+      }
+
+    unsigned found = 0;
+    double start = bench::now_usec();
+    for (unsigned i = 0; i < N_POINTS; i++)
+      if (scan_closest(graph, points[i]))
+        ++found;
+    double scan_time = bench::now_usec() - start;
+
+    // includes building the index once
+    start = bench::now_usec();
+    graph.nodes_changed();
+    for (unsigned i = 0; i < N_POINTS; i++)
+      if (graph.get_closest_node(points[i]))
+        ++found;
+    double index_time = bench::now_usec() - start;
+
+    bench::report("graph_index %s: %u nodes, %.3f us/query scanning, "
+                  "%.3f us/query indexed", name, graph.nodes_size,
+                  scan_time / N_POINTS, index_time / N_POINTS);
+  }
+}
+
+void bench::graph_index(void)
+{
+  time_map("prc_osm.rndf");
+  time_map("prc_large.rndf");
+  time_map("speedway.rndf");
+}
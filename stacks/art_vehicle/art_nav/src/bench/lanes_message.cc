@@ -0,0 +1,94 @@
+/*
+ *  Local road map message reuse benchmark
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <vector>
+
+#include <art/message_pool.h>
+#include <art_map/euclidean_distance.h>
+#include <art_map/MapLanes.h>
+
+#include "bench.h"
+
+namespace
+{
+  typedef ArtMsgPool::MessagePool<art_msgs::ArtLanes> LanesPool;
+
+  const float RANGE = 80.0;             // maplanes default (m)
+  const int N_POOL = 4;                 // maplanes default
+  const int MAX_POLYGONS = 1000;        // maplanes default
+}
+
+// Refills local road map messages the way maplanes does every cycle,
+// driving along the lanes of a bundled RNDF, with a new message each
+// cycle and with pooled messages.
+void bench::lanes_message(void)
+{
+  RNDF rndf(package_file("art_map", "rndf/prc_large.rndf"));
+  if (!rndf.is_valid)
+    {
+      report("lanes_message: prc_large.rndf not available");
+      return;
+    }
+  Graph graph;
+  rndf.populate_graph(graph);
+  graph.find_mapxy();
+  MapLanes map(RANGE);
+  if (map.MapRNDF(&graph, MIN_POLY_SIZE) != 0)
+    {
+      report("lanes_message: cannot map prc_large.rndf");
+      return;
+    }
+
+  // the vehicle route: every way-point in turn, with one position
+  // per meter in between, like odometry at 20Hz and 20 m/s
+  std::vector<MapXY> route;
+  for (unsigned i = 1; i < graph.nodes_size; ++i)
+    {
+      MapXY from = graph.nodes[i-1].map;
+      MapXY to = graph.nodes[i].map;
+      int steps = (int) Euclidean::DistanceTo(from, to);
+      for (int s = 0; s < steps; ++s)
+        {
+          float f = s / (float) steps;
+          route.push_back(MapXY(from.x + f * (to.x - from.x),
+                                from.y + f * (to.y - from.y)));
+        }
+    }
+  unsigned ncycles = route.size();
+
+  // a new message every cycle, as maplanes used to publish
+  double start = now_usec();
+  for (unsigned i = 0; i < ncycles; ++i)
+    {
+      art_msgs::ArtLanes lane_data;
+      map.getLanes(&lane_data, route[i]);
+    }
+  double fresh_usec = (now_usec() - start) / ncycles;
+
+  // pooled messages, with the last one still held by a subscriber
+  LanesPool pool(N_POOL);
+  for (unsigned i = 0; i < pool.size(); ++i)
+    pool[i].polygons.reserve(MAX_POLYGONS);
+  art_msgs::ArtLanes::Ptr held;
+  for (unsigned i = 0; i < ncycles; ++i)  // warm up
+    {
+      held = pool.get();
+      map.getLanes(held.get(), route[i]);
+    }
+  start = now_usec();
+  for (unsigned i = 0; i < ncycles; ++i)
+    {
+      held = pool.get();
+      map.getLanes(held.get(), route[i]);
+    }
+  double pooled_usec = (now_usec() - start) / ncycles;
+
+  report("lanes_message: %u cycles, %.1f us/cycle fresh, "
+         "%.1f us/cycle pooled", ncycles, fresh_usec, pooled_usec);
+}
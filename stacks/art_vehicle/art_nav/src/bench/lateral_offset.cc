@@ -0,0 +1,71 @@
+/*
+ *  Navigator lateral offset planner benchmark
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <stdlib.h>
+#include <vector>
+
+#include <art_nav/lateral_offset.h>
+
+#include "bench.h"
+
+namespace
+{
+  const float HALF_LANE = 2.0;          // m
+  const float X0 = 10.0;                // vehicle position (m)
+
+  // a straight lane along the x axis, in 2m polygons
+  poly_list_t straight_lane(void)
+  {
+    poly_list_t lane;
+    for (int i = 0; i < 50; ++i)
+      {
+        poly p;
+        p.p1 = MapXY(2.0 * i, HALF_LANE);
+        p.p2 = MapXY(2.0 * (i+1), HALF_LANE);
+        p.p3 = MapXY(2.0 * (i+1), -HALF_LANE);
+        p.p4 = MapXY(2.0 * i, -HALF_LANE);
+        p.midpoint = MapXY(2.0 * i + 1.0, 0.0);
+        lane.push_back(p);
+      }
+    return lane;
+  }
+}
+
+// Plans around a velodyne-sized obstacle cloud scattered over the
+// road, as the navigator avoid controller does every cycle.
+void bench::lateral_offset(void)
+{
+  poly_list_t lane = straight_lane();
+  LateralOffset planner;
+  planner.configure(0.5, 0.0, 30.0, 0.2);
+
+  const int npoints = 2000;
+  std::vector<MapXY> points;
+  unsigned seed = 42;
+  for (int i = 0; i < npoints; ++i)
+    {
+      float fx = rand_r(&seed) / (float) RAND_MAX;
+      float fy = rand_r(&seed) / (float) RAND_MAX;
+      points.push_back(MapXY(X0 + fx * 80.0 - 10.0, fy * 12.0 - 6.0));
+    }
+
+  const int ncycles = 100;
+  double start = now_usec();
+  for (int i = 0; i < ncycles; ++i)
+    {
+      planner.start(lane, MapXY(X0, 0.0));
+      for (int j = 0; j < npoints; ++j)
+        planner.add_obstacle(points[j]);
+      planner.plan();
+    }
+  double usec = (now_usec() - start) / ncycles;
+
+  report("lateral_offset: %d points, %d polygons, %.1f us/cycle",
+         npoints, (int) lane.size(), usec);
+}
@@ -0,0 +1,70 @@
+/*
+ *  Road map editing benchmark
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <art_map/MapEditor.h>
+
+#include "bench.h"
+
+namespace
+{
+  // rebuild after an edit, reporting edit-to-ready time
+  void time_rebuild(MapEditor &editor, const char *edit)
+  {
+    double start = bench::now_usec();
+    bool ok = editor.rebuild();
+    double usec = bench::now_usec() - start;
+    if (!ok)
+      {
+        bench::report("map_editor %s: rebuild failed", edit);
+        return;
+      }
+    MapLanes *lanes = editor.lanes();
+    bench::report("map_editor %s: %.1f ms, %u of %u units reused",
+                  edit, usec / 1000.0, lanes->unitsReused(),
+                  lanes->unitsMade());
+  }
+}
+
+// Times a full load of a bundled RNDF, then the incremental rebuild
+// after each kind of edit.
+void bench::map_editor(void)
+{
+  std::string path = package_file("art_map", "rndf/prc_large.rndf");
+  MapEditor editor;
+  double start = now_usec();
+  if (!editor.load(path))
+    {
+      report("map_editor: prc_large.rndf not available");
+      return;
+    }
+  report("map_editor full load: %.1f ms, %u units",
+         (now_usec() - start) / 1000.0, editor.lanes()->unitsMade());
+
+  LatLong ll = editor.rndf()->segments[0].lanes[0].waypoints[2].ll;
+  ll.latitude += 0.00001;
+  editor.move_waypoint(ElementID(1, 1, 3), ll);
+  time_rebuild(editor, "move lane way-point");
+
+  editor.set_lane_width(3, 2, 16);
+  time_rebuild(editor, "set lane width");
+
+  // a copy of lane 2.2, moved over by about five meters
+  Lane lane = editor.rndf()->segments[1].lanes[1];
+  lane.lane_id = 3;
+  lane.checkpoints.clear();
+  lane.stops.clear();
+  lane.exits.clear();
+  for (unsigned i = 0; i < lane.waypoints.size(); ++i)
+    lane.waypoints[i].ll.latitude += 0.00005;
+  editor.add_lane(2, lane);
+  time_rebuild(editor, "add lane");
+
+  editor.remove_lane(2, 3);
+  time_rebuild(editor, "remove lane");
+}
@@ -0,0 +1,83 @@
+/*
+ *  Per-node transform cache benchmark
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <art_map/transform_cache.h>
+
+#include "bench.h"
+
+namespace
+{
+  geometry_msgs::TransformStamped make_tf(const std::string &parent,
+                                          const std::string &child,
+                                          double stamp, double x, double y)
+  {
+    geometry_msgs::TransformStamped msg;
+    msg.header.stamp = ros::Time(stamp);
+    msg.header.frame_id = parent;
+    msg.child_frame_id = child;
+    msg.transform.translation.x = x;
+    msg.transform.translation.y = y;
+    msg.transform.translation.z = 0.0;
+    msg.transform.rotation = tf::createQuaternionMsgFromYaw(0.0);
+    return msg;
+  }
+
+  // static transforms, re-broadcast with post-dated time stamps
+  void add_static(TransformCache &cache, double stamp)
+  {
+    cache.add(make_tf("/map", "/odom", stamp, 0.0, 0.0));
+    cache.add(make_tf("vehicle", "velodyne", stamp, 1.0, 0.0));
+  }
+
+  // odometry moving straight east at 10 m/s, every 10 msec
+  void add_odometry(TransformCache &cache, double start, unsigned nsamples)
+  {
+    for (unsigned i = 0; i < nsamples; ++i)
+      {
+        double stamp = start + 0.01 * i;
+        double x = 10.0 * (stamp - 100.0);
+        cache.add(make_tf("/earth", "/vehicle", stamp, x, 0.0));
+        cache.add(make_tf("/odom", "/earth", stamp, 0.0, 0.0));
+      }
+  }
+}
+
+// Looks up a velodyne point transform in the map frame through the
+// vehicle frame chain, as the observers do for every scan, after ten
+// seconds of odometry and 5Hz static broadcasts.
+void bench::transform_cache(void)
+{
+  TransformCache cache;
+  for (int i = 0; i < 50; ++i)
+    {
+      add_static(cache, 100.2 + 0.2 * i);
+      add_odometry(cache, 100.0 + 0.2 * i, 20);
+    }
+
+  const int nlookups = 100000;
+  tf::StampedTransform transform;
+  unsigned found = 0;
+  double start = now_usec();
+  for (int i = 0; i < nlookups; ++i)
+    {
+      ros::Time stamp(109.5 + 0.0049 * (i % 100));
+      if (cache.lookup("/map", "velodyne", stamp, transform))
+        ++found;
+    }
+  double usec = (now_usec() - start) / nlookups;
+
+  if (found != (unsigned) nlookups)
+    {
+      report("transform_cache: %u of %d lookups failed",
+             nlookups - found, nlookups);
+      return;
+    }
+  report("transform_cache: %.3f us/lookup, %u bytes for %u frames",
+         usec, (unsigned) cache.memory(), cache.frames());
+}
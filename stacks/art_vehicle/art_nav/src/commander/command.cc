@@ -27,12 +27,14 @@ Commander::Commander(int verbosity, double limit,
   graph = _graph;
   mission = _mission;
   blockages = new Blockages(graph, route);
+  route_cost = new GraphSearch::RouteCost(*graph, speedlimit);
   set_checkpoint_goals();
   replan_num = 0;
 }
 
 Commander::~Commander()
 {
+  delete route_cost;
   delete blockages;
   delete fsm;
   delete route;
@@ -235,7 +237,8 @@ bool Commander::replan_route()
 
   // call A* from current to goal
   WayPointEdgeList edges =
-    GraphSearch::astar_search(*graph, current->index, goal.index, speedlimit);
+    GraphSearch::astar_search(*graph, current->index, goal.index,
+                              *route_cost);
     
   // Edges will be empty if we are planning inside a zone
   if (edges.empty()) // no route?
@@ -260,12 +263,15 @@ bool Commander::replan_route()
   Path new_route;
 
   new_route.new_path(current->index,goal.index,edges);
+  ROS_DEBUG("expected time to checkpoint %d: %.1f sec",
+            goal.checkpoint_id,
+            GraphSearch::route_time(*graph, *route_cost, edges));
   
   
   if (goal2.index != goal.index) {
     
     edges = GraphSearch::astar_search(*graph, goal.index, goal2.index,
-				      speedlimit);
+				      *route_cost);
     
     if (edges.empty())		// no route?
       {
@@ -15,6 +15,7 @@
 
 #include <art_map/zones.h>
 
+#include <art_nav/GraphSearch.h>
 #include <art_nav/NavBehavior.h>
 #include <art_nav/Mission.h>
 #include <art_msgs/NavigatorCommand.h>
@@ -47,6 +48,9 @@ class Commander
 
   Blockages* blockages;
 
+  // expected edge traversal times, for this road map and mission
+  GraphSearch::RouteCost* route_cost;
+
   ElementID current_way;
   const art_msgs::NavigatorState *navstate; // current Navigator state
   art_msgs::Order order;
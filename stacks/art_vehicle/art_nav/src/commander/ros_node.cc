@@ -11,11 +11,15 @@
 
 #include <iostream>
 
+#include <boost/thread.hpp>
+
 #include <ros/ros.h>
 
+#include <art/rates.h>
 #include <art_msgs/ArtHertz.h>
 #include <art_map/ZoneOps.h>
 
+#include <art_msgs/MapReload.h>
 #include <art_msgs/NavigatorState.h>
 #include <art_nav/NavEstopState.h>
 #include <art_nav/NavRoadState.h>
@@ -66,12 +70,43 @@
 
     Start running the robot immediately.
 
+    @section Reloading
+
+    A message on the @b map_reload topic [art_msgs::MapReload] replaces
+    the road map and mission without restarting.  The new files are
+    parsed in a background thread; between two cycles the commander
+    then switches to them.  A new MDF begins from its first
+    checkpoint.  When the MDF is unchanged, as for a road map reload,
+    the mission continues from its current checkpoint instead.  An
+    empty file name reloads the current one.
+
     @todo Make separate ROS packages for commander, navigator and pilot.
 
     @author Patrick Beeson, Jack O'Quin
 */
 
 
+/** @brief Road map and mission data, replaced as a unit. */
+struct MissionData
+{
+  RNDF *rndf;
+  MDF *mdf;
+  Graph *graph;
+  Mission *mission;
+
+  MissionData(): rndf(NULL), mdf(NULL), graph(NULL), mission(NULL) {}
+
+  /** delete all the objects */
+  void clear()
+  {
+    delete mission;
+    delete graph;
+    delete mdf;
+    delete rndf;
+    *this = MissionData();
+  }
+};
+
 /** @brief Commander node class */
 class CommanderNode
 {
@@ -120,21 +155,16 @@ public:
 
     nh.param("start_run", startrun_, false);
 
-    // class objects
-    rndf_ = new RNDF(rndf_name_);
-    mdf_ = new MDF(mdf_name_);
-    graph_ = NULL;
-    mission_ = NULL;
+    hertz_ = ArtRates::getHertz(nh, art_msgs::ArtHertz::COMMANDER);
+
+    reload_state_ = Idle;
   }
 
   ~CommanderNode()
   {
-    if (graph_ != NULL)
-      delete graph_;
-    if (mission_ != NULL)
-      delete mission_;
-    delete mdf_;
-    delete rndf_;
+    reload_thread_.join();              // wait for any mission build
+    pending_.clear();
+    current_.clear();
   }
 
   /** Set up ROS topics */
@@ -148,6 +178,8 @@ public:
                                       noDelay);
     nav_cmd_pub_ = 
       node.advertise<art_msgs::NavigatorCommand>("navigator/cmd", qDepth);
+    reload_topic_ = node.subscribe("map_reload", qDepth,
+                                   &CommanderNode::processReload, this);
     return true;
   }
 
@@ -158,6 +190,111 @@ public:
     navState_ = *nst;
   }
 
+  /** Process road map and mission reload request */
+  void processReload(const art_msgs::MapReload::ConstPtr &reloadIn)
+  {
+    boost::mutex::scoped_lock lock(reload_lock_);
+    if (reload_state_ != Idle)
+      {
+        ROS_WARN("mission reload already in progress, request ignored");
+        return;
+      }
+
+    std::string rndf_name = reloadIn->rndf;
+    if (rndf_name == "")
+      rndf_name = rndf_name_;
+    std::string mdf_name = reloadIn->mdf;
+    if (mdf_name == "")
+      mdf_name = mdf_name_;
+    ROS_INFO_STREAM("reloading RNDF: " << rndf_name
+                    << ", MDF: " << mdf_name);
+
+    // the previous thread (if any) has finished, start a new one
+    reload_thread_.join();
+    reload_state_ = Building;
+    reload_start_ = ros::WallTime::now();
+    reload_thread_ = boost::thread(&CommanderNode::reloadMission, this,
+                                   rndf_name, mdf_name);
+  }
+
+  /** Build new mission data (runs in reload_thread_) */
+  void reloadMission(std::string rndf_name, std::string mdf_name)
+  {
+    MissionData data;
+    bool ok = read_mission(rndf_name, mdf_name, false, data);
+
+    boost::mutex::scoped_lock lock(reload_lock_);
+    if (ok)
+      {
+        pending_ = data;
+        pending_rndf_ = rndf_name;
+        pending_mdf_ = mdf_name;
+        reload_state_ = Ready;
+      }
+    else
+      {
+        data.clear();
+        reload_state_ = Failed;
+      }
+  }
+
+  /** Switch to newly loaded mission data, if ready.
+   *
+   *  Called between cycles, replacing the Commander instance.  With
+   *  the same MDF, the new mission keeps the checkpoints already
+   *  reached, so the next goal is unchanged.
+   *
+   *  @param commander [in, out] current Commander, replaced if switched
+   */
+  void switchMission(Commander *&commander)
+  {
+    MissionData old;
+    bool same_mdf;
+    ros::WallTime requested;
+    ros::WallTime start = ros::WallTime::now();
+    {
+      boost::mutex::scoped_lock lock(reload_lock_);
+      if (reload_state_ == Failed)
+        {
+          ROS_ERROR("mission reload failed, continuing current mission");
+          reload_state_ = Idle;
+          return;
+        }
+      if (reload_state_ != Ready)
+        return;
+
+      old = current_;
+      current_ = pending_;
+      pending_ = MissionData();
+      same_mdf = (pending_mdf_ == mdf_name_);
+      rndf_name_ = pending_rndf_;
+      mdf_name_ = pending_mdf_;
+      requested = reload_start_;
+      reload_state_ = Idle;
+    }
+
+    if (same_mdf)
+      {
+        if (current_.mission->resume(*old.mission, *current_.graph))
+          ROS_INFO("continuing mission at checkpoint %d, %d remaining",
+                   current_.mission->current_checkpoint_id(),
+                   current_.mission->remaining_points());
+        else
+          ROS_WARN("cannot continue mission on new road map, "
+                   "restarting from first checkpoint");
+      }
+
+    delete commander;
+    commander = new Commander(verbose_, speed_limit_, current_.graph,
+                              current_.mission, zones_);
+    ros::WallTime done = ros::WallTime::now();
+    ROS_INFO("switched to new mission %.3fs after request, "
+             "switch took %.3fms", (done - requested).toSec(),
+             (done - start).toSec() * 1000.0);
+
+    old.clear();                        // no longer referenced
+  }
+
   /** Parse command line arguments */
   bool parse_args(int argc, char** argv)
   {
@@ -197,35 +334,61 @@ public:
   /** Build road map graph */
   bool build_graph()
   {
-    if (!rndf_->is_valid)
+    if (!read_mission(rndf_name_, mdf_name_, load_mission_, current_))
       {
-        ROS_FATAL("RNDF not valid");
+        ROS_FATAL("cannot load road map and mission");
+        return false;
+      }
+    return true;
+  }
+
+  /** Load road map graph and mission.
+   *
+   *  Uses no class variables except parameters, so it may run in a
+   *  background thread.
+   *
+   *  @param rndf_name Road Network Definition File name
+   *  @param mdf_name Mission Data File name
+   *  @param saved_state resume mission saved in mission_file_
+   *  @param data [out] new objects (even if unsuccessful)
+   *  @return true if successful
+   */
+  bool read_mission(const std::string &rndf_name,
+                    const std::string &mdf_name,
+                    bool saved_state, MissionData &data)
+  {
+    data.rndf = new RNDF(rndf_name);
+    data.mdf = new MDF(mdf_name);
+
+    if (!data.rndf->is_valid)
+      {
+        ROS_ERROR("RNDF not valid");
         return false;;
       }
 
-    graph_ = new Graph();
-    rndf_->populate_graph(*graph_);
-    graph_->find_mapxy();
-    graph_->find_implicit_edges();
+    data.graph = new Graph();
+    data.rndf->populate_graph(*data.graph);
+    data.graph->find_mapxy();
+    data.graph->find_implicit_edges();
     //zones_ = ZoneOps::build_zone_list_from_rndf(*rndf_, *graph_);    
 
     // Fill in mission data
-    if (!mdf_->is_valid)
+    if (!data.mdf->is_valid)
       {
-        ROS_FATAL("MDF not valid");
+        ROS_ERROR("MDF not valid");
         return false;;
       }
 
-    mdf_->add_speed_limits(*graph_);
-    mission_ = new Mission(*mdf_);
+    data.mdf->add_speed_limits(*data.graph);
+    data.mission = new Mission(*data.mdf);
 
-    if (load_mission_) 
+    if (saved_state) 
       {
         // Load state of previously started mission
-	mission_->clear();
-	if (!mission_->load(mission_file_.c_str(), *graph_))
+	data.mission->clear();
+	if (!data.mission->load(mission_file_.c_str(), *data.graph))
 	  {
-	    ROS_FATAL_STREAM("Unable to load stored mission file, "
+	    ROS_ERROR_STREAM("Unable to load stored mission file, "
                              <<mission_file_<<" is missing or corrupt");
 	    return false;
 	  }
@@ -234,17 +397,17 @@ public:
     else
       {
         // No started mission
-	if (!mission_->populate_elementid(*graph_))
+	if (!data.mission->populate_elementid(*data.graph))
 	  {
-	    ROS_FATAL("Mission IDs not same size as Element IDs");
+	    ROS_ERROR("Mission IDs not same size as Element IDs");
 	    return false;
 	  }
 	ROS_INFO("Running full mission from MDF");
       }
     
-    if (mission_->remaining_points() < 1)
+    if (data.mission->remaining_points() < 1)
       {
-        ROS_FATAL("No checkpoints left");
+        ROS_ERROR("No checkpoints left");
         return false;
       }
 
@@ -276,14 +439,17 @@ public:
       }
 
     // initialize Commander class
-    Commander commander(verbose_, speed_limit_, graph_, mission_, zones_);
+    Commander *commander = new Commander(verbose_, speed_limit_,
+                                         current_.graph, current_.mission,
+                                         zones_);
 
     // loop until end of mission
     ROS_INFO("begin mission");
-    ros::Rate cycle(art_msgs::ArtHertz::COMMANDER);
+    ros::Rate cycle(hertz_);
     while(ros::ok())
       {
         ros::spinOnce();                  // handle incoming messages
+        switchMission(commander);         // use new mission, if ready
 
         ROS_DEBUG_STREAM("navstate = "
                          << NavEstopState(navState_.estop).Name()
@@ -305,7 +471,7 @@ public:
           }
 
 	// generate navigator order for this cycle
-        art_msgs::Order next_order = commander.command(navState_);
+        art_msgs::Order next_order = commander->command(navState_);
 	
 	// send next order to Navigator, if any
 	if (next_order.behavior.value != NavBehavior::None)
@@ -315,6 +481,7 @@ public:
 
       }	//end of mission while loop
 
+    delete commander;
     ROS_INFO("Robot shut down.");
     return true;
   };
@@ -337,7 +504,7 @@ public:
   bool wait_for_input()
   {
     ROS_INFO("Waiting for navigator input");
-    ros::Rate cycle(art_msgs::ArtHertz::COMMANDER);
+    ros::Rate cycle(hertz_);
     while(ros::ok())
       {
         ros::spinOnce();                // handle incoming messages
@@ -362,17 +529,32 @@ private:
   std::string mdf_name_;
   int verbose_;
   std::string frame_id_;        ///< frame ID of map (default "/map")
+  double hertz_;                ///< commander cycle rate (Hz)
 
   // topics and messages
   ros::Subscriber nav_state_topic_;       // navigator state topic
   ros::Publisher nav_cmd_pub_;            // navigator command topic
   art_msgs::NavigatorState navState_;     // last received
+  ros::Subscriber reload_topic_;          // mission reload requests
 
-  RNDF *rndf_;
-  MDF *mdf_;
-  Graph* graph_;
-  Mission* mission_;
+  MissionData current_;                   // road map and mission in use
   ZonePerimeterList zones_;
+
+  // mission reload, built by reload_thread_ (protected by reload_lock_)
+  typedef enum
+    {
+      Idle,                               // no reload requested
+      Building,                           // background thread running
+      Ready,                              // pending_ waiting to switch
+      Failed                              // new mission not usable
+    } reload_state_t;
+  boost::thread reload_thread_;
+  boost::mutex reload_lock_;
+  reload_state_t reload_state_;
+  MissionData pending_;                   // new mission, when Ready
+  std::string pending_rndf_;
+  std::string pending_mdf_;
+  ros::WallTime reload_start_;            // when reload was requested
 };
 
 /** Main program */
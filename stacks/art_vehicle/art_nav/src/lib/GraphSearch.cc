@@ -8,9 +8,176 @@
 
 #include <art_nav/GraphSearch.h>
 #include <art_map/euclidean_distance.h>
+#include <art_map/zones.h>
 #include <float.h>
 
 namespace GraphSearch {
+
+  RouteCost::RouteCost(const Graph& graph, float speedlimit):
+    accel(1.0),
+    decel(2.0),
+    lateral_accel(2.0),
+    min_turn_speed(3.0),
+    stop_wait(3.0),
+    lane_change_time(2.0),
+    uturn_time(15.0),
+    zone_time(30.0),
+    speedlimit_(speedlimit)
+  {
+    update(graph);
+  }
+
+  void RouteCost::update(const Graph& graph)
+  {
+    // lane headings arriving at and leaving each way-point, for
+    // estimating how sharply each transition edge turns
+    heading_in_.assign(graph.nodes_size, NAN);
+    heading_out_.assign(graph.nodes_size, NAN);
+    max_speed_ = DEFAULT_ZONE_SPEED;
+    for (unsigned i = 0; i < graph.edges_size; i++)
+      {
+	const WayPointEdge& edge = graph.edges[i];
+	WayPointNode* start = graph.get_node_by_index(edge.startnode_index);
+	WayPointNode* end = graph.get_node_by_index(edge.endnode_index);
+	if (start == NULL || end == NULL
+	    || edge.startnode_index >= graph.nodes_size
+	    || edge.endnode_index >= graph.nodes_size)
+	  continue;
+	max_speed_ = fmax(max_speed_, fmin(edge.speed_max, speedlimit_));
+	if (start->id.lane != 0
+	    && start->id.seg == end->id.seg
+	    && start->id.lane == end->id.lane
+	    && end->id.pt == start->id.pt+1)
+	  {
+	    float heading = Coordinates::bearing(start->map, end->map);
+	    heading_out_[edge.startnode_index] = heading;
+	    heading_in_[edge.endnode_index] = heading;
+	  }
+      }
+
+    times_.clear();
+    for (unsigned i = 0; i < graph.edges_size; i++)
+      {
+	const WayPointEdge& edge = graph.edges[i];
+	EdgeKey key(edge.startnode_index, edge.endnode_index);
+	float time = compute_time(graph, edge);
+	std::map<EdgeKey,float>::iterator it = times_.find(key);
+	if (it == times_.end())
+	  times_[key] = time;
+	else
+	  it->second = fmin(it->second, time);
+      }
+  }
+
+  double RouteCost::edge_time(const Graph& graph,
+			      const WayPointEdge& edge) const
+  {
+    std::map<EdgeKey,float>::const_iterator it =
+      times_.find(EdgeKey(edge.startnode_index, edge.endnode_index));
+    if (it != times_.end())
+      return it->second;
+    return compute_time(graph, edge);	// edge added since update()
+  }
+
+  double RouteCost::min_time(const WayPointNode& start,
+			     const WayPointNode& end) const
+  {
+    // no edge is faster than a straight line at the highest speed
+    return Euclidean::DistanceTo(start.map, end.map) / max_speed_;
+  }
+
+  /** @brief time lost slowing from speed to turn_speed and back
+   *
+   *  Compared to driving the same distance at a constant speed.
+   */
+  static double slowdown_time(double speed, double turn_speed,
+			      double decel, double accel)
+  {
+    if (speed <= turn_speed)
+      return 0.0;
+    double dv = speed - turn_speed;
+    return (dv * dv) / (2.0 * speed) * (1.0/decel + 1.0/accel);
+  }
+
+  double RouteCost::compute_time(const Graph& graph,
+				 const WayPointEdge& edge) const
+  {
+    WayPointNode* start = graph.get_node_by_index(edge.startnode_index);
+    WayPointNode* end = graph.get_node_by_index(edge.endnode_index);
+    if (start == NULL || end == NULL)
+      return Infinite::distance;
+
+    float speed = fmin(edge.speed_max, speedlimit_);
+
+    // zones: slow travel, plus the time to plan a path through
+    if (start->is_perimeter || end->is_perimeter ||
+	start->is_spot || end->is_spot)
+      {
+	if (Epsilon::equal(speed, 0.0))
+	  speed = fmin(DEFAULT_ZONE_SPEED, speedlimit_);
+	double time = edge.distance / speed;
+	if (!start->is_perimeter && !start->is_spot)
+	  time += zone_time;
+	return time;
+      }
+
+    if (Epsilon::equal(speed, 0.0))
+      return Infinite::distance;
+
+    double time = edge.distance / speed;
+
+    if (edge.is_implicit)
+      {
+	time += lane_change_time;
+      }
+    else if (start->id.seg == end->id.seg
+	     && start->id.lane != end->id.lane)
+      {
+	// U-turn into another lane of this segment
+	if (!start->is_stop)
+	  time += slowdown_time(speed, 0.0, decel, accel);
+	time += uturn_time;
+      }
+    else if (start->id.seg != end->id.seg
+	     || end->id.pt != start->id.pt+1)
+      {
+	// intersection transition: slow enough to turn the corner
+	float heading_in = heading_in_[edge.startnode_index];
+	float heading_out = heading_out_[edge.endnode_index];
+	float bearing = Coordinates::bearing(start->map, end->map);
+	if (isnan(heading_in))
+	  heading_in = bearing;
+	if (isnan(heading_out))
+	  heading_out = bearing;
+	float turn = fabsf(Coordinates::normalize(heading_out - heading_in));
+	double turn_speed = speed;
+	if (turn > Epsilon::yaw)
+	  {
+	    double radius = edge.distance / turn;
+	    turn_speed = fmax(min_turn_speed,
+			      fmin(speed, sqrt(lateral_accel * radius)));
+	  }
+	time = edge.distance / turn_speed;
+	if (!start->is_stop)
+	  time += slowdown_time(speed, turn_speed, decel, accel);
+      }
+
+    if (end->is_stop)
+      time += slowdown_time(speed, 0.0, decel, accel) + stop_wait;
+
+    return time;
+  }
+
+  double route_time(const Graph& graph, const RouteCost& route_cost,
+		    const WayPointEdgeList& edges)
+  {
+    double time = 0.0;
+    for (WayPointEdgeList::const_iterator i = edges.begin();
+	 i != edges.end(); i++)
+      time += route_cost.edge_time(graph, *i);
+    return time;
+  }
+
   WayPointNodeList edge_list_to_node_list(const Graph& graph,
 					  WayPointEdgeList& edges) {
     WayPointNodeList nodes;
@@ -124,7 +291,8 @@ namespace GraphSearch {
   double heuristic(const Graph& graph,
 		   const waypt_index_t start_id,
 		   const waypt_index_t goal_id,
-		   float speedlimit)
+		   float speedlimit,
+		   const RouteCost *route_cost)
   {
     //printf("START: %d END: %d\n", start_id, goal_id);
     WayPointNode* start = graph.get_node_by_index(start_id);
@@ -134,13 +302,18 @@ namespace GraphSearch {
       std::cerr<<"ERROR: Graph edges have node indexes that don't exist!\n";
       return FLT_MAX;
     }
+    if (route_cost)
+      return route_cost->min_time(*start, *end);
     return time_between_nodes(*start, *end, speedlimit);
   }
 
   double cost(const Graph& graph,
 	      const WayPointEdge& edge,
-	      float speedlimit) {
+	      float speedlimit,
+	      const RouteCost *route_cost) {
 
+    if (route_cost)
+      return route_cost->edge_time(graph, edge);
     return time_along_edge(graph, edge, speedlimit);
   }
 
@@ -151,6 +324,7 @@ namespace GraphSearch {
 		    PossiblePath& old_possible_path,
 		    const waypt_index_t goal_id,
 		    float speedlimit,
+		    const RouteCost *route_cost,
 		    int prev_start_index) {
     WayPointEdgeList edges;
     WayPointNode *from_node = graph.get_node_by_index(from_index);
@@ -189,11 +363,13 @@ namespace GraphSearch {
 	  PossiblePath pp;
 	  
 	  // Actual cost so far
-	  pp.first.second = old_possible_path.first.second + cost(graph, *i, speedlimit);	
+	  pp.first.second = old_possible_path.first.second + cost(graph, *i, speedlimit,
+							       route_cost);	
 	  // Estimated total cost
 	  pp.first.first = pp.first.second + heuristic(graph,
 						       i->endnode_index,
-						       goal_id, speedlimit);
+						       goal_id, speedlimit,
+						       route_cost);
 	  
 	  
 	  pp.second = new_path;
@@ -204,10 +380,12 @@ namespace GraphSearch {
     }
   }
   
-  WayPointEdgeList astar_search(const Graph& graph,
-				waypt_index_t start_id,
-				waypt_index_t goal_id,
-				float speedlimit) {
+  // search with the route_cost edge times, if not NULL
+  WayPointEdgeList search(const Graph& graph,
+			  waypt_index_t start_id,
+			  waypt_index_t goal_id,
+			  float speedlimit,
+			  const RouteCost *route_cost) {
 
     std::map<waypt_index_t,bool> closed;
     closed[start_id] = true;
@@ -233,7 +411,8 @@ namespace GraphSearch {
 
     // Seed the search....
     empty.second = empty_list;
-    add_to_queue(graph, q, start_id, empty, goal_id, speedlimit, -1);
+    add_to_queue(graph, q, start_id, empty, goal_id, speedlimit,
+		 route_cost, -1);
     
     // Main searching loop
     while(!q->empty()) {
@@ -256,10 +435,25 @@ namespace GraphSearch {
 	return path.second;
       }
       closed[final_edge.endnode_index] = true;
-      add_to_queue(graph, q, final_edge.endnode_index, path, goal_id, speedlimit, final_edge.startnode_index);
+      add_to_queue(graph, q, final_edge.endnode_index, path, goal_id, speedlimit,
+		   route_cost, final_edge.startnode_index);
     }
     delete q;
     return empty_list;
   }
 
+  WayPointEdgeList astar_search(const Graph& graph,
+				waypt_index_t start_id,
+				waypt_index_t goal_id,
+				float speedlimit) {
+    return search(graph, start_id, goal_id, speedlimit, NULL);
+  }
+
+  WayPointEdgeList astar_search(const Graph& graph,
+				waypt_index_t start_id,
+				waypt_index_t goal_id,
+				const RouteCost& route_cost) {
+    return search(graph, start_id, goal_id, 0.0, &route_cost);
+  }
+
 };
@@ -10,6 +10,7 @@
 
 //Defines the Mission Data Structure
 
+#include <algorithm>
 #include <art_nav/Mission.h>
 
 //Copy Checkpoints in reverse order
@@ -61,6 +62,35 @@ bool Mission::populate_elementid(const Graph& graph)
     return true;
 };
 
+/** @brief continue the progress of another mission
+ *
+ *  Used when the road map is reloaded with the same MDF: the new
+ *  mission starts where the old one was, instead of at its first
+ *  checkpoint.
+ *
+ *  @param that mission in progress, its remaining checkpoints must
+ *         be the last ones of this mission
+ *  @param graph new road map, for the checkpoint element IDs
+ *  @return true if successful, this mission unchanged otherwise
+ */
+bool Mission::resume(const Mission& that, const Graph& graph)
+{
+  uint remaining = that.checkpoint_ids.size();
+  if (remaining > checkpoint_ids.size()
+      || !std::equal(that.checkpoint_ids.begin(), that.checkpoint_ids.end(),
+                     checkpoint_ids.end() - remaining))
+    return false;                       // not the same mission
+
+  Mission rest(that);
+  rest.checkpoint_elementid.clear();
+  if (!rest.populate_elementid(graph))
+    return false;
+
+  checkpoint_ids.swap(rest.checkpoint_ids);
+  checkpoint_elementid.swap(rest.checkpoint_elementid);
+  return true;
+};
+
 bool Mission::nextPoint(){
   if (checkpoint_ids.empty())
     return false;
@@ -0,0 +1,205 @@
+/*
+ *  Checkpoint file for warm restarts
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <boost/crc.hpp>
+#include <ros/ros.h>
+
+#include <art_nav/checkpoint_file.h>
+
+namespace
+{
+  const uint32_t MAGIC = 0x4b434e41;    // "ANCK" little-endian
+  const uint32_t N_SLOTS = 2;
+  const off_t SLOT_SIZE = (CheckpointFile::HEADER_SIZE
+                           + CheckpointFile::MAX_DATA);
+
+  /** header at the start of each slot */
+  struct SlotHeader
+  {
+    uint32_t magic;
+    uint32_t seq;                       ///< higher is newer
+    uint32_t size;                      ///< bytes of data following
+    uint32_t crc;                       ///< CRC-32 of the data
+  };
+
+  uint32_t crc32(const uint8_t *data, uint32_t size)
+  {
+    boost::crc_32_type crc;
+    crc.process_bytes(data, size);
+    return crc.checksum();
+  }
+
+  /** @brief read one slot
+   *
+   *  @return true if it holds a complete checkpoint
+   */
+  bool read_slot(int fd, uint32_t slot, SlotHeader &hdr,
+                 std::vector<uint8_t> &data)
+  {
+    off_t offset = slot * SLOT_SIZE;
+    if (pread(fd, &hdr, sizeof(hdr), offset) != (ssize_t) sizeof(hdr)
+        || hdr.magic != MAGIC
+        || hdr.size > CheckpointFile::MAX_DATA)
+      return false;
+
+    data.resize(hdr.size);
+    if (hdr.size > 0
+        && pread(fd, &data[0], hdr.size, offset + CheckpointFile::HEADER_SIZE)
+           != (ssize_t) hdr.size)
+      return false;
+
+    return (crc32(data.empty()? NULL: &data[0], hdr.size) == hdr.crc);
+  }
+
+  /** @brief create a directory and any missing parents
+   *
+   *  @return true if it exists now
+   */
+  bool make_dirs(const std::string &dir)
+  {
+    if (dir.empty() || mkdir(dir.c_str(), 0755) == 0 || errno == EEXIST)
+      return true;
+    if (errno != ENOENT)
+      return false;
+
+    size_t slash = dir.rfind('/');
+    if (slash == std::string::npos || slash == 0
+        || !make_dirs(dir.substr(0, slash)))
+      return false;
+    return (mkdir(dir.c_str(), 0755) == 0 || errno == EEXIST);
+  }
+}
+
+/** @brief full name of a checkpoint file
+ *
+ *  Relative names are in the ROS home directory: $ROS_HOME if set,
+ *  otherwise ~/.ros, so the file does not depend on the directory
+ *  the node happens to start in.
+ *
+ *  @param name file name, absolute or relative
+ *  @return file path
+ */
+std::string CheckpointFile::home_path(const std::string &name)
+{
+  if (name.empty() || name[0] == '/')
+    return name;
+
+  const char *ros_home = getenv("ROS_HOME");
+  if (ros_home && *ros_home)
+    return std::string(ros_home) + "/" + name;
+  const char *home = getenv("HOME");
+  if (home && *home)
+    return std::string(home) + "/.ros/" + name;
+  return name;                          // no home: current directory
+}
+
+/** @brief open (or create) a checkpoint file
+ *
+ *  Creates its directory, if missing, so the default file in the ROS
+ *  home directory works on a fresh account.
+ *
+ *  @param path file name
+ *  @return true if successful
+ */
+bool CheckpointFile::open(const std::string &path)
+{
+  close();
+  fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  size_t slash = path.rfind('/');
+  if (fd_ < 0 && errno == ENOENT && slash != std::string::npos
+      && make_dirs(path.substr(0, slash)))
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd_ < 0)
+    {
+      ROS_WARN("cannot open checkpoint file %s: %s",
+               path.c_str(), strerror(errno));
+      return false;
+    }
+
+  // continue the sequence of any checkpoints already saved, so the
+  // first write does not overwrite the latest one
+  std::vector<uint8_t> data;
+  seq_ = 0;
+  for (uint32_t slot = 0; slot < N_SLOTS; ++slot)
+    {
+      SlotHeader hdr;
+      if (read_slot(fd_, slot, hdr, data) && (int32_t) (hdr.seq - seq_) > 0)
+        seq_ = hdr.seq;
+    }
+  return true;
+}
+
+/** @brief close the checkpoint file */
+void CheckpointFile::close(void)
+{
+  if (fd_ >= 0)
+    ::close(fd_);
+  fd_ = -1;
+}
+
+/** @brief read the latest complete checkpoint
+ *
+ *  @param data [out] saved data
+ *  @return true if successful
+ */
+bool CheckpointFile::read(std::vector<uint8_t> &data) const
+{
+  if (fd_ < 0)
+    return false;
+
+  bool found = false;
+  uint32_t best_seq = 0;
+  std::vector<uint8_t> slot_data;
+  for (uint32_t slot = 0; slot < N_SLOTS; ++slot)
+    {
+      SlotHeader hdr;
+      if (read_slot(fd_, slot, hdr, slot_data)
+          && (!found || (int32_t) (hdr.seq - best_seq) > 0))
+        {
+          found = true;
+          best_seq = hdr.seq;
+          data.swap(slot_data);
+        }
+    }
+  return found;
+}
+
+/** @brief write a new checkpoint from the slot buffer
+ *
+ *  @param size number of data bytes after the first HEADER_SIZE bytes
+ *              of buffer_ (at most MAX_DATA)
+ *  @return true if successful
+ */
+bool CheckpointFile::write(uint32_t size)
+{
+  if (fd_ < 0 || size > MAX_DATA || buffer_.size() < HEADER_SIZE + size)
+    return false;
+
+  SlotHeader hdr;
+  hdr.magic = MAGIC;
+  hdr.seq = seq_ + 1;
+  hdr.size = size;
+  hdr.crc = crc32(&buffer_[HEADER_SIZE], size);
+
+  // the header goes in the space reserved in front of the data, so
+  // the whole slot is a single write
+  memcpy(&buffer_[0], &hdr, sizeof(hdr));
+  ssize_t len = HEADER_SIZE + size;
+  if (pwrite(fd_, &buffer_[0], len, (hdr.seq % N_SLOTS) * SLOT_SIZE) != len)
+    return false;
+
+  seq_ = hdr.seq;
+  return true;
+}
@@ -12,6 +12,7 @@
 #include <art/epsilon.h>
 #include <art_map/euclidean_distance.h>
 #include <art_map/coordinates.h>
+#include <art_map/pose_history.h>
 
 #include <art_nav/estimate.h>
 
@@ -21,6 +22,22 @@
  */
 namespace Estimate
 {
+  /** Replace the 2D pose of an odometry message.
+   *
+   *  @todo Preserve roll and pitch in the estimated quaternion.
+   *  This implementation sets them to zero, which does not matter
+   *  for the current navigator logic.
+   */
+  static void set_pose(const MapPose &pose, nav_msgs::Odometry &est)
+  {
+    est.pose.pose.position.x = pose.map.x;
+    est.pose.pose.position.y = pose.map.y;
+    est.pose.pose.orientation = tf::createQuaternionMsgFromYaw(pose.yaw);
+
+    ROS_DEBUG("estimated control pose = (%.3f, %.3f, %.3f)",
+              pose.map.x, pose.map.y, pose.yaw);
+  }
+
   /** Estimate control pose from earlier odometry.
    *
    * This is inherently a two-dimensional calculation, assuming
@@ -59,58 +76,50 @@ namespace Estimate
         return;                         // return unmodified odom
       }
 
-#if 1  // seems to be working now...
-
     // Refine pose estimate based on last reported velocity and yaw
     // rate: how far has the car travelled and its heading changed?
+    // This is the same motion model PoseHistory uses, so every
+    // estimate of where the car is agrees.
+    PoseHistory::Sample from;
+    from.pose = MapPose(odom.pose.pose);
+    from.speed = odom.twist.twist.linear.x;
+    from.yaw_rate = odom.twist.twist.angular.z;
+    PoseHistory::Sample to;
+    PoseHistory::extrapolate(from, dt, to);
+    set_pose(to.pose, est);
+  }
 
-    double odom_yaw = tf::getYaw(odom.pose.pose.orientation);
-    double odom_yawrate = odom.twist.twist.angular.z;
-    double est_dist = odom.twist.twist.linear.x * dt;
-    double est_yaw = Coordinates::normalize(odom_yaw
-                                            + odom_yawrate * dt);
-    if (fabs(odom_yawrate) < Epsilon::yaw)
-      {
-	// estimate straight line path at current velocity and heading
-	est.pose.pose.position.x = (odom.pose.pose.position.x
-                                    + est_dist * cos(odom_yaw));
-	est.pose.pose.position.y = (odom.pose.pose.position.y
-                                    + est_dist * sin(odom_yaw));
+  /** Estimate control pose from the vehicle pose history.
+   *
+   * Interpolates between odometry samples when @a est_time is
+   * within the history, otherwise extrapolates from the latest one,
+   * within the history's limit.
+   *
+   * @param history recent odometry poses
+   * @param[in] odom latest odometry, supplies the other fields
+   * @param est_time time for which estimated odometry desired
+   * @param est estimated odometry for time in @a est.header.stamp,
+   *            unmodified @a odom if not available
+   * @return true if pose estimated
+   */
+  bool control_pose(const PoseHistory &history,
+                    const nav_msgs::Odometry &odom,
+                    ros::Time est_time,
+                    nav_msgs::Odometry &est)
+  {
+    est = odom;
+    est.header.stamp = est_time;
 
-        ROS_DEBUG("estimated straight path distance = %.3f", est_dist);
-      }
-    else					// turning
+    PoseHistory::Sample sample;
+    if (!history.lookup(est_time, sample))
       {
-	// Car is turning. Estimate circular path [see: _Probabilistic
-	// Robotics_, Thrun, Burgard and Fox, ISBN 0-262-20162-3,
-	// 2005; section 5.3.3, exact motion model, pp. 125-127].
-	double est_radius = est_dist / odom_yawrate;
-	est.pose.pose.position.x = (odom.pose.pose.position.x
-                                    - est_radius * sin(odom_yaw)
-                                    + est_radius * sin(est_yaw));
-	est.pose.pose.position.y = (odom.pose.pose.position.y
-                                    + est_radius * cos(odom_yaw)
-                                    - est_radius * cos(est_yaw));
-
-        ROS_DEBUG("estimated path distance = %.3f, radius = %.3f",
-		  est_dist, est_radius);
+        ROS_WARN_STREAM("no pose history for estimate at " << est_time
+                        << ", odom: " << odom.header.stamp);
+        return false;                   // return unmodified odom
       }
 
-    ROS_DEBUG("estimated control pose = (%.3f, %.3f, %.3f)",
-	      est.pose.pose.position.x,
-	      est.pose.pose.position.y,
-              est_yaw);
-
-    // @todo Preserve roll and pitch in the estimated quaternion.
-    // This implementation sets them to zero, which does not matter
-    // for the current navigator logic.
-    est.pose.pose.orientation = tf::createQuaternionMsgFromYaw(est_yaw);
-
-#if 0  // for detailed debugging only, extremely verbose:
-    ROS_INFO_STREAM("last reported Odometry: " << odom);
-    ROS_INFO_STREAM("estimated Odometry: " << est);
-#endif // for detailed debugging only
-#endif
+    set_pose(sample.pose, est);
+    return true;
   }
 
   void front_bumper_pose(const nav_msgs::Odometry &odom, 
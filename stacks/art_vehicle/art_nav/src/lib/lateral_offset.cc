@@ -0,0 +1,259 @@
+/*
+ *  In-lane lateral offset planner implementation
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <math.h>
+#include <art_msgs/ArtVehicle.h>
+#include <art/infinity.h>
+#include <art_map/euclidean_distance.h>
+#include <art_nav/lateral_offset.h>
+
+using art_msgs::ArtVehicle;
+
+/**
+ *  Path coordinates are measured along the line joining the lane
+ *  polygon midpoints.  The vehicle body extends from rear_bumper_px
+ *  to front_bumper_px relative to its position, so an obstacle d
+ *  meters ahead is beside the body while the vehicle travels from
+ *  d - front_bumper_px to d - rear_bumper_px.  The planned offset is
+ *  monotonic, so it only needs checking at those two distances.
+ */
+
+LateralOffset::LateralOffset()
+{
+  configure(0.5, 0.0, 30.0, 0.2);
+  reset();
+}
+
+void LateralOffset::configure(float clearance, float outside_lane,
+                              float horizon, float slope, float step)
+{
+  clearance_ = clearance;
+  outside_lane_ = outside_lane;
+  horizon_ = horizon;
+  slope_ = slope;
+  step_ = step;
+}
+
+void LateralOffset::reset(void)
+{
+  path_.clear();
+  obstacles_.clear();
+  first_ = last_ = 0;
+  station_ = 0.0;
+  reach_ = max_target_ = lane_space_ = 0.0;
+  in_lane_ = 0;
+  current_ = target_ = prev_target_ = 0.0;
+  free_distance_ = Infinite::distance;
+}
+
+bool LateralOffset::start(const poly_list_t &plan, const MapXY &position)
+{
+  path_.clear();
+  obstacles_.clear();
+  in_lane_ = 0;
+  free_distance_ = Infinite::distance;
+  position_ = position;
+
+  float station = 0.0;
+  for (unsigned i = 0; i < plan.size(); ++i)
+    {
+      PathPoint pt;
+      pt.center = plan[i].midpoint;
+      pt.half_width = (Euclidean::DistanceTo(plan[i].p1, plan[i].p4)
+                       + Euclidean::DistanceTo(plan[i].p2, plan[i].p3)) / 4.0;
+      if (!path_.empty())
+        {
+          float length = Euclidean::DistanceTo(path_.back().center,
+                                               pt.center);
+          if (length < 0.01)            // skip repeated midpoints
+            continue;
+          station += length;
+        }
+      pt.station = station;
+      path_.push_back(pt);
+    }
+  if (path_.size() < 2)
+    return false;
+
+  // find the vehicle's segment
+  float closest = Infinite::distance;
+  unsigned segment = 0;
+  for (unsigned i = 0; i+1 < path_.size(); ++i)
+    {
+      const MapXY &a = path_[i].center;
+      const MapXY &b = path_[i+1].center;
+      float dx = b.x - a.x;
+      float dy = b.y - a.y;
+      float length = path_[i+1].station - path_[i].station;
+      float along = ((position.x - a.x) * dx
+                     + (position.y - a.y) * dy) / length;
+      float t = fminf(fmaxf(along / length, 0.0), 1.0);
+      float across = (dx * (position.y - a.y)
+                      - dy * (position.x - a.x)) / length;
+      float distance = Euclidean::DistanceTo(position.x, position.y,
+                                             a.x + t * dx, a.y + t * dy);
+      if (distance < closest)
+        {
+          closest = distance;
+          segment = i;
+          station_ = path_[i].station + t * length;
+          current_ = across;
+          lane_space_ = (path_[i].half_width
+                         + t * (path_[i+1].half_width - path_[i].half_width)
+                         - ArtVehicle::halfwidth);
+        }
+    }
+
+  // segments within range of the vehicle body over the horizon
+  first_ = segment;
+  while (first_ > 0
+         && path_[first_].station > station_ + ArtVehicle::rear_bumper_px)
+    --first_;
+  last_ = segment;
+  while (last_ + 2 < path_.size()
+         && (path_[last_+1].station
+             < station_ + horizon_ + ArtVehicle::front_bumper_px))
+    ++last_;
+
+  // stay within the narrowest part of the lane, plus any allowance
+  float space = Infinite::distance;
+  for (unsigned i = first_; i <= last_ + 1; ++i)
+    space = fminf(space, path_[i].half_width - ArtVehicle::halfwidth);
+  max_target_ = fmaxf(space + outside_lane_, 0.0);
+  reach_ = (fmaxf(max_target_, fabsf(current_))
+            + ArtVehicle::halfwidth + clearance_);
+  return true;
+}
+
+void LateralOffset::add_obstacle(const MapXY &point)
+{
+  // quickly ignore points far from the vehicle
+  float range = horizon_ + ArtVehicle::front_bumper_px + reach_;
+  float dx = point.x - position_.x;
+  float dy = point.y - position_.y;
+  if (dx * dx + dy * dy > range * range)
+    return;
+
+  // project onto the closest segment
+  float closest = Infinite::distance;
+  PathObstacle obs;
+  float half_width = 0.0;
+  for (unsigned i = first_; i <= last_; ++i)
+    {
+      const MapXY &a = path_[i].center;
+      const MapXY &b = path_[i+1].center;
+      float sx = b.x - a.x;
+      float sy = b.y - a.y;
+      float length = path_[i+1].station - path_[i].station;
+      float along = ((point.x - a.x) * sx + (point.y - a.y) * sy) / length;
+      float t = fminf(fmaxf(along / length, 0.0), 1.0);
+      float px = point.x - (a.x + t * sx);
+      float py = point.y - (a.y + t * sy);
+      float distance = px * px + py * py;
+      if (distance < closest)
+        {
+          closest = distance;
+          obs.distance = path_[i].station + t * length - station_;
+          obs.offset = (sx * (point.y - a.y) - sy * (point.x - a.x)) / length;
+          half_width = (path_[i].half_width
+                        + t * (path_[i+1].half_width - path_[i].half_width));
+        }
+    }
+
+  if (obs.distance < ArtVehicle::rear_bumper_px // already passed
+      || obs.distance > horizon_ + ArtVehicle::front_bumper_px
+      || fabsf(obs.offset) > reach_)    // no plan comes that close
+    return;
+
+  if (fabsf(obs.offset) < half_width)
+    ++in_lane_;
+  obstacles_.push_back(obs);
+}
+
+bool LateralOffset::plan(void)
+{
+  // candidate targets, nearest the center first
+  int n = (int) floorf(max_target_ / step_ + 0.001);
+  bool clear = false;
+  float best_cost = Infinite::distance;
+  float best_target = 0.0;
+  float farthest = -1.0;
+  float farthest_target = 0.0;
+  for (int i = 0; i <= 2*n; ++i)
+    {
+      float target = ((i+1) / 2) * step_ * ((i & 1)? 1.0: -1.0);
+      float contact = contact_distance(target);
+      if (contact >= horizon_)
+        {
+          float cost = fabsf(target) + 0.5 * fabsf(target - prev_target_);
+          if (cost < best_cost)
+            {
+              clear = true;
+              best_cost = cost;
+              best_target = target;
+            }
+        }
+      else if (!clear && contact > farthest)
+        {
+          farthest = contact;
+          farthest_target = target;
+        }
+    }
+
+  if (clear)
+    {
+      target_ = best_target;
+      free_distance_ = Infinite::distance;
+    }
+  else
+    {
+      target_ = farthest_target;
+      free_distance_ = farthest;
+    }
+  prev_target_ = target_;
+  return clear;
+}
+
+/** @brief distance a plan travels before obstacle contact
+ *
+ *  @param target offset of the plan (m)
+ *  @return distance (m), Infinite::distance if no contact
+ */
+float LateralOffset::contact_distance(float target) const
+{
+  float width = ArtVehicle::halfwidth + clearance_;
+  float contact = Infinite::distance;
+  for (unsigned i = 0; i < obstacles_.size(); ++i)
+    {
+      const PathObstacle &obs = obstacles_[i];
+      float start = fmaxf(obs.distance - ArtVehicle::front_bumper_px, 0.0);
+      if (start >= contact)
+        continue;
+      float finish = fmaxf(obs.distance - ArtVehicle::rear_bumper_px, 0.0);
+      float p1 = ramp(target, start);
+      float p2 = ramp(target, finish);
+      if (fmaxf(p1, p2) > obs.offset - width
+          && fminf(p1, p2) < obs.offset + width)
+        contact = start;
+    }
+  return contact;
+}
+
+/** @brief offset along a plan
+ *
+ *  @param target offset of the plan (m)
+ *  @param distance ahead of the vehicle (m)
+ *  @return offset (m)
+ */
+float LateralOffset::ramp(float target, float distance) const
+{
+  float change = slope_ * fmaxf(distance, 0.0);
+  float delta = fminf(fmaxf(target - current_, -change), change);
+  return current_ + delta;
+}
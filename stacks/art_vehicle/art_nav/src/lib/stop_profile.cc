@@ -0,0 +1,188 @@
+/*
+ *  Jerk-limited stop profile implementation
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <math.h>
+#include <art_nav/stop_profile.h>
+
+/**
+ *  With jerk limit J and peak deceleration A, a stop from a steady
+ *  speed V is symmetric: deceleration ramps up for A/J seconds, holds,
+ *  then ramps down for another A/J seconds, losing A**2/(2*J) speed
+ *  in each ramp.  The stop takes T = V/A + A/J seconds, and covers
+ *
+ * 	D = V*T/2 = V**2/(2*A) + V*A/(2*J)
+ *
+ *  When V < A**2/J the ramps meet before reaching A, at a peak of
+ *  sqrt(V*J), and the stop covers D = V*sqrt(V/J).
+ *
+ *  Plans starting from a non-zero acceleration are not symmetric, so
+ *  plan() searches for the peak deceleration numerically.
+ */
+
+void StopProfile::clear(void)
+{
+  n_phases_ = 0;
+  active_ = false;
+  distance_ = speed_ = accel_ = elapsed_ = 0.0;
+  jerk_ = 1.0;
+}
+
+float StopProfile::stopping_distance(float speed, float max_decel,
+                                     float max_jerk)
+{
+  if (speed <= 0.0)
+    return 0.0;
+  if (speed < max_decel * max_decel / max_jerk)
+    return speed * sqrtf(speed / max_jerk);
+  return (speed * speed / (2.0 * max_decel)
+          + speed * max_decel / (2.0 * max_jerk));
+}
+
+float StopProfile::max_speed(float distance, float max_decel,
+                             float max_jerk)
+{
+  if (distance <= 0.0)
+    return 0.0;
+
+  // solve V**2 + V*A**2/J - 2*A*D = 0 for V
+  float b = max_decel * max_decel / max_jerk;
+  float speed = (-b + sqrtf(b * b + 8.0 * max_decel * distance)) / 2.0;
+  if (speed >= b)
+    return speed;
+
+  // too slow to reach the deceleration limit: D = V*sqrt(V/J)
+  return cbrtf(distance * distance * max_jerk);
+}
+
+bool StopProfile::plan(float distance, float speed, float accel,
+                       float max_decel, float max_jerk)
+{
+  clear();
+  active_ = true;
+  distance_ = distance;
+  speed_ = fmax(speed, 0.0);
+  accel_ = accel;
+  jerk_ = max_jerk;
+
+  if (speed_ <= 0.0)
+    return (distance >= 0.0);           // already stopped
+
+  // Find the peak deceleration that stops exactly at the distance.
+  // Stopping distance decreases as the peak increases, until the
+  // peak is too high to reach before the speed runs out.
+  const double min_peak = 0.01;
+  double lo = min_peak;
+  double hi = max_decel;
+  double planned;
+  if (!set_phases(lo, planned))
+    {
+      // the speed runs out before even easing off the current
+      // deceleration: just ease off now
+      phases_[0].duration = fabs(accel_) / jerk_;
+      phases_[0].jerk = (accel_ < 0.0? jerk_: -jerk_);
+      n_phases_ = 1;
+      return true;
+    }
+  for (int i = 0; i < 40; ++i)
+    {
+      double mid = (lo + hi) / 2.0;
+      if (!set_phases(mid, planned) || planned < distance)
+        hi = mid;
+      else
+        lo = mid;
+    }
+  set_phases(lo, planned);
+  return (planned <= distance + 0.01);
+}
+
+float StopProfile::remaining(void) const
+{
+  double s, v, a;
+  state_at(elapsed_, s, v, a);
+  return distance_ - s;
+}
+
+float StopProfile::speed(float lookahead) const
+{
+  double s, v, a;
+  state_at(elapsed_ + lookahead, s, v, a);
+  return v;
+}
+
+float StopProfile::accel(void) const
+{
+  double s, v, a;
+  state_at(elapsed_, s, v, a);
+  return a;
+}
+
+/** @brief set phases for a peak deceleration
+ *
+ *  @param peak deceleration to hold (positive)
+ *  @param distance [out] distance to stop
+ *  @return false if the speed runs out before reaching the peak
+ */
+bool StopProfile::set_phases(double peak, double &distance)
+{
+  // change from the current acceleration to -peak
+  double change = -peak - accel_;
+  double t1 = fabs(change) / jerk_;
+  double j1 = (change < 0.0? -jerk_: jerk_);
+  double v1 = speed_ + accel_ * t1 + j1 * t1 * t1 / 2.0;
+
+  // easing off from -peak to zero loses this much speed
+  double v3 = peak * peak / (2.0 * jerk_);
+  if (v1 < v3)
+    return false;
+
+  phases_[0].duration = t1;
+  phases_[0].jerk = j1;
+  phases_[1].duration = (v1 - v3) / peak;
+  phases_[1].jerk = 0.0;
+  phases_[2].duration = peak / jerk_;
+  phases_[2].jerk = jerk_;
+  n_phases_ = 3;
+
+  double total = 0.0;
+  for (int i = 0; i < n_phases_; ++i)
+    total += phases_[i].duration;
+  double v, a;
+  state_at(total, distance, v, a);
+  return true;
+}
+
+/** @brief planned state at a time since planning
+ *
+ *  @param t time (s)
+ *  @param s [out] distance travelled (m)
+ *  @param v [out] speed (m/s)
+ *  @param a [out] acceleration (m/s^2)
+ */
+void StopProfile::state_at(double t, double &s, double &v, double &a) const
+{
+  s = 0.0;
+  v = speed_;
+  a = accel_;
+  for (int i = 0; i < n_phases_ && t > 0.0; ++i)
+    {
+      double dt = fmin(t, phases_[i].duration);
+      double j = phases_[i].jerk;
+      s += v * dt + a * dt * dt / 2.0 + j * dt * dt * dt / 6.0;
+      v += a * dt + j * dt * dt / 2.0;
+      a += j * dt;
+      t -= dt;
+    }
+
+  // stopped at the end of the plan
+  if (t > 0.0 || v <= 0.0)
+    {
+      v = 0.0;
+      a = 0.0;
+    }
+}
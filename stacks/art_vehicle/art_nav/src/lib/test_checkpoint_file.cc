@@ -0,0 +1,214 @@
+/*
+ *  Navigator checkpoint file unit test
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <gtest/gtest.h>
+
+#include <art_msgs/NavigatorCheckpoint.h>
+#include <art_nav/checkpoint_file.h>
+
+using art_msgs::NavigatorCheckpoint;
+
+// a unique file name, removed when the test ends
+class TempName
+{
+public:
+  TempName()
+  {
+    char name[] = "/tmp/test_checkpoint_XXXXXX";
+    int fd = mkstemp(name);
+    if (fd >= 0)
+      ::close(fd);
+    name_ = name;
+  }
+  ~TempName()
+  {
+    unlink(name_.c_str());
+  }
+  const std::string &str(void) const
+  {
+    return name_;
+  }
+private:
+  std::string name_;
+};
+
+// a checkpoint with some typical state, varying with n
+NavigatorCheckpoint make_checkpoint(int n)
+{
+  NavigatorCheckpoint chk;
+  chk.header.stamp = ros::Time(1000.0 + n);
+  chk.header.frame_id = "vehicle";
+  chk.navdata.estop.state = art_msgs::EstopState::Run;
+  chk.navdata.road.state = 3;
+  chk.navdata.last_waypt.seg = 1;
+  chk.navdata.last_waypt.lane = 2;
+  chk.navdata.last_waypt.pt = n;
+  chk.order.behavior.value = art_msgs::Behavior::Go;
+  chk.order.replan_num = n;
+  for (unsigned i = 0; i < art_msgs::Order::N_WAYPTS; ++i)
+    {
+      chk.order.waypt[i].id.seg = 1;
+      chk.order.waypt[i].id.lane = 2;
+      chk.order.waypt[i].id.pt = n + i;
+      chk.saved_waypt[i] = chk.order.waypt[i].id;
+    }
+  chk.go_state = 0;
+  chk.last_replan = n - 1;
+  chk.saved_replan_num = n - 1;
+  chk.passing_left = true;
+  for (unsigned i = 0; i < NavigatorCheckpoint::N_TIMERS; ++i)
+    chk.timers[i] = (i == NavigatorCheckpoint::STOP_LINE_TIMER? 1.5: -1.0);
+  return chk;
+}
+
+void expect_same(const NavigatorCheckpoint &a, const NavigatorCheckpoint &b)
+{
+  EXPECT_EQ(a.header.stamp, b.header.stamp);
+  EXPECT_EQ(a.header.frame_id, b.header.frame_id);
+  EXPECT_EQ(a.navdata.estop.state, b.navdata.estop.state);
+  EXPECT_EQ(a.navdata.road.state, b.navdata.road.state);
+  EXPECT_EQ(a.navdata.last_waypt.pt, b.navdata.last_waypt.pt);
+  EXPECT_EQ(a.order.behavior.value, b.order.behavior.value);
+  EXPECT_EQ(a.order.replan_num, b.order.replan_num);
+  for (unsigned i = 0; i < art_msgs::Order::N_WAYPTS; ++i)
+    {
+      EXPECT_EQ(a.order.waypt[i].id.pt, b.order.waypt[i].id.pt);
+      EXPECT_EQ(a.saved_waypt[i].pt, b.saved_waypt[i].pt);
+    }
+  EXPECT_EQ(a.go_state, b.go_state);
+  EXPECT_EQ(a.last_replan, b.last_replan);
+  EXPECT_EQ(a.saved_replan_num, b.saved_replan_num);
+  EXPECT_EQ(a.passing_left, b.passing_left);
+  for (unsigned i = 0; i < NavigatorCheckpoint::N_TIMERS; ++i)
+    EXPECT_EQ(a.timers[i], b.timers[i]);
+}
+
+TEST(CheckpointFile, empty)
+{
+  TempName name;
+  CheckpointFile file;
+  ASSERT_TRUE(file.open(name.str()));
+  NavigatorCheckpoint chk;
+  EXPECT_FALSE(file.load(chk));
+}
+
+TEST(CheckpointFile, round_trip)
+{
+  TempName name;
+  NavigatorCheckpoint saved = make_checkpoint(7);
+  {
+    CheckpointFile file;
+    ASSERT_TRUE(file.open(name.str()));
+    EXPECT_TRUE(file.save(make_checkpoint(6)));
+    EXPECT_TRUE(file.save(saved));
+  }
+
+  // a new process reads the latest checkpoint
+  CheckpointFile file;
+  ASSERT_TRUE(file.open(name.str()));
+  NavigatorCheckpoint restored;
+  ASSERT_TRUE(file.load(restored));
+  expect_same(saved, restored);
+
+  // and does not overwrite it with its first save
+  EXPECT_TRUE(file.save(make_checkpoint(8)));
+  CheckpointFile other;
+  ASSERT_TRUE(other.open(name.str()));
+  ASSERT_TRUE(other.load(restored));
+  expect_same(make_checkpoint(8), restored);
+}
+
+TEST(CheckpointFile, torn_write)
+{
+  TempName name;
+  CheckpointFile file;
+  ASSERT_TRUE(file.open(name.str()));
+  for (int n = 0; n < 5; ++n)
+    EXPECT_TRUE(file.save(make_checkpoint(n)));
+
+  // damage the latest slot, as if the process died while writing it
+  int fd = ::open(name.str().c_str(), O_WRONLY);
+  ASSERT_GE(fd, 0);
+  uint8_t junk[4] = {0xde, 0xad, 0xbe, 0xef};
+  off_t slot = 5 % 2;
+  off_t offset = (slot * (CheckpointFile::HEADER_SIZE + CheckpointFile::MAX_DATA)
+                  + CheckpointFile::HEADER_SIZE + 20);
+  EXPECT_EQ(4, pwrite(fd, junk, sizeof(junk), offset));
+  ::close(fd);
+
+  // the previous checkpoint survives
+  CheckpointFile reopened;
+  ASSERT_TRUE(reopened.open(name.str()));
+  NavigatorCheckpoint restored;
+  ASSERT_TRUE(reopened.load(restored));
+  expect_same(make_checkpoint(3), restored);
+}
+
+TEST(CheckpointFile, too_large)
+{
+  TempName name;
+  CheckpointFile file;
+  ASSERT_TRUE(file.open(name.str()));
+  NavigatorCheckpoint chk = make_checkpoint(1);
+  chk.header.frame_id = std::string(CheckpointFile::MAX_DATA, 'x');
+  EXPECT_FALSE(file.save(chk));
+}
+
+TEST(CheckpointFile, home_path)
+{
+  // absolute names are unchanged, relative ones go in ROS home
+  setenv("ROS_HOME", "/var/ros", 1);
+  setenv("HOME", "/home/robot", 1);
+  EXPECT_EQ("/tmp/chk", CheckpointFile::home_path("/tmp/chk"));
+  EXPECT_EQ("/var/ros/navigator_checkpoint",
+            CheckpointFile::home_path("navigator_checkpoint"));
+  EXPECT_EQ("", CheckpointFile::home_path(""));
+
+  unsetenv("ROS_HOME");
+  EXPECT_EQ("/home/robot/.ros/navigator_checkpoint",
+            CheckpointFile::home_path("navigator_checkpoint"));
+}
+
+TEST(CheckpointFile, missing_directory)
+{
+  // a fresh account has no ROS home directory yet
+  char top[] = "/tmp/test_checkpoint_home_XXXXXX";
+  ASSERT_TRUE(mkdtemp(top) != NULL);
+  std::string home = std::string(top) + "/robot";
+  setenv("HOME", home.c_str(), 1);
+  unsetenv("ROS_HOME");
+  std::string path = CheckpointFile::home_path("navigator_checkpoint");
+
+  {
+    CheckpointFile file;
+    ASSERT_TRUE(file.open(path));
+    EXPECT_TRUE(file.save(make_checkpoint(1)));
+  }
+  CheckpointFile reopened;
+  ASSERT_TRUE(reopened.open(path));
+  NavigatorCheckpoint chk;
+  ASSERT_TRUE(reopened.load(chk));
+  expect_same(make_checkpoint(1), chk);
+  reopened.close();
+
+  unlink(path.c_str());
+  rmdir((home + "/.ros").c_str());
+  rmdir(home.c_str());
+  rmdir(top);
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
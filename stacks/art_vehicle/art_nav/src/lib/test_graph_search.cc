@@ -0,0 +1,239 @@
+/*
+ *  Commander route cost model unit test
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <gtest/gtest.h>
+#include <art_nav/GraphSearch.h>
+#include <art_map/euclidean_distance.h>
+
+using GraphSearch::RouteCost;
+
+// builds small road map graphs with way-points in MapXY coordinates
+class TestMap
+{
+public:
+
+  waypt_index_t node(int seg, int lane, int pt, float x, float y,
+                     bool is_stop = false)
+  {
+    WayPointNode wp(MapXY(x, y));
+    wp.id = ElementID(seg, lane, pt);
+    wp.index = nodes_.size();
+    wp.is_stop = is_stop;
+    nodes_.push_back(wp);
+    return wp.index;
+  }
+
+  void edge(waypt_index_t from, waypt_index_t to, float speed)
+  {
+    WayPointEdge e;
+    e.startnode_index = from;
+    e.endnode_index = to;
+    e.distance = Euclidean::DistanceTo(nodes_[from].map, nodes_[to].map);
+    e.speed_max = speed;
+    e.is_exit = (nodes_[from].id.seg != nodes_[to].id.seg);
+    edges_.push_back(e);
+  }
+
+  Graph *graph(void)
+  {
+    return new Graph(nodes_.size(), edges_.size(),
+                     &nodes_[0], &edges_[0]);
+  }
+
+private:
+  std::vector<WayPointNode> nodes_;
+  std::vector<WayPointEdge> edges_;
+};
+
+// the segments a route passes through, in order
+std::vector<int> route_segments(const Graph &graph,
+                                const WayPointEdgeList &edges)
+{
+  std::vector<int> segs;
+  for (WayPointEdgeList::const_iterator i = edges.begin();
+       i != edges.end(); i++)
+    {
+      int seg = graph.nodes[i->endnode_index].id.seg;
+      if (segs.empty() || segs.back() != seg)
+        segs.push_back(seg);
+    }
+  return segs;
+}
+
+TEST(RouteCost, lane_following)
+{
+  TestMap map;
+  waypt_index_t a = map.node(1, 1, 1, 0.0, 0.0);
+  waypt_index_t b = map.node(1, 1, 2, 100.0, 0.0);
+  map.edge(a, b, 10.0);
+  Graph *graph = map.graph();
+
+  // the commander speed limit applies, as well as the MDF limit
+  RouteCost cost(*graph, 5.0);
+  EXPECT_NEAR(20.0, cost.edge_time(*graph, graph->edges[0]), 0.001);
+  RouteCost fast(*graph, 15.0);
+  EXPECT_NEAR(10.0, fast.edge_time(*graph, graph->edges[0]), 0.001);
+  delete graph;
+}
+
+TEST(RouteCost, stop_line)
+{
+  TestMap map;
+  waypt_index_t a = map.node(1, 1, 1, 0.0, 0.0);
+  waypt_index_t b = map.node(1, 1, 2, 100.0, 0.0, true);
+  map.edge(a, b, 10.0);
+  Graph *graph = map.graph();
+
+  // slowing to a stop and speeding up again, plus the wait
+  RouteCost cost(*graph, 10.0);
+  double slowdown = 10.0/2.0 * (1.0/cost.decel + 1.0/cost.accel);
+  EXPECT_NEAR(10.0 + slowdown + cost.stop_wait,
+              cost.edge_time(*graph, graph->edges[0]), 0.001);
+  delete graph;
+}
+
+TEST(RouteCost, sharp_turn)
+{
+  // a lane ending at an intersection, continuing straight or right
+  TestMap map;
+  waypt_index_t a = map.node(1, 1, 1, 0.0, 0.0);
+  waypt_index_t b = map.node(1, 1, 2, 50.0, 0.0);
+  waypt_index_t c = map.node(2, 1, 1, 60.0, 0.0);
+  waypt_index_t d = map.node(2, 1, 2, 110.0, 0.0);
+  waypt_index_t e = map.node(3, 1, 1, 55.0, -5.0);
+  waypt_index_t f = map.node(3, 1, 2, 55.0, -55.0);
+  map.edge(a, b, 10.0);
+  map.edge(b, c, 10.0);
+  map.edge(c, d, 10.0);
+  map.edge(b, e, 10.0);
+  map.edge(e, f, 10.0);
+  Graph *graph = map.graph();
+  RouteCost cost(*graph, 10.0);
+
+  double straight = cost.edge_time(*graph, graph->edges[1]);
+  double right = cost.edge_time(*graph, graph->edges[3]);
+  EXPECT_NEAR(1.0, straight, 0.001);
+  EXPECT_LT(straight + 2.0, right);
+  delete graph;
+}
+
+TEST(RouteCost, uturn)
+{
+  TestMap map;
+  waypt_index_t a = map.node(1, 1, 1, 0.0, 0.0);
+  waypt_index_t b = map.node(1, 1, 2, 100.0, 0.0);
+  waypt_index_t c = map.node(1, 2, 1, 100.0, 4.0);
+  waypt_index_t d = map.node(1, 2, 2, 0.0, 4.0);
+  map.edge(a, b, 10.0);
+  map.edge(b, c, 10.0);
+  map.edge(c, d, 10.0);
+  Graph *graph = map.graph();
+  RouteCost cost(*graph, 10.0);
+
+  EXPECT_LT(cost.uturn_time, cost.edge_time(*graph, graph->edges[1]));
+  delete graph;
+}
+
+// two roads from A to B: a short one with a low speed limit and
+// stop signs, and a longer faster one without
+class RouteChoice: public testing::Test
+{
+protected:
+
+  virtual void SetUp()
+  {
+    start_ = map_.node(1, 1, 1, 0.0, 0.0);
+    waypt_index_t exit = map_.node(1, 1, 2, 10.0, 0.0);
+    map_.edge(start_, exit, 15.0);
+
+    // segment 2: straight, 190m, stops every 60m
+    waypt_index_t prev = exit;
+    for (int pt = 1; pt <= 4; ++pt)
+      {
+        waypt_index_t wp = map_.node(2, 1, pt, 10.0 + pt * 60.0 - 58.0,
+                                     0.0, pt > 1);
+        map_.edge(prev, wp, slow_speed_);
+        prev = wp;
+      }
+    waypt_index_t slow_end = prev;
+
+    // segment 3: 240m around three sides of a rectangle
+    prev = exit;
+    const float corners[4][2] = {{12.0, 30.0}, {50.0, 30.0},
+                                 {150.0, 30.0}, {190.0, 30.0}};
+    for (int pt = 1; pt <= 4; ++pt)
+      {
+        waypt_index_t wp = map_.node(3, 1, pt, corners[pt-1][0],
+                                     corners[pt-1][1]);
+        map_.edge(prev, wp, 15.0);
+        prev = wp;
+      }
+    waypt_index_t fast_end = prev;
+
+    goal_ = map_.node(4, 1, 1, 200.0, 0.0);
+    map_.edge(slow_end, goal_, 15.0);
+    map_.edge(fast_end, goal_, 15.0);
+  }
+
+  TestMap map_;
+  waypt_index_t start_;
+  waypt_index_t goal_;
+  float slow_speed_;
+
+public:
+  RouteChoice(): slow_speed_(6.0) {}
+};
+
+TEST_F(RouteChoice, faster_road)
+{
+  Graph *graph = map_.graph();
+  RouteCost cost(*graph, 15.0);
+
+  WayPointEdgeList route =
+    GraphSearch::astar_search(*graph, start_, goal_, cost);
+  std::vector<int> segs = route_segments(*graph, route);
+  ASSERT_EQ(3u, segs.size());
+  EXPECT_EQ(3, segs[1]);
+
+  // the time on the slow road, for comparison
+  graph->edges[5].blocked = true;       // first edge into segment 3
+  WayPointEdgeList slow =
+    GraphSearch::astar_search(*graph, start_, goal_, cost);
+  segs = route_segments(*graph, slow);
+  ASSERT_EQ(3u, segs.size());
+  EXPECT_EQ(2, segs[1]);
+  EXPECT_LT(GraphSearch::route_time(*graph, cost, route),
+            GraphSearch::route_time(*graph, cost, slow));
+  delete graph;
+}
+
+TEST_F(RouteChoice, commander_speed_limit)
+{
+  // when the commander limits both roads to the same speed, and
+  // stops cost nothing, the shorter road is faster
+  Graph *graph = map_.graph();
+  RouteCost cost(*graph, slow_speed_);
+  cost.stop_wait = 0.0;
+  cost.decel = cost.accel = 100.0;
+  cost.update(*graph);
+
+  WayPointEdgeList route =
+    GraphSearch::astar_search(*graph, start_, goal_, cost);
+  std::vector<int> segs = route_segments(*graph, route);
+  ASSERT_EQ(3u, segs.size());
+  EXPECT_EQ(2, segs[1]);
+  delete graph;
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
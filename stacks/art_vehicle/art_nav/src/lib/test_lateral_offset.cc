@@ -0,0 +1,146 @@
+/*
+ *  Navigator lateral offset planner unit test
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <gtest/gtest.h>
+#include <art/infinity.h>
+#include <art_nav/lateral_offset.h>
+
+const float HALF_LANE = 2.0;            // m
+const float X0 = 10.0;                  // vehicle position (m)
+
+// a straight lane along the x axis, in 2m polygons
+poly_list_t straight_lane(void)
+{
+  poly_list_t lane;
+  for (int i = 0; i < 50; ++i)
+    {
+      poly p;
+      p.p1 = MapXY(2.0 * i, HALF_LANE);
+      p.p2 = MapXY(2.0 * (i+1), HALF_LANE);
+      p.p3 = MapXY(2.0 * (i+1), -HALF_LANE);
+      p.p4 = MapXY(2.0 * i, -HALF_LANE);
+      p.midpoint = MapXY(2.0 * i + 1.0, 0.0);
+      lane.push_back(p);
+    }
+  return lane;
+}
+
+class LateralOffsetTest: public testing::Test
+{
+protected:
+
+  virtual void SetUp()
+  {
+    lane_ = straight_lane();
+    planner_.configure(0.5, 0.0, 30.0, 0.2);
+  }
+
+  // plan around obstacle points (distance ahead, offset)
+  bool plan(int npoints, const float points[][2])
+  {
+    EXPECT_TRUE(planner_.start(lane_, MapXY(X0, 0.0)));
+    for (int i = 0; i < npoints; ++i)
+      planner_.add_obstacle(MapXY(X0 + points[i][0], points[i][1]));
+    return planner_.plan();
+  }
+
+  poly_list_t lane_;
+  LateralOffset planner_;
+};
+
+TEST_F(LateralOffsetTest, no_obstacles)
+{
+  EXPECT_TRUE(plan(0, NULL));
+  EXPECT_FLOAT_EQ(0.0, planner_.current());
+  EXPECT_FLOAT_EQ(0.0, planner_.target());
+  EXPECT_EQ(0u, planner_.in_lane());
+  EXPECT_NEAR(HALF_LANE - 1.06, planner_.lane_space(), 0.001);
+  EXPECT_EQ(Infinite::distance, planner_.free_distance());
+}
+
+TEST_F(LateralOffsetTest, lane_edge)
+{
+  // in the lane, but clear of the vehicle at the center
+  const float points[][2] = {{15.0, -1.8}};
+  EXPECT_TRUE(plan(1, points));
+  EXPECT_FLOAT_EQ(0.0, planner_.target());
+  EXPECT_EQ(1u, planner_.in_lane());
+}
+
+TEST_F(LateralOffsetTest, partly_blocked)
+{
+  // needs an offset of 1.56m from the obstacle: 0.75 to the left
+  const float points[][2] = {{15.0, -1.0}, {15.5, -1.2}, {16.0, -1.9}};
+  EXPECT_TRUE(plan(3, points));
+  EXPECT_FLOAT_EQ(0.75, planner_.target());
+  EXPECT_EQ(3u, planner_.in_lane());
+
+  // ramps over the first few meters, then holds
+  EXPECT_FLOAT_EQ(0.0, planner_.offset(0.0));
+  EXPECT_NEAR(0.4, planner_.offset(2.0), 0.001);
+  EXPECT_FLOAT_EQ(0.75, planner_.offset(10.0));
+
+  // on the other side of the lane, avoids to the right
+  const float left[][2] = {{15.0, 1.0}};
+  EXPECT_TRUE(plan(1, left));
+  EXPECT_FLOAT_EQ(-0.75, planner_.target());
+}
+
+TEST_F(LateralOffsetTest, fully_blocked)
+{
+  const float points[][2] = {{20.0, 0.0}};
+  EXPECT_FALSE(plan(1, points));
+  EXPECT_NEAR(20.0 - 3.5, planner_.free_distance(), 0.001);
+
+  // possible when allowed partly out of the lane
+  planner_.configure(0.5, 1.0, 30.0, 0.2);
+  EXPECT_TRUE(plan(1, points));
+  EXPECT_LE(1.56, fabsf(planner_.target()));
+}
+
+TEST_F(LateralOffsetTest, too_close)
+{
+  // not enough distance to ramp over
+  const float points[][2] = {{5.0, -1.0}};
+  EXPECT_FALSE(plan(1, points));
+  EXPECT_NEAR(5.0 - 3.5, planner_.free_distance(), 0.001);
+
+  // possible with a steeper ramp
+  planner_.configure(0.5, 0.0, 30.0, 0.5);
+  EXPECT_TRUE(plan(1, points));
+}
+
+TEST_F(LateralOffsetTest, passed)
+{
+  // behind the vehicle, or beside it with room to spare
+  const float points[][2] = {{-2.0, 0.0}, {0.0, -1.9}};
+  EXPECT_TRUE(plan(2, points));
+  EXPECT_FLOAT_EQ(0.0, planner_.target());
+}
+
+TEST_F(LateralOffsetTest, hold_target)
+{
+  // stays at the previous target while it remains clear
+  const float points[][2] = {{15.0, -1.0}};
+  EXPECT_TRUE(plan(1, points));
+  EXPECT_FLOAT_EQ(0.75, planner_.target());
+  EXPECT_TRUE(plan(1, points));
+  EXPECT_FLOAT_EQ(0.75, planner_.target());
+
+  // then returns to the center
+  EXPECT_TRUE(plan(0, NULL));
+  EXPECT_FLOAT_EQ(0.0, planner_.target());
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,96 @@
+/*
+ *  Commander mission unit test
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <ros/package.h>
+
+#include <art_map/RNDF.h>
+#include <art_nav/Mission.h>
+
+// road map and mission read from the files, as the commander does
+class MissionFiles
+{
+public:
+  MissionFiles(const std::string &rndf_name, const std::string &mdf_name):
+    rndf_(ros::package::getPath("art_map") + "/rndf/" + rndf_name),
+    mdf_(ros::package::getPath("art_nav") + "/test/" + mdf_name),
+    mission_(NULL)
+  {
+    if (!rndf_.is_valid || !mdf_.is_valid)
+      return;
+    rndf_.populate_graph(graph_);
+    graph_.find_mapxy();
+    mdf_.add_speed_limits(graph_);
+    mission_ = new Mission(mdf_);
+    if (!mission_->populate_elementid(graph_))
+      {
+        delete mission_;
+        mission_ = NULL;
+      }
+  }
+  ~MissionFiles()
+  {
+    delete mission_;
+  }
+
+  Graph graph_;
+  RNDF rndf_;
+  MDF mdf_;
+  Mission *mission_;
+};
+
+TEST(Mission, resume)
+{
+  MissionFiles running("prc_large.rndf", "prc_large.mdf");
+  ASSERT_TRUE(running.mission_ != NULL);
+  ASSERT_EQ(5, running.mission_->remaining_points());
+  EXPECT_TRUE(running.mission_->nextPoint());
+  EXPECT_TRUE(running.mission_->nextPoint());
+  ElementID goal = running.mission_->current_checkpoint_elementid();
+  ElementID goal2 = running.mission_->next_checkpoint_elementid();
+
+  // reloaded map, same MDF: continue from the third checkpoint
+  MissionFiles reloaded("prc_large.rndf", "prc_large.mdf");
+  ASSERT_TRUE(reloaded.mission_ != NULL);
+  ASSERT_TRUE(reloaded.mission_->resume(*running.mission_,
+                                        reloaded.graph_));
+  EXPECT_EQ(3, reloaded.mission_->remaining_points());
+  EXPECT_EQ(5, reloaded.mission_->current_checkpoint_id());
+  EXPECT_EQ(goal, reloaded.mission_->current_checkpoint_elementid());
+  EXPECT_EQ(goal2, reloaded.mission_->next_checkpoint_elementid());
+  EXPECT_TRUE(reloaded.mission_->compare(*running.mission_));
+}
+
+TEST(Mission, resumeOther)
+{
+  MissionFiles running("prc_large.rndf", "prc_large.mdf");
+  MissionFiles other("prc_large.rndf", "prc_large.mdf");
+  ASSERT_TRUE(running.mission_ != NULL);
+  ASSERT_TRUE(other.mission_ != NULL);
+  EXPECT_TRUE(running.mission_->nextPoint());
+
+  // the same checkpoints in another order are a different mission,
+  // left unchanged
+  std::reverse(other.mission_->checkpoint_ids.begin(),
+               other.mission_->checkpoint_ids.end());
+  std::reverse(other.mission_->checkpoint_elementid.begin(),
+               other.mission_->checkpoint_elementid.end());
+  Mission before(*other.mission_);
+  EXPECT_FALSE(other.mission_->resume(*running.mission_, other.graph_));
+  EXPECT_TRUE(other.mission_->compare(before));
+  EXPECT_EQ(15, other.mission_->current_checkpoint_id());
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,97 @@
+/*
+ *  Navigator stop profile unit test
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <math.h>
+#include <gtest/gtest.h>
+#include <art_nav/stop_profile.h>
+
+const float DECEL = 2.0;                // m/s^2
+const float JERK = 2.0;                 // m/s^3
+const float DT = 0.01;                  // seconds
+
+// follows a plan to the end, checking it stays within the limits,
+// returns the distance travelled
+float follow(StopProfile &profile, float decel, float jerk)
+{
+  float travelled = 0.0;
+  float prev_accel = profile.accel();
+  for (int i = 0; i < 10000 && profile.speed() > 0.0; ++i)
+    {
+      float v = profile.speed();
+      profile.advance(DT);
+      travelled += (v + profile.speed()) / 2.0 * DT;
+      float accel = profile.accel();
+      EXPECT_GE(accel, -decel - 0.001);
+      EXPECT_LE(fabsf(accel - prev_accel), jerk * DT + 0.001);
+      prev_accel = accel;
+    }
+  EXPECT_FLOAT_EQ(0.0, profile.speed());
+  return travelled;
+}
+
+TEST(StopProfile, steady_speed)
+{
+  for (float speed = 1.0; speed <= 15.0; speed += 1.0)
+    {
+      float distance = StopProfile::stopping_distance(speed, DECEL, JERK);
+      EXPECT_NEAR(speed, StopProfile::max_speed(distance, DECEL, JERK),
+                  0.001);
+
+      StopProfile profile;
+      EXPECT_TRUE(profile.plan(distance, speed, 0.0, DECEL, JERK));
+      EXPECT_NEAR(distance, profile.remaining(), 0.001);
+      EXPECT_NEAR(distance, follow(profile, DECEL, JERK), 0.02)
+        << "from " << speed << " m/s";
+      EXPECT_NEAR(0.0, profile.remaining(), 0.01);
+    }
+}
+
+TEST(StopProfile, gentle_stop)
+{
+  // with more room than needed, the peak deceleration is lower
+  StopProfile profile;
+  EXPECT_TRUE(profile.plan(60.0, 10.0, 0.0, DECEL, JERK));
+  EXPECT_NEAR(60.0, follow(profile, 1.0, JERK), 0.02);
+}
+
+TEST(StopProfile, already_slowing)
+{
+  // replanning part way through a stop starts from the deceleration
+  // already planned
+  StopProfile profile;
+  EXPECT_TRUE(profile.plan(20.0, 8.0, -1.5, DECEL, JERK));
+  EXPECT_FLOAT_EQ(-1.5, profile.accel());
+  EXPECT_NEAR(20.0, follow(profile, DECEL, JERK), 0.02);
+}
+
+TEST(StopProfile, too_close)
+{
+  // too fast to stop in time: brake as hard as allowed
+  StopProfile profile;
+  float distance = StopProfile::stopping_distance(10.0, DECEL, JERK);
+  EXPECT_FALSE(profile.plan(distance - 5.0, 10.0, 0.0, DECEL, JERK));
+  EXPECT_NEAR(distance, follow(profile, DECEL, JERK), 0.02);
+}
+
+TEST(StopProfile, stopped)
+{
+  StopProfile profile;
+  EXPECT_FALSE(profile.active());
+  EXPECT_TRUE(profile.plan(3.0, 0.0, 0.0, DECEL, JERK));
+  EXPECT_TRUE(profile.active());
+  EXPECT_FLOAT_EQ(0.0, profile.speed());
+  EXPECT_FLOAT_EQ(3.0, profile.remaining());
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -10,80 +10,95 @@
 
 #include "navigator_internal.h"
 #include "Controller.h"
+#include "course.h"
+#include "obstacle.h"
 #include "avoid.h"
 
 #include "lane_edge.h"
-#include "safety.h"
 
 Avoid::Avoid(Navigator *navptr, int _verbose):
   Controller(navptr, _verbose)
 {
   lane_edge = new LaneEdge(navptr, _verbose);
-  safety = new Safety(navptr, _verbose);
   reset_me();
 };
 
 Avoid::~Avoid()
 {
   delete lane_edge;
-  delete safety;
 };
 
-void Avoid::configure()
-{
-  // left and right lane offsets for lane_edge controller
-  left_offset_ratio = cf->ReadFloat(section, "left_offset_ratio", 0.8);
-  ART_MSG(2, "\toffset ratio to left of lane is %.3f", left_offset_ratio);
-  right_offset_ratio = cf->ReadFloat(section, "right_offset_ratio", -0.8);
-  ART_MSG(2, "\toffset ratio to right of lane is %.3f", right_offset_ratio);
-
-  lane_edge->configure(cf, section);
-  safety->configure(cf, section);
-}
-
-// avoid obstacles in travel lane
+// avoid obstacles partly blocking the travel lane
+//
+// Plans a lateral offset from the lane center that clears all the
+// obstacle points on the road ahead, and steers for it instead of
+// stopping.  The offset returns to the center once they are passed.
 //
 // entry:
 //	pcmd is planned output from primary lane following controller
 //	incmd is a copy of the original primary controller input
 // exit:
-//	pcmd updated based on safety considerations
+//	pcmd steering around the obstacles at no more than avoid_speed,
+//	unless the result is NotApplicable, Unsafe or Blocked
 // result:
-//	from safety controller
+//	NotApplicable, if nothing in the lane to avoid;
+//	Blocked, if no way around within the lane;
+//	from safety controller, otherwise
 //
 Controller::result_t Avoid::control(pilot_command_t &pcmd,
 				     pilot_command_t incmd)
 {
-  // make copies of primary controller output
-  pilot_command_t right_cmd = pcmd;
-  pilot_command_t left_cmd = pcmd;
-  result_t result = safety->control(pcmd);
-  if (result != OK)			// safety modified pcmd?
+  const Obstacle::PtCloud *points = obstacle->points();
+  planner_.configure(config_->avoid_clearance, config_->avoid_outside_lane,
+                     config_->avoid_horizon, config_->avoid_slope);
+  if (points == NULL
+      || !planner_.start(course->plan,
+                         MapXY(estimate->pose.pose.position)))
+    {
+      // no obstacle data or no lane to follow
+      reset_me();
+      return NotApplicable;
+    }
+
+  for (unsigned i = 0; i < points->points.size(); ++i)
+    planner_.add_obstacle(MapXY(points->points[i].x, points->points[i].y));
+  bool clear = planner_.plan();
+
+  ROS_DEBUG("avoid: offset %.3f, target %.3f, %u points in lane, "
+            "free for %.3fm", planner_.current(), planner_.target(),
+            planner_.in_lane(), planner_.free_distance());
+
+  if (!clear)
+    return Blocked;
+
+  // nothing in the way, and already back in the lane center?
+  static const float centered = 0.1;
+  if (planner_.in_lane() == 0
+      && Epsilon::equal(planner_.target(), 0.0)
+      && fabsf(planner_.current()) < centered)
     {
-      // Try some avoidance maneuvers.  Each reruns the safety
-      // controller on its output before returning.
-      result_t edge_right = lane_edge->control(right_cmd, right_offset_ratio);
-      result_t edge_left = lane_edge->control(left_cmd, left_offset_ratio);
+      reset_me();
+      return NotApplicable;
+    }
+
+  // steer for the planned offset ahead
+  float offset = planner_.offset(config_->min_lane_steer_dist);
+  float offset_ratio = 0.0;
+  if (planner_.lane_space() > 0.0)
+    offset_ratio = offset / planner_.lane_space();
+  else if (fabsf(offset) >= centered)
+    return Blocked;                     // no room in this lane
 
-      if (std::min(edge_right, edge_left) < result)
-	{
-	  if (edge_left < edge_right)	// left side is clearer?
-	    {
-	      if (verbose >= 2)
-		ART_MSG(5, "avoiding to left (%s < %s)",
-			result_name(edge_left), result_name(edge_right));
-	      pcmd = left_cmd;
-	      result = edge_left;
-	    }
-	  else				// right side at least as good?
-	    {
-	      if (verbose >= 2)
-		ART_MSG(5, "avoiding to right (%s >= %s)",
-			result_name(edge_left), result_name(edge_right));
-	      pcmd = right_cmd;
-	      result = edge_right;
-	    }
-	}
+  pilot_command_t avoid_cmd = incmd;
+  avoid_cmd.velocity = fminf(incmd.velocity, config_->avoid_speed);
+  result_t result = lane_edge->control(avoid_cmd, offset_ratio);
+  if (result < Unsafe)
+    {
+      if (!active_)
+        ROS_INFO("steering around obstacles in lane, offset %.2fm",
+                 planner_.target());
+      active_ = true;
+      pcmd = avoid_cmd;
     }
 
   trace("avoid controller", pcmd, result);
@@ -96,10 +111,11 @@ void Avoid::reset(void)
   trace_reset("Avoid");
   reset_me();
   lane_edge->reset();
-  safety->reset();
 }
 
 // reset this controller only
 void Avoid::reset_me(void)
 {
+  active_ = false;
+  planner_.reset();
 }
@@ -12,8 +12,9 @@
 #ifndef __AVOID_HH__
 #define __AVOID_HH__
 
+#include <art_nav/lateral_offset.h>
+
 class LaneEdge;
-class Safety;
 
 class Avoid: public Controller
 {
@@ -21,18 +22,18 @@ public:
 
   Avoid(Navigator *navptr, int _verbose);
   ~Avoid();
-  void configure();
   result_t control(pilot_command_t &pcmd, pilot_command_t incmd);
   void reset(void);
 
+  // true while steering around obstacles, until back in the lane center
+  bool active(void) const {return active_;}
+
 private:
 
-  // .cfg variables
-  float left_offset_ratio;
-  float right_offset_ratio;
+  bool active_;
+  LateralOffset planner_;
 
   LaneEdge *lane_edge;
-  Safety *safety;
 
   void reset_me(void);
 };
@@ -245,15 +245,15 @@ void Course::desired_heading(pilot_command_t &pcmd, float offset_ratio)
       // Look in plan
       aim_index = pops->getPolyIndex(plan, aim_poly);
 
-      poly_list_t edge;
-      pops->add_polys_for_waypts(plan,edge,order->waypt[0].id,
+      edge_polys.clear();
+      pops->add_polys_for_waypts(plan, edge_polys, order->waypt[0].id,
                                  order->waypt[1].id);
 
       // get closest polygon to estimated position
       int nearby_poly =
-        pops->getClosestPoly(edge, MapPose(estimate->pose.pose));
+        pops->getClosestPoly(edge_polys, MapPose(estimate->pose.pose));
       if (nearby_poly >= 0)
-	nearby_poly = pops->getPolyIndex(plan,edge.at(nearby_poly));
+	nearby_poly = pops->getPolyIndex(plan, edge_polys.at(nearby_poly));
       else
         nearby_poly = pops->getClosestPoly(plan, MapPose(estimate->pose.pose));
 
@@ -451,17 +451,17 @@ void Course::end_run_cycle()
 //
 int Course::find_aim_polygon(poly_list_t &lane)
 {
-
-  poly_list_t edge;
-  pops->add_polys_for_waypts(lane,edge,order->waypt[0].id,
+  edge_polys.clear();
+  pops->add_polys_for_waypts(lane, edge_polys, order->waypt[0].id,
 			     order->waypt[1].id);
   
   // get closest polygon to estimated position
-  int nearby_poly = pops->getClosestPoly(edge, MapPose(estimate->pose.pose));
+  int nearby_poly =
+    pops->getClosestPoly(edge_polys, MapPose(estimate->pose.pose));
   if (nearby_poly < 0)
     nearby_poly = pops->getClosestPoly(lane, MapPose(estimate->pose.pose));
   else
-    nearby_poly = pops->getPolyIndex(lane,edge.at(nearby_poly));
+    nearby_poly = pops->getPolyIndex(lane, edge_polys.at(nearby_poly));
 
   if (nearby_poly < 0)
     return -1;
@@ -1353,9 +1353,8 @@ float Course::get_yaw_spring_system(const Polar& aim_polar,
   float velocity = fmaxf(curr_velocity, Steering::steer_speed_min);
   nav_msgs::Odometry front_est;  
   Estimate::front_axle_pose(*estimate, front_est);
-  ros::Duration frequency(1.0 / art_msgs::ArtHertz::NAVIGATOR);
   ros::Time time_in_future = (ros::Time::now()
-                              + frequency
+                              + nav->cycle
                               + ros::Duration(velocity * spring_lookahead));
   nav_msgs::Odometry pos_est;
   Estimate::control_pose(front_est, time_in_future, pos_est);
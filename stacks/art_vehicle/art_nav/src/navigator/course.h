@@ -154,6 +154,24 @@ class Course
   /** @brief reset course */
   void reset(void);
 
+  /** @brief restore road block memory from a warm restart checkpoint */
+  void restore(const art_msgs::NavigatorCheckpoint &chk)
+  {
+    saved_replan_num = chk.saved_replan_num;
+    for (unsigned i = 0; i < art_msgs::Order::N_WAYPTS; ++i)
+      saved_waypt_id[i] = ElementID(chk.saved_waypt[i]);
+    passing_left = chk.passing_left;
+  }
+
+  /** @brief save road block memory in a warm restart checkpoint */
+  void save(art_msgs::NavigatorCheckpoint &chk) const
+  {
+    chk.saved_replan_num = saved_replan_num;
+    for (unsigned i = 0; i < art_msgs::Order::N_WAYPTS; ++i)
+      chk.saved_waypt[i] = saved_waypt_id[i].toMapID();
+    chk.passing_left = passing_left;
+  }
+
   /** @brief are id1 and id2 in the same lane?
    *
    *  Beware of a segment that loops back to itself.  In that case,
@@ -307,6 +325,7 @@ class Course
   // minimize dynamic memory allocation, instead of making them
   // automatic.
   ElementID plan_waypt[art_msgs::Order::N_WAYPTS]; //< waypts in the plan
+  poly_list_t edge_polys;		//< polygons near the next way-point
   bool new_plan_lanes;			//< new lanes since plan made
   bool waypoint_checked;
   int poly_index;			// index in polygons of odom pose
@@ -189,6 +189,24 @@ void Estop::reset(void)
   run->reset();
 }
 
+/** restore state from a warm restart checkpoint
+ *
+ *  @pre navdata already restored
+ */
+void Estop::restore(const art_msgs::NavigatorCheckpoint &chk)
+{
+  reset();
+  state = chk.navdata.estop.state;
+  prev = state;
+  run->restore(chk);
+}
+
+/** save state in a warm restart checkpoint */
+void Estop::save(art_msgs::NavigatorCheckpoint &chk) const
+{
+  run->save(chk);
+}
+
 void Estop::reset_me(void)
 {
   state = NavEstopState();		// initial state
@@ -29,6 +29,8 @@ public:
   ~Estop();
   result_t control(pilot_command_t &pcmd);
   void reset(void);
+  void restore(const art_msgs::NavigatorCheckpoint &chk);
+  void save(art_msgs::NavigatorCheckpoint &chk) const;
 
   NavEstopState State(void)
   {
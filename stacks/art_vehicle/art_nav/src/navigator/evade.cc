@@ -45,22 +45,6 @@ Evade::~Evade()
   delete safety;
 }
 
-void Evade::configure()
-{
-  evade_delay = cf->ReadFloat(section, "evade_delay", 7.0);
-  ART_MSG(2, "\tevade delay is %.1f seconds", evade_delay);
-
-  evade_offset_ratio = cf->ReadFloat(section, "evade_offset_ratio", -2.0);
-  ART_MSG(2, "\tevade offset ratio is %.3f", evade_offset_ratio);
-
-  evasion_speed = cf->ReadFloat(section, "evasion_speed", 3.0);
-  ART_MSG(2, "\tevasion speed is %.1f m/s", evasion_speed);
-
-  halt->configure(cf, section);
-  lane_edge->configure(cf, section);
-  safety->configure(cf, section);
-}
-
 // This controller is called from Road when a car is approaching in
 // the current lane.  Its job is to leave the lane to the right, wait
 // until there is no longer a car approaching, then return Finished.
@@ -86,7 +70,7 @@ Controller::result_t Evade::control(pilot_command_t &pcmd)
       // fall through
 
     case Leave:
-      if (course->in_lane(estimate->pos))	// still in lane?
+      if (course->in_lane(MapPose(estimate->pose.pose))) // still in lane?
 	{
 	  // leave lane as long as car is still approaching.
 	  if (obstacle->car_approaching())
@@ -110,7 +94,7 @@ Controller::result_t Evade::control(pilot_command_t &pcmd)
       // TODO: include obstacle->observation(Nearest_forward).time in
       // the delay?
       course->turn_signals_both_on();
-      evade_timer->Start(evade_delay);
+      evade_timer->Start(config_->evade_delay);
       // fall through
 
     case Wait:
@@ -155,12 +139,12 @@ Controller::result_t Evade::control(pilot_command_t &pcmd)
 Controller::result_t Evade::leave_lane_right(pilot_command_t &pcmd)
 {
   // go slowly while leaving lane
-  pcmd.velocity = fminf(pcmd.velocity, evasion_speed);
+  pcmd.velocity = fminf(pcmd.velocity, config_->evasion_speed);
 
   result_t result = Unsafe;
-  if (obstacle->observer_clear(ObserverID::Adjacent_right))
+  if (obstacle->observer_clear(Observation::Adjacent_right))
     {
-      result = lane_edge->control(pcmd, evade_offset_ratio);
+      result = lane_edge->control(pcmd, config_->evade_offset_ratio);
       if (result < Unsafe)
 	{
 	  // evade right did not stop immediately
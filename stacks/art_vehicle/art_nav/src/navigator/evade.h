@@ -23,17 +23,11 @@ public:
 
   Evade(Navigator *navptr, int _verbose);
   ~Evade();
-  void configure();
   result_t control(pilot_command_t &pcmd);
   void reset(void);
 
 private:
 
-  // .cfg variables
-  float evade_delay;
-  float evade_offset_ratio;
-  float evasion_speed;
-
   // simple state machine
   typedef enum
     {
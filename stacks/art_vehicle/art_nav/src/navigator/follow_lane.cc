@@ -113,7 +113,7 @@ FollowLane::approaching_waypoint_type(WayPointNode &stop_point)
 FollowLane::FollowLane(Navigator *navptr, int _verbose):
   Controller(navptr, _verbose)
 {
-  //avoid = new Avoid(navptr, _verbose);
+  avoid = new Avoid(navptr, _verbose);
   follow_safely = new FollowSafely(navptr, _verbose);
   slow_for_curves = new SlowForCurves(navptr, _verbose);
   stop_area =	new StopArea(navptr, _verbose);
@@ -123,7 +123,7 @@ FollowLane::FollowLane(Navigator *navptr, int _verbose):
 
 FollowLane::~FollowLane()
 {
-  //delete avoid;
+  delete avoid;
   delete follow_safely;
   delete slow_for_curves;
   delete stop_area;
@@ -144,9 +144,7 @@ Controller::result_t FollowLane::control(pilot_command_t &pcmd)
     pcmd.velocity=fminf(pcmd.velocity,1.0); //Make this config
 
 
-#if 0 // not doing avoid right now
   pilot_command_t incmd = pcmd;		// copy of original input
-#endif // not doing avoid right now
 
   // set approaching way-point type
   way_type_t wtype = approaching_waypoint_type(course->stop_waypt);
@@ -201,6 +199,8 @@ Controller::result_t FollowLane::control(pilot_command_t &pcmd)
 
   // adjust speed to maintain a safe following distance in the lane
   result_t result = follow_safely->control(pcmd);
+  bool obstacle_ahead = (result == Blocked
+                         || pcmd.velocity < incmd.velocity);
 
   // reduce speed if approaching sharp turn.
   slow_for_curves->control(pcmd);
@@ -241,14 +241,20 @@ Controller::result_t FollowLane::control(pilot_command_t &pcmd)
   // check if way-point reached, ignoring stop lines and U-turns
   course->lane_waypoint_reached();
 
-#if 0 // not doing avoid right now
-  if (result == OK)			// still moving, no Collision?
+  // Steer around obstacles partly blocking the lane, instead of
+  // stopping for them.  Not within a safety area, where no passing
+  // is allowed, nor for a car approaching.
+  if (!in_safety_area
+      && (result == OK || result == Blocked)
+      && (obstacle_ahead || avoid->active()))
     {
-      result = avoid->control(pcmd, incmd);
-      if (result == Blocked)
-	result = Unsafe;		// return Blocked only for passing
+      result_t avoid_result = avoid->control(pcmd, incmd);
+      if (avoid_result < Unsafe)	// going around?
+	{
+	  navdata->lane_blocked = false;
+	  result = avoid_result;
+	}
     }
-#endif // not doing avoid right now
 
   trace("follow_lane controller", pcmd, result);
 
@@ -260,7 +266,7 @@ void FollowLane::reset(void)
 {
   trace_reset("FollowLane");
   reset_me();
-  //avoid->reset();
+  avoid->reset();
   follow_safely->reset();
   slow_for_curves->reset();
   stop_area->reset();
@@ -11,7 +11,7 @@
 #ifndef __FOLLOW_LANE_HH__
 #define __FOLLOW_LANE_HH__
 
-//class Avoid;
+class Avoid;
 class FollowSafely;
 class SlowForCurves;
 class StopArea;
@@ -40,7 +40,7 @@ private:
       ZoneExit,
     } way_type_t;
 
-  //Avoid       *avoid;
+  Avoid		*avoid;
   FollowSafely	*follow_safely;
   SlowForCurves *slow_for_curves;
   StopArea	*stop_area;
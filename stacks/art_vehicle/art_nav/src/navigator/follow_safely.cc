@@ -44,7 +44,7 @@ Controller::result_t FollowSafely::control(pilot_command_t &pcmd)
   navdata->lane_blocked = false;
 
   result_t result = OK;
-  art_msgs::Observation fobs =
+  const art_msgs::Observation &fobs =
     obstacle->observation(art_msgs::Observation::Nearest_forward);
 
   ROS_DEBUG("Nearest_forward: C%d A%d, dist %.3f, time %.3f, vel %.3f",
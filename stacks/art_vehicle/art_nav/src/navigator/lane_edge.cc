@@ -25,11 +25,6 @@ LaneEdge::~LaneEdge()
   delete safety;
 }
 
-void LaneEdge::configure()
-{
-  safety->configure(cf, section);
-}
-
 // steer towards the edge of the lane
 //
 // entry:
@@ -20,7 +20,6 @@ public:
 
   LaneEdge(Navigator *navptr, int _verbose);
   ~LaneEdge();
-  void configure();
   result_t control(pilot_command_t &pcmd, float offset_ratio);
   void reset(void);
 
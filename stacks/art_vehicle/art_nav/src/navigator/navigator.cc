@@ -15,6 +15,7 @@
 #include "course.h"
 
 #include "obstacle.h"
+#include <art_nav/NavRoadState.h>
 
 // subordinate controller classes
 #include "estop.h"
@@ -28,9 +29,11 @@
 
    @todo Add ROS-style obstacle detection.
 */
-Navigator::Navigator(nav_msgs::Odometry *odom_msg)
+Navigator::Navigator(nav_msgs::Odometry *odom_msg, double hz):
+  pose_history(ros::Duration(1.0))      // as far as control_pose() goes
 {
   odometry = odom_msg;
+  cycle = ros::Duration(1.0 / hz);
 
   order.behavior.value = art_msgs::Behavior::Pause; // initial order
 
@@ -90,6 +93,42 @@ pilot_command_t Navigator::navigate(void)
   return pcmd;
 }
 
+/** Restore state saved by a previous navigator process.
+ *
+ *  Controllers below the Road level start from their reset states,
+ *  and the course plan is rebuilt from the restored order when the
+ *  next road map arrives.
+ *
+ *  @return true if checkpoint accepted.
+ */
+bool Navigator::restore(const art_msgs::NavigatorCheckpoint &chk)
+{
+  if (chk.navdata.estop.state >= NavEstopState::N_states
+      || chk.navdata.road.state >= NavRoadState::N_states)
+    {
+      ROS_WARN("invalid navigator checkpoint states (%u, %u) ignored",
+               chk.navdata.estop.state, chk.navdata.road.state);
+      return false;
+    }
+
+  order = chk.order;
+  navdata = chk.navdata;
+  course->restore(chk);
+  obstacle->restore(chk);
+  estop->restore(chk);
+  return true;
+}
+
+/** Save state for a warm restart. */
+void Navigator::save(art_msgs::NavigatorCheckpoint &chk) const
+{
+  chk.order = order;
+  chk.navdata = navdata;
+  course->save(chk);
+  obstacle->save(chk);
+  estop->save(chk);
+}
+
 /** Configure parameters */
 void Navigator::configure()
 {
@@ -28,8 +28,10 @@
 #include <art_msgs/ArtHertz.h>
 #include <art_map/euclidean_distance.h>
 #include <art_map/PolyOps.h>
+#include <art_map/pose_history.h>
 
 #include <art_msgs/Behavior.h>
+#include <art_msgs/NavigatorCheckpoint.h>
 #include <art_msgs/NavigatorCommand.h>
 #include <art_msgs/NavigatorState.h>
 #include <art_msgs/ObservationArray.h>
@@ -78,9 +80,11 @@ public:
   art_msgs::NavigatorState navdata;    // current navigator state data
   nav_msgs::Odometry estimate;         // estimated control position
   nav_msgs::Odometry *odometry;
+  PoseHistory pose_history;            // recent odometry poses
+  ros::Duration cycle;                 // nominal navigator cycle duration
 
   // public methods
-  Navigator(nav_msgs::Odometry *odom_msg);
+  Navigator(nav_msgs::Odometry *odom_msg, double hz);
   ~Navigator();
 
   // configure parameters
@@ -98,6 +102,10 @@ public:
   // main navigator entry point -- called once every cycle
   pilot_command_t navigate(void);
 
+  // warm restart checkpoints
+  bool restore(const art_msgs::NavigatorCheckpoint &chk);
+  void save(art_msgs::NavigatorCheckpoint &chk) const;
+
   // trace controller state
   void trace_controller(const char *name, pilot_command_t &pcmd)
   {
@@ -12,8 +12,9 @@
 #ifndef _NAV_TIMER_HH_
 #define _NAV_TIMER_HH_
 
-#include <sys/time.h>
-#include <time.h>
+#include <math.h>
+#include <ros/ros.h>
+#include <art/rates.h>
 
 /** @brief Navigator node timer class.
  *
@@ -23,8 +24,12 @@ class NavTimer
 {
  public:
 
-  /** @brief Constructor */
-  NavTimer()
+  /** @brief Constructor
+   *
+   *  @param cycle nominal navigator cycle duration
+   */
+  NavTimer(const ros::Duration &cycle):
+    cycle_(cycle)
     {
       this->Cancel();
     };
@@ -43,14 +48,18 @@ class NavTimer
    *  not contribute to timer expiration.  That allows timers to pause
    *  while the vehicle is pausing.  It should not immediately begin
    *  passing after pausing behind a stopped vehicle, for example.
+   *
+   *  The time actually elapsed since the previous check is used, so
+   *  expiration does not depend on the configured cycle rate.  A gap
+   *  much longer than one cycle counts as a single cycle.
    */
   virtual bool Check(void)
   {
     if (!timer_running)
       return false;			// timer not set
 
-    // decrement time remaining by the duration of one cycle
-    time_remaining -= (1.0 / art_msgs::ArtHertz::NAVIGATOR);
+    // decrement time remaining by the duration of this cycle
+    time_remaining -= ArtRates::elapsed(last_check_, cycle_);
     return (time_remaining <= 0.0);
   }
 
@@ -66,17 +75,40 @@ class NavTimer
     Start(duration);
   }
 
+  /** @brief Resume a timer saved by Remaining().
+   *
+   *  @param remaining seconds left, negative if not running
+   */
+  virtual void Resume(double remaining)
+  {
+    if (remaining < 0.0)
+      Cancel();
+    else
+      Start(remaining);
+  }
+
+  /** @brief Seconds remaining, negative if not running. */
+  double Remaining(void) const
+  {
+    if (!timer_running)
+      return -1.0;
+    return fmax(time_remaining, 0.0);
+  }
+
   /** @brief Start timer. */
   virtual void Start(double duration)
   {
     timer_running = true;
     time_remaining = duration;
+    last_check_ = ros::Time::now();
   }
 
  protected:
 
   double time_remaining;		//< time remaining until done
   bool timer_running;			//< true when timer running
+  ros::Time last_check_;		//< time of previous check
+  ros::Duration cycle_;			//< nominal cycle duration
 };
 
 #endif // _NAV_TIMER_HH_
@@ -36,21 +36,25 @@ Obstacle::Obstacle(Navigator *_nav, int _verbose)
   // TODO Make this a parameter
   max_range = 80.0;
 
+  ros::NodeHandle mynh("~");
+  mynh.param("max_points_age", max_points_age_, 0.5);
+  ROS_INFO("use obstacle points received within %.3f sec", max_points_age_);
+
   // initialize observers state to all clear in case that driver is
   // not subscribed or not publishing data
-  obstate.obs.resize(Observation::N_Observers);
+  obs_default_.obs.resize(Observation::N_Observers);
   for (unsigned i = 0; i < Observation::N_Observers; ++i)
     {
-      obstate.obs[i].oid = i;
-      obstate.obs[i].clear = true;
-      obstate.obs[i].applicable = true;
+      obs_default_.obs[i].oid = i;
+      obs_default_.obs[i].clear = true;
+      obs_default_.obs[i].applicable = true;
     }
 
   // exception: initialize Nearest_forward not applicable
-  obstate.obs[Observation::Nearest_forward].applicable = false;
+  obs_default_.obs[Observation::Nearest_forward].applicable = false;
 
   // allocate timers
-  blockage_timer = new NavTimer();
+  blockage_timer = new NavTimer(nav->cycle);
   was_stopped = false;
 
   reset();
@@ -59,6 +63,9 @@ Obstacle::Obstacle(Navigator *_nav, int _verbose)
   obs_sub_ = node.subscribe("observations", 10,
                             &Obstacle::observers_message, this,
                             ros::TransportHints().tcpNoDelay(true));
+  points_sub_ = node.subscribe("obstacles/points_on_road", 1,
+                               &Obstacle::points_message, this,
+                               ros::TransportHints().tcpNoDelay(true));
 }
 
 // is there a car approaching from ahead in our lane?
@@ -70,8 +77,8 @@ bool Obstacle::car_approaching()
   if (config_->offensive_driving)
     return false;
 
-  Observation::_oid_type oid = Observation::Nearest_forward;
-  if (obstate.obs[oid].clear || !obstate.obs[oid].applicable)
+  const Observation &obs = observation(Observation::Nearest_forward);
+  if (obs.clear || !obs.applicable)
     {
       if (verbose >= 4)
 	ART_MSG(6, "no known car approaching from ahead");
@@ -80,7 +87,7 @@ bool Obstacle::car_approaching()
 
   // estimate absolute speed of obstacle from closing velocity and
   // vehicle speed
-  float rel_speed = obstate.obs[oid].velocity;
+  float rel_speed = obs.velocity;
 #if 0
   // use vehicle speed at time of observation
   float abs_speed = rel_speed - obstate.odom.twist.twist.linear.x;
@@ -181,18 +188,47 @@ bool Obstacle::in_lane(MapXY location, const poly_list_t &lane,
 void
   Obstacle::observers_message(const art_msgs::ObservationArrayConstPtr obs_msg)
 {
-  // Messages could arrive out of order, only track the most recent
-  // time stamp.
-  obstate.header.stamp = std::max(obstate.header.stamp,
-                                  obs_msg->header.stamp);
+  // Messages could arrive out of order, only keep the most recent.
+  if (obs_msg_ && obs_msg->header.stamp < obs_msg_->header.stamp)
+    return;
 
-  // obstate contains all the latest observations received, update
-  // only the ones present in this message.
+  // Observations are indexed by observer ID, so keep a reference to
+  // the whole message instead of copying them out.
+  if (obs_msg->obs.size() != (size_t) Observation::N_Observers)
+    {
+      ROS_WARN_THROTTLE(10.0, "observations message has %u entries,"
+                        " expecting %d", (unsigned) obs_msg->obs.size(),
+                        (int) Observation::N_Observers);
+      return;
+    }
   for (uint32_t i = 0; i < obs_msg->obs.size(); ++i)
     {
-      obstate.obs[obs_msg->obs[i].oid] = obs_msg->obs[i];
-      // TODO (maybe) track time stamps separately for each OID?
+      if (obs_msg->obs[i].oid != (int32_t) i)
+        {
+          ROS_WARN_THROTTLE(10.0, "observation %u has ID %d, ignored",
+                            i, obs_msg->obs[i].oid);
+          return;
+        }
+    }
+  obs_msg_ = obs_msg;
+}
+
+/** @brief obstacle points message callback
+ *
+ *  @param points_msg pointer to the points on the road, kept
+ *         instead of copying them.
+ */
+void
+  Obstacle::points_message(const PtCloud::ConstPtr &points_msg)
+{
+  if (points_msg->header.frame_id != "/map"
+      && points_msg->header.frame_id != "map")
+    {
+      ROS_WARN_THROTTLE(10.0, "obstacle points in %s frame, expecting /map",
+                        points_msg->header.frame_id.c_str());
+      return;
     }
+  points_msg_ = points_msg;
 }
 
 // return true when observer reports passing lane clear
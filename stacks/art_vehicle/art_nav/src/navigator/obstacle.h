@@ -15,16 +15,24 @@
 #include "ntimer.h"
 
 #include <art_msgs/ObservationArray.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl_ros/point_cloud.h>
 
 /** @brief Navigator obstacle class.
+ *
+ *  Obstacle data come from the ART observers, and as points on the
+ *  road in the /map frame from the points_on_road node.
  *
  *  @todo Add ROS-style ObstacleGrid input.
- *  @todo Add ART-style Observers input.
  */
 class Obstacle
 {
  public:
 
+  /** @brief obstacle points, received as PointCloud2 */
+  typedef pcl::PointCloud<pcl::PointXYZ> PtCloud;
+
   /** @brief Constructor */
   Obstacle(Navigator *_nav, int _verbose);
 
@@ -57,6 +65,21 @@ class Obstacle
   /** Return distances of closest obstacles ahead and behind in a lane. */
   void closest_in_lane(const poly_list_t &lane, float &ahead, float &behind);
 
+  /** @brief restore blockage timer from a warm restart checkpoint */
+  void restore(const art_msgs::NavigatorCheckpoint &chk)
+  {
+    using art_msgs::NavigatorCheckpoint;
+    blockage_timer->Resume(chk.timers[NavigatorCheckpoint::BLOCKAGE_TIMER]);
+  }
+
+  /** @brief save blockage timer in a warm restart checkpoint */
+  void save(art_msgs::NavigatorCheckpoint &chk) const
+  {
+    using art_msgs::NavigatorCheckpoint;
+    chk.timers[NavigatorCheckpoint::BLOCKAGE_TIMER] =
+      blockage_timer->Remaining();
+  }
+
   /** @brief return true if class initialized */
   bool initialized(void)
   {
@@ -67,16 +90,25 @@ class Obstacle
   /** @brief maximum scan range accessor. */
   float maximum_range(void) {return max_range;}
 
-  /** @brief return current observation state */
-  art_msgs::Observation observation(art_msgs::Observation::_oid_type oid)
+  /** @brief return current observation state
+   *
+   *  The reference points into the latest observations message, and
+   *  remains valid until the next message callback.
+   */
+  const art_msgs::Observation &
+    observation(art_msgs::Observation::_oid_type oid) const
   {
-    return obstate.obs[oid];
+    if (obs_msg_ && oid < (int) obs_msg_->obs.size()
+        && !obs_msg_->obs[oid].stamp.isZero())
+      return obs_msg_->obs[oid];
+    return obs_default_.obs[oid];       // no report from that observer
   }
 
   /** @brief return true when observer reports clear to go */
   bool observer_clear(art_msgs::Observation::_oid_type oid)
   {
-    bool clear = obstate.obs[oid].clear && obstate.obs[oid].applicable;
+    const art_msgs::Observation &obs = observation(oid);
+    bool clear = obs.clear && obs.applicable;
 
     // if waiting on observers, reset the blockage_timer
     if (!clear)
@@ -86,6 +118,24 @@ class Obstacle
 
   void observers_message(const art_msgs::ObservationArrayConstPtr obs_msg);
 
+  /** @brief latest obstacle points on the road
+   *
+   *  The points are in the /map frame.  The pointer remains valid
+   *  until the next message callback.
+   *
+   *  @return NULL unless a recent message has arrived
+   */
+  const PtCloud *points(void) const
+  {
+    if (!points_msg_
+        || (ros::Time::now() - points_msg_->header.stamp
+            > ros::Duration(max_points_age_)))
+      return NULL;
+    return points_msg_.get();
+  }
+
+  void points_message(const PtCloud::ConstPtr &points_msg);
+
   /** @brief return true when observer reports passing lane clear */
   bool passing_lane_clear(void);
 
@@ -123,10 +173,17 @@ class Obstacle
   // parameters
   float max_range;			//< maximum scan range
 
+  double max_points_age_;               //< oldest points used (s)
+
   ros::Subscriber obs_sub_;             //< observations subscription
+  ros::Subscriber points_sub_;          //< obstacle points subscription
 
   // observers data
-  art_msgs::ObservationArray obstate;   //< current observers state
+  art_msgs::ObservationArrayConstPtr obs_msg_; //< latest observations
+  art_msgs::ObservationArray obs_default_; //< state if none reported
+
+  // obstacle points data
+  PtCloud::ConstPtr points_msg_;        //< latest points on road
 
   // blockage timer
   NavTimer *blockage_timer;
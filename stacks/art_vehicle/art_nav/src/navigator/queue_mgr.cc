@@ -12,6 +12,7 @@
 #include <dynamic_reconfigure/server.h>
 
 #include <art/frames.h>
+#include <art/rates.h>
 
 #include <art_msgs/IOadrCommand.h>
 #include <art_msgs/IOadrState.h>
@@ -19,6 +20,8 @@
 #include <art_map/ZoneOps.h>
 
 #include <art_msgs/CarCommand.h>
+#include <art_msgs/CarTrajectory.h>
+#include <art_nav/checkpoint_file.h>
 #include <art_nav/NavEstopState.h>
 #include <art_nav/NavRoadState.h>
 //#include <art_msgs/Observers.h>
@@ -33,6 +36,24 @@
 
   Use the commander node to control this node.
 
+  The navigator state is saved to a checkpoint file every cycle.  If
+  the node is restarted, it resumes from that checkpoint as soon as
+  odometry and the local road map are available, rather than starting
+  over in Pause, provided the checkpoint is recent enough.
+
+  Parameters:
+
+  - @b ~checkpoint_file (string): file name, empty to disable;
+    relative names are in $ROS_HOME (default ~/.ros)
+    [default: "$ROS_HOME/navigator_checkpoint"]
+  - @b ~checkpoint_max_age (double): seconds after which a saved
+    checkpoint is ignored [default: 5.0]
+  - @b ~max_points_age (double): seconds after which obstacle points
+    are no longer used for avoiding obstacles in the lane [default: 0.5]
+  - @b ~trajectory_horizon (double): seconds of speed and curvature
+    sent to the pilot each cycle as a CarTrajectory, or zero to send
+    a single CarCommand [default: 0.5]
+
   @todo Add Observers interface.
 
   @author Jack O'Quin
@@ -62,6 +83,7 @@ private:
   void processOdom(const nav_msgs::Odometry::ConstPtr &odomIn);
   void processRoadMap(const art_msgs::ArtLanes::ConstPtr &cmdIn);
   void processRelays(const art_msgs::IOadrState::ConstPtr &sigIn);
+  bool resumeCheckpoint(void);
   void PublishState(void);
   void reconfig(Config &newconfig, uint32_t level);
   void SetRelays(void);
@@ -69,6 +91,7 @@ private:
 
   // ROS topics
   ros::Publisher  car_cmd_;             // pilot CarCommand
+  ros::Publisher  traj_cmd_;            // pilot CarTrajectory
   ros::Subscriber nav_cmd_;             // NavigatorCommand topic
   ros::Publisher  nav_state_;           // navigator state topic
   ros::Subscriber odom_state_;          // odometry
@@ -91,6 +114,19 @@ private:
   ros::Time cmd_time_;
   ros::Time map_time_;
 
+  double hertz_;                        // navigator cycle rate
+
+  // pilot trajectory
+  double traj_horizon_;                 // trajectory duration (sec)
+  float prev_velocity_;                 // previous velocity command
+  art_msgs::CarTrajectory traj_msg_;    // reused every cycle
+
+  // warm restart checkpoint
+  CheckpointFile chk_file_;
+  art_msgs::NavigatorCheckpoint chk_;
+  bool chk_pending_;                    // saved state not yet resumed
+  double chk_max_age_;                  // oldest checkpoint to resume
+
   // navigator implementation class
   Navigator *nav_;
 
@@ -103,9 +139,16 @@ NavQueueMgr::NavQueueMgr()
 {
   signal_on_left_ = signal_on_right_ = false;
   flasher_on_ = alarm_on_ = false;
+  chk_pending_ = false;
+  traj_horizon_ = 0.0;
+  prev_velocity_ = 0.0;
+
+  // configured cycle rate is needed before creating the controllers
+  ros::NodeHandle mynh("~");
+  hertz_ = ArtRates::getHertz(mynh, art_msgs::ArtHertz::NAVIGATOR);
 
   // create control driver, declare dynamic reconfigure callback
-  nav_ = new Navigator(&odom_msg_);
+  nav_ = new Navigator(&odom_msg_, hertz_);
   ccb_.setCallback(boost::bind(&NavQueueMgr::reconfig, this, _1, _2));
 }
 
@@ -133,6 +176,8 @@ void NavQueueMgr::processOdom(const nav_msgs::Odometry::ConstPtr &odomIn)
   float vel = odomIn->twist.twist.linear.x;
   ROS_DEBUG("current velocity = %.3f m/sec, (%02.f mph)", vel, mps2mph(vel));
   odom_msg_ = *odomIn;
+  if (!nav_->pose_history.add(*odomIn))
+    ROS_DEBUG("odometry out of order, not added to pose history");
 }
 
 /** Handle road map polygons. */
@@ -212,11 +257,75 @@ bool NavQueueMgr::setup(ros::NodeHandle node)
                                   &NavQueueMgr::processRelays, this, noDelay);
 
   // topics to write
-  car_cmd_ = node.advertise<art_msgs::CarCommand>("pilot/cmd", qDepth);
+  ros::NodeHandle mynh("~");
+  mynh.param("trajectory_horizon", traj_horizon_, 0.5);
+  if (traj_horizon_ > 0.0)
+    {
+      ROS_INFO("sending %.3f sec pilot trajectories", traj_horizon_);
+      traj_cmd_ =
+        node.advertise<art_msgs::CarTrajectory>("pilot/trajectory", qDepth);
+    }
+  else
+    car_cmd_ = node.advertise<art_msgs::CarCommand>("pilot/cmd", qDepth);
   nav_state_ =
     node.advertise<art_msgs::NavigatorState>("navigator/state", qDepth);
   signals_cmd_ = node.advertise<art_msgs::IOadrCommand>("ioadr/cmd", qDepth);
 
+  // open checkpoint file, loading any state saved recently
+  std::string chk_name;
+  mynh.param("checkpoint_file", chk_name, std::string("navigator_checkpoint"));
+  mynh.param("checkpoint_max_age", chk_max_age_, 5.0);
+  chk_name = CheckpointFile::home_path(chk_name);
+  if (chk_name != "" && chk_file_.open(chk_name))
+    {
+      ROS_INFO_STREAM("navigator checkpoint file: " << chk_name);
+      if (chk_file_.load(chk_))
+        {
+          double age = (ros::Time::now() - chk_.header.stamp).toSec();
+          if (age >= 0.0 && age <= chk_max_age_)
+            {
+              ROS_INFO("resuming navigator checkpoint saved %.3f sec ago",
+                       age);
+              chk_pending_ = true;
+            }
+          else
+            ROS_INFO("navigator checkpoint %.3f sec old, not resumed", age);
+        }
+    }
+
+  return true;
+}
+
+/** Resume navigator state from the checkpoint loaded at startup.
+ *
+ *  Waits for odometry and the local road map, so the controllers
+ *  resume with a valid position and the course can be replanned.
+ *
+ *  @return true if the navigator may run this cycle.
+ */
+bool NavQueueMgr::resumeCheckpoint(void)
+{
+  if (odom_msg_.header.stamp == ros::Time() || map_time_ == ros::Time())
+    {
+      if ((ros::Time::now() - chk_.header.stamp).toSec() <= chk_max_age_)
+        return false;                   // keep waiting
+      ROS_WARN("no odometry or road map, navigator checkpoint expired");
+      chk_pending_ = false;
+      return true;
+    }
+
+  ros::WallTime start = ros::WallTime::now();
+
+  // an order received since the checkpoint was saved is newer
+  art_msgs::Order order = nav_->order;
+  if (nav_->restore(chk_) && cmd_time_ > chk_.header.stamp)
+    nav_->order = order;
+  chk_pending_ = false;
+
+  ROS_INFO("navigator resumed in %s, %s state after %.6f sec",
+           NavEstopState(nav_->navdata.estop).Name(),
+           NavRoadState(nav_->navdata.road).Name(),
+           (ros::WallTime::now() - start).toSec());
   return true;
 }
 
@@ -302,21 +411,61 @@ void NavQueueMgr::SetSpeed(pilot_command_t pcmd)
       return;
     }
 
-  art_msgs::CarCommand cmd;
-  cmd.header.stamp = ros::Time::now();
-  cmd.header.frame_id = ArtFrames::vehicle;
-
-  cmd.control.velocity = pcmd.velocity;
   float yawRate = pcmd.yawRate;
   if (pcmd.velocity < 0)
     yawRate = -yawRate;                 // steer in opposite direction
-  cmd.control.angle =
-    Steering::steering_angle(fabs(pcmd.velocity), yawRate);
-    
-  ROS_DEBUG("Navigator CMD_CAR (%.3f m/s, %.3f degrees)",
-	    cmd.control.velocity, cmd.control.angle);
-  
-  car_cmd_.publish(cmd);
+  float angle = Steering::steering_angle(fabs(pcmd.velocity), yawRate);
+
+  if (traj_horizon_ <= 0.0)
+    {
+      art_msgs::CarCommand cmd;
+      cmd.header.stamp = ros::Time::now();
+      cmd.header.frame_id = ArtFrames::vehicle;
+      cmd.control.velocity = pcmd.velocity;
+      cmd.control.angle = angle;
+
+      ROS_DEBUG("Navigator CMD_CAR (%.3f m/s, %.3f degrees)",
+                cmd.control.velocity, cmd.control.angle);
+
+      car_cmd_.publish(cmd);
+      return;
+    }
+
+  // One point per navigator cycle over the horizon.  Curvature holds
+  // constant.  Speed continues any deceleration since the previous
+  // cycle, but never increases, so the pilot can keep following it
+  // when the next cycle is late without going faster than requested.
+  traj_msg_.header.stamp = ros::Time::now();
+  traj_msg_.header.frame_id = ArtFrames::vehicle;
+  if (pcmd.velocity > 0.0)
+    traj_msg_.gear.value = art_msgs::Gear::Drive;
+  else if (pcmd.velocity < 0.0)
+    traj_msg_.gear.value = art_msgs::Gear::Reverse;
+  else
+    traj_msg_.gear.value = art_msgs::Gear::Naught;
+
+  float speed = fabs(pcmd.velocity);
+  float curvature = (tanf(angles::from_degrees(angle))
+                     / art_msgs::ArtVehicle::wheelbase);
+  float decel = 0.0;                    // speed change (m/s/s)
+  if (pcmd.velocity * prev_velocity_ >= 0.0) // same direction
+    decel = fminf((speed - fabs(prev_velocity_)) * hertz_, 0.0);
+  prev_velocity_ = pcmd.velocity;
+
+  unsigned npoints = 1 + (unsigned) ceil(traj_horizon_ * hertz_ - 0.001);
+  traj_msg_.points.resize(npoints);
+  for (unsigned i = 0; i < npoints; ++i)
+    {
+      float t = i / hertz_;
+      traj_msg_.points[i].time = t;
+      traj_msg_.points[i].speed = fmaxf(speed + decel * t, 0.0);
+      traj_msg_.points[i].curvature = curvature;
+    }
+
+  ROS_DEBUG("Navigator trajectory (%.3f m/s, %.3f m/s/s, %.3f degrees)",
+            pcmd.velocity, decel, angle);
+
+  traj_cmd_.publish(traj_msg_);
 }
 
 /** Publish current navigator state data */
@@ -344,17 +493,29 @@ void NavQueueMgr::PublishState(void)
 /** Spin method for main thread */
 void NavQueueMgr::spin() 
 {
-  ros::Rate cycle(art_msgs::ArtHertz::NAVIGATOR);
+  ros::Rate cycle(hertz_);
   while(ros::ok())
     {
       ros::spinOnce();                  // handle incoming messages
 
-      // invoke appropriate Navigator method, pass result to Pilot
-      SetSpeed(nav_->navigate());
+      if (!chk_pending_ || resumeCheckpoint())
+        {
+          // invoke appropriate Navigator method, pass result to Pilot
+          SetSpeed(nav_->navigate());
+
+          SetRelays();
 
-      SetRelays();
+          PublishState();
 
-      PublishState();
+          // save state for a warm restart
+          if (chk_file_.is_open())
+            {
+              chk_.header.stamp = nav_->navdata.header.stamp;
+              nav_->save(chk_);
+              if (!chk_file_.save(chk_))
+                ROS_WARN_THROTTLE(10, "navigator checkpoint not saved");
+            }
+        }
 
       // wait for next cycle
       cycle.sleep();
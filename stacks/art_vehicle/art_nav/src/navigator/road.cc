@@ -13,7 +13,7 @@
 #include "obstacle.h"
 #include "road.h"
 
-//#include "evade.h"
+#include "evade.h"
 #include "follow_lane.h"
 #include "follow_safely.h"
 #include "halt.h"
@@ -148,7 +148,7 @@ Road::Road(Navigator *navptr, int _verbose):
       NavRoadState::Zone,		NavRoadState::WaitCross);
 
   // allocate subordinate controllers
-  //evade = new Evade(navptr, _verbose);
+  evade = new Evade(navptr, _verbose);
   follow_lane = new FollowLane(navptr, _verbose);
   follow_safely = new FollowSafely(navptr, _verbose);
   halt = new Halt(navptr, _verbose);
@@ -157,10 +157,10 @@ Road::Road(Navigator *navptr, int _verbose):
   //zone = new RealZone(navptr, _verbose);
 
   // allocate timers
-  passing_timer = new NavTimer();
-  precedence_timer = new NavTimer();
-  roadblock_timer = new NavTimer();
-  stop_line_timer = new NavTimer();
+  passing_timer = new NavTimer(navptr->cycle);
+  precedence_timer = new NavTimer(navptr->cycle);
+  roadblock_timer = new NavTimer(navptr->cycle);
+  stop_line_timer = new NavTimer(navptr->cycle);
 
   // reset this controller only
   reset_me();
@@ -168,7 +168,7 @@ Road::Road(Navigator *navptr, int _verbose):
 
 Road::~Road()
 {
-  //delete evade;
+  delete evade;
   delete follow_lane;
   delete follow_safely;
   delete halt;
@@ -236,7 +236,7 @@ void Road::reset(void)
 {
   trace_reset("Road");
   reset_me();
-  //evade->reset();
+  evade->reset();
   follow_lane->reset();
   follow_safely->reset();
   halt->reset();
@@ -245,6 +245,34 @@ void Road::reset(void)
   //zone->reset();
 }
 
+/** restore state from a warm restart checkpoint
+ *
+ *  @pre this controller and its subordinates already reset
+ */
+void Road::restore(const art_msgs::NavigatorCheckpoint &chk)
+{
+  using art_msgs::NavigatorCheckpoint;
+  state = (NavRoadState::state_t) chk.navdata.road.state;
+  prev = state;
+  passing_timer->Resume(chk.timers[NavigatorCheckpoint::PASSING_TIMER]);
+  precedence_timer->Resume(chk.timers[NavigatorCheckpoint::PRECEDENCE_TIMER]);
+  roadblock_timer->Resume(chk.timers[NavigatorCheckpoint::ROADBLOCK_TIMER]);
+  stop_line_timer->Resume(chk.timers[NavigatorCheckpoint::STOP_LINE_TIMER]);
+}
+
+/** save state in a warm restart checkpoint */
+void Road::save(art_msgs::NavigatorCheckpoint &chk) const
+{
+  using art_msgs::NavigatorCheckpoint;
+  chk.timers[NavigatorCheckpoint::PASSING_TIMER] = passing_timer->Remaining();
+  chk.timers[NavigatorCheckpoint::PRECEDENCE_TIMER] =
+    precedence_timer->Remaining();
+  chk.timers[NavigatorCheckpoint::ROADBLOCK_TIMER] =
+    roadblock_timer->Remaining();
+  chk.timers[NavigatorCheckpoint::STOP_LINE_TIMER] =
+    stop_line_timer->Remaining();
+}
+
 // reset this controller only
 void Road::reset_me(void)
 {
@@ -349,9 +377,7 @@ Controller::result_t Road::ActionInBlock(pilot_command_t &pcmd)
 
 Controller::result_t Road::ActionInEvade(pilot_command_t &pcmd)
 {
-  /** @todo Either implement the Evade controller or delete it. */
-  //result_t result = evade->control(pcmd);
-  result_t result = halt->control(pcmd);
+  result_t result = evade->control(pcmd);
   if (result == Finished)
     {
       pending_event = NavRoadEvent::FollowLane;
@@ -530,7 +556,7 @@ Controller::result_t Road::ActionInWaitStop(pilot_command_t &pcmd)
     }
 
   // restart precedence timer if number of cars remaining changed
-  Observation obs = obstacle->observation(Observation::Intersection);
+  const Observation &obs = obstacle->observation(Observation::Intersection);
   if (obs.applicable && obs.nobjects != prev_nobjects)
     {
       prev_nobjects = obs.nobjects;
@@ -633,7 +659,7 @@ Controller::result_t Road::ActionToEvade(pilot_command_t &pcmd)
 	}
     }
   // no passing lane: evade collision by leaving lane to the right
-  //evade->reset();
+  evade->reset();
 #endif
   return ActionInEvade(pcmd);
 }
@@ -14,7 +14,7 @@
 #include <art_nav/NavRoadState.h>
 #include "NavRoadEvent.h"
 
-//class Evade;
+class Evade;
 class FollowLane;
 class FollowSafely;
 class Halt;
@@ -31,6 +31,8 @@ public:
   ~Road();
   result_t control(pilot_command_t &pcmd);
   void reset(void);
+  void restore(const art_msgs::NavigatorCheckpoint &chk);
+  void save(art_msgs::NavigatorCheckpoint &chk) const;
 
   NavRoadState State(void)
   {
@@ -63,7 +65,7 @@ private:
   int32_t prev_nobjects;		// previous number of cars
 
   // subordinate controllers
-  //Evade	*evade;
+  Evade		*evade;
   FollowLane	*follow_lane;
   FollowSafely	*follow_safely;
   Halt		*halt;
@@ -42,7 +42,7 @@ Run::Run(Navigator *navptr, int _verbose):
   safety =	new Safety(navptr, _verbose);
   unstuck =	new VoronoiZone(navptr, _verbose);
 
-  escape_timer = new NavTimer(cycle);
+  escape_timer = new NavTimer(navptr->cycle);
 #endif
   go_state = Continue;
 };
@@ -103,9 +103,10 @@ Controller::result_t Run::control(pilot_command_t &pcmd)
   pcmd.yawRate = 0.0;
   pcmd.velocity = fminf(order->max_speed, config_->max_speed);
   
-  // estimate current dead reckoning position based on time of current
-  // cycle and latest odometry course and speed
-  Estimate::control_pose(*odom, ros::Time::now(), *estimate);
+  // estimate current dead reckoning position at the time of the
+  // current cycle, from the odometry pose history
+  Estimate::control_pose(nav->pose_history, *odom, ros::Time::now(),
+                         *estimate);
 
   course->begin_run_cycle();
 
@@ -313,6 +314,23 @@ void Run::reset(void)
 #endif
 }
 
+/** restore state from a warm restart checkpoint */
+void Run::restore(const art_msgs::NavigatorCheckpoint &chk)
+{
+  if (chk.go_state >= Continue && chk.go_state <= Replan)
+    go_state = (state_t) chk.go_state;
+  last_replan = chk.last_replan;
+  road->restore(chk);
+}
+
+/** save state in a warm restart checkpoint */
+void Run::save(art_msgs::NavigatorCheckpoint &chk) const
+{
+  chk.go_state = go_state;
+  chk.last_replan = last_replan;
+  road->save(chk);
+}
+
 /** set new Go behavior state */
 void Run::set_go_state(state_t newstate)
 {
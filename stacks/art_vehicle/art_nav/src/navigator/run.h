@@ -27,6 +27,8 @@ public:
   ~Run();
   result_t control(pilot_command_t &pcmd);
   void reset(void);
+  void restore(const art_msgs::NavigatorCheckpoint &chk);
+  void save(art_msgs::NavigatorCheckpoint &chk) const;
 
 private:
 
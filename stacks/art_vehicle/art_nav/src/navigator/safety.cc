@@ -1,63 +1,28 @@
-#include "safety.h"
+/*
+ *  Navigator safety controller
+ *
+ *  Copyright (C) 2007, 2010, Austin Robot Technology
+ *
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <art_msgs/ArtVehicle.h>
+
+#include "navigator_internal.h"
 #include "Controller.h"
 #include "obstacle.h"
-#include <art/steering.h>
-#include <art/Safety.h>
+#include "safety.h"
+
+using art_msgs::ArtVehicle;
 
-Safety::Safety(Navigator *navptr, int _verbose, int mode):
+Safety::Safety(Navigator *navptr, int _verbose):
   Controller(navptr, _verbose)
-  {
-    _mode=mode; // 0 for normal, 1 for zone, 2 for parking
-    safety = new Safety_Distance(_verbose);
-  }
+{}
 
 Safety::~Safety()
-  {
-    delete safety;
-  }
-
-void Safety::configure(ConfigFile* cf, int section)
-{
-
-  if (_mode==0)
-    {
-      far_slow_ratio = cf->ReadFloat(section, "far_slow_ratio", 0.75);
-      near_slow_ratio = cf->ReadFloat(section, "near_slow_ratio", 0.5);
-      
-      far_safety_time = cf->ReadFloat(section, "far_safety_time", 3);
-      near_safety_time = cf->ReadFloat(section, "near_safety_time", 2);
-      collision_safety_time = cf->ReadFloat(section, "collision_safety_time", 1);
-    }
-  else if (_mode==1)
-    {
-      far_slow_ratio = cf->ReadFloat(section, "zone_far_slow_ratio", 0.75);
-      near_slow_ratio = cf->ReadFloat(section, "zone_near_slow_ratio", 0.5);
-      
-      far_safety_time = cf->ReadFloat(section, "zone_far_safety_time", 3);
-      near_safety_time = cf->ReadFloat(section, "zone_near_safety_time", 2);
-      collision_safety_time = cf->ReadFloat(section, "zone_collision_safety_time", 1.0);
-    }
-  else{
-    far_slow_ratio = cf->ReadFloat(section, "parking_far_slow_ratio", 0.75);
-    near_slow_ratio = cf->ReadFloat(section, "parking_near_slow_ratio", 0.5);
-    
-    far_safety_time = cf->ReadFloat(section, "parking_far_safety_time", 1.5);
-    near_safety_time = cf->ReadFloat(section, "parking_near_safety_time", 1);
-    collision_safety_time = cf->ReadFloat(section, "parking_collision_safety_time", 1.0);
-  }
-  
-  safety_speed = cf->ReadFloat(section, "safety_speed", 2.0);
-  
-  ART_MSG(2, "Safety is in mode %d",_mode);
-  ART_MSG(2, "\tMinimum nonzero safety speed is %.3f m/s", safety_speed);
-  
-  ART_MSG(2, "\tMultiply speed by %.2f if collision in %f seconds", 
-	  far_slow_ratio, far_safety_time);
-  ART_MSG(2, "\tMultiply speed by %.2f if collision in %f seconds", 
-	  near_slow_ratio, near_safety_time);
-  ART_MSG(2, "\tBrake immediately if collision in %f seconds", 
-	  near_safety_time);
-}
+{}
 
 // safety controller -- always runs last in every road state
 //
@@ -66,6 +31,9 @@ void Safety::configure(ConfigFile* cf, int section)
 // alternatives.  It may reduce the requested speed, but requests no
 // heading changes.
 //
+// It only checks ahead of the vehicle, using the latest obstacle
+// points on the road.  Without recent points, it does nothing.
+//
 // returns:
 //	OK, if no immediate danger;
 //	Caution, if obstacle far away and reducing speed;
@@ -73,123 +41,70 @@ void Safety::configure(ConfigFile* cf, int section)
 //	Unsafe, if collision imminent and stopping;
 //	Blocked, if stopped and unable to proceed.
 //
-Controller::result_t Safety::control(pilot_command_t &retpcmd)
+Controller::result_t Safety::control(pilot_command_t &pcmd)
 {
-  pilot_command_t pcmd=retpcmd;
-  if (navdata->reverse)
-    pcmd.velocity*=-1;
+  result_t result = OK;
+  const Obstacle::PtCloud *points = obstacle->points();
+  if (points == NULL || navdata->reverse)
+    return result;
 
   // Look to see if current velocity is going to hit anything.  If so
   // slam on brakes.
-  player_pose2d_t tmp=estimate->pos;
-  float min_val=Infinite::distance;
-    
-
-
-  float ret_val=
-    safety->minimum_obstacle_to_arc(tmp,
-				    estimate->vel.px*collision_safety_time,
-				    estimate->vel.pa*collision_safety_time,
-				    obstacle->lasers->all_obstacle_list,
-				    tmp);
-  if (Epsilon::equal(ret_val,0.0))
-    {
-      return halt_immediately(retpcmd);
-    }    
-
-  // While our current trajectory will hit something nearby, keep
-  // reducing the speed.
-  bool collision_obst=false;
-  bool collision;
-  result_t result = OK;
-
-  do {
-    tmp=estimate->pos;
-    min_val=Infinite::distance;
-    
-    collision=false;
-    
-    float ret_val=
-      safety->minimum_obstacle_to_arc(tmp,
-				      pcmd.velocity*near_safety_time,
-				      pcmd.yawRate*near_safety_time,
-				      obstacle->lasers->all_obstacle_list,
-				      tmp);
-    if (Epsilon::equal(ret_val,0.0))
-      {
-	// collision imminent
-	collision_obst=true;
-	collision=true;
-	result = Beware;
-	if (pcmd.velocity > safety_speed/near_slow_ratio)
-	  {
-	    if (verbose >= 3)
-	      ART_MSG(2, "Collision potential, multiply by %.3f: "
-		      "from %.3f, %.3f",
-		      near_slow_ratio, pcmd.velocity, pcmd.yawRate);
-	    pcmd.velocity*=near_slow_ratio;
-	    //pcmd.yawRate*=near_slow_ratio;
-	  }
-	else if (pcmd.velocity > safety_speed)
-	  {
-	    float ratio=safety_speed/pcmd.velocity;
-	    if (verbose >= 3)
-	      ART_MSG(2, "Collision potential, multiply by %.3f: "
-		      "from %.3f, %.3f",
-		      ratio, pcmd.velocity, pcmd.yawRate);
-	    pcmd.velocity*=ratio;
-	    //pcmd.yawRate*=ratio;
-	  }
-	else
-	  {
-	    return halt_immediately(retpcmd);
-	  }
-      }
-  } while (collision);
-  
-  if (collision_obst)
+  float speed = estimate->twist.twist.linear.x;
+  float yaw_rate = estimate->twist.twist.angular.z;
+  float t = config_->safety_collision_time;
+  if (speed > 0.0
+      && obstacle_on_arc(*points, speed * t, yaw_rate * t)
+      < Infinite::distance)
     {
-      retpcmd=pcmd;
-      retpcmd.velocity=fabsf(retpcmd.velocity);
-      trace("safety controller", retpcmd, result);
-      return result;
+      return halt_immediately(pcmd);
     }
 
-  // If something out ahead, slow down a bit.  
-
-  // tmp should already be at point near_safety_time seconds ahead of
-  // current position
-
-  ret_val=
-    safety->minimum_obstacle_to_arc(tmp,
-				    pcmd.velocity*(far_safety_time-near_safety_time),
-				    pcmd.yawRate*(far_safety_time-near_safety_time),
-				    obstacle->lasers->all_obstacle_list,
-				    tmp);
-  if (Epsilon::equal(ret_val,0.0))
+  // While our requested trajectory will hit something nearby, keep
+  // reducing the speed.
+  float safety_speed = config_->safety_speed;
+  float near_slow_ratio = config_->safety_near_slow_ratio;
+  t = config_->safety_near_time;
+  while (pcmd.velocity > 0.0
+         && obstacle_on_arc(*points, pcmd.velocity * t, pcmd.yawRate * t)
+         < Infinite::distance)
     {
-      // no immediate collision, but danger ahead
-      result = Caution;
-      if (pcmd.velocity > safety_speed/far_slow_ratio)
+      // collision imminent
+      result = Beware;
+      if (pcmd.velocity > safety_speed / near_slow_ratio)
 	{
-	  if (verbose >= 3)
-	    ART_MSG(2, "Danger ahead, slowing by %.3f times: from %.3f, %.3f ", 
-		    far_slow_ratio, pcmd.velocity, pcmd.yawRate);
-	  pcmd.velocity=pcmd.velocity*far_slow_ratio;
-	  //pcmd.yawRate=pcmd.yawRate*far_slow_ratio;
+          ROS_DEBUG("Collision potential, multiply by %.3f: from %.3f, %.3f",
+                    near_slow_ratio, pcmd.velocity, pcmd.yawRate);
+	  pcmd.velocity *= near_slow_ratio;
 	}
       else if (pcmd.velocity > safety_speed)
 	{
-	  float ratio=safety_speed/pcmd.velocity;
-	  if (verbose >= 3)
-	    ART_MSG(2, "Danger ahead, slowing by %.3f times: from %.3f, %.3f ", 
-		    ratio, pcmd.velocity, pcmd.yawRate);
-	  pcmd.velocity=pcmd.velocity*ratio;
-	  //pcmd.yawRate=pcmd.yawRate*ratio;
+          ROS_DEBUG("Collision potential, slow to %.3f: from %.3f, %.3f",
+                    safety_speed, pcmd.velocity, pcmd.yawRate);
+	  pcmd.velocity = safety_speed;
 	}
-    }    
-  retpcmd=pcmd;
-  retpcmd.velocity=fabsf(retpcmd.velocity);
+      else
+        return halt_immediately(pcmd);
+    }
+
+  if (result == OK)
+    {
+      // If something out ahead, slow down a bit.
+      float far_slow_ratio = config_->safety_far_slow_ratio;
+      t = config_->safety_far_time;
+      if (pcmd.velocity > safety_speed
+          && obstacle_on_arc(*points, pcmd.velocity * t, pcmd.yawRate * t)
+          < Infinite::distance)
+        {
+          // no immediate collision, but danger ahead
+          result = Caution;
+          ROS_DEBUG("Danger ahead, slowing by %.3f: from %.3f, %.3f",
+                    far_slow_ratio, pcmd.velocity, pcmd.yawRate);
+          pcmd.velocity = fmaxf(pcmd.velocity * far_slow_ratio,
+                                safety_speed);
+        }
+    }
+
   trace("safety controller", pcmd, result);
   return result;
 }
@@ -201,11 +116,9 @@ Controller::result_t Safety::control(pilot_command_t &retpcmd)
 //	Blocked, if car already stopped
 Controller::result_t Safety::halt_immediately(pilot_command_t &pcmd)
 {
-  if (verbose >= 3)
-    ART_MSG(2, "Collision imminent, halting: from %.3f, %.3f",
-	    pcmd.velocity, pcmd.yawRate);
-  pcmd.velocity=0.0;
-  //pcmd.yawRate=0.0;
+  ROS_DEBUG("Collision imminent, halting: from %.3f, %.3f",
+            pcmd.velocity, pcmd.yawRate);
+  pcmd.velocity = 0.0;
 
   // return Blocked if already stopped and still requesting halt
   result_t result = Unsafe;
@@ -214,3 +127,60 @@ Controller::result_t Safety::halt_immediately(pilot_command_t &pcmd)
   trace("safety controller", pcmd, result);
   return result;
 }
+
+// distance to the first obstacle point the front of the vehicle
+// would reach on an arc
+//
+// entry:
+//	points = obstacle points in the /map frame
+//	distance = arc length travelled from the current pose
+//	yaw_change = heading change over that distance
+// returns:
+//	distance travelled before reaching the point,
+//	Infinite::distance if none
+//
+float Safety::obstacle_on_arc(const pcl::PointCloud<pcl::PointXYZ> &points,
+                              float distance, float yaw_change)
+{
+  MapPose pose(estimate->pose.pose);
+  float cos_yaw = cosf(pose.yaw);
+  float sin_yaw = sinf(pose.yaw);
+  float reach = distance + ArtVehicle::front_bumper_px;
+
+  // arc radius, positive when turning left
+  bool straight = (fabsf(yaw_change) < 0.001);
+  float radius = (straight? 0.0: distance / yaw_change);
+
+  float closest = Infinite::distance;
+  for (unsigned i = 0; i < points.points.size(); ++i)
+    {
+      // egocentric coordinates, relative to the rear axle
+      float dx = points.points[i].x - pose.map.x;
+      float dy = points.points[i].y - pose.map.y;
+      float px = cos_yaw * dx + sin_yaw * dy;
+      float py = cos_yaw * dy - sin_yaw * dx;
+
+      float along;
+      if (straight)
+        {
+          if (fabsf(py) >= ArtVehicle::halfwidth)
+            continue;
+          along = px;
+        }
+      else
+        {
+          // relative to the center of the turn
+          float ry = py - radius;
+          float rho = sqrtf(px * px + ry * ry);
+          if (fabsf(rho - fabsf(radius)) >= ArtVehicle::halfwidth)
+            continue;
+          float angle = (radius > 0.0? atan2f(px, -ry): atan2f(px, ry));
+          along = fabsf(radius) * angle;
+        }
+
+      // ignore points within the vehicle body or beyond the arc
+      if (along >= ArtVehicle::front_bumper_px && along <= reach)
+        closest = fminf(closest, along - ArtVehicle::front_bumper_px);
+    }
+  return closest;
+}
@@ -14,6 +14,7 @@
 #include "stop_area.h"
 
 #include <art/DARPA_rules.h>
+#include <art_nav/stop_profile.h>
 
 StopArea::StopArea(Navigator *navptr, int _verbose):
   Controller(navptr, _verbose)
@@ -25,6 +26,9 @@ StopArea::~StopArea() {};
 
 // Slow down if stop line safety area reached.
 //
+// Limits speed to the fastest one from which the StopLine profile
+// can still stop at the line, but not below stop_approach_speed.
+//
 // exit:
 //	course->stop_waypt set
 // result:
@@ -41,7 +45,11 @@ Controller::result_t StopArea::control(pilot_command_t &pcmd)
     return NotApplicable;
 
   // reduce speed within stop line safety area
-  nav->reduce_speed_with_min(pcmd, config_->stop_approach_speed);
+  float stop_speed = StopProfile::max_speed(wayptdist,
+                                            config_->stop_deceleration,
+                                            config_->stop_jerk);
+  nav->reduce_speed_with_min(pcmd, fmaxf(config_->stop_approach_speed,
+                                         stop_speed));
 
   if (!in_safety_area)
     {
@@ -17,26 +17,22 @@ using art_msgs::ArtVehicle;
 #include "stop_line.h"
 
 /**
- *  This is based on the unpublished "Control Tutorial" draft dated
- *  January 26, 2004 by Dr. Benjamin Kuypers, section 5: "The Stopping
- *  Controller".  He recommends a constant deceleration instead of the
- *  simpler exponential decay.  The dynamical system is:
- * 
- * 	x_dot = -k * sqrt(x)
- * 
- *  Solving analytically with initial condition x(0) = D and v(0) = V
- *  yields these equations of motion:
- * 
- * 	x(t) = (sqrt(D) - V*t/(2*sqrt(D)))**2	(parabolic drop)
- * 	v(t) = dx/dt = (V**2/2*D)*t + V		(linear velocity)
- * 	a(t) = dv/dt = V**2/(2*D) = A		(constant deceleration)
- * 
- *  Note that the initial velocity V is negative in these equations,
- *  because it represents motion from positive x to zero.  The system
- *  stops in finite time T = -2*D/V, with x(T) = 0, and v(T) = 0.
- * 
- *  For example, when D = 10m from stop line and V = -5m/s, the
- *  vehicle stops in 4 seconds at a constant 1.25m/s/s deceleration.
+ *  Stopping follows a jerk-limited deceleration profile to the stop
+ *  point (see StopProfile).  Braking begins as late as the
+ *  stop_deceleration and stop_jerk limits allow, and the peak
+ *  deceleration is the lowest one stopping exactly at the line.
+ *
+ *  The profile is planned once, then followed by time.  Control
+ *  latency and estimate noise make the measured distance drift from
+ *  the plan, so it is replanned from the current speed and planned
+ *  deceleration whenever they differ by more than
+ *  stop_replan_distance.  Smaller errors are corrected by adding
+ *  stop_position_gain times the error to the speed requested, which
+ *  is the one planned stop_line_latency seconds ahead, to compensate
+ *  for braking latency.  With no lookahead, the brake lag carries the
+ *  vehicle past the line, so stop_line_latency should match the
+ *  measured lag of the brake servo.  It is separate from stop_latency,
+ *  which the Stop controller converts into a distance instead.
  */
 
 StopLine::StopLine(Navigator *navptr, int _verbose):
@@ -70,29 +66,28 @@ Controller::result_t StopLine::control(pilot_command_t &pcmd,
     (Euclidean::DistanceToWaypt(MapPose(estimate->pose.pose),
                                 course->stop_waypt)
      - ArtVehicle::front_bumper_px + config_->stop_distance);
-  // stop_latency compensates for latency in the braking system.
   float abs_speed = fabsf(estimate->twist.twist.linear.x);
-  float latencydist = abs_speed * config_->stop_latency;
-  float D = wayptdist - latencydist;
-
-  // According to the model, deceleration should be constant, but in
-  // the real world control latency will cause it to vary, so apply
-  // feedback and recompute the model every cycle.
   if (abs_speed < Epsilon::speed)
     abs_speed = 0.0;
 
-  float V = -abs_speed;
-  float A = V*V/(2.0*D);
+  // distance to the point where the vehicle should halt
+  float D = wayptdist - config_->stop_distance;
   ElementID stop_id = course->stop_waypt.id;
   
   // see if it is time to begin stopping
-  if ((D <= config_->min_stop_distance || A >= config_->stop_deceleration)
-      && !stopping)
+  if (!stopping
+      && (wayptdist <= config_->min_stop_distance
+          || (StopProfile::stopping_distance(abs_speed,
+                                             config_->stop_deceleration,
+                                             config_->stop_jerk)
+              + abs_speed * nav->cycle.toSec()) >= D))
     {
       stopping = true;
       initial_speed = fmaxf(topspeed,abs_speed);
-      ART_MSG(8, "begin stopping for waypoint %s",
-	      stop_id.name().str);
+      begin_time = ros::Time::now();
+      profile.clear();
+      ART_MSG(8, "begin stopping for waypoint %s, %.3f m away",
+	      stop_id.name().str, D);
     }
 
   // Once stopping is initiated, keep doing it until reset(), no
@@ -103,7 +98,7 @@ Controller::result_t StopLine::control(pilot_command_t &pcmd,
       // check whether front bumper is within stop way-point polygon
       Polar front_bumper(0.0, ArtVehicle::front_bumper_px);
 
-      if (D <= config_->stop_distance ||
+      if (D <= 0.0 ||
 	  pops->pointInPoly(front_bumper, MapPose(estimate->pose.pose),
                             course->stop_poly))
 	{
@@ -112,6 +107,10 @@ Controller::result_t StopLine::control(pilot_command_t &pcmd,
 	  // report Finished when stopped within stop polygon
 	  if (abs_speed < Epsilon::speed)
 	    {
+	      ROS_DEBUG("stopped for waypoint %s after %.3f sec, %.3f m away",
+                        stop_id.name().str,
+                        (ros::Time::now() - begin_time).toSec(), D);
+
 	      // Consider this way-point "reached".
 	      course->new_waypoint_reached(stop_id);
 	      course->stop_waypt.id = ElementID(); // reset way-point
@@ -120,10 +119,29 @@ Controller::result_t StopLine::control(pilot_command_t &pcmd,
 	}
       else if (!creeping && abs_speed >= Epsilon::speed)
 	{
-	  // Not there yet.  Do not let the requested speed increase
-	  // above initial speed when stopping began, even when the
-	  // car was accelerating.
-	  pcmd.velocity = fminf(pcmd.velocity, abs_speed - A);
+	  // Not there yet.  Follow the profile, replanning only when
+	  // the distance has drifted away from it.
+	  if (profile.active())
+	    profile.advance(nav->cycle.toSec());
+	  if (!profile.active()
+	      || fabsf(profile.remaining() - D)
+	         > config_->stop_replan_distance)
+	    {
+	      float accel = (profile.active()? profile.accel(): 0.0);
+	      if (!profile.plan(D, abs_speed, accel,
+				config_->stop_deceleration,
+				config_->stop_jerk))
+		ROS_DEBUG("stop for waypoint %s exceeds limits, %.3f m away",
+			  stop_id.name().str, D);
+	    }
+
+	  // Do not let the requested speed increase above initial
+	  // speed when stopping began, even when the car was
+	  // accelerating.
+	  float error = D - profile.remaining(); // behind plan if > 0
+	  pcmd.velocity = fminf(pcmd.velocity,
+				(profile.speed(config_->stop_line_latency)
+				 + config_->stop_position_gain * error));
 	  pcmd.velocity = fminf(pcmd.velocity, initial_speed);
 	  if (pcmd.velocity < 0.0)
 	    pcmd.velocity = 0.0;	// do not change direction
@@ -137,14 +155,12 @@ Controller::result_t StopLine::control(pilot_command_t &pcmd,
 
       if (verbose >= 2)
 	{
-	  ART_MSG(8, "stop %.3f m away for waypoint %s (%.3f,%.3f),"
-		  " %.3f m latency",
-		  wayptdist - config_->stop_distance, stop_id.name().str,
-		  course->stop_waypt.map.x, course->stop_waypt.map.y,
-		  latencydist);
+	  ART_MSG(8, "stop %.3f m away for waypoint %s (%.3f,%.3f)",
+		  D, stop_id.name().str,
+		  course->stop_waypt.map.x, course->stop_waypt.map.y);
 	  ART_MSG(8, "current, desired speed %.3f m/s, %.3f m/s,"
-		  " decel %.3f m/s/s",
-		  abs_speed, pcmd.velocity, A);
+		  " planned decel %.3f m/s/s",
+		  abs_speed, pcmd.velocity, -profile.accel());
 	}
     }
 
@@ -165,4 +181,5 @@ void StopLine::reset_me(void)
   stopping = false;
   creeping = false;
   initial_speed = 0.0;
+  profile.clear();
 };
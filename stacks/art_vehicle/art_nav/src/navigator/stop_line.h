@@ -12,6 +12,8 @@
 #ifndef __STOP_LINE_HH__
 #define __STOP_LINE_HH__
 
+#include <art_nav/stop_profile.h>
+
 class StopLine: public Controller
 {
 public:
@@ -28,6 +30,8 @@ private:
   bool creeping;                        // creeping up to line
   double initial_speed;                 // initial speed while stopping
   double max_creep_distance;            // applicable distance for creep
+  StopProfile profile;                  // planned approach to the line
+  ros::Time begin_time;                 // when stopping began
 
   void reset_me(void);
 };
@@ -0,0 +1,194 @@
+/*
+ *  Navigator cycle heap allocation unit test
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <gtest/gtest.h>
+#include "alloc_counter.h"
+
+#include <art_msgs/ArtLanes.h>
+#include <art_nav/NavEstopState.h>
+#include <art_nav/NavRoadState.h>
+
+#include "navigator_internal.h"
+#include "course.h"
+
+// Drives the navigator along a straight lane, closing the loop with
+// simple odometry, and checks that its steady state cycle does not
+// allocate memory.  The navigator subscribes to topics, so this runs
+// under rostest, with a master.
+
+const int N_WAYPTS = 40;                // way-points in the lane
+const int N_BETWEEN = 3;                // polygons between way-points
+const float POLY_LENGTH = 2.0;          // length of each polygon
+const float LANE_WIDTH = 4.0;
+const float WAYPT_SPACING = POLY_LENGTH * (N_BETWEEN + 1);
+const double HZ = 20.0;                 // navigator cycle rate
+
+// a straight east-bound lane: one polygon containing each way-point,
+// followed by N_BETWEEN polygons leading to the next one
+art_msgs::ArtLanes make_lane(void)
+{
+  art_msgs::ArtLanes lanes;
+  for (int w = 1; w <= N_WAYPTS; ++w)
+    {
+      for (int i = 0; i <= N_BETWEEN; ++i)
+        {
+          if (i > 0 && w == N_WAYPTS)
+            break;
+          poly p;
+          float x = lanes.polygons.size() * POLY_LENGTH - POLY_LENGTH/2;
+          p.p1 = MapXY(x, LANE_WIDTH/2);
+          p.p2 = MapXY(x + POLY_LENGTH, LANE_WIDTH/2);
+          p.p3 = MapXY(x + POLY_LENGTH, -LANE_WIDTH/2);
+          p.p4 = MapXY(x, -LANE_WIDTH/2);
+          p.midpoint = MapXY(x + POLY_LENGTH/2, 0.0);
+          p.heading = 0.0;
+          p.length = POLY_LENGTH;
+          p.poly_id = lanes.polygons.size();
+          p.is_stop = false;
+          p.is_transition = false;
+          p.contains_way = (i == 0);
+          p.start_way = ElementID(1, 1, w);
+          p.end_way = ElementID(1, 1, (i == 0? w: w + 1));
+          p.left_boundary = DOUBLE_YELLOW;
+          p.right_boundary = SOLID_WHITE;
+          art_msgs::ArtQuadrilateral quad;
+          p.toMsg(quad);
+          lanes.polygons.push_back(quad);
+        }
+    }
+  return lanes;
+}
+
+// the way-point order the commander would send, starting at pt
+art_msgs::Order make_order(int pt)
+{
+  art_msgs::Order order;
+  order.behavior.value = NavBehavior::Go;
+  order.min_speed = 0.0;
+  order.max_speed = 5.0;
+  for (unsigned i = 0; i < art_msgs::Order::N_WAYPTS; ++i)
+    {
+      int w = std::min(pt + (int) i, N_WAYPTS);
+      art_msgs::WayPoint &wp = order.waypt[i];
+      wp.id = ElementID(1, 1, w).toMapID();
+      wp.mapxy.x = (w - 1) * WAYPT_SPACING;
+      wp.mapxy.y = 0.0;
+      wp.index = w - 1;
+      wp.lane_width = LANE_WIDTH;
+    }
+  order.chkpt[0] = order.waypt[art_msgs::Order::N_WAYPTS-1];
+  order.chkpt[1] = order.chkpt[0];
+  order.next_uturn = -1;
+  return order;
+}
+
+class NavigatorCycle: public testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    odom_.header.frame_id = "/odom";
+    odom_.pose.pose.position.x = 1.0;
+    odom_.pose.pose.orientation = tf::createQuaternionMsgFromYaw(0.0);
+    nav_ = new Navigator(&odom_, HZ);
+    nav_->config_ = Config::__getDefault__();
+    nav_->configure();
+    nav_->course->lanes_message(make_lane());
+  }
+
+  virtual void TearDown()
+  {
+    delete nav_;
+  }
+
+  // one navigator cycle, then move the vehicle as commanded
+  pilot_command_t cycle(void)
+  {
+    odom_.header.stamp = ros::Time::now();
+    nav_->pose_history.add(odom_);
+    pilot_command_t pcmd = nav_->navigate();
+
+    double yaw = tf::getYaw(odom_.pose.pose.orientation);
+    double dt = 1.0 / HZ;
+    odom_.pose.pose.position.x += pcmd.velocity * cos(yaw) * dt;
+    odom_.pose.pose.position.y += pcmd.velocity * sin(yaw) * dt;
+    odom_.pose.pose.orientation =
+      tf::createQuaternionMsgFromYaw(yaw + pcmd.yawRate * dt);
+    odom_.twist.twist.linear.x = pcmd.velocity;
+    odom_.twist.twist.angular.z = pcmd.yawRate;
+    return pcmd;
+  }
+
+  // run and initialize, as the commander does before Go
+  void start(void)
+  {
+    nav_->order.behavior.value = NavBehavior::Run;
+    cycle();
+    nav_->order.behavior.value = NavBehavior::Initialize;
+    cycle();
+  }
+
+  // one Go cycle from the last way-point reached
+  pilot_command_t go(void)
+  {
+    int pt = ElementID(nav_->navdata.last_waypt).pt;
+    nav_->order = make_order(std::max(pt, 1));
+    return cycle();
+  }
+
+  nav_msgs::Odometry odom_;
+  Navigator *nav_;
+};
+
+TEST_F(NavigatorCycle, follows_lane)
+{
+  start();
+  ASSERT_EQ(NavEstopState::Run, nav_->navdata.estop.state);
+  EXPECT_EQ(1, ElementID(nav_->navdata.last_waypt).pt);
+
+  for (int i = 0; i < 200; ++i)
+    go();
+  EXPECT_EQ(NavRoadState::Follow, nav_->navdata.road.state);
+  EXPECT_GT(odom_.pose.pose.position.x, 2 * WAYPT_SPACING);
+  EXPECT_NEAR(0.0, odom_.pose.pose.position.y, LANE_WIDTH/2);
+  EXPECT_GT(ElementID(nav_->navdata.last_waypt).pt, 2);
+}
+
+TEST_F(NavigatorCycle, no_allocations)
+{
+  start();
+
+  // warm up until vectors reach full size
+  for (int i = 0; i < 100; ++i)
+    go();
+
+  const int N_CYCLES = 300;
+  ArtAlloc::Counter allocs;
+  int start_pt = ElementID(nav_->navdata.last_waypt).pt;
+  for (int i = 0; i < N_CYCLES; ++i)
+    go();
+  EXPECT_EQ(0u, allocs.count());
+
+  // and it did pass some way-points meanwhile
+  EXPECT_GT(ElementID(nav_->navdata.last_waypt).pt, start_pt);
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "test_navigator_cycle");
+
+  // formatting log messages allocates, even when nobody listens
+  if (ros::console::set_logger_level(ROSCONSOLE_DEFAULT_NAME,
+                                     ros::console::levels::Warn))
+    ros::console::notifyLoggerLevelsChanged();
+
+  return RUN_ALL_TESTS();
+}
@@ -70,6 +70,14 @@ def test():
     rospy.Subscriber('navigator/cmd', NavigatorCommand, log_cmd)
     rospy.init_node('test_commander')
 
+    # cycle at the navigator's rate, from our private ~hertz parameter
+    hertz = rospy.get_param('~hertz', ArtHertz.NAVIGATOR)
+    if not hertz > 0.0:
+        rospy.logwarn('invalid cycle rate ' + str(hertz) + ' Hz, using '
+                      + str(ArtHertz.NAVIGATOR) + ' Hz instead')
+        hertz = ArtHertz.NAVIGATOR
+    cycle = rospy.Rate(hertz)
+
     rospy.loginfo('starting commander test')
 
     state_msg = NavigatorState()     # navigator state msg with header
@@ -89,7 +97,7 @@ def test():
         log_state(state_msg)
         topic.publish(state_msg)
 
-        rospy.sleep(1.0/ArtHertz.NAVIGATOR)
+        cycle.sleep()
 
 if __name__ == '__main__':
     try:
@@ -33,7 +33,15 @@ namespace art_observers
     /// default constructor
     ObserversConfig():
       map_frame_id(std::string("/map")),
-      robot_frame_id(std::string("vehicle"))
+      robot_frame_id(std::string("vehicle")),
+      approach_range(40.0),
+      intersection_radius(30.0),
+      stop_line_range(10.0),
+      merge_range(50.0),
+      cloud_queue_size(10),
+      max_cloud_age(0.2),
+      cloud_poll_period(0.01),
+      viz_period(0.2)
     {};
     ObserversConfig(const ObserversConfig &that)
     {
@@ -49,12 +57,34 @@ namespace art_observers
       std::string tf_prefix = tf::getPrefixParam(priv_nh);
       robot_frame_id = tf::resolve(tf_prefix, robot_frame_id);
 
+      // conflict zone geometry (see observers::ConflictZones)
+      priv_nh.param("approach_range", approach_range, 40.0);
+      priv_nh.param("intersection_radius", intersection_radius, 30.0);
+      priv_nh.param("stop_line_range", stop_line_range, 10.0);
+      priv_nh.param("merge_range", merge_range, 50.0);
+
+      // queue of point clouds waiting for transforms
+      priv_nh.param("cloud_queue_size", cloud_queue_size, 10);
+      priv_nh.param("max_cloud_age", max_cloud_age, 0.2);
+      priv_nh.param("cloud_poll_period", cloud_poll_period, 0.01);
+
+      // rviz obstacle markers, when subscribed
+      priv_nh.param("viz_period", viz_period, 0.2);
+
       ROS_INFO_STREAM("map frame: " << map_frame_id
 		      << ", robot frame: " << robot_frame_id);
     };
 
     std::string map_frame_id;		///< frame ID of map
     std::string robot_frame_id;		///< frame ID of robot
+    double approach_range;		///< distance before an exit (m)
+    double intersection_radius;		///< exits closer are one intersection (m)
+    double stop_line_range;		///< queue watched behind stop lines (m)
+    double merge_range;			///< oncoming traffic watched at merges (m)
+    int cloud_queue_size;		///< maximum clouds waiting for tf
+    double max_cloud_age;		///< drop clouds older than this (s)
+    double cloud_poll_period;		///< retry waiting clouds this often (s)
+    double viz_period;			///< minimum time between markers (s)
   };
 
 }; // namespace art_observers
@@ -33,7 +33,8 @@ public:
   ~AdjacentRight();
 
   virtual art_msgs::Observation
-    update(const art_msgs::ArtLanes &local_map,
+    update(const art_msgs::ArtQuadrilateral &robot_quad,
+           const art_msgs::ArtLanes &local_map,
            const art_msgs::ArtLanes &obstacles,
 	   MapPose pose_);
 
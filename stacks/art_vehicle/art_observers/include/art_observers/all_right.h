@@ -0,0 +1,44 @@
+/* -*- mode: C++ -*-
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ * 
+ *  $Id$
+ */
+
+/**  @file
+
+     All right lanes observer interface.
+
+ */
+
+#ifndef _ALL_RIGHT_OBSERVER_H_
+#define _ALL_RIGHT_OBSERVER_H_
+
+#include <art_observers/conflict_zones.h>
+#include <art_observers/observer.h>
+
+namespace observers
+{
+
+/** @brief All right observer class. */
+class AllRight: public Observer 
+{
+public:
+  AllRight(art_observers::ObserversConfig &config,
+           const ConflictZones &zones);
+  ~AllRight();
+
+  virtual art_msgs::Observation
+    update(const art_msgs::ArtQuadrilateral &robot_quad,
+           const art_msgs::ArtLanes &local_map,
+           const art_msgs::ArtLanes &obstacles,
+	   MapPose pose_);
+
+private:
+  const ConflictZones &zones_;		///< precomputed conflict zones
+};
+
+}; // namespace observers
+
+#endif // _ALL_RIGHT_OBSERVER_H_
@@ -0,0 +1,130 @@
+/* -*- mode: C++ -*-
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+/**  @file
+
+     ART observers conflict zones interface.
+
+     Conflict zones are the sets of road map polygons where other
+     vehicles could interfere with the robot at an intersection or
+     merge point.  They are computed once when the global road map
+     arrives, so each observer update only checks the obstacle quads
+     against the few polygons relevant to the current approach.
+
+ */
+
+#ifndef _CONFLICT_ZONES_H_
+#define _CONFLICT_ZONES_H_
+
+#include <limits>
+#include <map>
+#include <vector>
+#include <tr1/unordered_map>
+
+#include <art_msgs/ArtLanes.h>
+#include <art_observers/ObserversConfig.h>
+#include <art_map/PolyOps.h>
+
+namespace observers
+{
+
+/** @brief Precomputed intersection and merge conflict zones. */
+class ConflictZones
+{
+public:
+
+  /** Kinds of conflict zones for each approach. */
+  typedef enum
+    {
+      Intersection,			///< other stop lines and crossing
+      MergeNearest,			///< lanes entered by our transitions
+      MergeAll,				///< all traffic that does not stop
+      N_Zones
+    } zone_t;
+
+  /** Sides of a lane, for the All_left and All_right observers. */
+  typedef enum
+    {
+      Left,
+      Right,
+      N_Sides
+    } side_t;
+
+  /** A zone is a list of groups, each a sorted vector of poly IDs.
+   *
+   *  Each group represents one lane or stop line, so the number of
+   *  occupied groups approximates the number of vehicles.
+   */
+  typedef std::vector<std::vector<int> > zone_list_t;
+
+  ConflictZones(const art_observers::ObserversConfig &config);
+
+  void build(const art_msgs::ArtLanes &road_map);
+
+  /** @return true if no road map has been processed yet. */
+  bool empty() const
+  {
+    return lanes_.empty();
+  }
+
+  int approach(int poly_id) const;
+  bool approachStops(int approach) const;
+  unsigned count(int approach, zone_t kind,
+                 const art_msgs::ArtLanes &obstacles,
+                 const MapPose &pose, float &distance) const;
+  unsigned countSide(int poly_id, side_t side,
+                     const art_msgs::ArtLanes &obstacles,
+                     const MapPose &pose, float &distance) const;
+
+private:
+
+  /** Precomputed zones for one lane exit or stop way-point. */
+  struct Approach
+  {
+    ElementID exit;			///< exit or stop way-point ID
+    MapXY where;			///< exit way-point location
+    bool is_stop;			///< exit has a stop line
+    zone_list_t zones[N_Zones];		///< conflict zones
+  };
+
+  /** Per-lane data. */
+  struct Lane
+  {
+    std::vector<int> polys;		///< non-transition polys, in order
+    std::vector<int> sides[N_Sides];	///< indices of lanes on each side
+  };
+
+  typedef std::map<ElementID, std::vector<int> > lane_groups_t;
+
+  void addUpstream(int lane, int pos, const MapXY &where,
+                   double range, std::vector<int> &group) const;
+  int closestInLane(int lane, const MapXY &where) const;
+  void flatten(const lane_groups_t &groups, zone_list_t &zones) const;
+  int laneIndex(const ElementID &way) const;
+  static ElementID laneID(const ElementID &way)
+  {
+    return ElementID(way.seg, way.lane, 0);
+  }
+
+  art_observers::ObserversConfig config_;
+
+  poly_list_t polys_;			///< global road map polygons
+  std::tr1::unordered_map<int, int> index_; ///< poly ID => polys_ index
+  std::map<ElementID, MapXY> way_points_; ///< way-point locations
+
+  std::vector<Lane> lanes_;		///< all lanes in the road map
+  std::map<ElementID, int> lane_index_;	///< lane ID => lanes_ index
+  std::tr1::unordered_map<int, int> lane_of_; ///< poly ID => lanes_ index
+
+  std::vector<Approach> approaches_;	///< all lane exits
+  std::tr1::unordered_map<int, int> approach_of_; ///< poly ID => approach
+};
+
+}; // namespace observers
+
+#endif // _CONFLICT_ZONES_H_
@@ -18,6 +18,7 @@
 #ifndef _LANE_OBSERVATIONS_H_
 #define _LANE_OBSERVATIONS_H_
 
+#include <deque>
 #include <vector>
 #include <tr1/unordered_set>
 
@@ -28,10 +29,9 @@
 #include <pcl/io/pcd_io.h>
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
+#include <pcl_ros/point_cloud.h>
 #include <pcl_ros/transforms.h>
 #include <sensor_msgs/PointCloud.h>
-#include <sensor_msgs/PointCloud2.h>
-#include <tf/transform_listener.h>
 #include <visualization_msgs/MarkerArray.h>
 #include <nav_msgs/Odometry.h>
 
@@ -39,7 +39,15 @@
 #include <art_observers/nearest_backward.h>
 #include <art_observers/adjacent_left.h>
 #include <art_observers/adjacent_right.h>
-
+#include <art_observers/all_left.h>
+#include <art_observers/all_right.h>
+#include <art_observers/merge_into_nearest.h>
+#include <art_observers/merge_across_all.h>
+#include <art_observers/intersection.h>
+
+#include <art/message_pool.h>
+#include <art_map/pose_history.h>
+#include <art_map/transform_cache.h>
 #include <art_observers/ObserversConfig.h>
 typedef art_observers::ObserversConfig Config;
 
@@ -64,60 +72,85 @@ private:
   void addObserver(observers::Observer &obs)
   {
     observers_.push_back(&obs);
-    observations_.obs.push_back(art_msgs::Observation());
   }
 
   void calcRobotPolygon();
+  void dropOldestCloud(const char *reason);
   void filterPointsInLocalMap();
   bool isPointInAPolygon(float x, float y);
+  void processGlobalMap(const art_msgs::ArtLanes::ConstPtr &msg);
   void processLocalMap(const art_msgs::ArtLanes::ConstPtr &msg);
-  void processObstacles(void);
+  void pollCloudQueue(const ros::TimerEvent &event);
+  void processCloudQueue();
+  void processObstacles(const PtCloud &cloud);
   void processPointCloud(const sensor_msgs::PointCloud::ConstPtr &msg);
-  void processPointCloud2(const sensor_msgs::PointCloud2::ConstPtr &msg);
+  void processPointCloud2(const PtCloud::ConstPtr &msg);
   void processPose(const nav_msgs::Odometry &odom);
+  void queueCloud(const PtCloud::ConstPtr &cloud);
+  void initObstacleVisualization();
   void publishObstacleVisualization();
   void runObservers();
-  void transformPointCloud(const PtCloud &msg);
+  bool transformPointCloud(const PtCloud &msg);
 
   ros::NodeHandle node_;		///< node handle
   ros::NodeHandle priv_nh_;		///< private node handle
 
   Config config_;			///< configuration parameters
 
+  /// intersection and merge zones, computed from the global road map
+  observers::ConflictZones conflict_zones_;
+
   // observer instances
   observers::NearestForward nearest_forward_observer_;
   observers::NearestBackward nearest_backward_observer_;
   observers::AdjacentLeft adjacent_left_observer_;
   observers::AdjacentRight adjacent_right_observer_;
+  observers::AllLeft all_left_observer_;
+  observers::AllRight all_right_observer_;
+  observers::MergeIntoNearest merge_into_nearest_observer_;
+  observers::MergeAcrossAll merge_across_all_observer_;
+  observers::Intersection intersection_observer_;
 
-  boost::shared_ptr<tf::TransformListener> tf_listener_;
+  TransformCache transforms_;		///< recent tf transforms
 
   // ROS topic subscriptions and publishers
   ros::Subscriber pc_sub_;		///< deprecated PointCloud input
   ros::Subscriber pc2_sub_;		///< PointCloud2 input
   ros::Subscriber road_map_sub_;
+  ros::Subscriber global_map_sub_;	///< latched global road map
   ros::Subscriber odom_sub_;
   ros::Publisher observations_pub_;
   ros::Publisher viz_pub_;
+  ros::Timer queue_timer_;		///< retries queued clouds, while any
+
+  std::deque<PtCloud::ConstPtr> cloud_queue_; ///< clouds waiting for tf, by stamp
+  unsigned dropped_clouds_;		///< clouds never processed
 
-  PtCloud obstacles_;			///< current obstacle data
-  art_msgs::ArtLanes local_map_;	///< local road map
+  /// converted deprecated PointCloud input, reused once processed
+  /// or dropped
+  ArtMsgPool::MessagePool<PtCloud> cloud_pool_;
+
+  PtCloud obstacles_;			///< current obstacles, map frame
+  art_msgs::ArtLanes::ConstPtr local_map_; ///< latest local road map
 
   /// vector of observers, in order of the observations they publish
   std::vector<observers::Observer *> observers_;
 
-  /// current observations from the observers
+  /// current observations, one per observer ID
   art_msgs::ObservationArray observations_;
 
   std::tr1::unordered_set<int> added_quads_; ///< set of obstacle quads
   art_msgs::ArtLanes obs_quads_;	///< vector of obstacle quads
-  std::vector<art_msgs::ArtQuadrilateral>::iterator obs_it_;
+  unsigned n_obs_quads_;		///< obstacle quads found so far
   art_msgs::ArtQuadrilateral robot_polygon_; ///< robot's current polygon
-  MapPose pose_; // pose of Map
+  MapPose pose_;			///< robot pose for current obstacles
+  PoseHistory pose_history_;		///< recent odometry poses
 
-  /// Only used within LaneObservations::publishObstacleVisualization(), a
-  /// class variable only to avoid memory allocation on every cycle.
+  /// Only used within LaneObservations::publishObstacleVisualization(),
+  /// a single CUBE_LIST marker, set up once and reused every cycle.
   visualization_msgs::MarkerArray marks_msg_;
+  ros::Time last_viz_time_;		///< scan time of last markers
+
 };
 
 #endif // _LANE_OBSERVATIONS_H_
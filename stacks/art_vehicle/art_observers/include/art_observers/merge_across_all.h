@@ -0,0 +1,44 @@
+/* -*- mode: C++ -*-
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ * 
+ *  $Id$
+ */
+
+/**  @file
+
+     Merge across all lanes observer interface.
+
+ */
+
+#ifndef _MERGE_ACROSS_ALL_OBSERVER_H_
+#define _MERGE_ACROSS_ALL_OBSERVER_H_
+
+#include <art_observers/conflict_zones.h>
+#include <art_observers/observer.h>
+
+namespace observers
+{
+
+/** @brief Merge across all observer class. */
+class MergeAcrossAll: public Observer 
+{
+public:
+  MergeAcrossAll(art_observers::ObserversConfig &config,
+                 const ConflictZones &zones);
+  ~MergeAcrossAll();
+
+  virtual art_msgs::Observation
+    update(const art_msgs::ArtQuadrilateral &robot_quad,
+           const art_msgs::ArtLanes &local_map,
+           const art_msgs::ArtLanes &obstacles,
+	   MapPose pose_);
+
+private:
+  const ConflictZones &zones_;		///< precomputed conflict zones
+};
+
+}; // namespace observers
+
+#endif // _MERGE_ACROSS_ALL_OBSERVER_H_
@@ -42,10 +42,10 @@ public:
    */
   Observer(art_observers::ObserversConfig &config,
 	   Oid_t id, const std::string &name):
-    config_(config)
+    config_(config),
+    name_(name)
   {
     observation_.oid = id;
-    observation_.name = name;
     observation_.applicable = false;
     observation_.clear = false;
     observation_.time = std::numeric_limits<float>::infinity();
@@ -55,12 +55,25 @@ public:
   }
   ~Observer();
 
+  /** @return observer ID */
+  Oid_t oid() const
+  {
+    return observation_.oid;
+  }
+
+  /** @return observer name, for logging */
+  const std::string &name() const
+  {
+    return name_;
+  }
+
   /** Generic observer update function.
    *
    *  Called whenever there are new obstacle data, assuming the
    *  local_map is also available.
    *
-   *  @param robot_quad    quadrilateral containing the robot
+   *  @param robot_quad    quadrilateral containing the robot,
+   *                       poly_id -1 if none
    *  @param local_map     road map lanes within range of the robot
    *  @param obstacles     local map quads currently containing obstacles
    *  @param pose          current pose of robot
@@ -68,7 +81,8 @@ public:
    *  @todo Make pure virtual once deprecated version is deleted. 
    */
   virtual art_msgs::Observation
-    update(const art_msgs::ArtLanes &local_map,
+    update(const art_msgs::ArtQuadrilateral &robot_quad,
+           const art_msgs::ArtLanes &local_map,
            const art_msgs::ArtLanes &obstacles,
 	   MapPose pose) = 0;
 
@@ -83,6 +97,7 @@ public:
 protected:
   art_msgs::Observation observation_;
   art_observers::ObserversConfig config_;
+  std::string name_;
 };
 
 }; // namespace observers
@@ -18,7 +18,7 @@
 
 */
 
-#include <sensor_msgs/point_cloud_conversion.h>
+#include <algorithm>
 #include <art_observers/lane_observations.h>
 #include <art_observers/QuadrilateralOps.h>
 
@@ -28,12 +28,24 @@ LaneObservations::LaneObservations(ros::NodeHandle &node,
   node_(node),
   priv_nh_(priv_nh),
   config_(priv_nh),
+  conflict_zones_(config_),
   nearest_forward_observer_(config_),
   nearest_backward_observer_(config_),
   adjacent_left_observer_(config_),
   adjacent_right_observer_(config_),
-  tf_listener_(new tf::TransformListener())
+  all_left_observer_(config_, conflict_zones_),
+  all_right_observer_(config_, conflict_zones_),
+  merge_into_nearest_observer_(config_, conflict_zones_),
+  merge_across_all_observer_(config_, conflict_zones_),
+  intersection_observer_(config_, conflict_zones_),
+  dropped_clouds_(0),
+  n_obs_quads_(0)
 { 
+  // one buffer per queued cloud, plus the one being converted
+  cloud_pool_.resize(config_.cloud_queue_size + 1);
+
+  transforms_.subscribe(node_);
+
   // subscribe to point cloud topics
   pc_sub_ =
     node_.subscribe("velodyne/obstacles", 1,
@@ -44,15 +56,27 @@ LaneObservations::LaneObservations(ros::NodeHandle &node,
                     &LaneObservations::processPointCloud2, this,
                     ros::TransportHints().tcpNoDelay(true));
 
+  // retry clouds waiting for their transforms, only running while
+  // the queue holds any
+  queue_timer_ =
+    node_.createTimer(ros::Duration(config_.cloud_poll_period),
+                      &LaneObservations::pollCloudQueue, this);
+  queue_timer_.stop();
+
   // subscribe to local road map
   road_map_sub_ =
     node_.subscribe("roadmap_local", 1,
                     &LaneObservations::processLocalMap, this,
                     ros::TransportHints().tcpNoDelay(true));
 
+  // subscribe to global road map (latched), for conflict zones
+  global_map_sub_ =
+    node_.subscribe("roadmap_global", 1,
+                    &LaneObservations::processGlobalMap, this);
+
   // subscribe to odometry
   odom_sub_ = 
-    node_.subscribe("odom", 1,
+    node_.subscribe("odom", 10,
                     &LaneObservations::processPose, this,
                     ros::TransportHints().tcpNoDelay(true));
 
@@ -60,14 +84,30 @@ LaneObservations::LaneObservations(ros::NodeHandle &node,
   const std::string viz_topic("visualization_marker_array");
   viz_pub_ =
     node_.advertise<visualization_msgs::MarkerArray>(viz_topic, 1, true);
+  initObstacleVisualization();
   observations_pub_ =
     node_.advertise <art_msgs::ObservationArray>("observations", 1, true);
 
+  // Every observer ID has an entry, not applicable until some
+  // observer reports it.
+  observations_.obs.resize(art_msgs::Observation::N_Observers);
+  for (unsigned i = 0; i < observations_.obs.size(); ++i)
+    {
+      observations_.obs[i].oid = i;
+      observations_.obs[i].applicable = false;
+      observations_.obs[i].clear = false;
+    }
+
   // Initialize observers.  They will be updated in this order.
   addObserver(nearest_forward_observer_);
   addObserver(nearest_backward_observer_);
   addObserver(adjacent_left_observer_);
   addObserver(adjacent_right_observer_);
+  addObserver(all_left_observer_);
+  addObserver(all_right_observer_);
+  addObserver(merge_into_nearest_observer_);
+  addObserver(merge_across_all_observer_);
+  addObserver(intersection_observer_);
 }
 
 /** @brief Deconstructor. */
@@ -75,16 +115,21 @@ LaneObservations::~LaneObservations() {}
 
 /** @brief Obstacles point cloud processing.  Starts all the observers
  *
- *  @pre @c obstacles_ contains the point cloud data received
+ *  @param cloud point cloud data received, transform available
  */
-void LaneObservations::processObstacles(void) 
+void LaneObservations::processObstacles(const PtCloud &cloud) 
 {
-  observations_.header.stamp = obstacles_.header.stamp;
-  obs_quads_.polygons.clear();
-  transformPointCloud(obstacles_);
+  observations_.header.stamp = cloud.header.stamp;
+  n_obs_quads_ = 0;
+
+  // observe from where the robot was when the cloud was acquired,
+  // or else its latest known pose
+  pose_history_.lookup(cloud.header.stamp, pose_);
+  if (!transformPointCloud(cloud))
+    return;
   
   // skip the rest until the local road map has been received at least once
-  if (local_map_.header.stamp > ros::Time())
+  if (local_map_)
     {
       filterPointsInLocalMap();
       runObservers();
@@ -92,41 +137,145 @@ void LaneObservations::processObstacles(void)
     }
 }
 
-/** @brief PointCloud callback. */
+/** @brief PointCloud callback.
+ *
+ *  Copies the points straight into a pooled PCL cloud, so their
+ *  vectors are reused from one message to the next.
+ */
 void LaneObservations::processPointCloud(const sensor_msgs::PointCloud::ConstPtr &msg)
 {
-  // convert to PointCloud2, then process that
-  boost::shared_ptr<sensor_msgs::PointCloud2> pc2(new sensor_msgs::PointCloud2);
-  sensor_msgs::convertPointCloudToPointCloud2(*msg, *pc2);
-  processPointCloud2(pc2);
+  PtCloud::Ptr cloud = cloud_pool_.get();
+  cloud->header.stamp = msg->header.stamp;
+  cloud->header.frame_id = msg->header.frame_id;
+  size_t npoints = msg->points.size();
+  cloud->points.resize(npoints);
+  for (size_t i = 0; i < npoints; ++i)
+    {
+      cloud->points[i].x = msg->points[i].x;
+      cloud->points[i].y = msg->points[i].y;
+      cloud->points[i].z = msg->points[i].z;
+    }
+  cloud->width = npoints;
+  cloud->height = 1;
+  cloud->is_dense = true;
+  queueCloud(cloud);
+}
+
+/** @brief PointCloud2 callback, already unpacked into PCL points. */
+void LaneObservations::processPointCloud2(const PtCloud::ConstPtr &msg)
+{
+  queueCloud(msg);
+}
+
+/** @brief Queue a point cloud for processing.
+ *
+ *  Never waits for tf.  The cloud is queued in time stamp order, then
+ *  any clouds whose transforms are already available get processed.
+ *
+ *  @param cloud shared with the subscription, never modified
+ */
+void LaneObservations::queueCloud(const PtCloud::ConstPtr &cloud)
+{
+  // insert in stamp order, usually at the end
+  std::deque<PtCloud::ConstPtr>::iterator it = cloud_queue_.end();
+  while (it != cloud_queue_.begin()
+         && cloud->header.stamp < (*(it-1))->header.stamp)
+    --it;
+  cloud_queue_.insert(it, cloud);
+
+  // bound the queue, discarding the oldest data first
+  while (cloud_queue_.size() > (unsigned) config_.cloud_queue_size)
+    dropOldestCloud("queue full");
+
+  processCloudQueue();
+}
+
+/** @brief Process queued clouds whose transforms are available.
+ *
+ *  Clouds are handled strictly in stamp order: a cloud still waiting
+ *  for tf holds back newer ones until it either becomes transformable
+ *  or exceeds max_cloud_age and is dropped.  That bounds observer
+ *  latency when tf is late.
+ *
+ *  The poll timer runs only while some cloud is still waiting.
+ */
+void LaneObservations::processCloudQueue()
+{
+  ros::Time now = ros::Time::now();
+  while (!cloud_queue_.empty())
+    {
+      const PtCloud &cloud = *cloud_queue_.front();
+      if (transforms_.canTransform(config_.map_frame_id,
+                                   cloud.header.frame_id,
+                                   cloud.header.stamp))
+        {
+          processObstacles(cloud);
+          cloud_queue_.pop_front();
+        }
+      else if ((now - cloud.header.stamp).toSec() > config_.max_cloud_age)
+        {
+          dropOldestCloud("no transform");
+        }
+      else
+        {
+          break;                        // wait for tf to catch up
+        }
+    }
+
+  if (cloud_queue_.empty())
+    queue_timer_.stop();
+  else
+    queue_timer_.start();
 }
 
-/** @brief PointCloud2 callback. */
-void LaneObservations::processPointCloud2(const sensor_msgs::PointCloud2::ConstPtr &msg)
+/** @brief Timer callback, retries clouds waiting for transforms. */
+void LaneObservations::pollCloudQueue(const ros::TimerEvent &event)
 {
-  // convert ROS message into PCL point cloud
-  pcl::fromROSMsg(*msg, obstacles_);
+  processCloudQueue();
+}
 
-  // process the PCL point cloud data
-  processObstacles();
+/** @brief Drop the oldest queued cloud, counting it.
+ *
+ *  @param reason why it was dropped, for the log
+ */
+void LaneObservations::dropOldestCloud(const char *reason)
+{
+  ++dropped_clouds_;
+  ROS_WARN_THROTTLE(20, "point cloud dropped (%s), %u dropped so far",
+                    reason, dropped_clouds_);
+  cloud_queue_.pop_front();
 }
 
-/** @brief Local road map callback. */
+/** @brief Local road map callback.
+ *
+ *  Keeps a reference to the message instead of copying it.
+ */
 void LaneObservations::processLocalMap(const art_msgs::ArtLanes::ConstPtr &msg) 
 {
-  local_map_ = *msg;
+  local_map_ = msg;
+}
+
+/** @brief Global road map callback.
+ *
+ *  The conflict zones only change when a new map is published, so
+ *  they are precomputed here instead of on every point cloud.
+ */
+void LaneObservations::processGlobalMap(const art_msgs::ArtLanes::ConstPtr &msg)
+{
+  conflict_zones_.build(*msg);
 }
 
-/** @brief process the pose of the map **/
+/** @brief Odometry callback, saves the pose history. */
 void LaneObservations::processPose(const nav_msgs::Odometry &odom)
 {
   pose_ = MapPose(odom.pose.pose);
+  if (!pose_history_.add(odom))
+    ROS_DEBUG("odometry out of order, not added to pose history");
 }
 
 /** @brief Filter obstacle points to those in a road map polygon. */
 void LaneObservations::filterPointsInLocalMap() 
 {
-  // set the exact point cloud size
   size_t npoints = obstacles_.points.size();
   added_quads_.clear();
   for (unsigned i = 0; i < npoints; ++i)
@@ -134,28 +283,35 @@ void LaneObservations::filterPointsInLocalMap()
       isPointInAPolygon(obstacles_.points[i].x,
                         obstacles_.points[i].y);
     }
+
+  // polygons after the last one found are left over from earlier
+  obs_quads_.polygons.resize(n_obs_quads_);
 }
 
-/** @brief Transform obstacle points into the map frame of reference. */
-void LaneObservations::transformPointCloud(const PtCloud &msg) 
+/** @brief Transform obstacle points into the map frame of reference.
+ *
+ *  @param msg point cloud, its transform must already be available
+ *  @return true if @c obstacles_ now contains the transformed points
+ */
+bool LaneObservations::transformPointCloud(const PtCloud &msg) 
 {
-  try
+  tf::StampedTransform transform;
+  if (!transforms_.lookup(config_.map_frame_id, msg.header.frame_id,
+                          msg.header.stamp, transform))
     {
-      // wait for transform to be available
-      tf_listener_->waitForTransform(config_.map_frame_id, msg.header.frame_id,
-				     msg.header.stamp, ros::Duration(0.2));
-      pcl_ros::transformPointCloud(config_.map_frame_id, msg, obstacles_,
-				   *tf_listener_);
-      observations_.header.frame_id = obstacles_.header.frame_id;
-
-      // hopefully not needed in future
-      calcRobotPolygon();
-    }
-  catch (tf::TransformException ex)
-    {
-      // only log tf error once every 20 times
-      ROS_WARN_STREAM_THROTTLE(20, ex.what());
+      ROS_WARN_THROTTLE(20, "no transform from %s to %s",
+                        msg.header.frame_id.c_str(),
+                        config_.map_frame_id.c_str());
+      return false;
     }
+
+  pcl_ros::transformPointCloud(msg, obstacles_, transform);
+  obstacles_.header.frame_id = config_.map_frame_id;
+  obstacles_.header.stamp = msg.header.stamp;
+  observations_.header.frame_id = obstacles_.header.frame_id;
+
+  calcRobotPolygon();
+  return true;
 }
 
 /** Point in polygon predicate.
@@ -163,18 +319,19 @@ void LaneObservations::transformPointCloud(const PtCloud &msg)
  *  @return true if (X, Y) is within a road map polygon.
  *
  *  @post @a added_quads contains polygon ID, if found.
- *        @a obstacle_quads contains polygon, if found.
+ *        @a obs_quads_ contains polygon, if found, reusing the
+ *        storage of any polygon previously at that index.
  */
 bool LaneObservations::isPointInAPolygon(float x, float y) 
 {
-  size_t num_polys = local_map_.polygons.size();
+  size_t num_polys = local_map_->polygons.size();
   
   bool inside = false;
   std::pair<std::tr1::unordered_set<int>::iterator, bool> pib;
   
   for (size_t i=0; i<num_polys; i++)
     {
-      art_msgs::ArtQuadrilateral *p= &(local_map_.polygons[i]);
+      const art_msgs::ArtQuadrilateral *p= &(local_map_->polygons[i]);
       float dist= ((p->midpoint.x-x)*(p->midpoint.x-x)
                    + (p->midpoint.y-y)*(p->midpoint.y-y));
 
@@ -188,7 +345,11 @@ bool LaneObservations::isPointInAPolygon(float x, float y)
           pib = added_quads_.insert(p->poly_id);
           if (pib.second)
             {
-              obs_quads_.polygons.push_back(*p);
+              if (n_obs_quads_ < obs_quads_.polygons.size())
+                obs_quads_.polygons[n_obs_quads_] = *p;
+              else
+                obs_quads_.polygons.push_back(*p);
+              ++n_obs_quads_;
             }
         }
     }
@@ -202,118 +363,119 @@ void LaneObservations::runObservers()
   // update all the registered observers
   for (unsigned i = 0; i < observers_.size(); ++i)
     {
-      observations_.obs[i] =
-	observers_[i]->update(local_map_, obs_quads_, pose_);
+      art_msgs::Observation &obs = observations_.obs[observers_[i]->oid()];
+      obs = observers_[i]->update(robot_polygon_, *local_map_,
+                                  obs_quads_, pose_);
+      obs.stamp = observations_.header.stamp;
     }
 
   // Publish their observations
   observations_pub_.publish(observations_);
 }                                                            
 
-/** @brief Calculate which polygon currently contains the robot. */
+/** @brief Calculate which polygon contains the robot.
+ *
+ *  Uses the same pose the observers see for these obstacles.  Done
+ *  once per scan, all the observers share the result.
+ *
+ *  @post robot_polygon_.poly_id is -1 if no polygon contains the robot.
+ */
 void LaneObservations::calcRobotPolygon() 
 {
-  // --- Hack to get my own polygon
-  geometry_msgs::PointStamped laser_point;
-  laser_point.header.frame_id = config_.robot_frame_id;  
-  laser_point.header.stamp = ros::Time();
-  
-  laser_point.point.x = 0.0;
-  laser_point.point.y = 0.0;
-  laser_point.point.z = 0.0;
-  
-  geometry_msgs::PointStamped robot_point;
-  tf_listener_->transformPoint(config_.map_frame_id, laser_point, robot_point);
+  robot_polygon_.poly_id = -1;
+  if (!local_map_)
+    return;
 
-  size_t numPolys = local_map_.polygons.size();
-  float x = robot_point.point.x; 
-  float y = robot_point.point.y;
-  bool inside=false;
+  size_t numPolys = local_map_->polygons.size();
+  float x = pose_.map.x;
+  float y = pose_.map.y;
   for (size_t i=0; i<numPolys; i++)
     {
-      art_msgs::ArtQuadrilateral *p= &(local_map_.polygons[i]);
+      const art_msgs::ArtQuadrilateral *p= &(local_map_->polygons[i]);
       float dist = ((p->midpoint.x-x)*(p->midpoint.x-x)
                     + (p->midpoint.y-y)*(p->midpoint.y-y));
 
       if (dist > 16)          // quick check: we are near the polygon?
         continue;
 
-      inside = quad_ops::quickPointInPoly(x,y,*p); 
-      if (inside)
+      if (quad_ops::quickPointInPoly(x,y,*p))
         {
           robot_polygon_ = *p;
+          break;
         }
     }
 }
 
-/** @brief Publish rviz markers for obstacles in the road. */
+/** @brief Set up the obstacle marker message once.
+ *
+ *  Only the point and color vectors change from scan to scan.
+ */
+void LaneObservations::initObstacleVisualization()
+{
+  marks_msg_.markers.resize(1);
+  visualization_msgs::Marker &mark = marks_msg_.markers[0];
+  mark.header.frame_id = config_.map_frame_id;
+
+  mark.ns = "obstacle_polygons";
+  mark.id = 0;
+  mark.type = visualization_msgs::Marker::CUBE_LIST;
+  mark.action = visualization_msgs::Marker::ADD;
+  mark.pose.orientation.w = 1.0;
+
+  mark.scale.x = 1.5;
+  mark.scale.y = 1.5;
+  mark.scale.z = 0.1;
+
+  // keep each set of markers until the next one arrives
+  mark.lifetime = ros::Duration(std::max(0.2, 2.0 * config_.viz_period));
+  mark.color.a = 0.8;
+
+  // reserve enough for typical scenes, vectors only grow
+  mark.points.reserve(64);
+  mark.colors.reserve(64);
+}
+
+/** @brief Publish rviz markers for obstacles in the road.
+ *
+ *  All obstacle polygons plus the robot's own polygon go in one
+ *  CUBE_LIST marker, published no more often than viz_period.
+ */
 void LaneObservations::publishObstacleVisualization()
 {
   if (viz_pub_.getNumSubscribers()==0)
     return;
 
-  ros::Time now = ros::Time::now();
+  // decimate to the display rate, using scan times so playback of
+  // recorded data works too (restart if time went backwards)
+  const ros::Time &stamp = observations_.header.stamp;
+  if (stamp >= last_viz_time_
+      && (stamp - last_viz_time_).toSec() < config_.viz_period)
+    return;
+  last_viz_time_ = stamp;
+
+  visualization_msgs::Marker &mark = marks_msg_.markers[0];
+  mark.header.stamp = stamp;
 
-  // clear message array, this is a class variable to avoid memory
-  // allocation and deallocation on every cycle
-  marks_msg_.markers.clear();
+  // resize() reuses the vectors' storage once they are big enough
+  unsigned nquads = obs_quads_.polygons.size();
+  mark.points.resize(nquads + 1);
+  mark.colors.resize(nquads + 1);
 
-  int i=0;
-  for (obs_it_=obs_quads_.polygons.begin();
-       obs_it_!=obs_quads_.polygons.end(); obs_it_++)
+  for (unsigned i = 0; i < nquads; ++i)
     {
-      visualization_msgs::Marker mark;
-      mark.header.stamp = now;
-      mark.header.frame_id = config_.map_frame_id;
-    
-      mark.ns = "obstacle_polygons";
-      mark.id = (int32_t) i;
-      mark.type = visualization_msgs::Marker::CUBE;
-      mark.action = visualization_msgs::Marker::ADD;
-    
-      mark.pose.position = obs_it_->midpoint;
-      mark.pose.orientation =
-        tf::createQuaternionMsgFromYaw(obs_it_->heading);
-    
-      mark.scale.x = 1.5;
-      mark.scale.y = 1.5;
-      mark.scale.z = 0.1;
-      mark.lifetime =  ros::Duration(0.2);
-    
-      mark.color.a = 0.8;       // way-points are slightly transparent
-      mark.color.r = 0.0;
-      mark.color.g = 0.0;
-      mark.color.b = 1.0;
-    
-      marks_msg_.markers.push_back(mark);
-      i++;
+      mark.points[i] = obs_quads_.polygons[i].midpoint;
+      mark.colors[i].a = 0.8;   // way-points are slightly transparent
+      mark.colors[i].r = 0.0;
+      mark.colors[i].g = 0.0;
+      mark.colors[i].b = 1.0;
     }
 
   // Draw the polygon containing the robot
-  visualization_msgs::Marker mark;
-  mark.header.stamp = now;
-  mark.header.frame_id = config_.map_frame_id;
-  
-  mark.ns = "obstacle_polygons";
-  mark.id = (int32_t) i;
-  mark.type = visualization_msgs::Marker::CUBE;
-  mark.action = visualization_msgs::Marker::ADD;
-    
-  mark.pose.position = robot_polygon_.midpoint;
-  mark.pose.orientation =
-    tf::createQuaternionMsgFromYaw(robot_polygon_.heading);
-    
-  mark.scale.x = 1.5;
-  mark.scale.y = 1.5;
-  mark.scale.z = 0.1;
-  mark.lifetime =  ros::Duration(0.2);
-  
-  mark.color.a = 0.8;           // way-points are slightly transparent
-  mark.color.r = 0.3;
-  mark.color.g = 0.7;
-  mark.color.b = 0.9;
-  
-  marks_msg_.markers.push_back(mark);
+  mark.points[nquads] = robot_polygon_.midpoint;
+  mark.colors[nquads].a = 0.8;
+  mark.colors[nquads].r = 0.3;
+  mark.colors[nquads].g = 0.7;
+  mark.colors[nquads].b = 0.9;
 
   // Publish the markers
   viz_pub_.publish(marks_msg_);
@@ -1,101 +1,190 @@
 /*
  *  Copyright (C) 2010 UT-Austin &  Austin Robot Technology, Michael Quinlan
- * 
- *  License: Modified BSD Software License 
+ *
+ *  License: Modified BSD Software License
  */
 
 /** \file
 
-  This node takes in a point cloud an republishes only the points that
-  lie inside road polygons
+  This node takes in a point cloud and republishes only the points
+  that lie inside road polygons, in the /map frame.
 
-  This probably not the neatest or fastest way of doing this, but it's
-  an example.
+  Input and output are PCL point clouds, carried as PointCloud2 on the
+  wire.  Each cloud is transformed and filtered in a single pass over
+  its points, with one tf lookup per cloud.  The deprecated
+  sensor_msgs::PointCloud input is still accepted, and handled the
+  same way without any intermediate conversion.
+
+  Transforms come from a TransformCache, so lookups never wait.
 
   @author Michael Quinlan
 
 */
 
 #include <ros/ros.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl_ros/point_cloud.h>
 #include <sensor_msgs/PointCloud.h>
 
+#include <art/message_pool.h>
 #include <art_msgs/ArtLanes.h>
 
 #include <art_map/PolyOps.h>
-#include <tf/transform_listener.h>
+#include <art_map/transform_cache.h>
 
+#include <cfloat>
 #include <string>
+#include <vector>
 
 #define NODE "maplanes_grid"
 
+typedef pcl::PointCloud<pcl::PointXYZ> PtCloud;
+
 static int qDepth = 1;                  // ROS topic queue size
 static ros::Publisher output;
-sensor_msgs::PointCloud pc;             // outgoing PointCloud message
+static const std::string map_frame("/map");
+
+/// outgoing clouds, reused once roscpp releases them
+ArtMsgPool::MessagePool<PtCloud> cloud_pool;
 
-tf::TransformListener* listener;
-art_msgs::ArtLanes map;                 // local map
+TransformCache transforms;              // recent tf transforms
 PolyOps* pops;
 
-bool isPointInMap(float x, float y) 
+/** @brief road polygon with its bounding box
+ *
+ *  The box is a little larger than the hull PolyOps::pointInPoly()
+ *  checks, so it only rejects points that test would reject.
+ */
+struct RoadPoly
 {
-  int numPolys = map.polygons.size();
-  for (int i=0; i<numPolys; i++)
+  poly p;
+  float min_x, min_y, max_x, max_y;
+};
+
+/// polygons of the latest local map, converted once per map message
+std::vector<RoadPoly> road;
+float road_min_x, road_min_y, road_max_x, road_max_y;
+
+/** @brief set up the road polygons for a new local map */
+void setRoad(const art_msgs::ArtLanes &map)
+{
+  static const float margin = 1.0;      // meters
+
+  road.resize(map.polygons.size());
+  road_min_x = road_min_y = FLT_MAX;
+  road_max_x = road_max_y = -FLT_MAX;
+  for (unsigned i = 0; i < road.size(); ++i)
     {
-      poly p(map.polygons[i]);
-      if (pops->pointInPoly(x,y,p))
-        {
-          return true;
-        }
+      RoadPoly &r = road[i];
+      r.p = poly(map.polygons[i]);
+      r.min_x = fminf(fminf(r.p.p1.x, r.p.p2.x), fminf(r.p.p3.x, r.p.p4.x));
+      r.min_y = fminf(fminf(r.p.p1.y, r.p.p2.y), fminf(r.p.p3.y, r.p.p4.y));
+      r.max_x = fmaxf(fmaxf(r.p.p1.x, r.p.p2.x), fmaxf(r.p.p3.x, r.p.p4.x));
+      r.max_y = fmaxf(fmaxf(r.p.p1.y, r.p.p2.y), fmaxf(r.p.p3.y, r.p.p4.y));
+      r.min_x -= margin;
+      r.min_y -= margin;
+      r.max_x += margin;
+      r.max_y += margin;
+      road_min_x = fminf(road_min_x, r.min_x);
+      road_min_y = fminf(road_min_y, r.min_y);
+      road_max_x = fmaxf(road_max_x, r.max_x);
+      road_max_y = fmaxf(road_max_y, r.max_y);
+    }
+}
+
+bool isPointInMap(float x, float y)
+{
+  // no map received yet, or far from every polygon
+  if (road.empty()
+      || x < road_min_x || x > road_max_x
+      || y < road_min_y || y > road_max_y)
+    return false;
+
+  for (unsigned i = 0; i < road.size(); ++i)
+    {
+      const RoadPoly &r = road[i];
+      if (x < r.min_x || x > r.max_x || y < r.min_y || y > r.max_y)
+        continue;
+      if (pops->pointInPoly(x, y, r.p))
+        return true;
     }
   return false;
 }
 
-/** \brief callback for incoming point cloud
+/** \brief transform and filter an incoming point cloud
+
+    Looks up the transform to the /map frame once, then transforms
+    each point and keeps it if it lies in a road polygon.
+
+    The output clouds come from a pool, so their point vectors keep
+    their storage from one cloud to the next.
 
-    Transforms cloud to /map frame of reference
-    CHecks if each point is in a polygon, if so adds it to output point cloud
+    @param msg any cloud whose points have x, y and z fields
  */
-void processObstacles(const sensor_msgs::PointCloud &msg)
+template <class Cloud>
+void processObstacles(const Cloud &msg)
 {
-   //ROS_INFO("num 3d points = %d", msg->points.size());  
-	if(msg.points.size()<1)
-		return;
-  
-  sensor_msgs::PointCloud trans;
-  try {
-    listener->transformPointCloud("/map", msg, trans); 
-
-  } catch (tf::TransformException ex){
-    ROS_ERROR("%s",ex.what());
-  }
- 
-  // pass along original time stamp and frame ID
-  pc.header.stamp = trans.header.stamp;
-  pc.header.frame_id = trans.header.frame_id;
-
-  // set the exact point cloud size -- the vectors should already have
-  // enough space
-  size_t npoints = trans.points.size();
-  pc.points.resize(npoints);
-  size_t count=0;
-  for (unsigned i = 0; i < npoints; ++i)
+  if (msg.points.size() < 1)
+    return;
+
+  tf::StampedTransform transform;
+  if (!transforms.lookup(map_frame, msg.header.frame_id,
+                         msg.header.stamp, transform))
     {
-      bool in = isPointInMap(trans.points[i].x,trans.points[i].y);
-      if (in) {
-        pc.points[count].x = trans.points[i].x;
-        pc.points[count].y = trans.points[i].y;
-        pc.points[count].z = trans.points[i].z;
-        count++;
-      }
+      ROS_WARN_THROTTLE(20, "no transform from %s to %s at %.3f",
+                        msg.header.frame_id.c_str(), map_frame.c_str(),
+                        msg.header.stamp.toSec());
+      return;
     }
-  pc.points.resize(count);
+
+  // pass along original time stamp
+  PtCloud::Ptr pc = cloud_pool.get();
+  pc->header.stamp = msg.header.stamp;
+  pc->header.frame_id = map_frame;
+
+  // set the exact point cloud size afterwards -- the vector usually
+  // already has enough space
+  size_t npoints = msg.points.size();
+  pc->points.resize(npoints);
+  size_t count = 0;
+  for (size_t i = 0; i < npoints; ++i)
+    {
+      tf::Point pt = transform * tf::Point(msg.points[i].x,
+                                           msg.points[i].y,
+                                           msg.points[i].z);
+      if (isPointInMap(pt.x(), pt.y()))
+        {
+          pc->points[count].x = pt.x();
+          pc->points[count].y = pt.y();
+          pc->points[count].z = pt.z();
+          count++;
+        }
+    }
+  pc->points.resize(count);
+
+  pc->width = count;
+  pc->height = 1;
+  pc->is_dense = true;
   output.publish(pc);
 }
 
-// \brief stores the values of the map
-void processMap(const art_msgs::ArtLanes &msg)
+/** \brief PointCloud2 callback, already unpacked into PCL points */
+void processCloud(const PtCloud::ConstPtr &msg)
 {
-  map = msg;
+  processObstacles(*msg);
+}
+
+/** \brief deprecated PointCloud callback */
+void processPointCloud(const sensor_msgs::PointCloud::ConstPtr &msg)
+{
+  processObstacles(*msg);
+}
+
+/** \brief converts the road polygons of each new map message */
+void processMap(const art_msgs::ArtLanes::ConstPtr &msg)
+{
+  setRoad(*msg);
 }
 
 int main(int argc, char *argv[])
@@ -104,24 +193,25 @@ int main(int argc, char *argv[])
   ros::NodeHandle node;
 
   pops = new PolyOps();
-  
+
   // subscribe to velodyne input -- make sure queue depth is minimal,
   // so any missed scans are discarded.  Otherwise latency gets out of
   // hand.  It's bad enough anyway.
+  ros::Subscriber obstacles =
+    node.subscribe("obstacles", qDepth, processCloud,
+                   ros::TransportHints().tcpNoDelay(true));
   ros::Subscriber velodyne_obstacles =
-    node.subscribe("velodyne/obstacles", qDepth, processObstacles,
+    node.subscribe("velodyne/obstacles", qDepth, processPointCloud,
                    ros::TransportHints().tcpNoDelay(true));
 
-  
   ros::Subscriber road_map =
     node.subscribe("roadmap_local", qDepth, processMap,
                    ros::TransportHints().tcpNoDelay(true));
 
-  output = node.advertise<sensor_msgs::PointCloud>("obstacles/points_on_road",
-                                                   qDepth);
-  
-  listener = new tf::TransformListener();
- 
+  output = node.advertise<PtCloud>("obstacles/points_on_road", qDepth);
+
+  transforms.subscribe(node);
+
   ros::spin();                          // handle incoming data
 
   return 0;
@@ -39,7 +39,8 @@ AdjacentLeft::~AdjacentLeft()
  *  left lane.
  */
 art_msgs::Observation
-  AdjacentLeft::update(const art_msgs::ArtLanes &local_map,
+  AdjacentLeft::update(const art_msgs::ArtQuadrilateral &robot_quad,
+			 const art_msgs::ArtLanes &local_map,
 			 const art_msgs::ArtLanes &obstacles,
 			 MapPose pose_)
 {
@@ -39,7 +39,8 @@ AdjacentRight::~AdjacentRight()
  *  right lane.
  */
 art_msgs::Observation
-  AdjacentRight::update(const art_msgs::ArtLanes &local_map,
+  AdjacentRight::update(const art_msgs::ArtQuadrilateral &robot_quad,
+			 const art_msgs::ArtLanes &local_map,
 			 const art_msgs::ArtLanes &obstacles,
 			 MapPose pose_) {
 
@@ -0,0 +1,60 @@
+/*
+ *  Copyright (C) 2011 UT-Austin & Austin Robot Technology
+ *  License: Modified BSD Software License 
+ */
+
+/**  @file
+
+     All left lanes observer implementation.  Counts the lanes to the
+     left of the robot's lane, in the same segment, containing
+     obstacles.
+
+ */
+
+#include <art_observers/all_left.h>
+
+namespace observers
+{
+
+AllLeft::AllLeft(art_observers::ObserversConfig &config,
+                 const ConflictZones &zones):
+  Observer(config,
+	   art_msgs::Observation::All_left,
+	   std::string("All_left")),
+  zones_(zones)
+{
+}
+
+AllLeft::~AllLeft()
+{
+}
+
+/** @brief Updates the observation_ msg.
+ *
+ *  @note Always applicable.  Before the global road map arrives,
+ *        or with no zone for the robot's position, nothing is known
+ *        to conflict, so it reports clear.  The navigator assumes
+ *        the same of a silent observer, and would otherwise wait on
+ *        this one forever.
+ */
+art_msgs::Observation
+  AllLeft::update(const art_msgs::ArtQuadrilateral &robot_quad,
+                  const art_msgs::ArtLanes &local_map,
+                  const art_msgs::ArtLanes &obstacles,
+                  MapPose pose_)
+{
+  float distance;
+  unsigned nobjects = zones_.countSide(robot_quad.poly_id,
+                                       ConflictZones::Left,
+                                       obstacles, pose_, distance);
+
+  // return the observation
+  observation_.distance = distance;
+  observation_.nobjects = nobjects;
+  observation_.clear = (nobjects == 0);
+  observation_.applicable = true;
+
+  return observation_;
+}
+
+}; // namespace observers
@@ -0,0 +1,420 @@
+/*
+ *  Copyright (C) 2011 UT-Austin & Austin Robot Technology
+ *  License: Modified BSD Software License
+ *
+ *  $Id$
+ */
+
+/**  @file
+
+     Conflict zones implementation.  Builds the intersection and merge
+     regions for every lane exit once, when the global road map is
+     received.  Observers then count obstacle quads in the few zones
+     belonging to the robot's current approach.
+
+ */
+
+#include <algorithm>
+#include <set>
+
+#include <art_map/euclidean_distance.h>
+#include <art_observers/conflict_zones.h>
+
+namespace observers
+{
+
+ConflictZones::ConflictZones(const art_observers::ObserversConfig &config):
+  config_(config)
+{}
+
+/** @brief Precompute conflict zones for a new global road map.
+ *
+ *  Transition polygons connect a lane exit way-point (start_way) to
+ *  the entry way-point (end_way) of another lane.  Every distinct
+ *  exit becomes an approach, and so does every stop line, even where
+ *  the lane ends there.  Exits closer than intersection_radius
+ *  belong to the same intersection.
+ *
+ *  @param road_map global road map polygons
+ */
+void ConflictZones::build(const art_msgs::ArtLanes &road_map)
+{
+  polys_.clear();
+  index_.clear();
+  way_points_.clear();
+  lanes_.clear();
+  lane_index_.clear();
+  lane_of_.clear();
+  approaches_.clear();
+  approach_of_.clear();
+
+  PolyOps polyOps;
+  polyOps.GetPolys(road_map, polys_);
+
+  // transition polygons, indexed by exit and by entry way-point
+  std::map<ElementID, std::vector<int> > exit_trans;
+  std::map<ElementID, std::set<ElementID> > exit_entries;
+  std::map<ElementID, std::vector<int> > entry_trans;
+  std::set<ElementID> stops;
+
+  for (unsigned i = 0; i < polys_.size(); ++i)
+    {
+      const poly &p = polys_[i];
+      index_[p.poly_id] = i;
+      if (p.is_transition)
+        {
+          exit_trans[p.start_way].push_back(p.poly_id);
+          exit_entries[p.start_way].insert(p.end_way);
+          entry_trans[p.end_way].push_back(p.poly_id);
+          continue;
+        }
+
+      if (p.contains_way)
+        {
+          way_points_[p.start_way] = p.midpoint;
+          if (p.is_stop)
+            stops.insert(p.start_way);
+        }
+
+      // polygons arrive in lane order
+      ElementID lane = laneID(p.start_way);
+      std::map<ElementID, int>::iterator it = lane_index_.find(lane);
+      if (it == lane_index_.end())
+        {
+          it = lane_index_.insert(std::make_pair(lane, lanes_.size())).first;
+          lanes_.push_back(Lane());
+        }
+      lanes_[it->second].polys.push_back(i);
+      lane_of_[p.poly_id] = it->second;
+    }
+
+  // create an approach for every lane exit, and for every stop line,
+  // even one with no transitions leaving it
+  std::set<ElementID> exits(stops);
+  for (std::map<ElementID, std::vector<int> >::iterator it = exit_trans.begin();
+       it != exit_trans.end(); ++it)
+    exits.insert(it->first);
+
+  std::map<ElementID, std::map<int, int> > lane_exits;
+  for (std::set<ElementID>::iterator it = exits.begin();
+       it != exits.end(); ++it)
+    {
+      Approach a;
+      a.exit = *it;
+      a.is_stop = (stops.count(a.exit) != 0);
+      std::vector<int> &trans = exit_trans[a.exit];
+      std::map<ElementID, MapXY>::iterator wp = way_points_.find(a.exit);
+      if (wp != way_points_.end())
+        a.where = wp->second;
+      else
+        a.where = polys_[index_[trans.front()]].midpoint;
+
+      lane_exits[laneID(a.exit)][a.exit.pt] = approaches_.size();
+      for (unsigned j = 0; j < trans.size(); ++j)
+        approach_of_[trans[j]] = approaches_.size();
+      approaches_.push_back(a);
+    }
+
+  // map each lane polygon to the next exit within approach_range
+  for (unsigned l = 0; l < lanes_.size(); ++l)
+    {
+      if (lanes_[l].polys.empty())
+        continue;
+      const poly &first = polys_[lanes_[l].polys.front()];
+      std::map<ElementID, std::map<int, int> >::iterator exits =
+        lane_exits.find(laneID(first.start_way));
+      if (exits == lane_exits.end())
+        continue;
+
+      for (unsigned j = 0; j < lanes_[l].polys.size(); ++j)
+        {
+          const poly &p = polys_[lanes_[l].polys[j]];
+          int pt = (p.contains_way? p.start_way.pt: p.end_way.pt);
+          std::map<int, int>::iterator next = exits->second.lower_bound(pt);
+          if (next == exits->second.end())
+            continue;
+          const Approach &a = approaches_[next->second];
+          if (Euclidean::DistanceTo(p.midpoint, a.where)
+              <= config_.approach_range)
+            approach_of_[p.poly_id] = next->second;
+        }
+    }
+
+  // classify the other lanes of each segment as left or right
+  for (unsigned l = 0; l < lanes_.size(); ++l)
+    {
+      if (lanes_[l].polys.empty())
+        continue;
+      const poly &mid = polys_[lanes_[l].polys[lanes_[l].polys.size()/2]];
+      MapPose lane_pose(mid.midpoint, mid.heading);
+      for (unsigned m = 0; m < lanes_.size(); ++m)
+        {
+          if (m == l || lanes_[m].polys.empty()
+              || polys_[lanes_[m].polys.front()].start_way.seg
+                 != mid.start_way.seg)
+            continue;
+          int k = closestInLane(m, mid.midpoint);
+          float theta = Coordinates::bearing(lane_pose,
+                                             polys_[lanes_[m].polys[k]].midpoint);
+          if (theta > 0)
+            lanes_[l].sides[Left].push_back(m);
+          else if (theta < 0)
+            lanes_[l].sides[Right].push_back(m);
+        }
+    }
+
+  // precompute the conflict zones for each approach
+  for (unsigned i = 0; i < approaches_.size(); ++i)
+    {
+      Approach &a = approaches_[i];
+      ElementID own_lane = laneID(a.exit);
+      lane_groups_t groups[N_Zones];
+
+      for (unsigned j = 0; j < approaches_.size(); ++j)
+        {
+          const Approach &b = approaches_[j];
+          if (Euclidean::DistanceTo(a.where, b.where)
+              > config_.intersection_radius)
+            continue;
+
+          ElementID other_lane = laneID(b.exit);
+          if (j != i)
+            {
+              // the intersection box: other transitions through it
+              std::vector<int> &trans = exit_trans[b.exit];
+              std::vector<int> &box = groups[Intersection][ElementID()];
+              box.insert(box.end(), trans.begin(), trans.end());
+            }
+          if (other_lane == own_lane)
+            continue;
+
+          int lane = laneIndex(b.exit);
+          if (lane < 0)
+            continue;
+          int pos = closestInLane(lane, b.where);
+          if (b.is_stop)
+            {
+              // vehicles waiting at another stop line
+              addUpstream(lane, pos, b.where, config_.stop_line_range,
+                          groups[Intersection][other_lane]);
+            }
+          else
+            {
+              // cross traffic that does not stop
+              addUpstream(lane, pos, b.where, config_.merge_range,
+                          groups[MergeAll][other_lane]);
+            }
+        }
+
+      std::set<ElementID> &entries = exit_entries[a.exit];
+      for (std::set<ElementID>::iterator e = entries.begin();
+           e != entries.end(); ++e)
+        {
+          MapXY where = a.where;
+          std::map<ElementID, MapXY>::iterator wp = way_points_.find(*e);
+          if (wp != way_points_.end())
+            where = wp->second;
+
+          // traffic in the lane we are entering, including other
+          // vehicles turning into it
+          ElementID target = laneID(*e);
+          int lane = laneIndex(*e);
+          if (lane >= 0)
+            {
+              addUpstream(lane, closestInLane(lane, where), where,
+                          config_.merge_range, groups[MergeNearest][target]);
+            }
+          std::vector<int> &group = groups[MergeNearest][target];
+          std::vector<int> &trans = entry_trans[*e];
+          for (unsigned j = 0; j < trans.size(); ++j)
+            {
+              if (ElementID(polys_[index_[trans[j]]].start_way) != a.exit)
+                group.push_back(trans[j]);
+            }
+
+          // every lane of the segment we are entering
+          for (unsigned m = 0; m < lanes_.size(); ++m)
+            {
+              if (lanes_[m].polys.empty())
+                continue;
+              ElementID mid = laneID(polys_[lanes_[m].polys.front()].start_way);
+              if (mid.seg != e->seg)
+                continue;
+              addUpstream(m, closestInLane(m, where), where,
+                          config_.merge_range, groups[MergeAll][mid]);
+            }
+        }
+
+      for (unsigned z = 0; z < N_Zones; ++z)
+        flatten(groups[z], a.zones[z]);
+    }
+
+  ROS_INFO("conflict zones: %u polygons, %u lanes, %u approaches",
+           (unsigned) polys_.size(), (unsigned) lanes_.size(),
+           (unsigned) approaches_.size());
+}
+
+/** @brief Get approach for the polygon containing the robot.
+ *
+ *  @param poly_id road map polygon ID
+ *  @return approach index, -1 if not approaching any lane exit
+ */
+int ConflictZones::approach(int poly_id) const
+{
+  std::tr1::unordered_map<int, int>::const_iterator it =
+    approach_of_.find(poly_id);
+  if (it == approach_of_.end())
+    return -1;
+  return it->second;
+}
+
+/** @return true if approach ends at a stop line. */
+bool ConflictZones::approachStops(int approach) const
+{
+  return (approach >= 0 && approaches_[approach].is_stop);
+}
+
+/** @brief Count occupied groups in a conflict zone.
+ *
+ *  @param approach index returned by approach()
+ *  @param kind which zone to check
+ *  @param obstacles local map quads currently containing obstacles
+ *  @param pose current pose of robot
+ *  @param distance [out] to closest obstacle in zone, or infinity
+ *  @return number of zone groups containing obstacles
+ */
+unsigned ConflictZones::count(int approach, zone_t kind,
+                              const art_msgs::ArtLanes &obstacles,
+                              const MapPose &pose, float &distance) const
+{
+  distance = std::numeric_limits<float>::infinity();
+  if (approach < 0)
+    return 0;
+
+  unsigned nobjects = 0;
+  const zone_list_t &zone = approaches_[approach].zones[kind];
+  for (unsigned g = 0; g < zone.size(); ++g)
+    {
+      bool occupied = false;
+      for (unsigned i = 0; i < obstacles.polygons.size(); ++i)
+        {
+          const art_msgs::ArtQuadrilateral &q = obstacles.polygons[i];
+          if (std::binary_search(zone[g].begin(), zone[g].end(),
+                                 (int) q.poly_id))
+            {
+              occupied = true;
+              distance = std::min(distance,
+                                  Euclidean::DistanceTo(pose.map,
+                                                        MapXY(q.midpoint)));
+            }
+        }
+      if (occupied)
+        ++nobjects;
+    }
+  return nobjects;
+}
+
+/** @brief Count occupied lanes on one side of the robot's lane.
+ *
+ *  @param poly_id polygon containing the robot
+ *  @param side which side to check
+ *  @param obstacles local map quads currently containing obstacles
+ *  @param pose current pose of robot
+ *  @param distance [out] to closest obstacle on that side, or infinity
+ *  @return number of lanes on that side containing obstacles
+ */
+unsigned ConflictZones::countSide(int poly_id, side_t side,
+                                  const art_msgs::ArtLanes &obstacles,
+                                  const MapPose &pose, float &distance) const
+{
+  distance = std::numeric_limits<float>::infinity();
+  std::tr1::unordered_map<int, int>::const_iterator own =
+    lane_of_.find(poly_id);
+  if (own == lane_of_.end())
+    return 0;
+
+  const std::vector<int> &lanes = lanes_[own->second].sides[side];
+  std::vector<int> occupied;
+  for (unsigned i = 0; i < obstacles.polygons.size(); ++i)
+    {
+      const art_msgs::ArtQuadrilateral &q = obstacles.polygons[i];
+      std::tr1::unordered_map<int, int>::const_iterator it =
+        lane_of_.find(q.poly_id);
+      if (it == lane_of_.end()
+          || std::find(lanes.begin(), lanes.end(), it->second) == lanes.end())
+        continue;
+      distance = std::min(distance,
+                          Euclidean::DistanceTo(pose.map, MapXY(q.midpoint)));
+      if (std::find(occupied.begin(), occupied.end(), it->second)
+          == occupied.end())
+        occupied.push_back(it->second);
+    }
+  return occupied.size();
+}
+
+/** @brief Add a lane's polygons upstream of a point to a group.
+ *
+ *  @param lane index in lanes_
+ *  @param pos starting position in that lane's polygon list
+ *  @param where location the range is measured from
+ *  @param range maximum distance from @a where
+ *  @param group [out] polygon IDs added
+ */
+void ConflictZones::addUpstream(int lane, int pos, const MapXY &where,
+                                double range, std::vector<int> &group) const
+{
+  const std::vector<int> &polys = lanes_[lane].polys;
+  for (int j = pos; j >= 0; --j)
+    {
+      const poly &p = polys_[polys[j]];
+      if (Euclidean::DistanceTo(p.midpoint, where) > range)
+        break;
+      group.push_back(p.poly_id);
+    }
+}
+
+/** @return position of the polygon in a lane closest to a point. */
+int ConflictZones::closestInLane(int lane, const MapXY &where) const
+{
+  const std::vector<int> &polys = lanes_[lane].polys;
+  int closest = 0;
+  float min_dist = std::numeric_limits<float>::infinity();
+  for (unsigned j = 0; j < polys.size(); ++j)
+    {
+      float dist = Euclidean::DistanceTo(polys_[polys[j]].midpoint, where);
+      if (dist < min_dist)
+        {
+          min_dist = dist;
+          closest = j;
+        }
+    }
+  return closest;
+}
+
+/** @brief Convert lane groups to sorted, unique polygon ID vectors. */
+void ConflictZones::flatten(const lane_groups_t &groups,
+                            zone_list_t &zones) const
+{
+  zones.clear();
+  for (lane_groups_t::const_iterator it = groups.begin();
+       it != groups.end(); ++it)
+    {
+      if (it->second.empty())
+        continue;
+      std::vector<int> group(it->second);
+      std::sort(group.begin(), group.end());
+      group.erase(std::unique(group.begin(), group.end()), group.end());
+      zones.push_back(group);
+    }
+}
+
+/** @return index in lanes_ of a way-point's lane, -1 if unknown. */
+int ConflictZones::laneIndex(const ElementID &way) const
+{
+  std::map<ElementID, int>::const_iterator it = lane_index_.find(laneID(way));
+  if (it == lane_index_.end())
+    return -1;
+  return it->second;
+}
+
+}; // namespace observers
@@ -0,0 +1,61 @@
+/*
+ *  Copyright (C) 2011 UT-Austin & Austin Robot Technology
+ *  License: Modified BSD Software License 
+ */
+
+/**  @file
+
+     Intersection observer implementation.  Counts the other stop
+     lines of the current intersection where vehicles are waiting,
+     plus one if the intersection itself is occupied.  The navigator
+     uses that count to determine precedence.
+
+ */
+
+#include <art_observers/intersection.h>
+
+namespace observers
+{
+
+Intersection::Intersection(art_observers::ObserversConfig &config,
+                           const ConflictZones &zones):
+  Observer(config,
+	   art_msgs::Observation::Intersection,
+	   std::string("Intersection")),
+  zones_(zones)
+{
+}
+
+Intersection::~Intersection()
+{
+}
+
+/** @brief Updates the observation_ msg.
+ *
+ *  @note Always applicable.  Before the global road map arrives,
+ *        or with no zone for the robot's position, nothing is known
+ *        to conflict, so it reports clear.  The navigator assumes
+ *        the same of a silent observer, and would otherwise wait on
+ *        this one forever.
+ */
+art_msgs::Observation
+  Intersection::update(const art_msgs::ArtQuadrilateral &robot_quad,
+                       const art_msgs::ArtLanes &local_map,
+                       const art_msgs::ArtLanes &obstacles,
+                       MapPose pose_)
+{
+  int approach = zones_.approach(robot_quad.poly_id);
+  float distance;
+  unsigned nobjects = zones_.count(approach, ConflictZones::Intersection,
+                                   obstacles, pose_, distance);
+
+  // return the observation
+  observation_.distance = distance;
+  observation_.nobjects = nobjects;
+  observation_.clear = (nobjects == 0);
+  observation_.applicable = true;
+
+  return observation_;
+}
+
+}; // namespace observers
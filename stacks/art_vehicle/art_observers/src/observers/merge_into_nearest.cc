@@ -0,0 +1,60 @@
+/*
+ *  Copyright (C) 2011 UT-Austin & Austin Robot Technology
+ *  License: Modified BSD Software License 
+ */
+
+/**  @file
+
+     Merge into nearest lane observer implementation.  Checks the
+     upstream part of each lane entered from the current approach,
+     including other vehicles turning into it.
+
+ */
+
+#include <art_observers/merge_into_nearest.h>
+
+namespace observers
+{
+
+MergeIntoNearest::MergeIntoNearest(art_observers::ObserversConfig &config,
+                                   const ConflictZones &zones):
+  Observer(config,
+	   art_msgs::Observation::Merge_into_nearest,
+	   std::string("Merge_into_nearest")),
+  zones_(zones)
+{
+}
+
+MergeIntoNearest::~MergeIntoNearest()
+{
+}
+
+/** @brief Updates the observation_ msg.
+ *
+ *  @note Always applicable.  Before the global road map arrives,
+ *        or with no zone for the robot's position, nothing is known
+ *        to conflict, so it reports clear.  The navigator assumes
+ *        the same of a silent observer, and would otherwise wait on
+ *        this one forever.
+ */
+art_msgs::Observation
+  MergeIntoNearest::update(const art_msgs::ArtQuadrilateral &robot_quad,
+                           const art_msgs::ArtLanes &local_map,
+                           const art_msgs::ArtLanes &obstacles,
+                           MapPose pose_)
+{
+  int approach = zones_.approach(robot_quad.poly_id);
+  float distance;
+  unsigned nobjects = zones_.count(approach, ConflictZones::MergeNearest,
+                                   obstacles, pose_, distance);
+
+  // return the observation
+  observation_.distance = distance;
+  observation_.nobjects = nobjects;
+  observation_.clear = (nobjects == 0);
+  observation_.applicable = true;
+
+  return observation_;
+}
+
+}; // namespace observers
@@ -35,7 +35,8 @@ NearestBackward::~NearestBackward()
 
 // \brief  Update message with new data.
 art_msgs::Observation
-  NearestBackward::update(const art_msgs::ArtLanes &local_map,
+  NearestBackward::update(const art_msgs::ArtQuadrilateral &robot_quad,
+			  const art_msgs::ArtLanes &local_map,
 			  const art_msgs::ArtLanes &obstacles, 
 			  MapPose pose_)
 {
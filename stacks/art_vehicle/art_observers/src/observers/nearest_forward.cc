@@ -36,7 +36,8 @@ NearestForward::~NearestForward()
 
 // \brief Updates the message with new data received.
 art_msgs::Observation
-  NearestForward::update(const art_msgs::ArtLanes &local_map,
+  NearestForward::update(const art_msgs::ArtQuadrilateral &robot_quad,
+			 const art_msgs::ArtLanes &local_map,
 			 const art_msgs::ArtLanes &obstacles,
 			 MapPose pose_)
 {
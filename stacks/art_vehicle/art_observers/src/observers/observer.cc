@@ -11,6 +11,7 @@
 
  */
 
+#include <art_map/ConvexPolygon.h>
 #include <art_observers/observer.h>
 #include <art_observers/QuadrilateralOps.h>
 
@@ -19,45 +20,26 @@ namespace observers
 
 Observer::~Observer() {}
 
-// \brief returns all obstacles located in wanted lane
+/** @brief returns all obstacles located in wanted lane
+ *
+ *  An obstacle quad is in the lane if at least half of its area
+ *  overlaps one of the lane's quads.
+ */
 art_msgs::ArtLanes 
   Observer::getObstaclesInLane(art_msgs::ArtLanes obstacles,
                                art_msgs::ArtLanes lane_quads) 
 {
-  int counter = 0;
   art_msgs::ArtLanes obstaclesInLane;
-  obstaclesInLane.polygons.resize(obstacles.polygons.size());
-  for(unsigned i = 0; i < obstacles.polygons.size(); i++) {
-    // implementation of pointsInLane from lane_observations here on out.
-    float x = obstacles.polygons[i].midpoint.x;
-    float y = obstacles.polygons[i].midpoint.y;
-    
-    // Want to do the following in pointInLane, but for some reason can't
-    size_t num_polys = lane_quads.polygons.size();
-
-    bool inside = false;
-  
-    for (size_t j=0; j<num_polys; j++) {
-      art_msgs::ArtQuadrilateral *p= &(lane_quads.polygons[j]);
-
-      float dist= ((p->midpoint.x-x)*(p->midpoint.x-x)
-                   + (p->midpoint.y-y)*(p->midpoint.y-y));
-
-      if (dist > 16)         // quick check: are we near the polygon?
-        continue;
-
-      inside = quad_ops::quickPointInPolyRatio(x,y,*p,0.6);
-
-      if(inside)
-	break;
-   }
-
-    if(inside) {
-      obstaclesInLane.polygons[counter] = obstacles.polygons[i];
-      counter++;
+  obstaclesInLane.polygons.reserve(obstacles.polygons.size());
+  mapxy_list_t region;
+  std::vector<int> overlaps;
+  for (unsigned i = 0; i < obstacles.polygons.size(); i++)
+    {
+      ConvexPolygon::fromQuad(obstacles.polygons[i], region);
+      float min_area = 0.5 * ConvexPolygon::area(region);
+      if (ConvexPolygon::overlapping(region, lane_quads, min_area, overlaps))
+        obstaclesInLane.polygons.push_back(obstacles.polygons[i]);
     }
-  }
-  obstaclesInLane.polygons.resize(counter);
   return obstaclesInLane;
 }
 
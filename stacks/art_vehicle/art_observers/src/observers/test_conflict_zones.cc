@@ -0,0 +1,161 @@
+/*
+ *  ART observers conflict zones unit test
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <gtest/gtest.h>
+#include <ros/package.h>
+
+#include <art_map/euclidean_distance.h>
+#include <art_map/MapLanes.h>
+#include <art_observers/conflict_zones.h>
+
+// Builds the conflict zones from the global road map of each bundled
+// RNDF, the way maplanes publishes it.  The navigator waits at every
+// stop line until the Intersection observer reports clear, so each
+// stop line polygon must belong to an approach that stops.
+
+/** load a bundled RNDF, get its global road map
+ *
+ *  @return number of stop line polygons found
+ */
+unsigned global_map(const std::string &rndf_name,
+                    art_msgs::ArtLanes &road_map)
+{
+  std::string path =
+    ros::package::getPath("art_map") + "/rndf/" + rndf_name;
+  RNDF rndf(path);
+  EXPECT_TRUE(rndf.is_valid);
+  if (!rndf.is_valid)
+    return 0;
+
+  Graph graph;
+  rndf.populate_graph(graph);
+  graph.find_mapxy();
+  MapLanes map(80.0);                   // maplanes default range
+  EXPECT_EQ(0, map.MapRNDF(&graph, MIN_POLY_SIZE));
+  EXPECT_LT(0, map.getAllLanes(&road_map));
+
+  unsigned nstops = 0;
+  for (unsigned i = 0; i < road_map.polygons.size(); ++i)
+    {
+      if (road_map.polygons[i].is_stop)
+        ++nstops;
+    }
+  return nstops;
+}
+
+/** every stop line polygon maps to an approach that stops */
+void check_stop_lines(const std::string &rndf_name)
+{
+  SCOPED_TRACE(rndf_name);
+  art_msgs::ArtLanes road_map;
+  unsigned nstops = global_map(rndf_name, road_map);
+  EXPECT_LT(0u, nstops);
+
+  art_observers::ObserversConfig config;
+  observers::ConflictZones zones(config);
+  zones.build(road_map);
+  ASSERT_FALSE(zones.empty());
+
+  for (unsigned i = 0; i < road_map.polygons.size(); ++i)
+    {
+      const art_msgs::ArtQuadrilateral &p = road_map.polygons[i];
+      if (!p.is_stop)
+        continue;
+      int approach = zones.approach(p.poly_id);
+      EXPECT_LE(0, approach) << "stop polygon " << p.poly_id;
+      EXPECT_TRUE(zones.approachStops(approach))
+        << "stop polygon " << p.poly_id;
+    }
+}
+
+TEST(ConflictZones, empty)
+{
+  art_observers::ObserversConfig config;
+  observers::ConflictZones zones(config);
+  EXPECT_TRUE(zones.empty());
+  EXPECT_EQ(-1, zones.approach(1));
+
+  // nothing can conflict before the road map arrives
+  art_msgs::ArtLanes obstacles;
+  obstacles.polygons.resize(1);
+  float distance;
+  EXPECT_EQ(0u, zones.count(zones.approach(1),
+                            observers::ConflictZones::Intersection,
+                            obstacles, MapPose(), distance));
+}
+
+TEST(ConflictZones, waiting_at_other_stop)
+{
+  art_msgs::ArtLanes road_map;
+  global_map("prc_large.rndf", road_map);
+  art_observers::ObserversConfig config;
+  observers::ConflictZones zones(config);
+  zones.build(road_map);
+
+  // a vehicle waiting at another stop line of the same intersection
+  // has precedence
+  unsigned npairs = 0;
+  for (unsigned i = 0; i < road_map.polygons.size(); ++i)
+    {
+      const art_msgs::ArtQuadrilateral &p = road_map.polygons[i];
+      if (!p.is_stop)
+        continue;
+      for (unsigned j = 0; j < road_map.polygons.size(); ++j)
+        {
+          const art_msgs::ArtQuadrilateral &q = road_map.polygons[j];
+          if (!q.is_stop || j == i
+              || (q.start_way.seg == p.start_way.seg
+                  && q.start_way.lane == p.start_way.lane)
+              || (Euclidean::DistanceTo(MapXY(p.midpoint), MapXY(q.midpoint))
+                  > config.intersection_radius))
+            continue;
+          art_msgs::ArtLanes obstacles;
+          obstacles.polygons.push_back(q);
+          float distance;
+          MapPose pose(MapXY(p.midpoint), p.heading);
+          EXPECT_EQ(1u, zones.count(zones.approach(p.poly_id),
+                                    observers::ConflictZones::Intersection,
+                                    obstacles, pose, distance))
+            << "stop polygon " << p.poly_id << ", waiting at "
+            << q.poly_id;
+          EXPECT_NEAR(Euclidean::DistanceTo(MapXY(p.midpoint),
+                                            MapXY(q.midpoint)),
+                      distance, 0.001);
+          ++npairs;
+        }
+    }
+  EXPECT_LT(0u, npairs);
+}
+
+TEST(ConflictZones, prc_large)
+{
+  check_stop_lines("prc_large.rndf");
+}
+
+TEST(ConflictZones, prc_large_obstacle)
+{
+  check_stop_lines("prc_large_obstacle.rndf");
+}
+
+TEST(ConflictZones, swri_site_visit)
+{
+  check_stop_lines("swri_site_visit.rndf");
+}
+
+TEST(ConflictZones, swri_site_visit_with_zones)
+{
+  check_stop_lines("swri_site_visit_with_zones.rndf");
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
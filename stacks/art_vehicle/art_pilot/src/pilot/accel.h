@@ -34,8 +34,11 @@ class AccelBase
    *
    *  @param[in,out] config pilot configuration parameters
    *                 (may be modified if parameter values invalid)
+   *  @param cycle nominal pilot cycle duration
    */
-  AccelBase(art_pilot::PilotConfig &config) {};
+  AccelBase(art_pilot::PilotConfig &config, const ros::Duration &cycle):
+    cycle_(cycle)
+  {};
 
   /** Destructor (required for virtual base classes). */
   virtual ~AccelBase();
@@ -61,6 +64,10 @@ class AccelBase
 
   /** Reset acceleration controller. */
   virtual void reset(void) = 0;
+
+ protected:
+
+  ros::Duration cycle_;                 // nominal pilot cycle duration
 };
 
 /** Shared point to AccelBase instance. */
@@ -70,9 +77,11 @@ typedef boost::shared_ptr<AccelBase> AccelBasePtr;
  *
  *  @param[in,out] config latest pilot configuration parameters
  *                 (may be modified if parameter values invalid)
+ *  @param cycle nominal pilot cycle duration
  *  @return boost shared pointer to acceleration controller object
  */
-AccelBasePtr allocAccel(art_pilot::PilotConfig &config);
+AccelBasePtr allocAccel(art_pilot::PilotConfig &config,
+                        const ros::Duration &cycle);
 
 /** Clamp value to range.
  *
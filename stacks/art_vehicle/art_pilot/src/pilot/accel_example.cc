@@ -28,8 +28,9 @@ using art_msgs::Epsilon;
 namespace pilot
 {
 
-AccelExample::AccelExample(art_pilot::PilotConfig &config):
-  AccelBase(config),
+AccelExample::AccelExample(art_pilot::PilotConfig &config,
+                           const ros::Duration &cycle):
+  AccelBase(config, cycle),
   braking_(true),                       // begin with brake on
   brake_pid_(new Pid("brake", config.brake_kp, config.brake_ki,
                      config.brake_kd, 1.0, 0.0, 5000.0)),
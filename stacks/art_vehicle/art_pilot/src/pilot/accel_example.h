@@ -29,7 +29,8 @@ class AccelExample: public AccelBase
 {
  public:
 
-  AccelExample(art_pilot::PilotConfig &config);
+  AccelExample(art_pilot::PilotConfig &config,
+               const ros::Duration &cycle);
   virtual ~AccelExample();
 
   typedef boost::shared_ptr<device_interface::ServoDeviceBase> ServoPtr;
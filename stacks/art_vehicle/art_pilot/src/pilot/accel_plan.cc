@@ -20,7 +20,6 @@
 
 #include <ros/ros.h>
 #include <art/pid2.h>
-#include <art_msgs/ArtHertz.h>
 #include <art_msgs/Epsilon.h>
 
 #include "accel_plan.h"
@@ -30,8 +29,9 @@ using art_msgs::Epsilon;
 namespace pilot
 {
 
-AccelPlan::AccelPlan(art_pilot::PilotConfig &config):
-  AccelBase(config),
+AccelPlan::AccelPlan(art_pilot::PilotConfig &config,
+                     const ros::Duration &cycle):
+  AccelBase(config, cycle),
   braking_(true),                       // begin with brake on
   brake_pid_(new Pid("brake", config.brake_kp, config.brake_ki,
                      config.brake_kd, 1.0, 0.0, 5000.0)),
@@ -74,7 +74,7 @@ void AccelPlan::adjust(art_msgs::PilotState &pstate,
   if (prev_cycle_ == ros::Time())       // first cycle since reset?
     {
       // assume nominal cycle time
-      dt = 1.0 / art_msgs::ArtHertz::PILOT;
+      dt = cycle_.toSec();
     }
   else
     {
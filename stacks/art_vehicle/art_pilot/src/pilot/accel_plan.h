@@ -29,7 +29,8 @@ class AccelPlan: public AccelBase
 {
  public:
 
-  AccelPlan(art_pilot::PilotConfig &config);
+  AccelPlan(art_pilot::PilotConfig &config,
+            const ros::Duration &cycle);
   virtual ~AccelPlan();
 
   typedef boost::shared_ptr<device_interface::ServoDeviceBase> ServoPtr;
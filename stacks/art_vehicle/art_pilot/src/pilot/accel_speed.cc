@@ -14,6 +14,7 @@
  */
 
 #include <ros/ros.h>
+#include <art/rates.h>
 #include "accel_speed.h"
 
 #include "speed.h"
@@ -22,8 +23,9 @@
 namespace pilot
 {
 
-AccelSpeed::AccelSpeed(art_pilot::PilotConfig &config):
-  AccelBase(config)
+AccelSpeed::AccelSpeed(art_pilot::PilotConfig &config,
+                       const ros::Duration &cycle):
+  AccelBase(config, cycle)
 {
   switch(config.acceleration_controller)
     {
@@ -67,6 +69,8 @@ void AccelSpeed::adjust(art_msgs::PilotState &pstate,
   float throttle_request = throttle->last_request();
   speed_->set_brake_position(brake->value());
   speed_->set_throttle_position(throttle->value());
+  speed_->set_cycle_time(ArtRates::elapsed(prev_cycle_, cycle_,
+                                           pstate.header.stamp));
 
   // Adjust brake and throttle settings.
   speed_->adjust(abs_speed, error,
@@ -28,7 +28,8 @@ class AccelSpeed: public AccelBase
 {
  public:
 
-  AccelSpeed(art_pilot::PilotConfig &config);
+  AccelSpeed(art_pilot::PilotConfig &config,
+             const ros::Duration &cycle);
   virtual ~AccelSpeed();
 
   typedef boost::shared_ptr<device_interface::ServoDeviceBase> ServoPtr;
@@ -51,6 +52,7 @@ class AccelSpeed: public AccelBase
 private:
 
   boost::shared_ptr<SpeedControl> speed_; // speed control
+  ros::Time prev_cycle_;                  // previous cycle time
 };
   
 }; // namespace pilot
@@ -27,10 +27,11 @@ AccelBase::~AccelBase() {}
 /** allocate an acceleration controller instance
  *
  *  @param config current Pilot configuration parameters
+ *  @param cycle nominal pilot cycle duration
  *  @return boost shared pointer to a newly allocated controller
  */
 boost::shared_ptr<AccelBase>
-  allocAccel(art_pilot::PilotConfig &config)
+  allocAccel(art_pilot::PilotConfig &config, const ros::Duration &cycle)
 {
   boost::shared_ptr<AccelBase> controller;
 
@@ -47,13 +48,13 @@ boost::shared_ptr<AccelBase>
     case art_pilot::Pilot_Accel_Example:
       {
         ROS_INFO("using example acceleration controller");
-        controller.reset(new AccelExample(config));
+        controller.reset(new AccelExample(config, cycle));
         break;
       }
     case art_pilot::Pilot_Accel_Plan:
       {
         ROS_INFO("using planned acceleration controller");
-        controller.reset(new AccelPlan(config));
+        controller.reset(new AccelPlan(config, cycle));
         break;
       }
     case art_pilot::Pilot_Speed_Learned:
@@ -61,7 +62,7 @@ boost::shared_ptr<AccelBase>
     case art_pilot::Pilot_Speed_PID:
       {
         // An older, speed-based controller. It will figure out which.
-        controller.reset(new AccelSpeed(config));
+        controller.reset(new AccelSpeed(config, cycle));
         break;
       }
     }
@@ -15,6 +15,9 @@
      using these interfaces should include device_interface.h,
      instead.
 
+     Subscription callbacks keep a pointer to the latest message
+     received, rather than copying it every time.
+
      @note There is a lot of repeated code here, mostly due to the
      diversity of message types.  Templates could reduce some of the
      repetition, but at the cost of extra complexity. That additional
@@ -59,7 +62,7 @@ class DeviceImu: public DeviceBase
 
   virtual DeviceState state(ros::Time recently)
   {
-    if (msg_.header.stamp > recently)
+    if (msg_ && msg_->header.stamp > recently)
       return art_msgs::DriverState::RUNNING;
     else
       return art_msgs::DriverState::CLOSED;
@@ -67,17 +70,17 @@ class DeviceImu: public DeviceBase
 
   float value()
   {
-    return msg_.linear_acceleration.x;  // current acceleration
+    return (msg_? msg_->linear_acceleration.x: 0.0); // current acceleration
   }
 
 private:
 
   void process(const sensor_msgs::Imu::ConstPtr &msgIn)
   {
-    msg_ = *msgIn;
+    msg_ = msgIn;
   }
 
-  sensor_msgs::Imu msg_;                // last message received
+  sensor_msgs::Imu::ConstPtr msg_;      // last message received
 };
 
 /** Odometry interface from Applanix node */
@@ -94,7 +97,7 @@ class DeviceOdom: public DeviceBase
 
   virtual DeviceState state(ros::Time recently)
   {
-    if (msg_.header.stamp > recently)
+    if (msg_ && msg_->header.stamp > recently)
       return art_msgs::DriverState::RUNNING;
     else
       return art_msgs::DriverState::CLOSED;
@@ -102,17 +105,17 @@ class DeviceOdom: public DeviceBase
 
   float value()
   {
-    return msg_.twist.twist.linear.x;   // current velocity
+    return (msg_? msg_->twist.twist.linear.x: 0.0); // current velocity
   }
 
 private:
 
   void process(const nav_msgs::Odometry::ConstPtr &msgIn)
   {
-    msg_ = *msgIn;
+    msg_ = msgIn;
   }
 
-  nav_msgs::Odometry msg_;              // last message received
+  nav_msgs::Odometry::ConstPtr msg_;    // last message received
 };
 
 
@@ -146,7 +149,7 @@ class DeviceBrake: public ServoDeviceBase
 
   virtual DeviceState state(ros::Time recently)
   {
-    if (msg_.header.stamp > recently)
+    if (msg_ && msg_->header.stamp > recently)
       return art_msgs::DriverState::RUNNING;
     else
       return art_msgs::DriverState::CLOSED;
@@ -154,18 +157,18 @@ class DeviceBrake: public ServoDeviceBase
 
   virtual float value()
   {
-    return msg_.position;               // current brake position
+    return (msg_? msg_->position: 0.0); // current brake position
   }
 
 private:
 
   void process(const art_msgs::BrakeState::ConstPtr &msgIn)
   {
-    msg_ = *msgIn;
+    msg_ = msgIn;
   }
 
   art_msgs::BrakeCommand cmd_;          // last command sent
-  art_msgs::BrakeState msg_;            // last message received
+  art_msgs::BrakeState::ConstPtr msg_;  // last message received
 };
 
 /** Shifter interface class
@@ -174,6 +177,15 @@ private:
  *  implement the full ServoDeviceBase interface, so it uses
  *  DeviceBase, with some similar additional members.  The publish()
  *  method takes a gear number, and the value() method returns one.
+ *
+ *  The shifter driver holds the relay until its indicator reports
+ *  the requested gear, then resets the relays itself.  A shift is
+ *  confirmed by the first state message showing that gear with the
+ *  relays off.
+ *
+ *  The driver gives up after its ~shift_timeout parameter, so the
+ *  pilot reads the same one, as shifter/shift_timeout, and waits a
+ *  little longer for the driver's last state message.
  */
 class DeviceShifter: public DeviceBase
 {
@@ -183,30 +195,38 @@ class DeviceShifter: public DeviceBase
 
   DeviceShifter(ros::NodeHandle node):
     DeviceBase(node),
-    shift_duration_(1.0)
+    pending_(false)
   {
+    // same default as the ioadr driver, plus an allowance for its
+    // last poll and state message
+    static const double confirm_margin = 0.5;
+    double driver_timeout;
+    node.param("shifter/shift_timeout", driver_timeout, 2.0);
+    shift_timeout_ = ros::Duration(driver_timeout + confirm_margin);
+    ROS_INFO("wait up to %.3f sec for shift confirmation",
+             shift_timeout_.toSec());
+
     sub_ = node.subscribe("shifter/state", 1,
                           &DeviceShifter::process, this,
                           ros::TransportHints().tcpNoDelay(true));
     pub_ = node.advertise<art_msgs::Shifter>("shifter/cmd", 1);
-    msg_.gear = art_msgs::Shifter::Drive;
   }
 
-  /** return true if shifter relay is busy */
+  /** return true while a shift request is waiting for confirmation
+   *
+   *  Without one before the timeout, the driver has given up, and the
+   *  request may be sent again.
+   */
   bool busy(void)
   {
-    return ((ros::Time::now() - shift_time_) < shift_duration_);
-  }
-
-  /** return true if shifting is done (all relays off) */
-  bool is_reset(void)
-  {
-    return (msg_.relays == 0);
+    return (pending_
+            && (ros::Time::now() - shift_time_) < shift_timeout_);
   }
 
   void publish(Gear new_position, ros::Time cycle_time)
   {
     shift_time_ = cycle_time;
+    pending_ = true;
     cmd_.header.stamp = cycle_time;
     cmd_.gear = new_position;
     pub_.publish(cmd_);
@@ -214,7 +234,7 @@ class DeviceShifter: public DeviceBase
 
   virtual DeviceState state(ros::Time recently)
   {
-    if (msg_.header.stamp > recently)
+    if (msg_ && msg_->header.stamp > recently)
       return art_msgs::DriverState::RUNNING;
     else
       return art_msgs::DriverState::CLOSED;
@@ -222,21 +242,31 @@ class DeviceShifter: public DeviceBase
 
   Gear value()
   {
-    return msg_.gear;                   // current gear number
+    return (msg_? msg_->gear: art_msgs::Shifter::Drive); // current gear
   }
 
 private:
 
   void process(const art_msgs::Shifter::ConstPtr &msgIn)
   {
-    msg_ = *msgIn;
+    msg_ = msgIn;
+    if (pending_
+        && msg_->header.stamp >= shift_time_
+        && msg_->gear == cmd_.gear
+        && msg_->relays == 0)
+      {
+        pending_ = false;
+        ROS_INFO("shift into gear %u confirmed after %.3f sec",
+                 cmd_.gear, (msg_->header.stamp - shift_time_).toSec());
+      }
   }
 
   art_msgs::Shifter cmd_;               // last command sent
-  art_msgs::Shifter msg_;               // last state message received
+  art_msgs::Shifter::ConstPtr msg_;     // last state message received
   ros::Publisher pub_;                  // command message publisher
+  bool pending_;                        // shift not yet confirmed
   ros::Time shift_time_;                // time last shift requested
-  ros::Duration shift_duration_;        // duration to hold relay
+  ros::Duration shift_timeout_;         // longest wait for confirmation
 };
 
 /** Steering servo interface class */
@@ -269,26 +299,26 @@ class DeviceSteering: public ServoDeviceBase
 
   virtual DeviceState state(ros::Time recently)
   {
-    if (msg_.header.stamp > recently)
-      return msg_.driver.state;
+    if (msg_ && msg_->header.stamp > recently)
+      return msg_->driver.state;
     else
       return art_msgs::DriverState::CLOSED;
   }
 
   virtual float value()
   {
-    return msg_.angle;                  // current steering angle
+    return (msg_? msg_->angle: 0.0);    // current steering angle
   }
 
 private:
 
   void process(const art_msgs::SteeringState::ConstPtr &msgIn)
   {
-    msg_ = *msgIn;
+    msg_ = msgIn;
   }
 
   art_msgs::SteeringCommand cmd_;          // last command sent
-  art_msgs::SteeringState msg_;            // last message received
+  art_msgs::SteeringState::ConstPtr msg_; // last message received
 };
 
 /** Throttle servo interface class */
@@ -321,7 +351,7 @@ class DeviceThrottle: public ServoDeviceBase
 
   virtual DeviceState state(ros::Time recently)
   {
-    if (msg_.header.stamp > recently)
+    if (msg_ && msg_->header.stamp > recently)
       return art_msgs::DriverState::RUNNING;
     else
       return art_msgs::DriverState::CLOSED;
@@ -329,18 +359,18 @@ class DeviceThrottle: public ServoDeviceBase
 
   virtual float value()
   {
-    return msg_.position;               // current throttle position
+    return (msg_? msg_->position: 0.0); // current throttle position
   }
 
 private:
 
   void process(const art_msgs::ThrottleState::ConstPtr &msgIn)
   {
-    msg_ = *msgIn;
+    msg_ = msgIn;
   }
 
   art_msgs::ThrottleCommand cmd_;       // last command sent
-  art_msgs::ThrottleState msg_;         // last message received
+  art_msgs::ThrottleState::ConstPtr msg_; // last message received
 };
 
 }; // end device_interface namespace
@@ -87,8 +87,8 @@ void LearnedSpeedControl::adjust(float speed, float error,
   
   // fix trouble starting from full brake
   if (speed < 0.01 && targetVel > 0 && *brake_req > 0.0 && act != 3){
-    ROS_WARN("Chose bad accel from stop. State %f, %f, %f, %f, action %i",
-             s[0], s[1], s[2], s[3], act);
+    ROS_WARN_THROTTLE(10, "Chose bad accel from stop. State %f, %f, %f, %f,"
+                      " action %i", s[0], s[1], s[2], s[3], act);
     act = 3;
   }
 
@@ -135,8 +135,15 @@ void LearnedSpeedControl::reset(void)
 
 int LearnedSpeedControl::getAction(const std::vector<float> &s) {
 
-  // Get action values
-  std::vector<float> &Q_s = Q[canonicalize(s)];
+  // Look up action values without adding unknown states, which would
+  // allocate memory every cycle in a state the policy never visited.
+  std::set<std::vector<float> >::const_iterator known = statespace.find(s);
+  if (known == statespace.end()) {
+    ROS_WARN_THROTTLE(10, "State unknown in policy: %f, %f, %f, %f",
+                      s[0], s[1], s[2], s[3]);
+    return 0;                           // no change
+  }
+  std::vector<float> &Q_s = Q[&*known];
   const std::vector<float>::iterator max =
     std::max_element(Q_s.begin(), Q_s.end());
 
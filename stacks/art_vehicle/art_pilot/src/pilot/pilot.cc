@@ -31,18 +31,21 @@
 #include <art_msgs/ArtHertz.h>
 #include <art_msgs/CarDriveStamped.h>
 #include <art_msgs/CarCommand.h>
+#include <art_msgs/CarTrajectory.h>
 #include <art_msgs/Epsilon.h>
 #include <art_msgs/Gear.h>
 #include <art_msgs/LearningCommand.h>
 #include <art_msgs/PilotState.h>
 
 #include <art/conversions.h>
+#include <art/rates.h>
 #include <art/steering.h>
 
 #include <art_pilot/PilotConfig.h>
 typedef art_pilot::PilotConfig Config;
 
 #include "accel.h"
+#include "trajectory.h"
 
 typedef art_msgs::DriverState DriverState;
 using art_msgs::Epsilon;
@@ -56,10 +59,17 @@ translates them into commands to the servo motor actuators for
 controlling the speed and direction of the vehicle.  It gets odometry
 information from a separate node.
 
+A CarTrajectory gives the speed and curvature for a short time
+ahead.  The pilot samples it every cycle, so its actuator commands
+change smoothly at the pilot rate, and a late navigator update does
+not stall them.  The most recent message of any command type is the
+one followed.
+
 Subscribes:
 
 - @b pilot/drive [art_msgs::CarDriveStamped] driving command
 - @b pilot/cmd [art_msgs::CarCommand] velocity and steering angle command
+- @b pilot/trajectory [art_msgs::CarTrajectory] short-horizon trajectory
 - @b imu [sensor_msgs::Imu] estimate of robot accelerations
 - @b odom [nav_msgs::Odometry] estimate of robot position and velocity.
 
@@ -93,12 +103,15 @@ private:
   void monitorHardware(void);
   void processCarDrive(const art_msgs::CarDriveStamped::ConstPtr &msg);
   void processCarCommand(const art_msgs::CarCommand::ConstPtr &msg);
+  void processCarTrajectory(const art_msgs::CarTrajectory::ConstPtr &msg);
   void processLearning(const art_msgs::LearningCommand::ConstPtr &learningIn);
   void reconfig(Config &newconfig, uint32_t level);
   void speedControl(void);
+  void trackTrajectory(void);
   void validateTarget(void);
 
   bool is_shifting_;                    // is transmission active?
+  ros::Time shift_start_;               // when the shift was needed
 
   typedef dynamic_reconfigure::Server<Config> ReconfigServer;
   boost::shared_ptr<ReconfigServer> reconfig_server_;
@@ -106,6 +119,7 @@ private:
   // ROS topics used by this node
   ros::Subscriber accel_cmd_;           // CarDriveStamped command
   ros::Subscriber car_cmd_;             // CarCommand
+  ros::Subscriber traj_cmd_;            // CarTrajectory
 
   // Device interfaces used by pilot
   boost::shared_ptr<device_interface::DeviceBrake> brake_;
@@ -122,14 +136,20 @@ private:
   // configuration
   Config config_;                       // dynamic configuration
   ros::Duration timeout_;               // device timeout (sec)
+  double hertz_;                        // pilot cycle rate
+  ros::Duration cycle_;                 // nominal cycle duration
 
   ros::Time current_time_;              // time current cycle began
+  ros::Time prev_time_;                 // time previous cycle began
+  float dt_;                            // measured cycle duration (sec)
 
   // times when messages received
   ros::Time goal_time_;                 // latest goal command
 
   art_msgs::PilotState pstate_msg_;     // pilot state message
 
+  pilot::Trajectory traj_;              // latest trajectory command
+
   boost::shared_ptr<pilot::AccelBase> accel_;  // acceleration controller
 };
 
@@ -143,6 +163,13 @@ PilotNode::PilotNode(ros::NodeHandle node):
   is_shifting_(false),
   reconfig_server_(new dynamic_reconfigure::Server<Config>)
 {
+  // The acceleration controllers need the cycle rate, so get it
+  // before the first reconfigure callback allocates one.
+  ros::NodeHandle mynh("~");
+  hertz_ = ArtRates::getHertz(mynh, art_msgs::ArtHertz::PILOT);
+  cycle_ = ros::Duration(1.0 / hertz_);
+  dt_ = cycle_.toSec();
+
   // Must declare dynamic reconfigure callback before initializing
   // devices or subscribing to topics.
   reconfig_server_->setCallback(boost::bind(&PilotNode::reconfig,
@@ -165,6 +192,8 @@ PilotNode::PilotNode(ros::NodeHandle node):
                               &PilotNode::processCarDrive, this, noDelay);
   car_cmd_ = node.subscribe("pilot/cmd", qDepth,
                             &PilotNode::processCarCommand, this , noDelay);
+  traj_cmd_ = node.subscribe("pilot/trajectory", qDepth,
+                             &PilotNode::processCarTrajectory, this, noDelay);
   learning_cmd_ = node.subscribe("pilot/learningCmd", qDepth,
                                  &PilotNode::processLearning, this, noDelay);
 
@@ -177,12 +206,13 @@ PilotNode::PilotNode(ros::NodeHandle node):
 void PilotNode::spin(void)
 {
   // Main loop
-  ros::Rate cycle(art_msgs::ArtHertz::PILOT); // set driver cycle rate
+  ros::Rate cycle(hertz_);              // set driver cycle rate
   while(ros::ok())
     {
       ros::spinOnce();                  // handle incoming messages
 
       monitorHardware();                // monitor device status
+      trackTrajectory();                // sample any trajectory
 
       // issue control commands
       speedControl();
@@ -276,6 +306,7 @@ void PilotNode::monitorHardware(void)
 {
   // update current pilot state
   current_time_ = ros::Time::now();
+  dt_ = ArtRates::elapsed(prev_time_, cycle_, current_time_);
   pstate_msg_.header.stamp = current_time_;
   pstate_msg_.current.acceleration = fabs(imu_->value());
   pstate_msg_.current.speed = fabs(odom_->value());
@@ -321,6 +352,7 @@ void PilotNode::monitorHardware(void)
 void PilotNode::processCarDrive(const art_msgs::CarDriveStamped::ConstPtr &msg)
 {
   goal_time_ = msg->header.stamp;
+  traj_.reset();
   pstate_msg_.target = msg->control;
   validateTarget();
 }
@@ -331,6 +363,7 @@ void PilotNode::processCarCommand(const art_msgs::CarCommand::ConstPtr &msg)
   ROS_WARN_THROTTLE(100, "CarCommand deprecated: use CarDriveStamped.");
 
   goal_time_ = msg->header.stamp;
+  traj_.reset();
   pstate_msg_.target.steering_angle = angles::from_degrees(msg->control.angle);
   pstate_msg_.target.behavior.value = art_msgs::PilotBehavior::Run;
 
@@ -355,6 +388,14 @@ void PilotNode::processCarCommand(const art_msgs::CarCommand::ConstPtr &msg)
   validateTarget();
 }
 
+/** CarTrajectory message callback */
+void PilotNode::processCarTrajectory(const art_msgs::CarTrajectory::ConstPtr
+                                     &msg)
+{
+  if (traj_.set(*msg))
+    goal_time_ = msg->header.stamp;
+}
+
 /** LearningCommand message callback (DEPRECATED) */
 void PilotNode::processLearning(const art_msgs::LearningCommand::ConstPtr
                                 &learningIn)
@@ -381,7 +422,7 @@ void PilotNode::reconfig(Config &newconfig, uint32_t level)
   if (level & driver_base::SensorLevels::RECONFIGURE_CLOSE)
     {
       // reallocate acceleration controller using new configuration
-      accel_ = pilot::allocAccel(newconfig);
+      accel_ = pilot::allocAccel(newconfig, cycle_);
     }
   else
     {
@@ -397,10 +438,10 @@ void PilotNode::reconfig(Config &newconfig, uint32_t level)
 /** Speed control
  *  
  *  Manage the shifter.  Inputs are the current and target states.  If
- *  a gear shift is requested, the vehicle must first be brought to a
- *  stop, then one of the transmission shift relays set for one second
- *  (then reset), before the vehicle can begin moving in the opposite
- *  direction.
+ *  a gear shift is requested, the vehicle is halted while the shifter
+ *  driver is asked for the new gear.  The vehicle can begin moving in
+ *  the opposite direction as soon as the driver confirms the shift,
+ *  reporting that gear with its relays reset.
  */
 void PilotNode::speedControl(void)
 {
@@ -409,22 +450,19 @@ void PilotNode::speedControl(void)
   if (pstate_msg_.preempted)
     return;
 
-  float dt = 1.0 / art_msgs::ArtHertz::PILOT;
+  float dt = dt_;
   float abs_current_speed = pstate_msg_.current.speed;
   float abs_target_speed = pstate_msg_.target.speed;
 
-  if (is_shifting_)
+  if (is_shifting_
+      && pstate_msg_.current.gear.value == pstate_msg_.target.gear.value
+      && !shifter_->busy())
     {
-      if (shifter_->is_reset())
-        {
-          // all relays are reset now
-          is_shifting_ = false;
-        }
-      else if (!shifter_->busy())
-        {
-          // original operation complete, reset shifter relays
-          shifter_->publish(art_msgs::Shifter::Reset, current_time_);
-        }
+      // shift confirmed, measured from when it was first needed
+      is_shifting_ = false;
+      ROS_INFO("shifted into gear %u in %.3f sec, including halt",
+               pstate_msg_.target.gear.value,
+               (current_time_ - shift_start_).toSec());
     }
 
   if (pstate_msg_.current.gear.value == pstate_msg_.target.gear.value
@@ -461,10 +499,15 @@ void PilotNode::speedControl(void)
   else
     {
       // not in desired gear, shift (still) needed
-      is_shifting_ = true;
+      if (!is_shifting_)
+        {
+          is_shifting_ = true;
+          shift_start_ = current_time_;
+        }
+
       if (!shifter_->busy())
         {
-          // request shift until driver reports success
+          // request shift until driver confirms it
           shifter_->publish(pstate_msg_.target.gear.value, current_time_);
         }
 
@@ -473,6 +516,30 @@ void PilotNode::speedControl(void)
 }
 
 
+/** Set target from the trajectory being tracked.
+ *
+ *  Runs every pilot cycle, after monitorHardware(), so the target
+ *  follows the trajectory at the pilot rate, independent of when
+ *  navigator updates arrive.
+ */
+void PilotNode::trackTrajectory(void)
+{
+  if (!traj_.active())
+    return;
+
+  float speed, curvature;
+  traj_.sample(current_time_, speed, curvature);
+
+  pstate_msg_.target.speed = speed;
+  pstate_msg_.target.acceleration = 0.0;
+  pstate_msg_.target.jerk = 0.0;
+  pstate_msg_.target.steering_angle =
+    atanf(art_msgs::ArtVehicle::wheelbase * curvature);
+  pstate_msg_.target.gear = traj_.trajectory().gear;
+  pstate_msg_.target.behavior.value = art_msgs::PilotBehavior::Run;
+  validateTarget();
+}
+
 /** validate target CarDrive values */
 void PilotNode::validateTarget(void)
 {
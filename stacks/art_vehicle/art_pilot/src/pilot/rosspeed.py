@@ -27,6 +27,8 @@ from art_msgs.msg import BrakeCommand
 from art_msgs.msg import BrakeState
 from art_msgs.msg import CarCommand
 from art_msgs.msg import CarDriveStamped
+from art_msgs.msg import CarTrajectory
+from art_msgs.msg import Gear
 from art_msgs.msg import ThrottleCommand
 from art_msgs.msg import ThrottleState
 
@@ -70,6 +72,17 @@ class speedTopics:
         self.plt.set_pilot_cmd(cmd.header.stamp.to_sec(),
                                cmd.control.velocity)
 
+    def get_pilot_trajectory(self, traj):
+        "ROS callback for /pilot/trajectory topic."
+        # the first point is the speed requested now, its sign
+        # given by the gear
+        if len(traj.points) > 0:
+            speed = traj.points[0].speed
+            if traj.gear.value == Gear.Reverse:
+                speed = -speed
+            self.plt.set_pilot_cmd(traj.header.stamp.to_sec()
+                                   + traj.points[0].time, speed)
+
     def get_odometry(self, odom):
         "ROS callback for /odom topic."
         if odom.header.stamp.to_sec() != 0.0:
@@ -103,6 +116,8 @@ class speedTopics:
         "Acquire speed topic data until ROS shutdown."
         rospy.Subscriber('pilot/drive', CarDriveStamped, self.get_pilot_drive)
         rospy.Subscriber('pilot/cmd', CarCommand, self.get_pilot_cmd)
+        rospy.Subscriber('pilot/trajectory', CarTrajectory,
+                         self.get_pilot_trajectory)
         rospy.Subscriber('odom', Odometry, self.get_odometry)
         rospy.Subscriber('brake/cmd', BrakeCommand, self.get_brake_cmd)
         rospy.Subscriber('brake/state', BrakeState, self.get_brake_state)
@@ -41,6 +41,7 @@ class SpeedControl
   {
     // initialize private node handle for getting parameter settings
     node_ = ros::NodeHandle("~");
+    cycle_time_ = 0.0;
   };
 
   /** Adjust speed to match goal.
@@ -70,11 +71,18 @@ class SpeedControl
     throttle_position_ = position;
   }
 
+  /** Set duration of current control cycle (seconds). */
+  virtual void set_cycle_time(float dt)
+  {
+    cycle_time_ = dt;
+  }
+
 protected:
 
   ros::NodeHandle node_;                // private node handle for parameters
   float brake_position_;
   float throttle_position_;
+  float cycle_time_;                    // current cycle duration (sec)
 };
 
 /** Acceleration matrix speed controller class */
@@ -0,0 +1,184 @@
+/*
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+/**  @file
+
+     Pilot speed control cycle heap allocation unit test.
+
+     Runs each acceleration controller against simulated brake and
+     throttle servos, tracking navigator trajectories, and checks
+     that the steady state cycle does not allocate memory.  The
+     controllers use node handles, so this runs under rostest.
+
+ */
+
+#include <gtest/gtest.h>
+#include "alloc_counter.h"
+
+#include <art_msgs/ArtHertz.h>
+#include "accel.h"
+#include "trajectory.h"
+
+const int N_POINTS = 10;                // points per trajectory
+const float CRUISE_SPEED = 5.0;         // m/s
+const int TRAJ_CYCLES = 4;              // pilot cycles per trajectory
+
+/** Servo that reaches each request by the next cycle. */
+class SimServo: public device_interface::ServoDeviceBase
+{
+ public:
+
+  SimServo():
+    ServoDeviceBase(ros::NodeHandle()),
+    position_(0.0),
+    request_(0.0)
+  {}
+
+  DeviceState state(ros::Time recently)
+  {
+    return art_msgs::DriverState::RUNNING;
+  }
+  float last_request() { return request_; }
+  float value() { return position_; }
+  void publish(float new_position, ros::Time cycle_time)
+  {
+    request_ = new_position;
+  }
+
+  void step(void) { position_ = request_; }
+
+ private:
+  float position_;
+  float request_;
+};
+
+/** Pilot speed control loop, closed with a crude vehicle model. */
+class AccelCycle
+{
+ public:
+
+  AccelCycle(int controller):
+    cycle_(1.0 / art_msgs::ArtHertz::PILOT),
+    brake_(new SimServo()),
+    throttle_(new SimServo()),
+    now_(100.0),
+    ncycles_(0)
+  {
+    art_pilot::PilotConfig config = art_pilot::PilotConfig::__getDefault__();
+    config.acceleration_controller = controller;
+    accel_ = pilot::allocAccel(config, cycle_);
+    pstate_.current.speed = 0.0;
+    traj_msg_.header.frame_id = "/odom";
+    traj_msg_.points.resize(N_POINTS);
+  }
+
+  /** one pilot cycle, with a new trajectory every few cycles */
+  void cycle(void)
+  {
+    if (ncycles_++ % TRAJ_CYCLES == 0)
+      {
+        // the navigator accelerates to cruise speed at 2 m/s/s
+        traj_msg_.header.stamp = now_;
+        for (int i = 0; i < N_POINTS; ++i)
+          {
+            traj_msg_.points[i].time = 0.1 * i;
+            traj_msg_.points[i].speed =
+              fminf(pstate_.current.speed + 0.2 * (i + 1), CRUISE_SPEED);
+            traj_msg_.points[i].curvature = 0.0;
+          }
+        EXPECT_TRUE(traj_.set(traj_msg_));
+      }
+
+    float speed, curvature;
+    traj_.sample(now_, speed, curvature);
+    pstate_.header.stamp = now_;
+    pstate_.target.speed = speed;
+    pstate_.target.acceleration = 0.0;
+    accel_->adjust(pstate_, brake_, throttle_);
+
+    brake_->step();
+    throttle_->step();
+    float dt = cycle_.toSec();
+    float accel = (4.0 * throttle_->value() - 8.0 * brake_->value()
+                   - 0.05 * pstate_.current.speed);
+    pstate_.current.speed = fmaxf(pstate_.current.speed + accel * dt, 0.0);
+    now_ += cycle_;
+  }
+
+  float speed(void) const { return pstate_.current.speed; }
+
+ private:
+  ros::Duration cycle_;
+  boost::shared_ptr<SimServo> brake_;
+  boost::shared_ptr<SimServo> throttle_;
+  pilot::AccelBasePtr accel_;
+  pilot::Trajectory traj_;
+  art_msgs::CarTrajectory traj_msg_;
+  art_msgs::PilotState pstate_;
+  ros::Time now_;
+  int ncycles_;
+};
+
+/** @return allocations in the steady state cycle of a controller */
+unsigned long cycle_allocations(int controller)
+{
+  AccelCycle pilot(controller);
+
+  // warm up until vectors reach full size
+  for (int i = 0; i < 100; ++i)
+    pilot.cycle();
+
+  const int N_CYCLES = 1000;
+  ArtAlloc::Counter allocs;
+  for (int i = 0; i < N_CYCLES; ++i)
+    pilot.cycle();
+  return allocs.count();
+}
+
+TEST(AccelCycle, plan)
+{
+  AccelCycle pilot(art_pilot::Pilot_Accel_Plan);
+  for (int i = 0; i < 400; ++i)
+    pilot.cycle();
+  EXPECT_NEAR(CRUISE_SPEED, pilot.speed(), 0.5);
+
+  EXPECT_EQ(0u, cycle_allocations(art_pilot::Pilot_Accel_Plan));
+}
+
+TEST(AccelCycle, example)
+{
+  EXPECT_EQ(0u, cycle_allocations(art_pilot::Pilot_Accel_Example));
+}
+
+TEST(AccelCycle, speed_pid)
+{
+  EXPECT_EQ(0u, cycle_allocations(art_pilot::Pilot_Speed_PID));
+}
+
+TEST(AccelCycle, speed_matrix)
+{
+  EXPECT_EQ(0u, cycle_allocations(art_pilot::Pilot_Speed_Matrix));
+}
+
+TEST(AccelCycle, speed_learned)
+{
+  EXPECT_EQ(0u, cycle_allocations(art_pilot::Pilot_Speed_Learned));
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "test_accel_cycle");
+
+  // formatting log messages allocates, even when nobody listens
+  if (ros::console::set_logger_level(ROSCONSOLE_DEFAULT_NAME,
+                                     ros::console::levels::Warn))
+    ros::console::notifyLoggerLevelsChanged();
+
+  return RUN_ALL_TESTS();
+}
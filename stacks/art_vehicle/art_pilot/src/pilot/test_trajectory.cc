@@ -0,0 +1,106 @@
+/*
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ * 
+ *  $Id$
+ */
+
+/**  @file
+ 
+     Unit tests for pilot trajectory tracking.
+
+ */
+
+#include <gtest/gtest.h>
+#include "trajectory.h"
+
+// a trajectory starting at t0, one point per 0.1 sec
+art_msgs::CarTrajectory make_trajectory(const ros::Time &t0, int npoints,
+                                        const float speeds[],
+                                        const float curvatures[])
+{
+  art_msgs::CarTrajectory traj;
+  traj.header.stamp = t0;
+  traj.points.resize(npoints);
+  for (int i = 0; i < npoints; ++i)
+    {
+      traj.points[i].time = 0.1 * i;
+      traj.points[i].speed = speeds[i];
+      traj.points[i].curvature = curvatures[i];
+    }
+  return traj;
+}
+
+TEST(Trajectory, invalid)
+{
+  pilot::Trajectory tracker;
+  EXPECT_FALSE(tracker.active());
+
+  art_msgs::CarTrajectory traj;
+  EXPECT_FALSE(tracker.set(traj));
+  EXPECT_FALSE(tracker.active());
+
+  const float speeds[] = {1.0, 1.0};
+  const float curvatures[] = {0.0, 0.0};
+  traj = make_trajectory(ros::Time(100.0), 2, speeds, curvatures);
+  traj.points[1].time = 0.0;
+  EXPECT_FALSE(tracker.set(traj));
+  EXPECT_FALSE(tracker.active());
+}
+
+TEST(Trajectory, interpolate)
+{
+  pilot::Trajectory tracker;
+  const float speeds[] = {2.0, 3.0, 3.0};
+  const float curvatures[] = {0.0, 0.1, 0.2};
+  ros::Time t0(100.0);
+  EXPECT_TRUE(tracker.set(make_trajectory(t0, 3, speeds, curvatures)));
+  EXPECT_TRUE(tracker.active());
+
+  float speed, curvature;
+  tracker.sample(t0 - ros::Duration(0.05), speed, curvature);
+  EXPECT_FLOAT_EQ(2.0, speed);
+  EXPECT_FLOAT_EQ(0.0, curvature);
+
+  tracker.sample(t0 + ros::Duration(0.05), speed, curvature);
+  EXPECT_NEAR(2.5, speed, 0.0001);
+  EXPECT_NEAR(0.05, curvature, 0.0001);
+
+  tracker.sample(t0 + ros::Duration(0.15), speed, curvature);
+  EXPECT_NEAR(3.0, speed, 0.0001);
+  EXPECT_NEAR(0.15, curvature, 0.0001);
+
+  tracker.reset();
+  EXPECT_FALSE(tracker.active());
+}
+
+TEST(Trajectory, extrapolate)
+{
+  pilot::Trajectory tracker;
+  float speed, curvature;
+  ros::Time t0(100.0);
+
+  // accelerating: holds the last speed
+  const float rising[] = {2.0, 3.0};
+  const float curvatures[] = {0.1, 0.1};
+  EXPECT_TRUE(tracker.set(make_trajectory(t0, 2, rising, curvatures)));
+  tracker.sample(t0 + ros::Duration(0.5), speed, curvature);
+  EXPECT_FLOAT_EQ(3.0, speed);
+  EXPECT_FLOAT_EQ(0.1, curvature);
+
+  // decelerating: continues slowing, until stopped
+  const float falling[] = {3.0, 2.0};
+  EXPECT_TRUE(tracker.set(make_trajectory(t0, 2, falling, curvatures)));
+  tracker.sample(t0 + ros::Duration(0.15), speed, curvature);
+  EXPECT_NEAR(1.5, speed, 0.0001);
+  tracker.sample(t0 + ros::Duration(1.0), speed, curvature);
+  EXPECT_FLOAT_EQ(0.0, speed);
+  EXPECT_FLOAT_EQ(0.1, curvature);
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
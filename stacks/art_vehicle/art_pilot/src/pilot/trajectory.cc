@@ -0,0 +1,81 @@
+/*
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ * 
+ *  $Id$
+ */
+
+/**  @file
+ 
+     ART pilot short-horizon trajectory tracking implementation.
+
+ */
+
+#include "trajectory.h"
+
+namespace pilot
+{
+
+bool Trajectory::set(const art_msgs::CarTrajectory &traj)
+{
+  active_ = false;
+  if (traj.points.empty())
+    {
+      ROS_WARN_THROTTLE(100, "empty trajectory ignored");
+      return false;
+    }
+  for (unsigned i = 1; i < traj.points.size(); ++i)
+    {
+      if (traj.points[i].time <= traj.points[i-1].time)
+        {
+          ROS_WARN_THROTTLE(100, "trajectory times not increasing, ignored");
+          return false;
+        }
+    }
+
+  traj_ = traj;                         // reuses points storage
+  active_ = true;
+  return true;
+}
+
+void Trajectory::sample(const ros::Time &now,
+                        float &speed, float &curvature) const
+{
+  const std::vector<art_msgs::CarTrajectoryPoint> &pts = traj_.points;
+  float t = (now - traj_.header.stamp).toSec();
+
+  if (t <= pts.front().time)
+    {
+      // not started yet: use the first point
+      speed = pts.front().speed;
+      curvature = pts.front().curvature;
+      return;
+    }
+
+  unsigned last = pts.size() - 1;
+  if (t >= pts[last].time)
+    {
+      // past the end: hold curvature, continue any deceleration
+      speed = pts[last].speed;
+      curvature = pts[last].curvature;
+      if (last > 0)
+        {
+          float slope = ((pts[last].speed - pts[last-1].speed)
+                         / (pts[last].time - pts[last-1].time));
+          if (slope < 0.0)
+            speed = fmaxf(speed + slope * (t - pts[last].time), 0.0);
+        }
+      return;
+    }
+
+  // interpolate between the surrounding points
+  unsigned i = 1;
+  while (pts[i].time < t)
+    ++i;
+  float frac = (t - pts[i-1].time) / (pts[i].time - pts[i-1].time);
+  speed = pts[i-1].speed + frac * (pts[i].speed - pts[i-1].speed);
+  curvature = (pts[i-1].curvature
+               + frac * (pts[i].curvature - pts[i-1].curvature));
+}
+
+}; // namespace pilot
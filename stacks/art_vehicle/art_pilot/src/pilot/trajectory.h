@@ -0,0 +1,73 @@
+/* -*- mode: C++ -*-
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ * 
+ *  $Id$
+ */
+
+/**  @file
+ 
+     ART pilot short-horizon trajectory tracking interface.
+
+ */
+
+#ifndef _TRAJECTORY_H_
+#define _TRAJECTORY_H_
+
+#include <ros/ros.h>
+#include <art_msgs/CarTrajectory.h>
+
+namespace pilot
+{
+
+/** Short-horizon trajectory tracker.
+ *
+ *  Holds the latest CarTrajectory from the navigator, sampling it at
+ *  the pilot's own cycle rate.  Between points, speed and curvature
+ *  are interpolated linearly.  Past the last point, curvature holds
+ *  and speed continues any deceleration of the final segment, but
+ *  never increases, so a late navigator update cannot make the
+ *  vehicle go faster than it last asked.
+ */
+class Trajectory
+{
+ public:
+
+  Trajectory(): active_(false) {};
+
+  /** @return true if a trajectory is being tracked */
+  bool active(void) const { return active_; }
+
+  /** stop tracking any trajectory */
+  void reset(void) { active_ = false; }
+
+  /** Track a new trajectory.
+   *
+   *  @param traj latest navigator trajectory
+   *  @return false (and not tracking) if it has no points, or they
+   *          are not in increasing time order
+   */
+  bool set(const art_msgs::CarTrajectory &traj);
+
+  /** Sample the trajectory.
+   *
+   *  @pre active()
+   *  @param now time of this pilot cycle
+   *  @param[out] speed requested speed (m/s)
+   *  @param[out] curvature requested curvature (1/m)
+   */
+  void sample(const ros::Time &now, float &speed, float &curvature) const;
+
+  /** @return latest trajectory */
+  const art_msgs::CarTrajectory &trajectory(void) const { return traj_; }
+
+ private:
+
+  art_msgs::CarTrajectory traj_;        // latest trajectory
+  bool active_;                         // tracking traj_?
+};
+
+}; // namespace pilot
+
+#endif // _TRAJECTORY_H_
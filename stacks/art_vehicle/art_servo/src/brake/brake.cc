@@ -26,9 +26,11 @@
 #include <art_msgs/BrakeState.h>
 
 #include <art_msgs/ArtHertz.h>
+#include <art/rates.h>
 
 
 #include "devbrake.h"			// servo device interface
+#include "../mailbox.h"
 
 /** 
  @brief ART brake servo driver
@@ -55,6 +57,10 @@ Parameters
   - use "/dev/null" when simulating the device
   - default: "/dev/brake" (actual hardware port)
 
+- hertz (double)
+  - driver cycle rate
+  - default: art_msgs/ArtHertz BRAKE
+
 - apply_on_exit (bool)
   - unless false, apply full brake during shutdown.
   - default: false
@@ -70,6 +76,10 @@ Training mode collects data while a human driver operates the vehicle.
     normal operation
   - default: false
 
+- reconnect_failures (int)
+  - consecutive failed device polls before reopening the port
+  - default: 5
+
 @todo describe initial calibration values
 @todo use ROS diagnostic_updater package
 
@@ -85,6 +95,8 @@ namespace
   std::string port = "/dev/brake";      // tty port name
   bool	training = false;               // use training mode
   bool	diagnostic = false;             // enable diagnostic mode
+  double hertz = art_msgs::ArtHertz::BRAKE; // driver cycle rate
+  int   reconnect_failures = 5;         // failed polls before reconnect
   int   qDepth = 1;                     // ROS topic queue depths
   /// @todo make queue depth an option
 
@@ -92,6 +104,15 @@ namespace
   devbrake *dev;                        // servo device interface
   float	brake_pos;                      // current brake position
   float	set_point;			// requested brake setting
+  int	io_failures = 0;                // consecutive failed polls
+
+  // latest command, from callback to device I/O thread, keeping
+  // the deltas of relative commands posted before it was taken
+  typedef MailboxMergeRelative<art_msgs::BrakeCommand,
+                               &art_msgs::BrakeCommand::position,
+                               art_msgs::BrakeCommand::Absolute,
+                               art_msgs::BrakeCommand::Relative> MergeCmd;
+  Mailbox<art_msgs::BrakeCommand::ConstPtr, MergeCmd> commands;
 }
 
 // ROS topics used by this driver
@@ -114,6 +135,10 @@ int GetParameters(void)
   if (diagnostic)
     ROS_INFO("using diagnostic mode");
 
+  hertz = ArtRates::getHertz(mynh, art_msgs::ArtHertz::BRAKE);
+
+  mynh.getParam("reconnect_failures", reconnect_failures);
+
   // allocate and initialize the devbrake interface
   dev = new devbrake(training);
 
@@ -181,6 +206,16 @@ int Shutdown()
   return 0;
 }
 
+// Command callback, runs in the spinner thread.
+//
+// Only hands the command to the device I/O thread, which applies the
+// latest one at the start of its next control cycle.
+void GetCommand(const art_msgs::BrakeCommand::ConstPtr &cmd)
+{
+  commands.post(cmd);
+}
+
+// update the set point (in the device I/O thread)
 void ProcessCommand(const art_msgs::BrakeCommand::ConstPtr &cmd)
 {
   uint32_t request = cmd->request;
@@ -210,6 +245,25 @@ void ProcessCommand(const art_msgs::BrakeCommand::ConstPtr &cmd)
     }
 }
 
+// Reopen the device after repeated I/O failures.
+//
+// The brake stays calibrated, so this takes a fraction of a second,
+// and the set point is unchanged.  If it fails, the next failed poll
+// tries again.
+void Reconnect(void)
+{
+  ROS_WARN("%d consecutive brake I/O failures, reconnecting", io_failures);
+  ros::WallTime start = ros::WallTime::now();
+  if (dev->Reconnect() == 0)
+    {
+      ROS_INFO("brake reconnected in %.3f sec",
+               (ros::WallTime::now() - start).toSec());
+      io_failures = 0;
+    }
+  else
+    ROS_ERROR("brake reconnect failed");
+}
+
 // Poll device for current status.  Publish results as brake status.
 //
 // If an I/O fails, the corresponding values remain unchanged and old
@@ -220,7 +274,11 @@ float PollDevice(void)
   art_msgs::BrakeState bs;             // brake state message
 
   // read the primary hardware sensor status
-  dev->get_state(&bs.position, &bs.potentiometer, &bs.encoder, &bs.pressure);
+  if (dev->get_state(&bs.position, &bs.potentiometer,
+                     &bs.encoder, &bs.pressure) == 0)
+    io_failures = 0;
+  else if (++io_failures >= reconnect_failures)
+    Reconnect();
 
 #if 0 // TODO: use ROS diagnostics package
   if (diagnostic)			// return extra diagnostic values?
@@ -245,24 +303,31 @@ int main(int argc, char** argv)
   ros::NodeHandle node;
 
   // topics to read and write
-  brake_cmd = node.subscribe(NODE "/cmd", qDepth, ProcessCommand,
+  brake_cmd = node.subscribe(NODE "/cmd", qDepth, GetCommand,
                              ros::TransportHints().tcpNoDelay(true));
   brake_state = node.advertise<art_msgs::BrakeState>(NODE "/state", qDepth);
 
   if (GetParameters() != 0)
     return 1;
 
-  ros::Rate cycle(art_msgs::ArtHertz::BRAKE); // set driver cycle rate
+  ros::Rate cycle(hertz);               // set driver cycle rate
 
   if (Setup() != 0)
     return 2;
 
-  // Main loop; grab messages off our queue and republish them via ROS
+  // callbacks run in a separate thread, never blocking on device I/O
+  ros::AsyncSpinner spinner(1);
+  spinner.start();
+
+  // Main loop; this thread does all the device I/O
+  art_msgs::BrakeCommand::ConstPtr cmd;
   while(ros::ok())
     {
+      dev->tick(ros::Time::now());      // advance simulated device
       brake_pos = PollDevice();         // get and publish device status
 
-      ros::spinOnce();                  // handle incoming commands
+      if (commands.take(cmd))           // new command?
+        ProcessCommand(cmd);
 
       static float const epsilon = 0.001;
       float ctlout = pid->Update(set_point - brake_pos, brake_pos);
@@ -272,6 +337,7 @@ int main(int argc, char** argv)
       cycle.sleep();                    // sleep until next cycle
     }
 
+  spinner.stop();
   Shutdown();
 
   return 0;
@@ -85,28 +85,16 @@ int devbrake::Open(const char *port_name)
   // retry count in case calibration fails
   int retries = 7;
 
-  // open the serial port
-  int rc = this->Servo::Open(port_name, (O_RDWR|O_NOCTTY|O_NONBLOCK));
+  int rc = open_port(port_name);
   if (fd < 0) {
-    ROS_FATAL("Couldn't open %s (%s)", port_name, strerror(errno));
-    return -1;
-  }  
-
-  // set initial baud rate
-  rc = configure_raw_port(B9600 | CS8, 0);
-  if (rc != 0) goto fail;
-    
-  // tell device to run at 38400; command does not and cannot respond
-  servo_write_only("BAUD38400\n");
-  sleep(3);
-    
-  // set actual baud rate
-  rc = configure_raw_port(B38400 | CS8, 0);
+    ROS_FATAL("Couldn't open %s (%s)", port_name, strerror(rc));
+    return rc;				// port not opened
+  }
   if (rc != 0) goto fail;
 
   // Initialize brake simulation before calibration.
   if (!have_tty)
-    sim = new ArtBrakeModel(cur_position);
+    sim = new ArtBrakeModel(cur_position, sim_clock);
 
   // No need to configure or calibrate brake if already done.
   // Must avoid touching the brake when in training mode.
@@ -135,13 +123,47 @@ int devbrake::Open(const char *port_name)
   return rc;				// Open() failed
 }
 
+/** @brief reopen the port after an I/O fault, without recalibrating
+ *
+ *  If the controller lost power, it also lost its configuration and
+ *  its encoder origin.  So, send the configuration again, and
+ *  resynchronize the encoder limits with the position sensors,
+ *  which still have their calibrated ranges.
+ *
+ *  @return 0 if successful, errno value otherwise
+ */
+int devbrake::Reconnect(void)
+{
+  if (sim)
+    return 0;				// simulated device never fails
+
+  if (fd >= 0)
+    this->Servo::Close();
+  fd = -1;
+
+  int rc = open_port(devName);
+  if (rc == 0 && !training)
+    {
+      rc = send_configuration();
+      if (rc == 0)
+        rc = resync_position();
+    }
+
+  if (rc != 0 && fd >= 0)
+    {
+      this->Servo::Close();
+      fd = -1;
+    }
+  return rc;
+}
+
 int devbrake::Close()
 {
   if (apply_on_exit && !training)
     {
       ROS_INFO("setting brake fully on for shutdown");
       brake_absolute(1.0);		// set brake fully on
-      sleep(1);                         // give it a second to work
+      wait(1000*1000);                  // give it a second to work
     }
   return this->Servo::Close();
 }
@@ -323,6 +345,57 @@ int devbrake::query_volts(float *data)
 /////////////////////////////////////////////////////////////////
 
 
+/** @brief open the serial port and switch it to 38400 baud
+ *
+ *  Continues as soon as the controller answers at the new rate,
+ *  instead of always sleeping three seconds.
+ *
+ *  @return 0 if successful, errno value otherwise
+ */
+int devbrake::open_port(const char *port_name)
+{
+  int rc = this->Servo::Open(port_name, (O_RDWR|O_NOCTTY|O_NONBLOCK));
+  if (fd < 0)
+    return rc;				// Servo::Open() logged the error
+
+  // set initial baud rate
+  rc = configure_raw_port(B9600 | CS8, 0);
+  if (rc != 0) return rc;
+    
+  // tell device to run at 38400; command does not and cannot respond
+  servo_write_only("BAUD38400\n");
+  tcdrain(fd);				// finish sending at 9600
+    
+  // set actual baud rate
+  rc = configure_raw_port(B38400 | CS8, 0);
+  if (rc != 0) return rc;
+
+  // the controller takes a while to switch, at most three seconds
+  return wait_ready("RW\n", '\r', 3000);
+}
+
+/** @brief resynchronize encoder limits with the position sensors
+ *
+ *  Relative encoder moves are converted using encoder_min and
+ *  encoder_range, which are only valid relative to the controller's
+ *  origin.  After it restarts, shift them so the current encoder
+ *  reading corresponds to the position reported by the calibrated
+ *  potentiometer or pressure sensor.
+ */
+int devbrake::resync_position(void)
+{
+  float position, pot, encoder, pressure;
+  int rc = get_state(&position, &pot, &encoder, &pressure);
+  if (rc != 0)
+    return rc;
+
+  encoder_min = encoder - position * encoder_range;
+  encoder_max = encoder_min + encoder_range;
+  ROS_INFO("brake position %.3f, resynchronized encoder range [%.f, %.f]",
+           position, encoder_min, encoder_max);
+  return 0;
+}
+
 #define ENC_EPSILON 2			// trivial position difference
 #define POT_EPSILON 0.002		// trivial potentiometer difference
 #define PRESS_EPSILON 0.005		// trivial pressure difference
@@ -373,7 +446,7 @@ int devbrake::calibrate_brake(void)
       if (rc != 0) return rc;
       if (cur_status & Status_Bp)	// +limit reached?
         break;
-      usleep(50*1000);                  // wait 0.05 sec
+      wait(50*1000);                    // wait 0.05 sec
     }
 
   // log whether or not brake reached +limit within 4 sec.
@@ -456,6 +529,46 @@ inline void devbrake::check_encoder_limits(void)
 // To remove brake spring use 3/16" allen wrench and 11mm open end wrench.
 //
 int devbrake::configure_brake(void)
+{
+  int rc = send_configuration();
+  if (rc != 0) return rc;
+    
+  // find negative limit position
+  for (int timeout = 4*10; timeout > 0; --timeout)
+    {
+      rc = encoder_goto(-10000);	// relative goto
+      if (rc != 0) return rc;
+      if (cur_status & Status_Bm)	// -limit reached?
+        {
+          ROS_INFO("-limit reached during configuration");
+          break;
+        }
+      wait(100*1000);                   // wait 0.1 sec
+    }
+
+  if ((cur_status & Status_Bm) == 0)    // -limit not reached?
+    {
+      ROS_ERROR("Brake failure: "
+                "unable to reach negative limit in 4 seconds.");
+      return ENODEV;
+    }
+
+  rc = servo_cmd("O=0 RW\n");		// set the origin here
+  if (rc != 0) return rc;
+
+  // initialize position values
+  encoder_min = 0.0;
+  encoder_range = encoder_max - encoder_min;
+  cur_position = 0.0;
+
+  return 0;
+}
+
+// Send the brake controller its settings, without moving the brake.
+//
+// These do not survive a controller restart, so Reconnect() sends
+// them again.
+int devbrake::send_configuration(void)
 {
   int rc;
 
@@ -489,38 +602,7 @@ int devbrake::configure_brake(void)
   rc = servo_cmd("UDM RW\n");		// set pin D to -limit
   if (rc != 0) return rc;
     
-  rc = servo_cmd("F=1 RW\n");		// stop after limit fault
-  if (rc != 0) return rc;
-    
-  // find negative limit position
-  for (int timeout = 4*10; timeout > 0; --timeout)
-    {
-      rc = encoder_goto(-10000);	// relative goto
-      if (rc != 0) return rc;
-      if (cur_status & Status_Bm)	// -limit reached?
-        {
-          ROS_INFO("-limit reached during configuration");
-          break;
-        }
-      usleep(100*1000);                 // wait 0.1 sec
-    }
-
-  if ((cur_status & Status_Bm) == 0)    // -limit not reached?
-    {
-      ROS_ERROR("Brake failure: "
-                "unable to reach negative limit in 4 seconds.");
-      return ENODEV;
-    }
-
-  rc = servo_cmd("O=0 RW\n");		// set the origin here
-  if (rc != 0) return rc;
-
-  // initialize position values
-  encoder_min = 0.0;
-  encoder_range = encoder_max - encoder_min;
-  cur_position = 0.0;
-
-  return 0;
+  return servo_cmd("F=1 RW\n");		// stop after limit fault
 }
 
 // send encoder position relative displacement command
@@ -733,7 +815,7 @@ int devbrake::read_stable_value(query_method_t query_method,
   // loop until value settles
   for (int timeout = 4*10; timeout > 0; --timeout)
     {
-      usleep(100*1000);			// wait 0.1 sec
+      wait(100*1000);			// wait 0.1 sec
 
       float cur_val;
       rc = (this->*query_method)(&cur_val);
@@ -819,3 +901,16 @@ void devbrake::servo_write_only(const char *string)
   if (res < 0)
     ROS_ERROR_THROTTLE(100, "write() error: %d", errno);
 }
+
+/* Wait for the brake actuator to move.
+ *
+ *  The simulated device only advances its model time, so
+ *  calibration takes no real time in simulation.
+ */
+void devbrake::wait(int usecs)
+{
+  if (sim)
+    sim_clock.advance(usecs / 1000000.0);
+  else
+    usleep(usecs);
+}
@@ -34,6 +34,7 @@ public:
 
   int	Open(const char *port_name);
   int	Close();
+  int	Reconnect(void);
 
   // brake command methods
   int	brake_absolute(float position);
@@ -42,6 +43,9 @@ public:
   // accessor method for current position
   float	get_position(void) {return cur_position;}
 
+  // start of driver cycle: advance simulation time
+  void	tick(const ros::Time &t) {sim_clock.tick(t);}
+
   // read the primary hardware sensor status
   int	get_state(float *position, float *potentiometer,
                   float *encoder, float *pressure);
@@ -89,6 +93,7 @@ public:
   float	cur_position;			// last position read
 
   ArtBrakeModel *sim;                   // brake simulation model
+  SimClock sim_clock;                   // simulation model time
 
   // pointer to any of the private query_* methods
   typedef int (devbrake::*query_method_t)(float *);
@@ -104,10 +109,14 @@ public:
   void	check_encoder_limits(void);
   int	configure_brake(void);
   int	encoder_goto(int enc_delta);
+  int	open_port(const char *port_name);
   int	query_cmd(const char *string, char *status, int nbytes);
   int	read_stable_value(query_method_t query_method,
 			  double *status, float epsilon);
+  int	resync_position(void);
+  int	send_configuration(void);
   int	servo_cmd(const char *string);
+  void	wait(int usecs);
   void	servo_write_only(const char *string);
 
   // Convert encoder readings to and from float positions.
@@ -27,7 +27,8 @@ namespace
 }
 
 /** Constructor */
-ArtBrakeModel::ArtBrakeModel(float init_pos)
+ArtBrakeModel::ArtBrakeModel(float init_pos, const SimClock &clock):
+  clock_(clock)
 {
   am_ = new Animatics;
 
@@ -54,7 +55,7 @@ ArtBrakeModel::ArtBrakeModel(float init_pos)
   a_ = 0;
   v_ = 0;
   update_sensors(brake_position_);
-  last_update_time_ = ros::Time::now().toSec();
+  last_update_time_ = clock_.now();
 }
 
 ArtBrakeModel::~ArtBrakeModel()
@@ -205,7 +206,7 @@ void ArtBrakeModel::move(double start, double finish)
 */
 double ArtBrakeModel::plan(double dx)
 {
-  double t0 = ros::Time::now().toSec();
+  double t0 = clock_.now();
   double a;                             // required actuator acceleration
 
   if (fabs(dx) > EPSILON_TICKS)         // nonzero move?
@@ -242,7 +243,7 @@ double ArtBrakeModel::plan(double dx)
 /** update brake actuator model for start of cycle */
 void ArtBrakeModel::update(void)
 {
-  double now = ros::Time::now().toSec();
+  double now = clock_.now();
 
   // model actuator movement since last update
 #if 1
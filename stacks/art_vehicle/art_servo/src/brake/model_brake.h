@@ -22,6 +22,7 @@
 #include <ros/ros.h>
 
 #include "animatics.h"
+#include "../sim_clock.h"
 
 /** Actuator movement plan.
 
@@ -108,7 +109,12 @@ class ArtBrakeModel
 {
 public:
     
-  ArtBrakeModel(float init_pos);
+  /** Constructor.
+
+      @param init_pos initial brake position
+      @param clock model time source, ticked by the driver
+   */
+  ArtBrakeModel(float init_pos, const SimClock &clock);
   ~ArtBrakeModel();
 
   /** Interpret actuator command and return response. */
@@ -119,6 +125,7 @@ private:
   // ROS interfaces
   ros::NodeHandle node_;        // simulation node handle
 
+  const SimClock &clock_;       // model time source
   double last_update_time_;
 
   Animatics *am_;               // Animatics Smart Motor data
@@ -0,0 +1,119 @@
+/*
+ *  Brake driver cycle heap allocation unit test
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <gtest/gtest.h>
+#include "alloc_counter.h"
+
+#include <art/pid2.h>
+#include <art_msgs/ArtHertz.h>
+#include "devbrake.h"
+
+// Runs the brake driver's control cycle on the simulated /dev/null
+// device, and checks that the steady state cycle does not allocate
+// memory.  The device reads its parameters, so this runs under
+// rostest, with a master.
+
+const int STEP_CYCLES = 20;             // cycles per set point change
+
+class BrakeCycle: public testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    // the same defaults brake.cc uses
+    dev_ = new devbrake(false);
+    dev_->encoder_min = 0.0;
+    dev_->encoder_max = 50000.0;
+    dev_->encoder_range = dev_->encoder_max - dev_->encoder_min;
+    dev_->pot_off = 4.9;
+    dev_->pot_full = 0.49;
+    dev_->pot_range = dev_->pot_full - dev_->pot_off;
+    dev_->pressure_min = 0.85;
+    dev_->pressure_max = 4.5;
+    dev_->pressure_range = dev_->pressure_max - dev_->pressure_min;
+    pid_ = new Pid("pid", 0.25, 0.0, 0.7);
+
+    now_ = ros::Time(100.0);
+    cycle_ = ros::Duration(1.0 / art_msgs::ArtHertz::BRAKE);
+    ncycles_ = 0;
+    ASSERT_EQ(0, dev_->Open("/dev/null"));
+    set_point_ = brake_pos_ = dev_->get_position();
+  }
+
+  virtual void TearDown()
+  {
+    dev_->Close();
+    delete pid_;
+    delete dev_;
+  }
+
+  // one driver cycle, alternating the set point now and then
+  void cycle(void)
+  {
+    if (ncycles_++ % STEP_CYCLES == 0)
+      set_point_ = (set_point_ > 0.5? 0.2: 0.8);
+
+    dev_->tick(now_);
+    float potentiometer, encoder, pressure;
+    EXPECT_EQ(0, dev_->get_state(&brake_pos_, &potentiometer,
+                                 &encoder, &pressure));
+
+    static float const epsilon = 0.001;
+    float ctlout = pid_->Update(set_point_ - brake_pos_, brake_pos_);
+    if (fabs(ctlout) > epsilon)
+      dev_->brake_relative(ctlout);
+
+    now_ += cycle_;
+  }
+
+  devbrake *dev_;
+  Pid *pid_;
+  ros::Time now_;
+  ros::Duration cycle_;
+  int ncycles_;
+  float brake_pos_;
+  float set_point_;
+};
+
+TEST_F(BrakeCycle, tracks_set_point)
+{
+  // releasing from full brake, towards 0.2
+  EXPECT_NEAR(1.0, brake_pos_, 0.01);
+  for (int i = 0; i < STEP_CYCLES; ++i)
+    cycle();
+  EXPECT_LT(brake_pos_, 0.5);
+  EXPECT_GT(brake_pos_, 0.2 - 0.05);
+}
+
+TEST_F(BrakeCycle, no_allocations)
+{
+  // warm up, through a few set point changes
+  for (int i = 0; i < 5 * STEP_CYCLES; ++i)
+    cycle();
+
+  const int N_CYCLES = 1000;
+  ArtAlloc::Counter allocs;
+  for (int i = 0; i < N_CYCLES; ++i)
+    cycle();
+  EXPECT_EQ(0u, allocs.count());
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "test_brake_cycle");
+
+  // formatting log messages allocates, even when nobody listens
+  if (ros::console::set_logger_level(ROSCONSOLE_DEFAULT_NAME,
+                                     ros::console::levels::Warn))
+    ros::console::notifyLoggerLevelsChanged();
+
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,78 @@
+/*
+ *  Brake actuator model unit test
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <gtest/gtest.h>
+#include "model_brake.h"
+
+const int BUFSIZE = 32;
+
+// reads the simulated encoder
+int encoder(ArtBrakeModel &model)
+{
+  char status[BUFSIZE];
+  EXPECT_EQ(0, model.interpret("RP\n", status, BUFSIZE));
+  return atoi(status);
+}
+
+// starts a relative move
+void move(ArtBrakeModel &model, int delta)
+{
+  char cmd[BUFSIZE];
+  char status[BUFSIZE];
+  snprintf(cmd, BUFSIZE, "D=%d RW G\n", delta);
+  EXPECT_EQ(0, model.interpret(cmd, status, BUFSIZE));
+}
+
+TEST(ArtBrakeModel, no_time_no_motion)
+{
+  SimClock clock;
+  ArtBrakeModel model(0.5, clock);
+  int start = encoder(model);
+  move(model, 10000);
+  EXPECT_EQ(start, encoder(model));
+
+  clock.advance(0.1);
+  EXPECT_LT(start, encoder(model));
+}
+
+TEST(ArtBrakeModel, deterministic)
+{
+  // the same commands at the same model times give the same
+  // positions, however the steps are divided
+  SimClock clock1;
+  SimClock clock2;
+  ArtBrakeModel model1(0.5, clock1);
+  ArtBrakeModel model2(0.5, clock2);
+  move(model1, 10000);
+  move(model2, 10000);
+  for (int i = 0; i < 20; ++i)
+    {
+      clock1.advance(0.05);
+      clock2.advance(0.025);
+      encoder(model2);
+      clock2.advance(0.025);
+      EXPECT_NEAR(encoder(model1), encoder(model2), 1) << "cycle " << i;
+    }
+
+  // a move of 10000 ticks at 8 in/s^2 (192000 ticks/s^2) takes
+  // 2*sqrt(10000/192000) = 0.456 sec
+  SimClock clock3;
+  ArtBrakeModel model3(0.5, clock3);
+  int start = encoder(model3);
+  move(model3, 10000);
+  clock3.advance(0.5);
+  EXPECT_NEAR(start + 10000, encoder(model3), 1);
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -7,8 +7,10 @@
  */
 
 #include <ros/ros.h>
+#include <ros/callback_queue.h>
 
 #include <art_msgs/ArtHertz.h>
+#include <art/rates.h>
 #include <art/conversions.h>
 
 #include <art_msgs/Shifter.h>
@@ -37,6 +39,16 @@ audible alarm).
 
 - "shifter" reads and sets the transmission control relays.
 
+@par Shifting
+
+Each gear request on shifter/cmd starts a shift.  The driver sets the
+relay for that gear right away, then polls the shifter indicator at
+~/shift_hertz.  As soon as the indicator reports the requested gear,
+it resets the relays and publishes the new gear with relays off,
+which confirms the shift.  If the indicator does not change within
+~/shift_timeout, the relays are reset anyway, leaving the old gear
+reported.  A Reset request ends any shift in progress.
+
 @par Commands
 
 - PLAYER_AIO_CMD_STATE
@@ -51,6 +63,19 @@ be set off, otherwise it is set on.
   - tty port name for IOADR8x board
   - default: "/dev/null"
 
+- ~/hertz (double)
+  - driver cycle rate
+  - default: art_msgs/ArtHertz IOADR
+
+- ~/shift_hertz (double)
+  - shifter indicator poll rate while shifting, limited by the
+    device's minimum wait after setting relays
+  - default: 12.0
+
+- ~/shift_timeout (double)
+  - longest time to hold a shift relay (seconds)
+  - default: 2.0
+
   \author Jack O'Quin
 
 */
@@ -86,6 +111,7 @@ private:
 
   void GetSetRelays(void);
   void PollDevice(void);
+  void CheckShift(void);
   void processOutput(const art_msgs::IOadrCommand::ConstPtr &cmd);
   void processShifter(const art_msgs::Shifter::ConstPtr &shifterIn);
 
@@ -96,6 +122,9 @@ private:
   int reset_relays_;			// initial/final relays setting
   std::string port_;			// IOADR8x tty port name
   bool do_shifter_;                     // handle Shifter messages
+  double hertz_;                        // driver cycle rate
+  double shift_hertz_;                  // poll rate while shifting
+  double shift_timeout_;                // longest shift relay hold
 
   // ROS topic interfaces
   ros::Subscriber ioadr_cmd_;            // ioadr command
@@ -104,6 +133,11 @@ private:
   ros::Publisher  shifter_state_;        // shifter state
   uint8_t shifter_gear_;                 // current gear number
 
+  // shift in progress
+  bool shifting_;                        // waiting for indicator?
+  uint8_t shift_gear_;                   // gear requested
+  ros::Time shift_start_;                // time requested
+
   // requested relay settings
   uint8_t relay_mask_;
   uint8_t relay_bits_;
@@ -158,6 +192,9 @@ IOadr::IOadr()
   if (reset_relays_ >= 0)
     ROS_INFO("reset relays to 0x%02x", reset_relays_);
 
+  relay_mask_ = relay_bits_ = 0;
+  shifting_ = false;
+
   mynh.param("shifter", do_shifter_, false);
   if (do_shifter_)
     {
@@ -173,6 +210,14 @@ IOadr::IOadr()
   mynh.getParam("port", port_);
   ROS_INFO_STREAM("IOADR8x port = " << port_);
 
+  hertz_ = ArtRates::getHertz(mynh, art_msgs::ArtHertz::IOADR);
+
+  mynh.param("shift_hertz", shift_hertz_, 12.0);
+  mynh.param("shift_timeout", shift_timeout_, 2.0);
+  if (do_shifter_)
+    ROS_INFO("poll shifter at %.1f Hz while shifting, for up to %.1f sec",
+             shift_hertz_, shift_timeout_);
+
   if (mynh.hasParam("poll_list"))
     {
       // read list of poll strings
@@ -261,17 +306,69 @@ void IOadr::processOutput(const art_msgs::IOadrCommand::ConstPtr &cmd)
 
 // Callback when shifter command arrives.
 // (only subscribed when do_shifter_ is true)
+//
+// A gear request starts a shift, finished by CheckShift().
 void IOadr::processShifter(const art_msgs::Shifter::ConstPtr &shifterIn)
 {
-  // save requested gear when doing shifter simulation
-  if (shifterIn->gear != art_msgs::Shifter::Reset
-      && port_ == "/dev/null")
-    shifter_gear_ = shifterIn->gear;
+  if (shifterIn->gear > art_msgs::Shifter::Drive)
+    {
+      ROS_WARN("invalid shifter command: gear %u", shifterIn->gear);
+      return;
+    }
   ROS_INFO("Shifter command: gear %u", shifterIn->gear);
+
+  if (shifterIn->gear == art_msgs::Shifter::Reset)
+    {
+      shifting_ = false;
+    }
+  else
+    {
+      // repeated requests do not restart the relay hold
+      if (shifting_ && shifterIn->gear == shift_gear_)
+        return;
+      shifting_ = true;
+      shift_gear_ = shifterIn->gear;
+      shift_start_ = ros::Time::now();
+
+      // save requested gear when doing shifter simulation
+      if (port_ == "/dev/null")
+        shifter_gear_ = shifterIn->gear;
+    }
+
   relay_bits_ = relay_value_[shifterIn->gear];
   relay_mask_ = 0xff;                   // set all relay bits
 }
 
+// Finish a shift in progress, once the indicator reports the
+// requested gear or the relay has been held too long.
+//
+// Updates: shifting_, relay_mask_, relay_bits_
+//
+void IOadr::CheckShift(void)
+{
+  if (!shifting_)
+    return;
+
+  double elapsed = (ros::Time::now() - shift_start_).toSec();
+  if (shifter_gear_ == shift_gear_)
+    {
+      ROS_INFO("shifted into gear %u in %.3f sec", shift_gear_, elapsed);
+    }
+  else if (elapsed > shift_timeout_)
+    {
+      ROS_WARN("shift into gear %u not done after %.3f sec, still in %u",
+               shift_gear_, elapsed, shifter_gear_);
+    }
+  else
+    {
+      return;                           // keep holding the relay
+    }
+
+  shifting_ = false;
+  relay_bits_ = relay_value_[art_msgs::Shifter::Reset];
+  relay_mask_ = 0xff;
+}
+
 int IOadr::poll_Analog_8bit(int ch)
 {
   int data;
@@ -364,6 +461,9 @@ void IOadr::PollDevice(void)
         }
     }
 
+  if (do_shifter_)
+    CheckShift();
+
   // Get relay values, set new ones if requested.  Note: setting the
   // relays MUST be the last IOADR8x operation of the cycle.  After
   // that, the device seems to stay busy for a while.  It hangs if
@@ -422,23 +522,36 @@ void IOadr::GetSetRelays(void)
 
 void IOadr::Main()
 {
-  ros::Rate cycle(art_msgs::ArtHertz::IOADR); // set driver cycle rate
+  ros::CallbackQueue *queue = ros::getGlobalCallbackQueue();
+  ros::Time next_poll = ros::Time::now() + ros::Duration(1.0 / hertz_);
 
   // Main loop; grab messages off our queue and republish them via ROS
   while(ros::ok())
     {
-      // wait for next cycle -- this must come first, because Setup()
-      // may have initialized the relays.  If we hit the device again
-      // too soon, it locks up.  Apparently, this is not just limited
-      // to the relay ports.
-
-      cycle.sleep();
-
-      relay_mask_ = relay_bits_ = 0;
-
-      ros::spinOnce();                  // handle incoming commands
+      // handle incoming commands as they arrive, until the next poll
+      ros::Duration wait = next_poll - ros::Time::now();
+      if (wait > ros::Duration(0.0))
+        queue->callAvailable(ros::WallDuration(wait.toSec()));
+      else
+        queue->callAvailable();
+
+      // A relay request moves the next poll up.  Setup() may have
+      // initialized the relays, though.  If we hit the device again
+      // too soon after that, it locks up.  Apparently, this is not
+      // just limited to the relay ports.
+      ros::Time now = ros::Time::now();
+      if (now < next_poll && relay_mask_ == 0)
+        continue;
+      if (dev_->relays_busy())
+        {
+          next_poll = now + ros::Duration(MIN_RELAY_WAIT / 4.0);
+          continue;
+        }
 
       PollDevice();                     // get & publish device status
+
+      double hertz = (shifting_? shift_hertz_: hertz_);
+      next_poll = now + ros::Duration(1.0 / hertz);
     }
 }
   
@@ -0,0 +1,156 @@
+/* -*- mode: C++ -*-
+ *
+ *  Description:  Latest-value mailbox for servo driver commands.
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#ifndef _MAILBOX_H_
+#define _MAILBOX_H_
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+/** @brief default Mailbox merge policy: a newer value replaces the
+ *         pending one
+ */
+template <class T>
+struct MailboxReplace
+{
+  void operator()(T &pending, const T &newer) const
+  {
+    pending = newer;
+  }
+};
+
+/** @brief Mailbox merge policy for servo command messages
+ *
+ *  A Relative command must not be lost when it replaces a command
+ *  not yet taken, or the device ends up somewhere else than the
+ *  sender intended.  So, a Relative request is folded into the
+ *  pending one: its delta is added to the pending position, keeping
+ *  the pending request type.  Two Relative deltas become their sum,
+ *  and an Absolute position followed by a delta becomes a new
+ *  Absolute position.  Any other request replaces the pending one.
+ *
+ *  @param Msg command message type
+ *  @param Value message field holding the position or delta
+ *  @param Absolute request code for an absolute position
+ *  @param Relative request code for a relative change
+ */
+template <class Msg, float Msg::*Value,
+          uint32_t Absolute, uint32_t Relative>
+struct MailboxMergeRelative
+{
+  typedef boost::shared_ptr<Msg const> ConstPtr;
+
+  void operator()(ConstPtr &pending, const ConstPtr &newer) const
+  {
+    if (!pending || !newer
+        || newer->request != Relative
+        || (pending->request != Absolute && pending->request != Relative))
+      {
+        pending = newer;
+        return;
+      }
+
+    // messages are shared, so merge into a copy of the newer one
+    boost::shared_ptr<Msg> merged(new Msg(*newer));
+    merged->request = pending->request;
+    (*merged).*Value = (*pending).*Value + (*newer).*Value;
+    pending = merged;
+  }
+};
+
+/** @brief Latest-value mailbox between ROS callbacks and a driver's
+ *         device I/O thread.
+ *
+ *  Subscriber callbacks run in a ros::AsyncSpinner thread, and only
+ *  post() the message they received.  The I/O thread polls the
+ *  device, and waits on the mailbox between polls, so it can send a
+ *  new command as soon as one arrives.
+ *
+ *  A newer value replaces one not yet taken, so the device only
+ *  ever receives the most recent request.  The @a Merge policy
+ *  decides how a newer value combines with the pending one;
+ *  MailboxMergeRelative keeps relative servo commands from being
+ *  lost that way.
+ */
+template <class T, class Merge = MailboxReplace<T> >
+class Mailbox
+{
+public:
+
+  Mailbox():
+    full_(false)
+  {}
+
+  /** @brief post a value, merging it with any value not yet taken,
+   *         and wake any waiting thread
+   */
+  void post(const T &value)
+  {
+    {
+      boost::mutex::scoped_lock lock(lock_);
+      if (full_)
+        merge_(value_, value);
+      else
+        value_ = value;
+      full_ = true;
+    }
+    cond_.notify_one();
+  }
+
+  /** @brief take the current value, if any, without waiting
+   *
+   *  @param value [out] set to the value posted
+   *  @return true if there was a value
+   */
+  bool take(T &value)
+  {
+    boost::mutex::scoped_lock lock(lock_);
+    return take_locked(value);
+  }
+
+  /** @brief wait a while for a value to be posted
+   *
+   *  @param value [out] set to the value posted
+   *  @param timeout maximum time to wait (seconds)
+   *  @return true if there was a value, false if the timeout expired
+   *          (or the wait was interrupted: callers recheck their
+   *          deadline and wait again)
+   */
+  bool wait(T &value, double timeout)
+  {
+    boost::mutex::scoped_lock lock(lock_);
+    if (!full_ && timeout > 0.0)
+      cond_.timed_wait(lock, boost::posix_time::microseconds
+                       ((int64_t) (timeout * 1000000.0)));
+    return take_locked(value);
+  }
+
+private:
+
+  bool take_locked(T &value)
+  {
+    if (!full_)
+      return false;
+    value = value_;
+    value_ = T();                       // release any shared message
+    full_ = false;
+    return true;
+  }
+
+  boost::mutex lock_;
+  boost::condition_variable cond_;
+  Merge merge_;                         ///< merges a newer value
+  T value_;                             ///< latest value posted
+  bool full_;                           ///< value_ not yet taken
+};
+
+#endif // _MAILBOX_H_
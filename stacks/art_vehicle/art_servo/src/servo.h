@@ -20,6 +20,7 @@
 #include <termios.h>
 #include <unistd.h>
 #include <errno.h>
+#include <poll.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 
@@ -40,7 +41,8 @@ class Servo
   {
     int rc = 0;
     have_tty = (strcmp(device, "/dev/null") != 0);
-    strncpy(devName, (char *) device, sizeof(devName));
+    if (device != devName)		// not reopening after a fault?
+      strncpy(devName, (char *) device, sizeof(devName));
     fd = open(devName, flags);
     if (fd < 0)
       {
@@ -72,6 +74,59 @@ class Servo
   char devName[FILENAME_MAX];
   char buffer[MAX_SERVO_CMD_BUFFER];
 
+  /** @brief wait until the device answers a query
+   *
+   *  Used instead of a fixed sleep after a command that makes the
+   *  controller unresponsive for a while (restart, baud rate change).
+   *  Repeatedly writes the query, until a complete line terminated by
+   *  eol comes back.  Any response is discarded.
+   *
+   *  @param query command that produces a one-line response
+   *  @param eol response line terminator
+   *  @param max_msecs longest time to wait
+   *  @return 0 when the device responds, EBUSY if it never did
+   */
+  int wait_ready(const char *query, char eol, int max_msecs)
+  {
+    if (!have_tty) return 0;		// /dev/null is always ready
+
+    const int try_msecs = 20;		// time allowed for each answer
+    ros::WallTime start = ros::WallTime::now();
+    ros::WallTime stop = start + ros::WallDuration(max_msecs / 1000.0);
+    while (ros::WallTime::now() < stop)
+      {
+	tcflush(fd, TCIOFLUSH);
+	if (write(fd, query, strlen(query)) < 0)
+	  {
+	    usleep(try_msecs*1000);	// port not accepting output
+	    continue;
+	  }
+
+	ros::WallTime try_stop =
+	  ros::WallTime::now() + ros::WallDuration(try_msecs / 1000.0);
+	ros::WallDuration delay;
+	while ((delay = try_stop - ros::WallTime::now()) > ros::WallDuration())
+	  {
+	    struct pollfd fds[1];
+	    fds[0].fd = fd;
+	    fds[0].events = POLLIN;
+	    if (::poll(fds, 1, delay.toNSec() / 1000000 + 1) <= 0)
+	      break;			// timeout or error: try again
+	    char c;
+	    if (read(fd, &c, 1) == 1 && c == eol)
+	      {
+		tcflush(fd, TCIOFLUSH);	// discard anything else
+		ROS_DEBUG("%s ready after %.3f sec", devName,
+			  (ros::WallTime::now() - start).toSec());
+		return 0;
+	      }
+	  }
+      }
+
+    ROS_WARN("%s not ready after %d msec", devName, max_msecs);
+    return EBUSY;
+  }
+
   /* We prefer to use the raw serial port for servo devices.  That
    * minimizes processing in the kernel tty driver, which might get in
    * the way of an accurate perception of the true state of the device.
@@ -0,0 +1,72 @@
+/* -*- mode: C++ -*-
+ *
+ *  Description:  Simulated time for servo device models.
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#ifndef _SIM_CLOCK_H_
+#define _SIM_CLOCK_H_
+
+#include <ros/ros.h>
+
+/** @brief Simulated time for servo device models.
+ *
+ *  Models of the servo hardware advance by the model time elapsed
+ *  since their last update, instead of reading the system clock
+ *  whenever they happen to receive a command.  Their behavior then
+ *  depends only on the sequence of driver cycles, not on I/O thread
+ *  scheduling.
+ *
+ *  The driver tick()s the clock once per cycle with the ROS time,
+ *  which follows /clock when use_sim_time is set, so models run at
+ *  whatever rate the simulation does.  Waits the real device needs
+ *  during calibration become advance() calls, taking no wall time.
+ *
+ *  Model time starts at zero.
+ */
+class SimClock
+{
+public:
+
+  SimClock():
+    now_(0.0),
+    started_(false)
+  {}
+
+  /** @brief start of a driver cycle
+   *
+   *  Advances model time by the ROS time since the previous tick,
+   *  nothing on the first one.
+   */
+  void tick(const ros::Time &t)
+  {
+    if (started_ && t > last_tick_)
+      now_ += (t - last_tick_).toSec();
+    last_tick_ = t;
+    started_ = true;
+  }
+
+  /** @brief advance model time without waiting
+   *  @param dt seconds
+   */
+  void advance(double dt)
+  {
+    if (dt > 0.0)
+      now_ += dt;
+  }
+
+  /** @return current model time (seconds) */
+  double now(void) const { return now_; }
+
+private:
+  double now_;                          ///< model time (seconds)
+  bool started_;                        ///< ticked at least once
+  ros::Time last_tick_;                 ///< ROS time of last tick
+};
+
+#endif // _SIM_CLOCK_H_
@@ -12,7 +12,6 @@
 #include <poll.h>
 
 #include <ros/ros.h>
-#include <art_msgs/ArtHertz.h>
 #include <art_msgs/ArtVehicle.h>
 #include "devsteer.h"
 #include "silverlode.h"
@@ -32,6 +31,7 @@ int64_t devsteer::GetTime()
 }
 
 devsteer::devsteer(int32_t center):
+  last_sim_time_(0.0),
   req_angle_(0.0),
   center_ticks_(center)                 // for unit testing
 {}
@@ -69,7 +69,8 @@ int devsteer::Close()
   return this->Servo::Close();
 }
 
-int devsteer::Configure()
+/** configure device parameters */
+int devsteer::Configure(void)
 {
   // use private node handle to get parameters
   ros::NodeHandle private_nh("~");
@@ -161,9 +162,11 @@ int devsteer::get_angle(float &degrees)
   else
     {
       // simulate steering motion as a constant angular velocity
+      // over the model time since the previous cycle
       float remaining_angle = req_angle_ - degrees;
-      float degrees_per_cycle = (steering_rate_ /
-                                 art_msgs::ArtHertz::STEERING);
+      float degrees_per_cycle = (steering_rate_ *
+                                 (sim_clock_.now() - last_sim_time_));
+      last_sim_time_ = sim_clock_.now();
 
       DBG("remaining angle %.3f, degrees per cycle %.3f",
           remaining_angle, degrees_per_cycle);
@@ -423,8 +426,11 @@ int devsteer::configure_steering(void)
 #if 1
   // The restart command branches to microcode address zero.
   // It never responds, and nothing works for a while afterward.
+  // Continue as soon as it answers a status query, waiting at most
+  // one second.
   servo_write_only("@16 4\r");          // RST: restart
-  usleep(1000000);			// wait for that to finish
+  rc = wait_ready("@16 20\r", '\r', 1000);
+  if (rc != 0) return rc;
 #endif
 
   // If the controller is in Profile Move Continuous (PMC) mode,
@@ -50,6 +50,7 @@ Training mode collects data while a human driver operates the vehicle.
 #include <art_msgs/SteeringDiagnostics.h>
 
 #include "../servo.h"
+#include "../sim_clock.h"
 
 #define DEVICE "Quicksilver"
 
@@ -77,7 +78,10 @@ public:
 
   int	Open();
   int	Close();
-  int	Configure();
+  int	Configure(void);
+
+  // start of driver cycle: advance simulation time
+  void	tick(const ros::Time &t) {sim_clock_.tick(t);}
 
   // Quicksilver command methods
   int	check_status(void);
@@ -109,6 +113,8 @@ public:
   bool	training_;                // use training mode
   bool	simulate_moving_errors_;  // simulate intermittent moving errors
   double steering_rate_;          // steering velocity (deg/sec)
+  SimClock sim_clock_;            // simulation model time
+  double last_sim_time_;          // model time of previous motion
 
   float	req_angle_;                    // requested angle (absolute)
   float	starting_angle_;               // starting wheel angle
@@ -12,9 +12,7 @@
 #ifndef _D_TIMER_HH_
 #define _D_TIMER_HH_
 
-#include <sys/time.h>
-#include <time.h>
-#include <art_msgs/ArtHertz.h>
+#include <ros/ros.h>
 
 /** @brief driver timer class. */
 class DriverTimer
@@ -37,19 +35,16 @@ class DriverTimer
 
   /** @brief Return true if timer has expired.
    *
-   *  Called once per cycle while timer is running.  Skipped cycles do
-   *  not contribute to timer expiration.  That allows timers to pause
-   *  while the vehicle is pausing.  It should not immediately begin
-   *  passing after pausing behind a stopped vehicle, for example.
+   *  Expiration depends on the time elapsed since the timer started,
+   *  not on the number of driver cycles, so it does not change with
+   *  the configured cycle rate.
    */
   virtual bool Check(void)
   {
     if (!timer_running)
       return false;			// timer not set
 
-    // decrement time remaining by the duration of one cycle
-    time_remaining -= (1.0 / art_msgs::ArtHertz::STEERING);
-    return (time_remaining <= 0.0);
+    return (ros::Time::now() >= deadline);
   }
 
   /** @brief Restart timer.
@@ -58,7 +53,7 @@ class DriverTimer
    */
   virtual void Restart(double duration)
   {
-    if (timer_running && time_remaining > 0.0)
+    if (timer_running && ros::Time::now() < deadline)
       return;
 
     Start(duration);
@@ -68,12 +63,12 @@ class DriverTimer
   virtual void Start(double duration)
   {
     timer_running = true;
-    time_remaining = duration;
+    deadline = ros::Time::now() + ros::Duration(duration);
   }
 
  protected:
 
-  double time_remaining;		//< time remaining until done
+  ros::Time deadline;			//< time when timer expires
   bool timer_running;			//< true when timer running
 };
 
@@ -12,6 +12,7 @@
 
 #include <art_msgs/ArtHertz.h>
 #include <art/polynomial.h>
+#include <art/rates.h>
 
 #include <art_msgs/SteeringCommand.h>
 #include <art_msgs/SteeringState.h>
@@ -19,6 +20,7 @@
 
 #include "devsteer.h"			// servo device interface
 #include "testwheel.h"			// steering wheel self-test
+#include "../mailbox.h"
 
 /**  \file
 
@@ -89,8 +91,11 @@ private:
   void	GetCmd(const art_msgs::SteeringCommand::ConstPtr &cmdIn);
   void	GetPos(const art_msgs::IOadrState::ConstPtr &ioIn);
   int	open();
+  void	ProcessCmd(const art_msgs::SteeringCommand::ConstPtr &cmdIn);
+  void	ProcessPos(const art_msgs::IOadrState::ConstPtr &ioIn);
   void	PublishStatus(void);
   void	read_wheel_angle(void);
+  void	send_set_point(void);
 
 
   // .cfg variables:
@@ -98,6 +103,7 @@ private:
   bool  simulate_;			// simulate sensor input
   int	calibration_periods_;		// number of sensor calibration cycles
   double sensor_timeout_;		// sensor timeout (sec)
+  double hertz_;			// driver cycle rate
 
   // ROS topic interfaces
   ros::Subscriber ioadr_state_;         // ioadr/state (position sensor)
@@ -111,6 +117,7 @@ private:
   double last_sensor_time_;	        // previous sensor data time (sec)
   float	set_point_;			// requested steering setting
   float	last_set_point_;                // previous requested steering setting
+  ros::WallTime fault_time_;            // time of last device fault
 
   // sensor calibration data
   int	calibration_cycle_;
@@ -135,6 +142,15 @@ private:
   boost::shared_ptr<devsteer> dev_;     // servo device interface
   boost::shared_ptr<testwheel> tw_;     // wheel self-test class
 
+  // latest messages, from callbacks to device I/O thread, keeping
+  // the deltas of relative commands posted before one was taken
+  typedef MailboxMergeRelative<art_msgs::SteeringCommand,
+                               &art_msgs::SteeringCommand::angle,
+                               art_msgs::SteeringCommand::Degrees,
+                               art_msgs::SteeringCommand::Relative> MergeCmd;
+  Mailbox<art_msgs::SteeringCommand::ConstPtr, MergeCmd> commands_;
+  Mailbox<art_msgs::IOadrState::ConstPtr> positions_;
+
   // polynomials for converting between sensor voltage and angle
   boost::shared_ptr<Polynomial> apoly_; // angle to voltage conversion
 #if defined(USE_VOLTAGE_POLYNOMIAL)
@@ -215,6 +231,8 @@ ArtSteer::ArtSteer():
   mynh.getParam("sensor_timeout", sensor_timeout_);
   ROS_INFO("steering sensor timeout: %.3f seconds.", sensor_timeout_);
 
+  hertz_ = ArtRates::getHertz(mynh, art_msgs::ArtHertz::STEERING);
+
   // allocate and initialize the steering device interface
   dev_->Configure();
 
@@ -275,7 +293,22 @@ void ArtSteer::close()
 }
 
 
+// Subscriber callbacks run in the spinner thread.  They only hand
+// messages to the device I/O thread, so they never wait for the
+// serial port.
+
 void ArtSteer::GetCmd(const art_msgs::SteeringCommand::ConstPtr &cmdIn)
+{
+  commands_.post(cmdIn);
+}
+
+void ArtSteer::GetPos(const art_msgs::IOadrState::ConstPtr &ioIn)
+{
+  positions_.post(ioIn);
+}
+
+// update the set point (in the device I/O thread)
+void ArtSteer::ProcessCmd(const art_msgs::SteeringCommand::ConstPtr &cmdIn)
 {
   switch (cmdIn->request)
     {
@@ -296,7 +329,8 @@ void ArtSteer::GetCmd(const art_msgs::SteeringCommand::ConstPtr &cmdIn)
     }
 }
 
-void ArtSteer::GetPos(const art_msgs::IOadrState::ConstPtr &ioIn)
+// update the wheel angle from the sensor (in the device I/O thread)
+void ArtSteer::ProcessPos(const art_msgs::IOadrState::ConstPtr &ioIn)
 {
   if (simulate_)			// not using real sensor?
     return;
@@ -389,15 +423,44 @@ void ArtSteer::PublishStatus(void)
     }
 }
 
+/** command steering position to match desired set point */
+void ArtSteer::send_set_point(void)
+{
+  if (fabs(set_point_ - last_set_point_) > epsilon)
+    {
+      int rc = dev_->steering_absolute(set_point_);
+      if (rc == 0)
+        last_set_point_ = set_point_;
+    }
+}
+
 // Main function for device thread
+//
+// Runs the driver state machine once per cycle.  Between cycles, it
+// waits for commands, sending each to the device as soon as it
+// arrives, so command latency does not depend on the polling cycle.
+//
 // TODO rationalize these states and bits
 void ArtSteer::run() 
 {
-  ros::Rate cycle(art_msgs::ArtHertz::STEERING); // set driver cycle rate
+  // callbacks run in a separate thread, never blocking on device I/O
+  ros::AsyncSpinner spinner(1);
+  spinner.start();
+
+  ros::Duration cycle(1.0 / hertz_);    // driver cycle period
+  ros::Time next_cycle = ros::Time::now();
+  art_msgs::SteeringCommand::ConstPtr cmd;
+  art_msgs::IOadrState::ConstPtr io;
 
   while(ros::ok())
     {
-      ros::spinOnce();                  // handle incoming commands
+      dev_->tick(ros::Time::now());     // advance simulated device
+
+      // handle latest sensor data and command
+      if (positions_.take(io))
+        ProcessPos(io);
+      if (commands_.take(cmd))
+        ProcessCmd(cmd);
 
       switch (driver_state_)
         {
@@ -414,8 +477,23 @@ void ArtSteer::run()
             read_wheel_angle();         // (may be simulated)
             if (wheel_tested_)          // wheel previously tested?
               {
-                // state: OPENED ==> RUNNING
-                driver_state_ = DriverState::RUNNING;
+                // Reopened after a fault.  The controller restarted,
+                // so resynchronize its encoder with the current
+                // wheel angle, instead of calibrating and testing the
+                // wheel again.
+                int rc = dev_->set_initial_angle(steering_angle_);
+                if (rc == 0)
+                  {
+                    ROS_INFO("steering reconnected in %.3f sec",
+                             (ros::WallTime::now() - fault_time_).toSec());
+                    // state: OPENED ==> RUNNING
+                    driver_state_ = DriverState::RUNNING;
+                  }
+                else
+                  {
+                    ROS_ERROR("steering resynchronization failure");
+                    close();            // (sets state to CLOSED)
+                  }
               }
             else if (wheel_calibrated_)	// initial position known?
               {
@@ -453,14 +531,12 @@ void ArtSteer::run()
             if (rc != 0)                // status bad?
               {
 		ROS_ERROR("bad steering status: closing driver");
+                fault_time_ = ros::WallTime::now();
 		close();		// (sets state to CLOSED)
               }
-            else if (fabs(set_point_ - last_set_point_) > epsilon)
+            else
               {
-                // command steering position to match desired set point.
-                rc = dev_->steering_absolute(set_point_);
-                if (rc == 0)
-                  last_set_point_ = set_point_;
+                send_set_point();
               }
             break;
           }
@@ -468,8 +544,25 @@ void ArtSteer::run()
 
       PublishStatus();                  // publish current status
       last_sensor_time_ = cur_sensor_time_;
-      cycle.sleep();                    // sleep until next cycle
+
+      // schedule next cycle, without trying to catch up if late
+      next_cycle += cycle;
+      if (next_cycle < ros::Time::now())
+        next_cycle = ros::Time::now();
+
+      ros::Duration remaining;
+      while ((remaining = next_cycle - ros::Time::now()) > ros::Duration())
+        {
+          if (commands_.wait(cmd, remaining.toSec()))
+            {
+              ProcessCmd(cmd);
+              if (driver_state_ == DriverState::RUNNING)
+                send_set_point();
+            }
+        }
     }
+
+  spinner.stop();
 }
   
 
@@ -0,0 +1,131 @@
+/*
+ *  Servo driver command mailbox unit test
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+#include <gtest/gtest.h>
+#include <art_msgs/BrakeCommand.h>
+#include <art_msgs/SteeringCommand.h>
+#include "mailbox.h"
+
+using art_msgs::BrakeCommand;
+using art_msgs::SteeringCommand;
+
+typedef MailboxMergeRelative<BrakeCommand, &BrakeCommand::position,
+                             BrakeCommand::Absolute,
+                             BrakeCommand::Relative> MergeBrake;
+typedef Mailbox<BrakeCommand::ConstPtr, MergeBrake> BrakeMailbox;
+
+BrakeCommand::ConstPtr brake_cmd(uint32_t request, float position)
+{
+  BrakeCommand::Ptr cmd(new BrakeCommand());
+  cmd->request = request;
+  cmd->position = position;
+  return cmd;
+}
+
+TEST(Mailbox, latest_value)
+{
+  Mailbox<int> box;
+  int value = 0;
+  EXPECT_FALSE(box.take(value));
+
+  box.post(1);
+  box.post(2);
+  EXPECT_TRUE(box.take(value));
+  EXPECT_EQ(2, value);
+  EXPECT_FALSE(box.take(value));
+  EXPECT_FALSE(box.wait(value, 0.01));
+}
+
+TEST(Mailbox, two_relative)
+{
+  BrakeMailbox box;
+  box.post(brake_cmd(BrakeCommand::Relative, 0.1));
+  box.post(brake_cmd(BrakeCommand::Relative, 0.2));
+
+  BrakeCommand::ConstPtr cmd;
+  ASSERT_TRUE(box.take(cmd));
+  EXPECT_TRUE(cmd->request == BrakeCommand::Relative);
+  EXPECT_FLOAT_EQ(0.3, cmd->position);
+  EXPECT_FALSE(box.take(cmd));
+
+  // once taken, the next delta starts over
+  box.post(brake_cmd(BrakeCommand::Relative, -0.05));
+  ASSERT_TRUE(box.take(cmd));
+  EXPECT_FLOAT_EQ(-0.05, cmd->position);
+}
+
+TEST(Mailbox, absolute_then_relative)
+{
+  BrakeMailbox box;
+  box.post(brake_cmd(BrakeCommand::Absolute, 0.5));
+  box.post(brake_cmd(BrakeCommand::Relative, 0.2));
+  box.post(brake_cmd(BrakeCommand::Relative, -0.1));
+
+  BrakeCommand::ConstPtr cmd;
+  ASSERT_TRUE(box.take(cmd));
+  EXPECT_TRUE(cmd->request == BrakeCommand::Absolute);
+  EXPECT_FLOAT_EQ(0.6, cmd->position);
+}
+
+TEST(Mailbox, relative_then_absolute)
+{
+  BrakeMailbox box;
+  box.post(brake_cmd(BrakeCommand::Relative, 0.2));
+  box.post(brake_cmd(BrakeCommand::Absolute, 0.7));
+
+  BrakeCommand::ConstPtr cmd;
+  ASSERT_TRUE(box.take(cmd));
+  EXPECT_TRUE(cmd->request == BrakeCommand::Absolute);
+  EXPECT_FLOAT_EQ(0.7, cmd->position);
+}
+
+TEST(Mailbox, posted_messages_unchanged)
+{
+  BrakeMailbox box;
+  BrakeCommand::ConstPtr first = brake_cmd(BrakeCommand::Relative, 0.1);
+  BrakeCommand::ConstPtr second = brake_cmd(BrakeCommand::Relative, 0.2);
+  box.post(first);
+  box.post(second);
+
+  // other subscribers may share the messages
+  BrakeCommand::ConstPtr cmd;
+  ASSERT_TRUE(box.take(cmd));
+  EXPECT_FLOAT_EQ(0.1, first->position);
+  EXPECT_FLOAT_EQ(0.2, second->position);
+}
+
+TEST(Mailbox, steering_degrees)
+{
+  typedef MailboxMergeRelative<SteeringCommand, &SteeringCommand::angle,
+                               SteeringCommand::Degrees,
+                               SteeringCommand::Relative> MergeSteering;
+  Mailbox<SteeringCommand::ConstPtr, MergeSteering> box;
+
+  SteeringCommand::Ptr degrees(new SteeringCommand());
+  degrees->request = SteeringCommand::Degrees;
+  degrees->angle = 10.0;
+  SteeringCommand::Ptr relative(new SteeringCommand());
+  relative->request = SteeringCommand::Relative;
+  relative->angle = -2.5;
+  box.post(degrees);
+  box.post(relative);
+  box.post(relative);
+
+  SteeringCommand::ConstPtr cmd;
+  ASSERT_TRUE(box.take(cmd));
+  EXPECT_TRUE(cmd->request == SteeringCommand::Degrees);
+  EXPECT_FLOAT_EQ(5.0, cmd->angle);
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
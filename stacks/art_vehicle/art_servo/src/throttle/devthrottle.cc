@@ -130,6 +130,35 @@ int devthrottle::Open(const char *device)
   return rc;				// Open() failed
 }
 
+/** @brief reopen the port after an I/O fault, without recalibrating
+ *
+ *  The controller may have restarted, so send it the PID parameters
+ *  and the idle position found by calibrate_idle() again, then
+ *  resynchronize it with the last requested position.
+ *
+ *  @return 0 if successful, errno value otherwise
+ */
+int devthrottle::Reconnect(void)
+{
+  if (!have_tty)
+    return 0;				// simulated device never fails
+
+  this->Servo::Close();
+  int rc = this->Servo::Open(devName, (O_RDWR|O_NOCTTY|O_NDELAY|O_NONBLOCK));
+  if (rc != 0) return rc;
+
+  rc = this->configure_raw_port(B115200 | CS8, 0);
+  if (rc == 0 && !training)
+    {
+      rc = configure_controller();
+      if (rc == 0)
+        rc = send_cmd08(SET_IDLE_CMD, avr_pos_min);
+      if (rc == 0)
+        rc = send_goto(pos2avr(last_req));
+    }
+  return rc;
+}
+
 int devthrottle::Close(void)
 {
   throttle_absolute(0.0);		// go to idle position
@@ -249,7 +278,14 @@ int devthrottle::calibrate_idle(void)
   if (rc != 0) return rc;
   cur_position = last_req = 0.0;
 
+  // Poll quickly, but only consider the throttle settled once a
+  // reading has stayed within epsilon of prev_pos for settle_msecs.
+  // That is at least as stable as the previous requirement of two
+  // consecutive readings 50 msec apart, but detects it sooner.
+  const int poll_msecs = 10;
+  const int settle_msecs = 50;
   int prev_pos = -(avr_pos_epsilon*2);	// significantly below zero
+  int64_t prev_time = GetTime();
   for (;;)				// loop until position settles
     {
       rc = send_cmd(STATUS_CMD);
@@ -262,12 +298,18 @@ int devthrottle::calibrate_idle(void)
 	}
 
       int cur_pos = resp.data.status.pos; // current sensor reading
+      int64_t cur_time = GetTime();
 
       // Once in a while, the sensor returns a bogus value.  Only
       // consider cur_pos to be valid when it is within epsilon of the
       // previous reading.  This indicates the throttle has settled to
       // a stable, achievable value.
-      if (abs(cur_pos - prev_pos) <= avr_pos_epsilon)
+      if (abs(cur_pos - prev_pos) > avr_pos_epsilon)
+	{
+	  prev_pos = cur_pos;		// still moving
+	  prev_time = cur_time;
+	}
+      else if (cur_time - prev_time >= settle_msecs)
 	{
 	  if (cur_pos <= AVR_POS_ABSURD)
 	    {
@@ -298,8 +340,7 @@ int devthrottle::calibrate_idle(void)
 	    }
 	}
 
-      usleep(50000);		// wait 50 milliseconds
-      prev_pos = cur_pos;
+      usleep(poll_msecs*1000);
     }
 }
 
@@ -50,6 +50,7 @@ public:
 
   int Open(const char *device);
   int Close(void);
+  int Reconnect(void);
 
   int64_t GetTime();
 
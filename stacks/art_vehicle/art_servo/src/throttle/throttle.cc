@@ -11,10 +11,12 @@
 #include <ros/ros.h>
 
 #include <art_msgs/ArtHertz.h>
+#include <art/rates.h>
 #include <art_msgs/ThrottleCommand.h>
 #include <art_msgs/ThrottleState.h>
 
 #include "devthrottle.h"		// servo device interface
+#include "../mailbox.h"
 
 #define IOADR_MAX_INPUTS  8
 
@@ -55,6 +57,10 @@ Training mode collects data while a human driver operates the vehicle.
     normal operation
   - default: false
 
+- reconnect_failures (int)
+  - consecutive failed device polls before reopening the port
+  - default: 5
+
 @author Jack O'Quin
 */
 
@@ -76,18 +82,32 @@ public:
 
 private:
 
+  void ExecuteCmd(const art_msgs::ThrottleCommand::ConstPtr &cmd);
   void GetCmd(const art_msgs::ThrottleCommand::ConstPtr &cmd);
   void PollDevice(void);
+  void Reconnect(void);
 
   // configuration parameters
   std::string port_;                    // tty port name
   bool	training_;			// use training mode
   bool	diagnostic_;			// enable diagnostic mode
+  double hertz_;			// driver cycle rate
+  int	reconnect_failures_;		// failed polls before reconnect
+
+  int	io_failures_;			// consecutive failed polls
 
   ros::Subscriber throttle_cmd_;        // throttle/cmd
   ros::Publisher  throttle_state_;      // throttle/state
 
   devthrottle *dev_;			// servo device interface
+
+  // latest command, from callback to device I/O thread, keeping
+  // the deltas of relative commands posted before it was taken
+  typedef MailboxMergeRelative<art_msgs::ThrottleCommand,
+                               &art_msgs::ThrottleCommand::position,
+                               art_msgs::ThrottleCommand::Absolute,
+                               art_msgs::ThrottleCommand::Relative> MergeCmd;
+  Mailbox<art_msgs::ThrottleCommand::ConstPtr, MergeCmd> commands_;
 };
 
 // constructor, use pull mode with replace
@@ -110,6 +130,12 @@ Throttle::Throttle()
   if (training_)
     ROS_INFO("using training mode");
 
+  hertz_ = ArtRates::getHertz(mynh, art_msgs::ArtHertz::THROTTLE);
+
+  reconnect_failures_ = 5;
+  mynh.getParam("reconnect_failures", reconnect_failures_);
+  io_failures_ = 0;
+
   // allocate and initialize the devthrottle interface
   dev_ = new devthrottle(training_);
 }
@@ -151,12 +177,22 @@ int Throttle::Shutdown()
   return 0;
 }
 
+// Command callback, runs in the spinner thread.
+//
+// Only hands the command to the device I/O thread, so it never waits
+// for the serial port.
 void Throttle::GetCmd(const art_msgs::ThrottleCommand::ConstPtr &cmd)
 {
   // ignore all throttle command messages when in training mode
   if (training_)
     return;
 
+  commands_.post(cmd);
+}
+
+// send a command to the device (in the device I/O thread)
+void Throttle::ExecuteCmd(const art_msgs::ThrottleCommand::ConstPtr &cmd)
+{
   switch (cmd->request)
     {
     case art_msgs::ThrottleCommand::Absolute:
@@ -194,20 +230,68 @@ void Throttle::PollDevice(void)
 
       msg.header.stamp = ros::Time::now();
       throttle_state_.publish(msg);
+      io_failures_ = 0;
+    }
+  else if (++io_failures_ >= reconnect_failures_)
+    {
+      Reconnect();
+    }
+}
+
+// Reopen the device after repeated I/O failures.
+//
+// The idle position is already calibrated, so this only takes a few
+// commands.  If it fails, the next failed poll tries again.
+void Throttle::Reconnect(void)
+{
+  ROS_WARN("%d consecutive throttle I/O failures, reconnecting",
+           io_failures_);
+  ros::WallTime start = ros::WallTime::now();
+  if (dev_->Reconnect() == 0)
+    {
+      ROS_INFO("throttle reconnected in %.3f sec",
+               (ros::WallTime::now() - start).toSec());
+      io_failures_ = 0;
     }
+  else
+    ROS_ERROR("throttle reconnect failed");
 }
 
 // Main function for device thread
+//
+// Polls the device once per cycle.  Between polls, it waits for
+// commands, sending each as soon as it arrives.  So, command latency
+// does not depend on when the device was last polled.
 void Throttle::Main() 
 {
-  ros::Rate cycle(art_msgs::ArtHertz::THROTTLE); // set driver cycle rate
+  // callbacks run in a separate thread, never blocking on device I/O
+  ros::AsyncSpinner spinner(1);
+  spinner.start();
+
+  ros::Duration cycle(1.0 / hertz_);    // driver cycle period
+  ros::Time next_poll = ros::Time::now();
+  art_msgs::ThrottleCommand::ConstPtr cmd;
 
   while(ros::ok())
     {
       PollDevice();
-      ros::spinOnce();                  // handle incoming commands
-      cycle.sleep();                    // sleep until next cycle
+      if (commands_.take(cmd))          // arrived during the poll?
+        ExecuteCmd(cmd);
+
+      // schedule next poll, without trying to catch up if late
+      next_poll += cycle;
+      if (next_poll < ros::Time::now())
+        next_poll = ros::Time::now();
+
+      ros::Duration remaining;
+      while ((remaining = next_poll - ros::Time::now()) > ros::Duration())
+        {
+          if (commands_.wait(cmd, remaining.toSec()))
+            ExecuteCmd(cmd);
+        }
     }
+
+  spinner.stop();
 }
   
 
@@ -80,6 +80,7 @@ typedef Stg::stg_world_callback_t world_callback_t;
 
 #include <art/frames.h>                 // ART vehicle frames of reference
 
+#include "sensor_faults.h"
 #include "vehicle_model.h"
 
 #define USAGE "artstage [-g] [ <worldfile> ]"
@@ -104,7 +105,8 @@ class StageNode
     // The models that we're interested in
     std::vector<StgLaser *> lasermodels;
     std::vector<Stg::ModelPosition *> positionmodels;
-    std::vector<ros::Publisher> laser_pubs_;
+    typedef FaultyPublisher<sensor_msgs::LaserScan> LaserPublisher;
+    std::vector<boost::shared_ptr<LaserPublisher> > laser_pubs_;
     ros::Publisher clock_pub_;
 
     // ART vehicle dynamics simulation
@@ -283,8 +285,10 @@ StageNode::SubscribeModels()
     }
 
     // subscribe to ROS topics
-    laser_pubs_.push_back(n_.advertise<sensor_msgs::LaserScan>
-                          (mapName(FRONT_LASER,r), 10));
+    ros::NodeHandle private_nh("~");
+    laser_pubs_.push_back(boost::shared_ptr<LaserPublisher>
+                          (new LaserPublisher));
+    laser_pubs_.back()->setup(n_, mapName(FRONT_LASER,r), 10, private_nh);
 
     // set up vehicle model ROS topics
     vehicleModels_[r]->setup();
@@ -296,6 +300,8 @@ StageNode::SubscribeModels()
 StageNode::~StageNode()
 {
   delete[] laserMsgs;
+  for (size_t r = 0; r < laser_pubs_.size(); r++)
+    laser_pubs_[r]->report();
   for (size_t r = 0; r < vehicleModels_.size(); r++)
     delete vehicleModels_[r];
 }
@@ -320,6 +326,10 @@ StageNode::WorldCallback()
     return;
   }
 
+  // deliver any sensor messages delayed until now
+  for (size_t r = 0; r < this->laser_pubs_.size(); r++)
+    this->laser_pubs_[r]->flush(sim_time);
+
   // Get latest laser data
   for (size_t r = 0; r < this->lasermodels.size(); r++)
   {
@@ -356,7 +366,7 @@ StageNode::WorldCallback()
         // TODO map each laser to separate frame and topic names
         this->laserMsgs[r].header.frame_id = "/" + ArtFrames::front_sick;
         this->laserMsgs[r].header.stamp = sim_time;
-        this->laser_pubs_[r].publish(this->laserMsgs[r]);
+        this->laser_pubs_[r]->publish(this->laserMsgs[r], sim_time);
       }
 
 #else // STAGE_VERSION 3
@@ -382,7 +392,7 @@ StageNode::WorldCallback()
       // TODO map each laser to separate frame and topic names
       this->laserMsgs[r].header.frame_id = "/" + ArtFrames::front_sick;
       this->laserMsgs[r].header.stamp = sim_time;
-      this->laser_pubs_[r].publish(this->laserMsgs[r]);
+      this->laser_pubs_[r]->publish(this->laserMsgs[r], sim_time);
     }
 
 #endif // STAGE_VERSION
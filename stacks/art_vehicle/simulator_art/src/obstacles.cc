@@ -4,21 +4,35 @@
 #include <pcl_ros/point_cloud.h>
 #include <pcl/point_types.h>
 
+#include <art/message_pool.h>
+
+#include "sensor_faults.h"
+
 namespace
 {
+  typedef pcl::PointCloud<pcl::PointXYZI> PtCloud;
+
   ros::Subscriber subLaserScan_;
-  ros::Publisher pubPointCloud_;
-  pcl::PointCloud<pcl::PointXYZI> pc_;
+  FaultyPublisher<PtCloud> pubPointCloud_;
+  ros::Timer flushTimer_;
+
+  // outgoing clouds, reused once subscribers are done with them
+  ArtMsgPool::MessagePool<PtCloud> pool_;
 }
 
 void processLaserScan(const sensor_msgs::LaserScan &laserScan) 
 {
+  PtCloud::Ptr cloud = pool_.get();
+  PtCloud &pc = *cloud;
+
   // Pass the header information along (including frame ID)
-  pc_.header = laserScan.header;
+  pc.header = laserScan.header;
 
+  // the points vector only reallocates when a scan is bigger than any
+  // earlier one using this message
   int maxPoints = ceil((laserScan.angle_max - laserScan.angle_min)
                        / laserScan.angle_increment) + 1;
-  pc_.points.resize(maxPoints);
+  pc.points.resize(maxPoints);
 
   float currentAngle = laserScan.angle_min;
   int angleIndex = 0;
@@ -32,10 +46,10 @@ void processLaserScan(const sensor_msgs::LaserScan &laserScan)
       float xPt = cosf(currentAngle) * distance;
       float yPt = sinf(currentAngle) * distance;
 
-      pc_.points[numPoints].x = xPt;
-      pc_.points[numPoints].y = yPt;
-      pc_.points[numPoints].z = 0.25;
-      pc_.points[numPoints].intensity = laserScan.intensities[angleIndex];
+      pc.points[numPoints].x = xPt;
+      pc.points[numPoints].y = yPt;
+      pc.points[numPoints].z = 0.25;
+      pc.points[numPoints].intensity = laserScan.intensities[angleIndex];
       numPoints++;
     }
 
@@ -43,9 +57,14 @@ void processLaserScan(const sensor_msgs::LaserScan &laserScan)
     currentAngle += laserScan.angle_increment;
   }
 
-  pc_.points.resize(numPoints);
+  pc.points.resize(numPoints);
 
-  pubPointCloud_.publish(pc_);
+  pubPointCloud_.publish(cloud, ros::Time::now());
+}
+
+void flushClouds(const ros::TimerEvent &event)
+{
+  pubPointCloud_.flush(ros::Time::now());
 }
 
 int main(int argc, char *argv[]) 
@@ -53,6 +72,15 @@ int main(int argc, char *argv[])
 
   ros::init(argc, argv, "art_simulated_obstacles");
   ros::NodeHandle node;
+  ros::NodeHandle priv_nh("~");
+
+  // outgoing cloud messages, with enough points for most scans
+  int pool_size, max_points;
+  priv_nh.param("pool_size", pool_size, 4);
+  priv_nh.param("max_points", max_points, 1024);
+  pool_.resize(pool_size);
+  for (unsigned i = 0; i < pool_.size(); ++i)
+    pool_[i].points.reserve(max_points);
   
   // Subscribers
   ros::TransportHints noDelay = ros::TransportHints().tcpNoDelay(true);
@@ -60,10 +88,19 @@ int main(int argc, char *argv[])
       node.subscribe("front_sick", 10, &processLaserScan, noDelay);
   
   // Publishers
-  pubPointCloud_ =
-    node.advertise<pcl::PointCloud<pcl::PointXYZI> >("velodyne_obstacles", 10);
+  pubPointCloud_.setup(node, "velodyne_obstacles", 10, priv_nh);
+
+  // deliver delayed clouds at the scan rate or better
+  if (pubPointCloud_.enabled())
+    {
+      double flush_period;
+      priv_nh.param("faults/flush_period", flush_period, 0.01);
+      flushTimer_ = node.createTimer(ros::Duration(flush_period),
+                                     &flushClouds);
+    }
 
   ros::spin();                          // handle incoming data
+  pubPointCloud_.report();
  
   return 0;
 }
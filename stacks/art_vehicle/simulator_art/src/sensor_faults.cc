@@ -0,0 +1,104 @@
+/*
+ *  Copyright (C) 2011 Austin Robot Technology
+ *
+ *  License: Modified BSD Software License Agreement
+ * 
+ *  $Id$
+ */
+
+/**  \file
+ 
+     Simulated sensor message latency, jitter and dropout.
+
+ */
+
+#include <stdlib.h>
+#include "sensor_faults.h"
+
+FaultModel::FaultModel()
+{
+  configure(0.0, 0.0, 0.0, 0.0, 0.5, 1);
+}
+
+void FaultModel::configure(double latency, double jitter, double drop,
+                           double stall, double stall_duration,
+                           unsigned seed)
+{
+  latency_ = latency;
+  jitter_ = jitter;
+  drop_ = drop;
+  stall_ = stall;
+  stall_duration_ = stall_duration;
+  seed_ = seed;
+  enabled_ = (latency_ > 0.0 || jitter_ > 0.0 || drop_ > 0.0
+              || (stall_ > 0.0 && stall_duration_ > 0.0));
+
+  offered = dropped = 0;
+  total_delay = max_delay = 0.0;
+  last_due_ = stall_end_ = ros::Time();
+}
+
+void FaultModel::configure(const ros::NodeHandle &priv,
+                           const std::string &topic)
+{
+  ros::NodeHandle nh(priv, "faults/" + topic);
+  double latency, jitter, drop, stall, stall_duration;
+  nh.param("latency", latency, 0.0);
+  nh.param("jitter", jitter, 0.0);
+  nh.param("drop", drop, 0.0);
+  nh.param("stall", stall, 0.0);
+  nh.param("stall_duration", stall_duration, 0.5);
+
+  // each topic gets its own repeatable random sequence
+  int seed;
+  priv.param("faults/seed", seed, 1);
+  unsigned topic_seed = seed;
+  for (unsigned i = 0; i < topic.size(); ++i)
+    topic_seed = topic_seed * 31 + (unsigned char) topic[i];
+
+  configure(latency, jitter, drop, stall, stall_duration, topic_seed);
+  if (enabled_)
+    ROS_INFO("%s faults: latency %.3f s, jitter %.3f s, drop %.3f, "
+             "stall %.3f for %.3f s", topic.c_str(), latency_, jitter_,
+             drop_, stall_, stall_duration_);
+}
+
+bool FaultModel::schedule(const ros::Time &now, ros::Time &due)
+{
+  ++offered;
+
+  // always draw the same random values for every message
+  bool drop = (uniform() < drop_);
+  bool stall = (uniform() < stall_);
+  double delay = latency_ + jitter_ * uniform();
+
+  if (drop)
+    {
+      ++dropped;
+      return false;
+    }
+
+  if (stall && now >= stall_end_)
+    stall_end_ = now + ros::Duration(stall_duration_);
+
+  due = now + ros::Duration(delay);
+  if (due < stall_end_)                 // held until the stall ends
+    due = stall_end_;
+  if (due < last_due_)                  // never overtake earlier messages
+    due = last_due_;
+  last_due_ = due;
+
+  delay = (due - now).toSec();
+  total_delay += delay;
+  if (delay > max_delay)
+    max_delay = delay;
+  return true;
+}
+
+void FaultModel::report(const std::string &topic) const
+{
+  unsigned delivered = offered - dropped;
+  ROS_INFO("%s faults: %u of %u messages dropped, delay mean %.3f s, "
+           "max %.3f s", topic.c_str(), dropped, offered,
+           (delivered? total_delay / delivered: 0.0), max_delay);
+}
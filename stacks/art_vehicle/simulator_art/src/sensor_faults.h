@@ -0,0 +1,188 @@
+/* -*- mode: C++ -*-
+ *
+ *  Copyright (C) 2011 Austin Robot Technology
+ *
+ *  License: Modified BSD Software License Agreement
+ * 
+ *  $Id$
+ */
+
+/**  \file
+ 
+     Simulated sensor message latency, jitter and dropout.
+
+     Each simulated sensor topic may be configured with private
+     parameters in the "faults/<topic>" namespace of its node:
+
+     - \b latency (double): fixed delivery delay (s) [0.0]
+     - \b jitter (double): additional random delay, uniform between
+       zero and this value (s) [0.0]
+     - \b drop (double): probability each message is lost [0.0]
+     - \b stall (double): probability each message starts a stall,
+       during which nothing is delivered; the messages held back then
+       arrive together in a burst [0.0]
+     - \b stall_duration (double): length of each stall (s) [0.5]
+
+     The random sequence for each topic depends only on the topic name
+     and the node's \b ~faults/seed parameter [default: 1], so runs
+     with the same parameters and world file are repeatable.  Each
+     message draws the same number of random values regardless of the
+     parameters, so varying the latency does not change which
+     messages are dropped.
+
+     Messages are delivered in order, with their original time
+     stamps, at the first simulation step after they are due.  With
+     no parameters set, they are published immediately, as before.
+ 
+ */
+
+#ifndef _SENSOR_FAULTS_H_
+#define _SENSOR_FAULTS_H_ 1
+
+#include <stdlib.h>
+#include <deque>
+#include <string>
+#include <utility>
+#include <boost/shared_ptr.hpp>
+#include <ros/ros.h>
+
+/** Delivery timing model for one simulated sensor topic. */
+class FaultModel
+{
+public:
+
+  FaultModel();
+
+  /** set model parameters directly */
+  void configure(double latency, double jitter, double drop,
+                 double stall, double stall_duration, unsigned seed);
+
+  /** read model parameters for a topic from the private namespace
+   *
+   *  @param priv node's private handle
+   *  @param topic name of the simulated topic
+   */
+  void configure(const ros::NodeHandle &priv, const std::string &topic);
+
+  /** @return true if any faults are configured */
+  bool enabled(void) const { return enabled_; }
+
+  /** schedule delivery of a message
+   *
+   *  @param now simulation time the message was produced
+   *  @param[out] due simulation time to deliver it
+   *  @return false if the message is dropped
+   */
+  bool schedule(const ros::Time &now, ros::Time &due);
+
+  /** log delivery statistics */
+  void report(const std::string &topic) const;
+
+  // delivery statistics
+  unsigned offered;                     ///< messages produced
+  unsigned dropped;                     ///< messages lost
+  double total_delay;                   ///< sum of delivery delays (s)
+  double max_delay;                     ///< longest delivery delay (s)
+
+private:
+
+  double uniform(void)
+  {
+    return rand_r(&seed_) / ((double) RAND_MAX + 1.0);
+  }
+
+  bool enabled_;
+  double latency_;
+  double jitter_;
+  double drop_;
+  double stall_;
+  double stall_duration_;
+  unsigned seed_;
+
+  ros::Time last_due_;                  ///< keeps deliveries in order
+  ros::Time stall_end_;                 ///< end of current stall
+};
+
+/** Publisher for a simulated sensor topic with delivery faults.
+ *
+ *  Delayed messages are held until flush() is called with a time
+ *  after they are due, normally once per simulation step.
+ */
+template <class M>
+class FaultyPublisher
+{
+public:
+
+  typedef boost::shared_ptr<M> MsgPtr;
+
+  /** advertise a topic and configure its fault model */
+  void setup(ros::NodeHandle &node, const std::string &topic,
+             uint32_t queue_size, const ros::NodeHandle &priv)
+  {
+    topic_ = topic;
+    pub_ = node.advertise<M>(topic, queue_size);
+    model_.configure(priv, topic);
+  }
+
+  /** publish a message produced at simulation time now
+   *
+   *  The message is only copied if its delivery is delayed.
+   */
+  void publish(const M &msg, const ros::Time &now)
+  {
+    ros::Time due;
+    if (!model_.enabled())
+      pub_.publish(msg);
+    else if (model_.schedule(now, due))
+      {
+        if (due <= now)
+          pub_.publish(msg);
+        else
+          pending_.push_back(std::make_pair(due, MsgPtr(new M(msg))));
+      }
+  }
+
+  /** publish a shared message produced at simulation time now */
+  void publish(const MsgPtr &msg, const ros::Time &now)
+  {
+    ros::Time due;
+    if (!model_.enabled())
+      pub_.publish(msg);
+    else if (model_.schedule(now, due))
+      {
+        if (due <= now)
+          pub_.publish(msg);
+        else
+          pending_.push_back(std::make_pair(due, msg));
+      }
+  }
+
+  /** deliver any delayed messages due by simulation time now */
+  void flush(const ros::Time &now)
+  {
+    while (!pending_.empty() && pending_.front().first <= now)
+      {
+        pub_.publish(pending_.front().second);
+        pending_.pop_front();
+      }
+  }
+
+  /** @return true if any faults are configured */
+  bool enabled(void) const { return model_.enabled(); }
+
+  /** log delivery statistics, if any faults are configured */
+  void report(void) const
+  {
+    if (model_.enabled())
+      model_.report(topic_);
+  }
+
+private:
+
+  std::string topic_;
+  ros::Publisher pub_;
+  FaultModel model_;
+  std::deque<std::pair<ros::Time, MsgPtr> > pending_;
+};
+
+#endif // _SENSOR_FAULTS_H_
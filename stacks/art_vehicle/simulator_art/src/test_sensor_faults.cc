@@ -0,0 +1,108 @@
+/*
+ *  Copyright (C) 2011 Austin Robot Technology
+ *
+ *  License: Modified BSD Software License Agreement
+ * 
+ *  $Id$
+ */
+
+/**  \file
+ 
+     Unit tests for simulated sensor delivery faults.
+
+ */
+
+#include <vector>
+#include <gtest/gtest.h>
+#include "sensor_faults.h"
+
+// offer n messages at 10 Hz, recording delivery delays (-1 if dropped)
+std::vector<double> deliver(FaultModel &model, int n)
+{
+  std::vector<double> delays;
+  ros::Time t0(100.0);
+  for (int i = 0; i < n; ++i)
+    {
+      ros::Time now = t0 + ros::Duration(0.1 * i);
+      ros::Time due;
+      if (model.schedule(now, due))
+        delays.push_back((due - now).toSec());
+      else
+        delays.push_back(-1.0);
+    }
+  return delays;
+}
+
+TEST(FaultModel, disabled)
+{
+  FaultModel model;
+  EXPECT_FALSE(model.enabled());
+  std::vector<double> delays = deliver(model, 10);
+  for (unsigned i = 0; i < delays.size(); ++i)
+    EXPECT_DOUBLE_EQ(0.0, delays[i]);
+}
+
+TEST(FaultModel, latency_jitter)
+{
+  FaultModel model;
+  model.configure(0.05, 0.02, 0.0, 0.0, 0.5, 1);
+  EXPECT_TRUE(model.enabled());
+  std::vector<double> delays = deliver(model, 1000);
+  for (unsigned i = 0; i < delays.size(); ++i)
+    {
+      EXPECT_LE(0.05 - 1e-6, delays[i]);
+      EXPECT_GE(0.07 + 1e-6, delays[i]);
+    }
+  EXPECT_EQ(0u, model.dropped);
+  EXPECT_NEAR(0.06, model.total_delay / model.offered, 0.002);
+}
+
+TEST(FaultModel, in_order)
+{
+  // jitter longer than the message period never reorders messages
+  FaultModel model;
+  model.configure(0.0, 0.5, 0.0, 0.0, 0.5, 1);
+  std::vector<double> delays = deliver(model, 100);
+  for (unsigned i = 1; i < delays.size(); ++i)
+    EXPECT_LE(0.1 * (i-1) + delays[i-1], 0.1 * i + delays[i] + 1e-6);
+}
+
+TEST(FaultModel, drop)
+{
+  FaultModel model;
+  model.configure(0.0, 0.0, 0.2, 0.0, 0.5, 1);
+  deliver(model, 5000);
+  EXPECT_NEAR(0.2, model.dropped / (double) model.offered, 0.02);
+}
+
+TEST(FaultModel, stall)
+{
+  // every message starts a stall once the previous one ends, so
+  // messages arrive in bursts of five, each 0.5 sec
+  FaultModel model;
+  model.configure(0.0, 0.0, 0.0, 1.0, 0.5, 1);
+  std::vector<double> delays = deliver(model, 10);
+  const double expected[] = {0.5, 0.4, 0.3, 0.2, 0.1,
+                             0.5, 0.4, 0.3, 0.2, 0.1};
+  for (unsigned i = 0; i < delays.size(); ++i)
+    EXPECT_NEAR(expected[i], delays[i], 1e-6);
+}
+
+TEST(FaultModel, repeatable)
+{
+  // the same seed drops the same messages, whatever the latency
+  FaultModel a, b;
+  a.configure(0.0, 0.0, 0.3, 0.0, 0.5, 42);
+  b.configure(0.2, 0.1, 0.3, 0.0, 0.5, 42);
+  std::vector<double> da = deliver(a, 200);
+  std::vector<double> db = deliver(b, 200);
+  for (unsigned i = 0; i < da.size(); ++i)
+    EXPECT_EQ(da[i] < 0.0, db[i] < 0.0);
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
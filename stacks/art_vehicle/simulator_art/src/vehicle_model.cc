@@ -35,14 +35,14 @@ void ArtVehicleModel::setup(void)
   int qDepth = 1;
   ros::TransportHints noDelay = ros::TransportHints().tcpNoDelay(true);
 
-  odom_pub_ =
-    node_.advertise<nav_msgs::Odometry>(ns_prefix_ + "odom", qDepth);
+  // simulated sensor topics, with optional delivery faults (ground
+  // truth is always delivered immediately)
+  ros::NodeHandle private_nh("~");
+  odom_pub_.setup(node_, ns_prefix_ + "odom", qDepth, private_nh);
   ground_truth_pub_ =
     node_.advertise<nav_msgs::Odometry>(ns_prefix_ + "ground_truth", qDepth);
-  imu_pub_ =
-    node_.advertise<sensor_msgs::Imu>(ns_prefix_ + "imu", qDepth);
-  gps_pub_ =
-    node_.advertise<art_msgs::GpsInfo>(ns_prefix_ + "gps", qDepth);
+  imu_pub_.setup(node_, ns_prefix_ + "imu", qDepth, private_nh);
+  gps_pub_.setup(node_, ns_prefix_ + "gps", qDepth, private_nh);
   
   // servo state topics
   brake_sub_ =
@@ -59,7 +59,6 @@ void ArtVehicleModel::setup(void)
                     &ArtVehicleModel::throttleReceived, this, noDelay);
 
   // set default GPS origin, from SwRI site visit in San Antonio
-  ros::NodeHandle private_nh("~");
   private_nh.param("latitude",  origin_lat_,   29.446018);
   private_nh.param("longitude", origin_long_, -98.607024);
   private_nh.param("elevation", origin_elev_, 100.0);
@@ -198,6 +197,11 @@ void ArtVehicleModel::update(ros::Time sim_time)
 {
   sensor_msgs::Imu imu_msg;
 
+  // deliver any sensor messages delayed until now
+  odom_pub_.flush(sim_time);
+  imu_pub_.flush(sim_time);
+  gps_pub_.flush(sim_time);
+
   // model vehicle acceleration from servo actuators
   ModelAcceleration(&odomMsg_.twist.twist, &imu_msg, sim_time);
 
@@ -212,13 +216,13 @@ void ArtVehicleModel::update(ros::Time sim_time)
   odomMsg_.header.stamp = sim_time;
   odomMsg_.header.frame_id = tf_prefix_ + ArtFrames::earth;
   odomMsg_.child_frame_id = tf_prefix_ + ArtFrames::vehicle;
-  odom_pub_.publish(odomMsg_);
+  odom_pub_.publish(odomMsg_, sim_time);
 
   // publish simulated IMU data
   imu_msg.header.stamp = sim_time;
   imu_msg.header.frame_id = tf_prefix_ + ArtFrames::vehicle;
   imu_msg.orientation = odomMsg_.pose.pose.orientation;
-  imu_pub_.publish(imu_msg);
+  imu_pub_.publish(imu_msg, sim_time);
 
   // broadcast /earth transform relative to sea level
   tf::Quaternion vehicleQ;
@@ -291,5 +295,5 @@ void ArtVehicleModel::publishGPS(ros::Time sim_time)
   gpsi.quality = art_msgs::GpsInfo::DGPS_FIX;
   gpsi.num_sats = 9;
 
-  gps_pub_.publish(gpsi);
+  gps_pub_.publish(gpsi, sim_time);
 }
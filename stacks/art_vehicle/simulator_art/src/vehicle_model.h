@@ -34,6 +34,9 @@
 #include <art_msgs/Shifter.h>
 #include <art_msgs/SteeringState.h>
 #include <art_msgs/ThrottleState.h>
+#include <art_msgs/GpsInfo.h>
+
+#include "sensor_faults.h"
 
 // Corresponding ROS relative names
 #define BRAKE_STATE    "brake/state"
@@ -61,7 +64,12 @@ public:
     steering_angle_ = 0.0;
     throttle_position_ = 0.0;
   }
-  ~ArtVehicleModel() {};
+  ~ArtVehicleModel()
+  {
+    odom_pub_.report();
+    imu_pub_.report();
+    gps_pub_.report();
+  };
 
   void update(ros::Time sim_time);      // update vehicle model
   void setup(void);                     // set up ROS topics
@@ -82,13 +90,13 @@ private:
   std::string tf_prefix_;               // transform ID prefix
 
   nav_msgs::Odometry odomMsg_;
-  ros::Publisher odom_pub_;
+  FaultyPublisher<nav_msgs::Odometry> odom_pub_;
   nav_msgs::Odometry groundTruthMsg_;
   ros::Publisher ground_truth_pub_;
   ros::Time last_update_time_;
 
-  ros::Publisher imu_pub_;
-  ros::Publisher gps_pub_;
+  FaultyPublisher<sensor_msgs::Imu> imu_pub_;
+  FaultyPublisher<art_msgs::GpsInfo> gps_pub_;
 
   // servo device interfaces
   ros::Subscriber brake_sub_;